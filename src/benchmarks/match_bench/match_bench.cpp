@@ -0,0 +1,403 @@
+/**
+ * @file match_bench.cpp
+ * Plays whole matches between the built in scripted players over a corpus of
+ * maps, and reports the turns per second, the time spent in each phase of a
+ * turn and the peak memory of each match
+ *
+ * Usage: match_bench [options] [map_file_or_dir...]
+ *
+ *   --mode <in_process|multi_process|all>  How matches are run, default all
+ *   --matchup <player_1>,<player_2>        Scripted players to match up, may
+ *                                          be repeated
+ *   --update-threads <n>                   Threads that plan the moves of bots
+ *   --path-heuristic <euclidean|landmarks> Heuristic of the path searches,
+ *                                          default euclidean
+ *   --path-planner <visibility|hierarchical|jps>
+ *                                          Path finder, default visibility
+ *   --min-turns-per-second <mode>=<n>      Fail if a match of the mode runs
+ *                                          fewer turns per second
+ *   --max-peak-rss-mb <n>                  Fail if a match peaks above this
+ *   --csv <file>                           Also write the results as CSV
+ *   --keep-run-dirs                        Keep the multi process matches'
+ *                                          directories and logs
+ *
+ * Map directories are searched for .txt files. With no maps, map.txt in the
+ * working directory is played. In process matches call the players' code
+ * directly and time each phase, multi process matches run main with the
+ * scripted_player executable as both players, found next to match_bench.
+ * In process matches also report the nodes each path search expanded, to
+ * compare heuristics and path finders by, and the searches saved per turn by
+ * sharing them between bots heading to the same destination.
+ * Exits with 1 if a threshold is crossed, and 2 on bad usage or a failed match
+ */
+
+#include "match_bench/match_runner.h"
+#include "scripted_players/scripted_players.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+
+const auto IN_PROCESS = std::string("in_process");
+const auto MULTI_PROCESS = std::string("multi_process");
+
+/**
+ * Matchups played when none are given, covering every scripted player
+ */
+const auto DEFAULT_MATCHUPS = std::vector<std::array<std::string, 2>>{
+    {"flag_rusher", "blast_swarm"},
+    {"tower_spammer", "flag_rusher"},
+    {"blast_swarm", "tower_spammer"},
+    {"idle", "idle"}};
+
+struct Options {
+    std::vector<std::string> modes = {IN_PROCESS, MULTI_PROCESS};
+    std::vector<std::array<std::string, 2>> matchups;
+    size_t num_update_threads = 1;
+    std::string path_heuristic = "euclidean";
+    std::string path_planner = "visibility";
+    std::map<std::string, double> min_turns_per_second;
+    double max_peak_rss_mb = 0;
+    std::string csv_file_name;
+    bool keep_run_dirs = false;
+    std::vector<std::string> map_paths;
+};
+
+/**
+ * Parses a number from an option's value
+ *
+ * @throw std::invalid_argument If the value is not a positive number
+ */
+template <typename T> T parsePositive(const std::string &value) {
+    auto value_stream = std::istringstream(value);
+    T number;
+    if (!(value_stream >> number) || !value_stream.eof() || !(number > 0)) {
+        throw std::invalid_argument("Expected a positive number, got " +
+                                    value);
+    }
+    return number;
+}
+
+/**
+ * Parses the command line
+ *
+ * @throw std::invalid_argument If an option is unknown or malformed
+ */
+Options parseOptions(int argc, char *argv[]) {
+    auto options = Options{};
+    for (int i = 1; i < argc; ++i) {
+        auto argument = std::string(argv[i]);
+        auto is_option = argument.compare(0, 2, "--") == 0;
+        auto has_value = i + 1 < argc;
+
+        if (argument == "--keep-run-dirs") {
+            options.keep_run_dirs = true;
+        } else if (is_option && !has_value) {
+            throw std::invalid_argument(argument + " needs a value");
+        } else if (argument == "--mode") {
+            auto mode = std::string(argv[++i]);
+            if (mode == "all") {
+                options.modes = {IN_PROCESS, MULTI_PROCESS};
+            } else if (mode == IN_PROCESS || mode == MULTI_PROCESS) {
+                options.modes = {mode};
+            } else {
+                throw std::invalid_argument("Unknown mode " + mode);
+            }
+        } else if (argument == "--matchup") {
+            auto matchup = std::string(argv[++i]);
+            auto separator = matchup.find(',');
+            if (separator == std::string::npos) {
+                throw std::invalid_argument("Expected two players, got " +
+                                            matchup);
+            }
+            auto player_names = std::array<std::string, 2>{
+                matchup.substr(0, separator), matchup.substr(separator + 1)};
+            // Unknown players are rejected before any match is played
+            for (const auto &player_name : player_names) {
+                scripted_players::buildScriptedPlayer(player_name);
+            }
+            options.matchups.push_back(player_names);
+        } else if (argument == "--update-threads") {
+            options.num_update_threads = parsePositive<size_t>(argv[++i]);
+        } else if (argument == "--path-heuristic") {
+            options.path_heuristic = argv[++i];
+            if (options.path_heuristic != "euclidean" &&
+                options.path_heuristic != "landmarks") {
+                throw std::invalid_argument("Unknown path heuristic " +
+                                            options.path_heuristic);
+            }
+        } else if (argument == "--path-planner") {
+            options.path_planner = argv[++i];
+            if (options.path_planner != "visibility" &&
+                options.path_planner != "hierarchical" &&
+                options.path_planner != "jps") {
+                throw std::invalid_argument("Unknown path planner " +
+                                            options.path_planner);
+            }
+        } else if (argument == "--min-turns-per-second") {
+            auto threshold = std::string(argv[++i]);
+            auto separator = threshold.find('=');
+            auto mode = threshold.substr(0, separator);
+            if (separator == std::string::npos ||
+                (mode != IN_PROCESS && mode != MULTI_PROCESS)) {
+                throw std::invalid_argument("Expected <mode>=<n>, got " +
+                                            threshold);
+            }
+            options.min_turns_per_second[mode] =
+                parsePositive<double>(threshold.substr(separator + 1));
+        } else if (argument == "--max-peak-rss-mb") {
+            options.max_peak_rss_mb = parsePositive<double>(argv[++i]);
+        } else if (argument == "--csv") {
+            options.csv_file_name = argv[++i];
+        } else if (is_option) {
+            throw std::invalid_argument("Unknown option " + argument);
+        } else {
+            options.map_paths.push_back(argument);
+        }
+    }
+
+    if (options.matchups.empty()) {
+        options.matchups = DEFAULT_MATCHUPS;
+    }
+    if (options.map_paths.empty()) {
+        options.map_paths.push_back("map.txt");
+    }
+    return options;
+}
+
+/**
+ * Lists the map files of the corpus, taking the .txt files of directories
+ *
+ * @throw std::runtime_error If a path does not exist
+ */
+std::vector<std::string> findMapFiles(const std::vector<std::string> &paths) {
+    auto map_files = std::vector<std::string>{};
+    for (const auto &path : paths) {
+        struct stat path_stat;
+        if (stat(path.c_str(), &path_stat) != 0) {
+            throw std::runtime_error("Could not find map " + path);
+        }
+        if (!S_ISDIR(path_stat.st_mode)) {
+            map_files.push_back(path);
+            continue;
+        }
+
+        auto dir_map_files = std::vector<std::string>{};
+        auto dir = opendir(path.c_str());
+        while (auto entry = readdir(dir)) {
+            auto name = std::string(entry->d_name);
+            if (name.size() > 4 && name.substr(name.size() - 4) == ".txt") {
+                dir_map_files.push_back(path + "/" + name);
+            }
+        }
+        closedir(dir);
+
+        std::sort(dir_map_files.begin(), dir_map_files.end());
+        map_files.insert(map_files.end(), dir_map_files.begin(),
+                         dir_map_files.end());
+    }
+    return map_files;
+}
+
+/**
+ * Finds the directory holding this executable, and so main and
+ * scripted_player
+ */
+std::string findBinDir() {
+    char path[PATH_MAX];
+    auto path_length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (path_length < 0) {
+        throw std::runtime_error("Could not find the match_bench executable");
+    }
+    auto exe_path = std::string(path, path_length);
+    return exe_path.substr(0, exe_path.rfind('/'));
+}
+
+struct MatchRecord {
+    std::string mode;
+    MatchConfig config;
+    MatchResult result;
+
+    double getTurnsPerSecond() const {
+        return result.num_turns / result.seconds;
+    }
+
+    double getPeakRssMb() const { return result.peak_rss_kb / 1024.0; }
+
+    double getExpandedNodesPerSearch() const {
+        const auto &stats = result.path_search_stats;
+        if (stats.num_searches == 0)
+            return 0;
+        return static_cast<double>(stats.num_expanded_nodes) /
+               stats.num_searches;
+    }
+
+    double getSavedSearchesPerTurn() const {
+        return static_cast<double>(
+                   result.path_search_stats.num_saved_searches) /
+               result.num_turns;
+    }
+};
+
+void printMatch(const MatchRecord &record) {
+    std::cout << std::fixed << std::setprecision(1) << record.mode << "  "
+              << record.config.map_file_name << "  "
+              << record.config.player_names[0] << " vs "
+              << record.config.player_names[1] << "  "
+              << record.getTurnsPerSecond() << " turns/s  "
+              << record.result.seconds * 1000 << " ms  peak RSS "
+              << record.getPeakRssMb() << " MB  " << record.result.outcome
+              << '\n';
+
+    if (record.result.path_search_stats.num_searches > 0) {
+        std::cout << "    " << record.result.path_search_stats.num_searches
+                  << " path searches, " << record.getExpandedNodesPerSearch()
+                  << " nodes expanded per search, "
+                  << record.getSavedSearchesPerTurn()
+                  << " searches saved per turn\n";
+    }
+
+    for (const auto &phase : record.result.phase_seconds) {
+        std::cout << "    " << std::left << std::setw(22) << phase.first
+                  << std::right << std::setprecision(2) << std::setw(10)
+                  << phase.second * 1e6 / record.result.num_turns
+                  << " us/turn\n";
+    }
+}
+
+void writeCsv(std::ostream &csv, const std::vector<MatchRecord> &records) {
+    csv << "mode,map,player_1,player_2,turns,seconds,turns_per_second,"
+           "peak_rss_kb,path_searches,expanded_nodes,saved_searches,phase,"
+           "phase_seconds\n";
+    for (const auto &record : records) {
+        auto match_columns = std::ostringstream();
+        match_columns << record.mode << ',' << record.config.map_file_name
+                      << ',' << record.config.player_names[0] << ','
+                      << record.config.player_names[1] << ','
+                      << record.result.num_turns << ',' << record.result.seconds
+                      << ',' << record.getTurnsPerSecond() << ','
+                      << record.result.peak_rss_kb << ','
+                      << record.result.path_search_stats.num_searches << ','
+                      << record.result.path_search_stats.num_expanded_nodes
+                      << ','
+                      << record.result.path_search_stats.num_saved_searches;
+
+        // One row per phase, or a single row without phases
+        csv << match_columns.str() << ",total," << record.result.seconds
+            << '\n';
+        for (const auto &phase : record.result.phase_seconds) {
+            csv << match_columns.str() << ',' << phase.first << ','
+                << phase.second << '\n';
+        }
+    }
+}
+
+/**
+ * Checks a match against the thresholds, and reports any it crosses
+ *
+ * @return true If the match is within the thresholds
+ */
+bool checkThresholds(const Options &options, const MatchRecord &record) {
+    auto is_within_thresholds = true;
+
+    auto min_turns_per_second = options.min_turns_per_second.find(record.mode);
+    if (min_turns_per_second != options.min_turns_per_second.end() &&
+        record.getTurnsPerSecond() < min_turns_per_second->second) {
+        std::cout << "REGRESSION: " << record.getTurnsPerSecond()
+                  << " turns/s is below " << min_turns_per_second->second
+                  << '\n';
+        is_within_thresholds = false;
+    }
+
+    if (options.max_peak_rss_mb > 0 &&
+        record.getPeakRssMb() > options.max_peak_rss_mb) {
+        std::cout << "REGRESSION: peak RSS of " << record.getPeakRssMb()
+                  << " MB is above " << options.max_peak_rss_mb << " MB\n";
+        is_within_thresholds = false;
+    }
+
+    return is_within_thresholds;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    std::vector<std::string> map_files;
+    std::string bin_dir;
+    try {
+        options = parseOptions(argc, argv);
+        map_files = findMapFiles(options.map_paths);
+        bin_dir = findBinDir();
+    } catch (const std::exception &error) {
+        std::cerr << "Error! " << error.what() << '\n';
+        return 2;
+    }
+
+    auto records = std::vector<MatchRecord>{};
+    auto is_within_thresholds = true;
+    for (const auto &mode : options.modes) {
+        auto num_turns = size_t{0};
+        auto seconds = 0.0;
+        auto path_search_stats = state::PathSearchStats{};
+
+        for (const auto &map_file : map_files) {
+            for (const auto &matchup : options.matchups) {
+                auto record = MatchRecord{
+                    mode,
+                    MatchConfig{map_file, matchup, options.num_update_threads,
+                                options.path_heuristic, options.path_planner},
+                    MatchResult{}};
+                try {
+                    record.result =
+                        mode == IN_PROCESS
+                            ? runInProcessMatch(record.config)
+                            : runMultiProcessMatch(record.config, bin_dir,
+                                                   options.keep_run_dirs);
+                } catch (const std::exception &error) {
+                    std::cerr << "Error! " << error.what() << '\n';
+                    return 2;
+                }
+
+                printMatch(record);
+                is_within_thresholds &= checkThresholds(options, record);
+                num_turns += record.result.num_turns;
+                seconds += record.result.seconds;
+                path_search_stats += record.result.path_search_stats;
+                records.push_back(record);
+            }
+        }
+
+        std::cout << mode << " overall: " << num_turns / seconds
+                  << " turns/s";
+        if (path_search_stats.num_searches > 0) {
+            std::cout << ", "
+                      << static_cast<double>(
+                             path_search_stats.num_expanded_nodes) /
+                             path_search_stats.num_searches
+                      << " nodes expanded per path search";
+        }
+        std::cout << "\n\n";
+    }
+
+    if (!options.csv_file_name.empty()) {
+        auto csv_file = std::ofstream(options.csv_file_name);
+        writeCsv(csv_file, records);
+    }
+
+    return is_within_thresholds ? 0 : 1;
+}
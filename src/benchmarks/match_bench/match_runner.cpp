@@ -0,0 +1,383 @@
+/**
+ * @file match_runner.cpp
+ * Definitions for running whole matches between scripted players
+ */
+
+#include "match_bench/match_runner.h"
+#include "constants/constants.h"
+#include "logger/logger.h"
+#include "main/state_builder.h"
+#include "player_wrapper/player_code_wrapper.h"
+#include "player_wrapper/transfer_state.h"
+#include "scripted_players/scripted_players.h"
+#include "state/command_buffer.h"
+#include "state/command_giver.h"
+#include "state/player_state.h"
+#include "state/state_syncer.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+using namespace Constants::Actor;
+using namespace Constants::Simulator;
+
+namespace bench {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Phases of a turn run in process, in the order they run
+ */
+enum Phase {
+    // Copying the player states into the form sent over shared memory
+    TRANSFER_STATE,
+    // Running both players' code, from the transfer state to the commands
+    PLAYER_CODE,
+    // The phases of StateSyncer::updateMainState
+    RUN_COMMANDS,
+    REMOVE_DEAD_ACTORS,
+    UPDATE_STATE,
+    LOG_STATE,
+    UPDATE_PLAYER_STATES,
+    // Writing the game log, once at the end of the match
+    WRITE_GAME,
+    NUM_PHASES
+};
+
+const std::array<const char *, NUM_PHASES> PHASE_NAMES = {
+    "transfer_state",       "player_code",  "run_commands",
+    "remove_dead_actors",   "update_state", "log_state",
+    "update_player_states", "write_game"};
+
+/**
+ * Runs a function and adds the time it took to its phase
+ */
+template <typename Function>
+void timePhase(std::array<Clock::duration, NUM_PHASES> &phase_durations,
+               Phase phase, Function function) {
+    auto start = Clock::now();
+    function();
+    phase_durations[phase] += Clock::now() - start;
+}
+
+double toSeconds(Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+/**
+ * Resets the peak resident set size of this process, so that the peak of a
+ * match is not hidden by an earlier match. Kernels without the reset leave
+ * the peak over the whole process
+ */
+void resetPeakRss() { std::ofstream("/proc/self/clear_refs") << "5"; }
+
+int64_t getPeakRssKb() {
+    auto usage = rusage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * Makes a fresh directory to run a match in
+ */
+std::string makeRunDir() {
+    auto temp_dir = std::getenv("TMPDIR");
+    auto run_dir_template =
+        std::string(temp_dir != nullptr ? temp_dir : "/tmp") +
+        "/match_bench.XXXXXX";
+    if (mkdtemp(&run_dir_template[0]) == nullptr) {
+        throw std::runtime_error("Could not make a run directory: " +
+                                 std::string(std::strerror(errno)));
+    }
+    return run_dir_template;
+}
+
+/**
+ * Removes a run directory, which only holds files
+ */
+void removeRunDir(const std::string &run_dir) {
+    auto dir = opendir(run_dir.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    while (auto entry = readdir(dir)) {
+        auto name = std::string(entry->d_name);
+        if (name != "." && name != "..") {
+            unlink((run_dir + "/" + name).c_str());
+        }
+    }
+    closedir(dir);
+    rmdir(run_dir.c_str());
+}
+
+/**
+ * Builds the environment of the main process, which its players inherit
+ */
+std::vector<std::string> buildEnvironment(const MatchConfig &config) {
+    auto overrides = std::vector<std::pair<std::string, std::string>>{
+        {SCRIPTED_PLAYER_ENV_VARS[0], config.player_names[0]},
+        {SCRIPTED_PLAYER_ENV_VARS[1], config.player_names[1]},
+        {UPDATE_THREADS_ENV_VAR, std::to_string(config.num_update_threads)},
+        {PATH_HEURISTIC_ENV_VAR, config.path_heuristic},
+        {PATH_PLANNER_ENV_VAR, config.path_planner}};
+
+    auto environment = std::vector<std::string>{};
+    for (auto variable = environ; *variable != nullptr; ++variable) {
+        auto is_overridden = false;
+        for (const auto &override : overrides) {
+            auto prefix = override.first + "=";
+            if (std::strncmp(*variable, prefix.c_str(), prefix.size()) == 0) {
+                is_overridden = true;
+            }
+        }
+        if (!is_overridden) {
+            environment.emplace_back(*variable);
+        }
+    }
+
+    for (const auto &override : overrides) {
+        environment.push_back(override.first + "=" + override.second);
+    }
+    return environment;
+}
+
+/**
+ * Starts the main process in the run directory, with its output going to a
+ * file in the directory
+ */
+pid_t startMainProcess(const std::string &main_path,
+                       const std::string &run_dir,
+                       const std::string &output_file_name,
+                       std::vector<std::string> environment) {
+    // Everything the child needs is built before forking
+    auto main_argv = std::vector<char *>{const_cast<char *>(main_path.c_str()),
+                                         nullptr};
+    auto envp = std::vector<char *>{};
+    for (auto &variable : environment) {
+        envp.push_back(&variable[0]);
+    }
+    envp.push_back(nullptr);
+
+    auto pid = fork();
+    if (pid < 0) {
+        throw std::runtime_error("Could not fork: " +
+                                 std::string(std::strerror(errno)));
+    }
+
+    if (pid == 0) {
+        auto output_fd =
+            open(output_file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (chdir(run_dir.c_str()) != 0 || output_fd < 0 ||
+            dup2(output_fd, STDOUT_FILENO) < 0 ||
+            dup2(output_fd, STDERR_FILENO) < 0) {
+            _exit(127);
+        }
+        execve(main_path.c_str(), main_argv.data(), envp.data());
+        _exit(127);
+    }
+
+    return pid;
+}
+
+/**
+ * Reads the last line of a file
+ */
+std::string readLastLine(const std::string &file_name) {
+    auto file = std::ifstream(file_name);
+    auto line = std::string(), last_line = std::string();
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            last_line = line;
+        }
+    }
+    return last_line;
+}
+} // namespace
+
+MatchResult runInProcessMatch(const MatchConfig &config) {
+    using namespace state;
+
+    resetPeakRss();
+    auto phase_durations = std::array<Clock::duration, NUM_PHASES>{};
+    auto match_start = Clock::now();
+
+    // Build the engine as the main process does, minus the drivers
+    auto owned_state =
+        buildState(config.num_update_threads, config.map_file_name);
+    auto state = owned_state.get();
+    state->getPathPlanner()->setPathHeuristic(
+        config.path_heuristic == "landmarks" ? PathHeuristic::LANDMARKS
+                                             : PathHeuristic::EUCLIDEAN);
+    if (config.path_planner == "hierarchical") {
+        state->getPathPlanner()->setBackend(PathPlannerBackend::HIERARCHICAL);
+    } else if (config.path_planner == "jps") {
+        state->getPathPlanner()->setBackend(
+            PathPlannerBackend::JUMP_POINT_SEARCH);
+    } else {
+        state->getPathPlanner()->setBackend(
+            PathPlannerBackend::VISIBILITY_GRAPH);
+    }
+    auto logger = std::make_unique<logger::Logger>(
+        state, PLAYER_INSTRUCTION_LIMIT_TURN, PLAYER_INSTRUCTION_LIMIT_GAME,
+        MAX_BOT_HP, MAX_TOWER_HP);
+    auto game_limits = state->getGameLimits();
+    auto owned_command_giver =
+        std::make_unique<CommandGiver>(state, logger.get(), game_limits);
+    auto command_giver = owned_command_giver.get();
+    auto state_syncer = std::make_unique<StateSyncer>(
+        std::move(owned_state), std::move(owned_command_giver), logger.get());
+
+    auto player_codes = std::vector<player_wrapper::PlayerCodeWrapper>{};
+    for (const auto &player_name : config.player_names) {
+        player_codes.emplace_back(
+            scripted_players::buildScriptedPlayer(player_name));
+    }
+
+    auto player_states = std::array<player_state::State, 2>{};
+    state_syncer->updatePlayerStates(player_states);
+    logger->logState();
+
+    auto transfer_states = std::array<transfer_state::StateStorage, 2>{
+        transfer_state::StateStorage(game_limits),
+        transfer_state::StateStorage(game_limits)};
+    auto command_buffers = std::array<CommandBufferStorage, 2>{
+        CommandBufferStorage(game_limits.getMaxNumCommands()),
+        CommandBufferStorage(game_limits.getMaxNumCommands())};
+    auto skip_turns = std::array<bool, 2>{false, false};
+
+    for (int64_t turn = 0; turn < NUM_TURNS; ++turn) {
+        timePhase(phase_durations, TRANSFER_STATE, [&] {
+            for (size_t player_id = 0; player_id < 2; ++player_id) {
+                transfer_state::ConvertToTransferState(
+                    player_states[player_id], *transfer_states[player_id]);
+            }
+        });
+
+        timePhase(phase_durations, PLAYER_CODE, [&] {
+            for (size_t player_id = 0; player_id < 2; ++player_id) {
+                player_codes[player_id].update(*transfer_states[player_id],
+                                               *command_buffers[player_id]);
+            }
+        });
+
+        // Scripted players are not instrumented, so they use no instructions
+        for (auto player_id : {PlayerId::PLAYER1, PlayerId::PLAYER2}) {
+            logger->logInstructionCount(player_id, 0, logger::PerfCounts{});
+        }
+
+        // Mirrors StateSyncer::updateMainState, a phase at a time
+        timePhase(phase_durations, RUN_COMMANDS, [&] {
+            command_giver->runCommands(
+                {&*command_buffers[0], &*command_buffers[1]}, skip_turns);
+        });
+        timePhase(phase_durations, REMOVE_DEAD_ACTORS,
+                  [&] { state->removeDeadActors(); });
+        timePhase(phase_durations, UPDATE_STATE, [&] { state->update(); });
+        timePhase(phase_durations, LOG_STATE, [&] { logger->logState(); });
+        timePhase(phase_durations, UPDATE_PLAYER_STATES, [&] {
+            state_syncer->updatePlayerStates(player_states);
+            state->resetTurnArena();
+        });
+    }
+
+    auto scores = state_syncer->getScores();
+    timePhase(phase_durations, WRITE_GAME, [&] {
+        auto winner = PlayerId::PLAYER_NULL;
+        if (scores[0] != scores[1]) {
+            winner = scores[0] > scores[1] ? PlayerId::PLAYER1
+                                           : PlayerId::PLAYER2;
+        }
+        logger->logFinalGameParams(winner, scores);
+        auto game_log = std::ostringstream();
+        logger->writeGame(game_log);
+    });
+
+    auto result = MatchResult{};
+    result.num_turns = NUM_TURNS;
+    result.seconds = toSeconds(Clock::now() - match_start);
+    for (size_t phase = 0; phase < NUM_PHASES; ++phase) {
+        result.phase_seconds.emplace_back(PHASE_NAMES[phase],
+                                          toSeconds(phase_durations[phase]));
+    }
+    result.peak_rss_kb = getPeakRssKb();
+    result.path_search_stats = state->getPathPlanner()->getPathSearchStats();
+    result.outcome = "SCORE " + std::to_string(scores[0]) + " " +
+                     std::to_string(scores[1]);
+    return result;
+}
+
+MatchResult runMultiProcessMatch(const MatchConfig &config,
+                                 const std::string &bin_dir,
+                                 bool keep_run_dir) {
+    auto run_dir = makeRunDir();
+
+    {
+        auto map_file = std::ifstream(config.map_file_name, std::ios::binary);
+        auto run_map_file = std::ofstream(run_dir + "/" + MAP_FILE_NAME,
+                                          std::ios::binary);
+        if (!map_file || !(run_map_file << map_file.rdbuf())) {
+            removeRunDir(run_dir);
+            throw std::runtime_error("Could not copy map file " +
+                                     config.map_file_name);
+        }
+    }
+
+    // The main process launches ./player_1 and ./player_2, which take their
+    // player number from their name
+    for (auto player_name : {"player_1", "player_2"}) {
+        auto player_path = run_dir + "/" + player_name;
+        if (symlink((bin_dir + "/scripted_player").c_str(),
+                    player_path.c_str()) != 0) {
+            removeRunDir(run_dir);
+            throw std::runtime_error("Could not link " + player_path + ": " +
+                                     std::strerror(errno));
+        }
+    }
+
+    auto output_file_name = run_dir + "/main.out";
+    auto match_start = Clock::now();
+    auto pid = startMainProcess(bin_dir + "/main", run_dir, output_file_name,
+                                buildEnvironment(config));
+
+    // wait4 gives the peak of the main process, and of the players it waited
+    // for, which the benchmark's own children so far would hide
+    auto status = 0;
+    auto usage = rusage{};
+    if (wait4(pid, &status, 0, &usage) != pid) {
+        throw std::runtime_error("Could not wait for the main process: " +
+                                 std::string(std::strerror(errno)));
+    }
+    auto seconds = toSeconds(Clock::now() - match_start);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw std::runtime_error("Main process failed, see " +
+                                 output_file_name);
+    }
+
+    auto result = MatchResult{};
+    result.num_turns = NUM_TURNS;
+    result.seconds = seconds;
+    result.peak_rss_kb = usage.ru_maxrss;
+    result.outcome = readLastLine(output_file_name);
+
+    if (!keep_run_dir) {
+        removeRunDir(run_dir);
+    }
+    return result;
+}
+} // namespace bench
@@ -0,0 +1,109 @@
+/**
+ * @file match_runner.h
+ * Declarations for running whole matches between scripted players, timed, in
+ * the main process or as the main and player processes of a real match
+ */
+
+#pragma once
+
+#include "state/path_planner/graph/graph.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+/**
+ * A match to run
+ */
+struct MatchConfig {
+    /**
+     * File holding the map the match is played on
+     */
+    std::string map_file_name;
+
+    /**
+     * Names of the scripted players of each side, from SCRIPTED_PLAYER_NAMES
+     */
+    std::array<std::string, 2> player_names;
+
+    /**
+     * Threads that plan the moves of bots each turn
+     */
+    size_t num_update_threads;
+
+    /**
+     * Heuristic that paths are searched with, one of "euclidean" or
+     * "landmarks"
+     */
+    std::string path_heuristic = "euclidean";
+
+    /**
+     * Path finder, one of "visibility", "hierarchical" or "jps"
+     */
+    std::string path_planner = "visibility";
+};
+
+/**
+ * Measurements of a match
+ */
+struct MatchResult {
+    size_t num_turns;
+
+    /**
+     * Wall clock time of the whole match, in seconds
+     */
+    double seconds;
+
+    /**
+     * Time spent in each phase of a turn over the match, in seconds, in the
+     * order the phases run. Only measured in process
+     */
+    std::vector<std::pair<std::string, double>> phase_seconds;
+
+    /**
+     * Peak resident set size in kilobytes, of the benchmark process in
+     * process, and of the largest of the main and player processes otherwise
+     */
+    int64_t peak_rss_kb;
+
+    /**
+     * Work done by the path searches of the match. Only counted in process
+     */
+    state::PathSearchStats path_search_stats;
+
+    /**
+     * Outcome of the match, as the main process reports it
+     */
+    std::string outcome;
+};
+
+/**
+ * Runs a match in this process. The players' code is called directly, and the
+ * state synced in the same order as the main driver does
+ *
+ * @param config Match to run
+ * @return MatchResult
+ */
+MatchResult runInProcessMatch(const MatchConfig &config);
+
+/**
+ * Runs a match as the main process does, with scripted player processes and
+ * shared memory, in a fresh directory holding the map
+ *
+ * @param config Match to run
+ * @param bin_dir Directory holding the main and scripted_player executables
+ * @param keep_run_dir Leave the match's directory and logs behind
+ * @return MatchResult
+ *
+ * @throw std::runtime_error If the match could not be set up, or the main
+ * process failed
+ */
+MatchResult runMultiProcessMatch(const MatchConfig &config,
+                                 const std::string &bin_dir,
+                                 bool keep_run_dir);
+} // namespace bench
@@ -0,0 +1,120 @@
+/**
+ * @file player_startup_benchmark.cpp
+ * Measures how long a player takes from launch to finishing its first turn,
+ * when spawned as a new process and when forked from a warm zygote
+ *
+ * Usage: player_startup_benchmark [num_runs] [player_pool_dir]
+ *
+ * Run from the directory holding player_1. The pooled measurement needs a
+ * zygote started with `./player_1 --zygote <player_pool_dir>/player_1.sock`,
+ * and is skipped if no pool directory is given. The SHM pages of both sides
+ * are backed as CODECHARACTER_SHM_PAGING asks, as in a game
+ */
+
+#include "boost/process.hpp"
+#include "constants/constants.h"
+#include "drivers/player_pool/pooled_player.h"
+#include "drivers/shared_memory_utils/shared_memory_main.h"
+#include "drivers/shared_memory_utils/shared_memory_paging.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bp = boost::process;
+
+using namespace drivers;
+using namespace Constants::Simulator;
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Launches a player attached to the given SHM and returns a handle that kills
+ * the player when destroyed
+ */
+using LaunchPlayer =
+    std::function<std::shared_ptr<void>(const std::string &shm_name)>;
+
+/**
+ * Times launch to the end of the first turn, in milliseconds
+ */
+double timeStartup(const LaunchPlayer &launch_player, int run,
+                   SharedMemoryPaging shm_paging) {
+    auto shm_name = "startup_benchmark_" + std::to_string(run);
+    SharedMemoryMain shm_main(shm_name, true, 0, 0, state::GameLimits{},
+                              shm_paging);
+    auto buffer = shm_main.getBuffer();
+
+    auto start = Clock::now();
+    auto player = launch_player(shm_name);
+
+    // The player clears the flag once its first turn is done
+    while (buffer->is_player_running)
+        ;
+
+    auto end = Clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void printSummary(const std::string &mode, std::vector<double> timings) {
+    std::sort(timings.begin(), timings.end());
+    auto percentile = [&timings](double fraction) {
+        return timings[static_cast<size_t>(fraction * (timings.size() - 1))];
+    };
+
+    std::cout << std::fixed << std::setprecision(3) << std::setw(8) << mode
+              << "  min " << timings.front() << " ms  median "
+              << percentile(0.5) << " ms  p95 " << percentile(0.95)
+              << " ms  max " << timings.back() << " ms\n";
+}
+
+std::vector<double> runBenchmark(const LaunchPlayer &launch_player,
+                                 int num_runs, SharedMemoryPaging shm_paging) {
+    std::vector<double> timings;
+    for (int run = 0; run < num_runs; ++run) {
+        timings.push_back(timeStartup(launch_player, run, shm_paging));
+    }
+    return timings;
+}
+
+int main(int argc, char *argv[]) {
+    auto num_runs = argc > 1 ? std::atoi(argv[1]) : 50;
+    if (num_runs <= 0) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [num_runs] [player_pool_dir]\n";
+        return 1;
+    }
+
+    auto shm_paging = SharedMemoryPaging::DEFAULT;
+    auto shm_paging_name = std::getenv(SHM_PAGING_ENV_VAR);
+    if (shm_paging_name != nullptr) {
+        shm_paging = parseSharedMemoryPaging(shm_paging_name);
+    }
+
+    auto spawn_player = [](const std::string &shm_name) {
+        std::ofstream(SHM_FILE_NAMES[0]) << shm_name;
+        auto player = std::make_shared<bp::child>("./player_1");
+        return std::shared_ptr<void>(player, player.get());
+    };
+    printSummary("spawned", runBenchmark(spawn_player, num_runs, shm_paging));
+    std::remove(SHM_FILE_NAMES[0].c_str());
+
+    if (argc > 2) {
+        auto socket_path =
+            std::string(argv[2]) + "/" + PLAYER_POOL_SOCKET_NAMES[0];
+        auto pooled_player = [&socket_path](const std::string &shm_name) {
+            auto player = std::make_shared<PooledPlayer>(socket_path, shm_name);
+            return std::shared_ptr<void>(player, player.get());
+        };
+        printSummary("pooled",
+                     runBenchmark(pooled_player, num_runs, shm_paging));
+    }
+
+    return 0;
+}
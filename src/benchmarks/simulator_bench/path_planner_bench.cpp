@@ -0,0 +1,281 @@
+/**
+ * @file path_planner_bench.cpp
+ * Benchmarks of the path finding code, on maps of increasing obstacle density,
+ * and of each path finder on maps of increasing size
+ */
+
+#include "simulator_bench/synthetic_game.h"
+#include "constants/constants.h"
+#include "state/path_planner/graph/graph.h"
+#include "state/path_planner/path_graph.h"
+#include "state/path_planner/path_planner.h"
+
+#include <benchmark/benchmark.h>
+
+using namespace state;
+using namespace Constants::Actor;
+using namespace Constants::Map;
+
+namespace bench {
+namespace {
+
+/**
+ * Number of queries each benchmark cycles through, so that no single query
+ * dominates the measurement
+ */
+const size_t NUM_QUERIES = 256;
+
+/**
+ * Obstacle densities, in percent, that every path finding benchmark runs at
+ */
+void addDensities(benchmark::internal::Benchmark *benchmark) {
+    benchmark->ArgName("obstacle_percent");
+    for (auto obstacle_percent : {0, 10, 25, 40}) {
+        benchmark->Arg(obstacle_percent);
+    }
+}
+
+double_t getDensity(const benchmark::State &bench_state) {
+    return bench_state.range(0) / 100.0;
+}
+
+std::vector<std::vector<bool>>
+getValidTerrain(const std::vector<std::vector<TerrainType>> &terrain) {
+    auto valid_terrain = std::vector<std::vector<bool>>(
+        terrain.size(), std::vector<bool>(terrain.size()));
+    for (size_t x = 0; x < terrain.size(); ++x) {
+        for (size_t y = 0; y < terrain.size(); ++y) {
+            valid_terrain[x][y] = terrain[x][y] != TerrainType::WATER;
+        }
+    }
+    return valid_terrain;
+}
+
+/**
+ * Obstacle density of the maps that the path finders are compared on
+ */
+const double_t BACKEND_OBSTACLE_DENSITY = 0.25;
+
+/**
+ * Largest map the visibility graph is benchmarked on. Its waypoints and their
+ * visibility tables grow too fast to build in reasonable time beyond this
+ */
+const int64_t MAX_VISIBILITY_GRAPH_MAP_SIZE = 100;
+
+/**
+ * Path finders that are compared, indexed by the backend argument
+ */
+const PathPlannerBackend BACKENDS[] = {PathPlannerBackend::VISIBILITY_GRAPH,
+                                       PathPlannerBackend::HIERARCHICAL,
+                                       PathPlannerBackend::JUMP_POINT_SEARCH};
+
+/**
+ * Each path finder on maps of 30, 100 and 250 cells per side
+ */
+void addBackendsAndMapSizes(benchmark::internal::Benchmark *benchmark) {
+    benchmark->ArgNames({"backend", "map_size"})
+        ->ArgsProduct({{0, 1, 2}, {30, 100, 250}})
+        ->Unit(benchmark::kMicrosecond);
+}
+
+PathPlannerBackend getBackend(const benchmark::State &bench_state) {
+    return BACKENDS[bench_state.range(0)];
+}
+
+/**
+ * Skip the visibility graph on maps too large for it
+ * @return bool True, if the benchmark was skipped
+ */
+bool skipLargeVisibilityGraph(benchmark::State &bench_state) {
+    if (getBackend(bench_state) == PathPlannerBackend::VISIBILITY_GRAPH &&
+        bench_state.range(1) > MAX_VISIBILITY_GRAPH_MAP_SIZE) {
+        bench_state.SkipWithError("Map too large for the visibility graph");
+        return true;
+    }
+    return false;
+}
+
+std::vector<std::pair<DoubleVec2D, DoubleVec2D>>
+getQueries(const std::vector<std::vector<TerrainType>> &terrain) {
+    auto random = Random();
+    auto queries = std::vector<std::pair<DoubleVec2D, DoubleVec2D>>();
+    for (size_t i = 0; i < NUM_QUERIES; ++i) {
+        auto source = pickLandPosition(terrain, random);
+        queries.emplace_back(source, pickLandPosition(terrain, random));
+    }
+    return queries;
+}
+
+/**
+ * Graph::getPath on a graph with a node at the center of every land cell,
+ * joined to the land cells around it
+ */
+void BM_GraphGetPath(benchmark::State &bench_state) {
+    auto terrain = buildTerrain(getDensity(bench_state));
+    auto graph = Graph();
+    for (size_t x = 0; x < MAP_SIZE; ++x) {
+        for (size_t y = 0; y < MAP_SIZE; ++y) {
+            if (terrain[x][y] == TerrainType::LAND) {
+                graph.addNode(DoubleVec2D(x + 0.5, y + 0.5));
+            }
+        }
+    }
+    for (auto node : graph.getNodeSet()) {
+        for (auto dx : {-1, 0, 1}) {
+            for (auto dy : {-1, 0, 1}) {
+                auto neighbour =
+                    FixedVec2D(node.to_double() + DoubleVec2D(dx, dy));
+                if ((dx != 0 || dy != 0) && graph.checkNodeExists(neighbour)) {
+                    graph.addEdge(node, neighbour, node.distance(neighbour));
+                }
+            }
+        }
+    }
+
+    auto queries = getQueries(terrain);
+    size_t query_index = 0;
+    for (auto _ : bench_state) {
+        const auto &query = queries[query_index++ % NUM_QUERIES];
+        benchmark::DoNotOptimize(graph.getPath(query.first, query.second));
+    }
+    bench_state.SetItemsProcessed(bench_state.iterations());
+}
+BENCHMARK(BM_GraphGetPath)->Apply(addDensities);
+
+/**
+ * PathGraph::setValidTerrain, which recomputes the waypoint graph and its
+ * visibility tables, as recomputeWaypointGraph alone does nothing while the
+ * terrain is unchanged
+ */
+void BM_RecomputeWaypointGraph(benchmark::State &bench_state) {
+    auto terrain = buildTerrain(getDensity(bench_state));
+    auto valid_terrain = getValidTerrain(terrain);
+    auto path_graph = PathGraph(MAP_SIZE, valid_terrain, Graph());
+
+    for (auto _ : bench_state) {
+        path_graph.setValidTerrain(valid_terrain);
+    }
+}
+BENCHMARK(BM_RecomputeWaypointGraph)->Apply(addDensities);
+
+void BM_ArePointsDirectlyReachable(benchmark::State &bench_state) {
+    auto terrain = buildTerrain(getDensity(bench_state));
+    auto path_graph = PathGraph(MAP_SIZE, getValidTerrain(terrain), Graph());
+
+    auto queries = getQueries(terrain);
+    size_t query_index = 0;
+    for (auto _ : bench_state) {
+        const auto &query = queries[query_index++ % NUM_QUERIES];
+        benchmark::DoNotOptimize(
+            path_graph.arePointsDirectlyReachable(query.first, query.second));
+    }
+    bench_state.SetItemsProcessed(bench_state.iterations());
+}
+BENCHMARK(BM_ArePointsDirectlyReachable)->Apply(addDensities);
+
+/**
+ * PathPlanner::getNextPosition without its cache, which is cleared as the
+ * path graph is recomputed every NUM_QUERIES queries
+ */
+void BM_GetNextPosition(benchmark::State &bench_state) {
+    auto terrain = buildTerrain(getDensity(bench_state));
+    auto map = Map(terrain, MAP_SIZE);
+    auto path_planner = PathPlanner(&map);
+
+    auto queries = getQueries(terrain);
+    size_t query_index = 0;
+    for (auto _ : bench_state) {
+        if (query_index % NUM_QUERIES == 0) {
+            bench_state.PauseTiming();
+            path_planner.recomputePathGraph();
+            bench_state.ResumeTiming();
+        }
+
+        const auto &query = queries[query_index++ % NUM_QUERIES];
+        benchmark::DoNotOptimize(path_planner.getNextPosition(
+            query.first, query.second, BOT_SPEED));
+    }
+    bench_state.SetItemsProcessed(bench_state.iterations());
+}
+BENCHMARK(BM_GetNextPosition)->Apply(addDensities);
+
+/**
+ * PathPlanner construction and the first recomputePathGraph, which builds
+ * the graph of the path finder from scratch
+ */
+void BM_BackendBuild(benchmark::State &bench_state) {
+    if (skipLargeVisibilityGraph(bench_state))
+        return;
+
+    auto map_size = static_cast<size_t>(bench_state.range(1));
+    auto terrain = buildTerrain(BACKEND_OBSTACLE_DENSITY, SEED, map_size);
+    auto map = Map(terrain, map_size);
+
+    for (auto _ : bench_state) {
+        auto path_planner = PathPlanner(&map);
+        path_planner.setBackend(getBackend(bench_state));
+        path_planner.recomputePathGraph();
+    }
+}
+BENCHMARK(BM_BackendBuild)->Apply(addBackendsAndMapSizes);
+
+/**
+ * PathPlanner::getNextPosition without its cache, with each path finder
+ */
+void BM_BackendGetNextPosition(benchmark::State &bench_state) {
+    if (skipLargeVisibilityGraph(bench_state))
+        return;
+
+    auto map_size = static_cast<size_t>(bench_state.range(1));
+    auto terrain = buildTerrain(BACKEND_OBSTACLE_DENSITY, SEED, map_size);
+    auto map = Map(terrain, map_size);
+    auto path_planner = PathPlanner(&map);
+    path_planner.setBackend(getBackend(bench_state));
+
+    auto queries = getQueries(terrain);
+    size_t query_index = 0;
+    for (auto _ : bench_state) {
+        if (query_index % NUM_QUERIES == 0) {
+            bench_state.PauseTiming();
+            path_planner.recomputePathGraph();
+            bench_state.ResumeTiming();
+        }
+
+        const auto &query = queries[query_index++ % NUM_QUERIES];
+        benchmark::DoNotOptimize(path_planner.getNextPosition(
+            query.first, query.second, BOT_SPEED));
+    }
+    bench_state.SetItemsProcessed(bench_state.iterations());
+}
+BENCHMARK(BM_BackendGetNextPosition)->Apply(addBackendsAndMapSizes);
+
+/**
+ * Building a tower on one cell and destroying it, recomputing the graph of the
+ * path finder after each, as a turn does when a tower changes
+ */
+void BM_BackendTowerUpdate(benchmark::State &bench_state) {
+    if (skipLargeVisibilityGraph(bench_state))
+        return;
+
+    auto map_size = static_cast<size_t>(bench_state.range(1));
+    auto terrain = buildTerrain(BACKEND_OBSTACLE_DENSITY, SEED, map_size);
+    auto map = Map(terrain, map_size);
+    auto path_planner = PathPlanner(&map);
+    path_planner.setBackend(getBackend(bench_state));
+    path_planner.recomputePathGraph();
+
+    auto queries = getQueries(terrain);
+    size_t query_index = 0;
+    for (auto _ : bench_state) {
+        const auto &query = queries[query_index++ % NUM_QUERIES];
+        auto tower_offset =
+            path_planner.buildTower(query.first, PlayerId::PLAYER1);
+        path_planner.recomputePathGraph();
+        path_planner.destroyTower(tower_offset);
+        path_planner.recomputePathGraph();
+    }
+    bench_state.SetItemsProcessed(bench_state.iterations());
+}
+BENCHMARK(BM_BackendTowerUpdate)->Apply(addBackendsAndMapSizes);
+} // namespace
+} // namespace bench
@@ -0,0 +1,40 @@
+/**
+ * @file simulator_bench.cpp
+ * Entry point of the simulator microbenchmarks
+ *
+ * Every benchmark runs on maps and states generated from a fixed seed, so
+ * that the JSON written with
+ *
+ *     simulator_bench --benchmark_out=<file> --benchmark_out_format=json
+ *
+ * can be compared across commits, such as with
+ * ext/benchmark/tools/compare.py. Label each run with
+ * --benchmark_context=revision=<commit>
+ */
+
+#include "simulator_bench/synthetic_game.h"
+#include "constants/constants.h"
+
+#include <benchmark/benchmark.h>
+#include <string>
+
+#ifndef SIMULATOR_BUILD_TYPE
+#define SIMULATOR_BUILD_TYPE "unknown"
+#endif
+
+int main(int argc, char *argv[]) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    // Runs are only comparable if these match
+    benchmark::AddCustomContext("build_type", SIMULATOR_BUILD_TYPE);
+    benchmark::AddCustomContext("map_size",
+                                std::to_string(Constants::Map::MAP_SIZE));
+    benchmark::AddCustomContext("seed", std::to_string(bench::SEED));
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
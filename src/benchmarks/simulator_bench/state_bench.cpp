@@ -0,0 +1,193 @@
+/**
+ * @file state_bench.cpp
+ * Benchmarks of a turn of the main state, and of the work around it, at
+ * increasing numbers of bots
+ */
+
+#include "simulator_bench/synthetic_game.h"
+#include "constants/constants.h"
+#include "logger/logger.h"
+#include "player_wrapper/transfer_state.h"
+#include "state/command_buffer.h"
+#include "state/command_giver.h"
+#include "state/player_state.h"
+#include "state/state_syncer.h"
+
+#include <benchmark/benchmark.h>
+#include <sstream>
+
+using namespace state;
+using namespace Constants::Actor;
+using namespace Constants::Map;
+using namespace Constants::Simulator;
+
+namespace bench {
+namespace {
+
+/**
+ * Obstacle density of the maps the state benchmarks run on
+ */
+const double_t OBSTACLE_DENSITY = 0.1;
+
+/**
+ * Turns logged in each iteration of BM_LogGame
+ */
+const size_t NUM_LOGGED_TURNS = 100;
+
+/**
+ * Bots per player that every state benchmark runs with
+ */
+void addBotCounts(benchmark::internal::Benchmark *benchmark) {
+    benchmark->ArgName("bots_per_player");
+    for (auto num_bots : {10, 50, 150}) {
+        benchmark->Arg(num_bots);
+    }
+}
+
+/**
+ * A state along with the objects that sync it and log it
+ */
+struct Game {
+    State *state;
+    std::unique_ptr<logger::Logger> logger;
+    CommandGiver *command_giver;
+    std::unique_ptr<StateSyncer> state_syncer;
+
+    explicit Game(size_t num_bots) {
+        auto owned_state = buildState(OBSTACLE_DENSITY, num_bots);
+        state = owned_state.get();
+        logger = std::make_unique<logger::Logger>(
+            state, PLAYER_INSTRUCTION_LIMIT_TURN,
+            PLAYER_INSTRUCTION_LIMIT_GAME, MAX_BOT_HP, MAX_TOWER_HP);
+
+        auto owned_command_giver =
+            std::make_unique<CommandGiver>(state, logger.get());
+        command_giver = owned_command_giver.get();
+        state_syncer = std::make_unique<StateSyncer>(
+            std::move(owned_state), std::move(owned_command_giver),
+            logger.get());
+    }
+};
+
+/**
+ * One State::update, of a freshly built state whose bots are all on the move
+ */
+void BM_StateUpdate(benchmark::State &bench_state) {
+    auto num_bots = bench_state.range(0);
+    auto num_update_threads = bench_state.range(1);
+
+    for (auto _ : bench_state) {
+        bench_state.PauseTiming();
+        auto state = buildState(OBSTACLE_DENSITY, num_bots);
+        state->setNumUpdateThreads(num_update_threads);
+        bench_state.ResumeTiming();
+
+        state->update();
+        state->resetTurnArena();
+
+        bench_state.PauseTiming();
+        state.reset();
+        bench_state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_StateUpdate)
+    ->ArgNames({"bots_per_player", "update_threads"})
+    ->ArgsProduct({{10, 50, 150}, {1, 4}})
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_UpdatePlayerStates(benchmark::State &bench_state) {
+    auto game = Game(bench_state.range(0));
+    auto player_states = std::array<player_state::State, 2>{};
+
+    for (auto _ : bench_state) {
+        game.state_syncer->updatePlayerStates(player_states);
+    }
+}
+BENCHMARK(BM_UpdatePlayerStates)->Apply(addBotCounts);
+
+void BM_ConvertToTransferState(benchmark::State &bench_state) {
+    auto game = Game(bench_state.range(0));
+    auto player_states = std::array<player_state::State, 2>{};
+    game.state_syncer->updatePlayerStates(player_states);
+    auto transfer_state = transfer_state::StateStorage();
+
+    for (auto _ : bench_state) {
+        transfer_state::ConvertToTransferState(player_states[0],
+                                               *transfer_state);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_ConvertToTransferState)->Apply(addBotCounts);
+
+void BM_ConvertToPlayerState(benchmark::State &bench_state) {
+    auto game = Game(bench_state.range(0));
+    auto player_states = std::array<player_state::State, 2>{};
+    game.state_syncer->updatePlayerStates(player_states);
+    auto transfer_state = transfer_state::StateStorage();
+    transfer_state::ConvertToTransferState(player_states[0], *transfer_state);
+
+    for (auto _ : bench_state) {
+        benchmark::DoNotOptimize(
+            transfer_state::ConvertToPlayerState(*transfer_state));
+    }
+}
+BENCHMARK(BM_ConvertToPlayerState)->Apply(addBotCounts);
+
+/**
+ * CommandGiver::runCommands with a move for every bot of both players
+ */
+void BM_RunCommands(benchmark::State &bench_state) {
+    auto game = Game(bench_state.range(0));
+    auto terrain = buildTerrain(OBSTACLE_DENSITY);
+    auto random = Random();
+
+    std::array<CommandBufferStorage, 2> command_buffers;
+    for (auto player_id : {PlayerId::PLAYER1, PlayerId::PLAYER2}) {
+        auto &command_buffer = command_buffers[(int) player_id];
+
+        for (auto *bot : game.state->getBots(player_id)) {
+            auto destination = pickLandPosition(terrain, random);
+
+            // Player 2 gives positions in its flipped frame of reference
+            if (player_id == PlayerId::PLAYER2) {
+                destination = DoubleVec2D(MAP_SIZE - destination.x,
+                                          MAP_SIZE - destination.y);
+            }
+            command_buffer->moveBot(bot->getActorId(), destination);
+        }
+    }
+
+    auto buffers = std::array<const CommandBuffer *, 2>{
+        &*command_buffers[0], &*command_buffers[1]};
+    for (auto _ : bench_state) {
+        game.command_giver->runCommands(buffers, {false, false});
+    }
+    bench_state.SetItemsProcessed(bench_state.iterations() * 2 *
+                                  bench_state.range(0));
+}
+BENCHMARK(BM_RunCommands)->Apply(addBotCounts);
+
+/**
+ * Logger::logState for NUM_LOGGED_TURNS turns, then Logger::writeGame
+ */
+void BM_LogGame(benchmark::State &bench_state) {
+    auto game = Game(bench_state.range(0));
+
+    for (auto _ : bench_state) {
+        logger::Logger game_logger(game.state, PLAYER_INSTRUCTION_LIMIT_TURN,
+                                   PLAYER_INSTRUCTION_LIMIT_GAME, MAX_BOT_HP,
+                                   MAX_TOWER_HP);
+        for (size_t turn = 0; turn < NUM_LOGGED_TURNS; ++turn) {
+            game_logger.logState();
+        }
+
+        auto game_stream = std::ostringstream();
+        game_logger.writeGame(game_stream);
+        benchmark::DoNotOptimize(game_stream.tellp());
+    }
+    bench_state.SetItemsProcessed(bench_state.iterations() *
+                                  NUM_LOGGED_TURNS);
+}
+BENCHMARK(BM_LogGame)->Apply(addBotCounts)->Unit(benchmark::kMillisecond);
+} // namespace
+} // namespace bench
@@ -0,0 +1,118 @@
+/**
+ * @file synthetic_game.cpp
+ * Definitions for building reproducible maps and states to benchmark the
+ * simulator on
+ */
+
+#include "simulator_bench/synthetic_game.h"
+#include "constants/constants.h"
+
+#include <cmath>
+
+using namespace state;
+using namespace Constants::Actor;
+using namespace Constants::Map;
+
+namespace bench {
+
+Random::Random(uint64_t seed) : generator(seed) {}
+
+double_t Random::nextDouble() {
+    // The top 53 bits fill the mantissa of a double exactly
+    return (generator() >> 11) * (1.0 / (uint64_t{1} << 53));
+}
+
+size_t Random::nextIndex(size_t bound) {
+    return static_cast<size_t>(nextDouble() * bound);
+}
+
+std::vector<std::vector<TerrainType>>
+buildTerrain(double_t obstacle_density, uint64_t seed, size_t map_size) {
+    auto random = Random(seed);
+    auto terrain = std::vector<std::vector<TerrainType>>(
+        map_size, std::vector<TerrainType>(map_size, TerrainType::LAND));
+
+    for (auto &row : terrain) {
+        for (auto &cell : row) {
+            if (random.nextDouble() < obstacle_density) {
+                cell = TerrainType::WATER;
+            }
+        }
+    }
+
+    // Keep the bases open, so that bots can leave them
+    for (auto base_position : PLAYER_BASE_POSITIONS) {
+        auto base_x = static_cast<int64_t>(std::floor(base_position.x));
+        auto base_y = static_cast<int64_t>(std::floor(base_position.y));
+        for (auto x = base_x - 1; x <= base_x + 1; ++x) {
+            for (auto y = base_y - 1; y <= base_y + 1; ++y) {
+                if (x >= 0 && y >= 0 && x < (int64_t) map_size &&
+                    y < (int64_t) map_size) {
+                    terrain[x][y] = TerrainType::LAND;
+                }
+            }
+        }
+    }
+
+    return terrain;
+}
+
+DoubleVec2D
+pickLandPosition(const std::vector<std::vector<TerrainType>> &terrain,
+                 Random &random) {
+    while (true) {
+        auto x = random.nextIndex(terrain.size());
+        auto y = random.nextIndex(terrain.size());
+        if (terrain[x][y] == TerrainType::LAND) {
+            return DoubleVec2D(x + 0.5, y + 0.5);
+        }
+    }
+}
+
+std::unique_ptr<State> buildState(double_t obstacle_density, size_t num_bots,
+                                  uint64_t seed) {
+    auto random = Random(seed);
+    auto terrain = buildTerrain(obstacle_density, seed);
+
+    auto map = std::make_unique<Map>(terrain, MAP_SIZE);
+    auto path_planner = std::make_unique<PathPlanner>(map.get());
+    auto score_manager =
+        std::make_unique<ScoreManager>(std::array<uint64_t, 2>{0, 0});
+
+    auto model_bot =
+        Bot(PlayerId::PLAYER1, MAX_BOT_HP, MAX_BOT_HP, PLAYER_BASE_POSITIONS[0],
+            BOT_SPEED, BOT_BLAST_IMPACT_RADIUS, BOT_BLAST_DAMAGE_POINTS,
+            score_manager.get(), path_planner.get(), BlastCallback{},
+            ConstructTowerCallback{});
+    auto model_tower = Tower(PlayerId::PLAYER1, MAX_TOWER_HP, MAX_TOWER_HP,
+                             PLAYER_BASE_POSITIONS[0], TOWER_BLAST_DAMAGE_POINTS,
+                             TOWER_BLAST_IMPACT_RADIUS, score_manager.get(),
+                             BlastCallback{});
+
+    auto bots = std::array<std::vector<std::unique_ptr<Bot>>, 2>{};
+    for (auto player_id : {PlayerId::PLAYER1, PlayerId::PLAYER2}) {
+        for (size_t i = 0; i < num_bots; ++i) {
+            bots[(int) player_id].push_back(std::make_unique<Bot>(
+                player_id, MAX_BOT_HP, MAX_BOT_HP,
+                pickLandPosition(terrain, random), BOT_SPEED,
+                BOT_BLAST_IMPACT_RADIUS, BOT_BLAST_DAMAGE_POINTS,
+                score_manager.get(), path_planner.get(), BlastCallback{},
+                ConstructTowerCallback{}));
+        }
+    }
+
+    auto state = std::make_unique<State>(
+        std::move(map), std::move(score_manager), std::move(path_planner),
+        std::move(bots), std::array<std::vector<std::unique_ptr<Tower>>, 2>{},
+        std::move(model_bot), std::move(model_tower));
+
+    for (auto player_id : {PlayerId::PLAYER1, PlayerId::PLAYER2}) {
+        for (auto *bot : state->getBots(player_id)) {
+            state->moveBot(bot->getActorId(),
+                           pickLandPosition(terrain, random));
+        }
+    }
+
+    return state;
+}
+} // namespace bench
@@ -0,0 +1,86 @@
+/**
+ * @file synthetic_game.h
+ * Declarations for building reproducible maps and states to benchmark the
+ * simulator on
+ */
+
+#pragma once
+
+#include "constants/map.h"
+#include "physics/vector.hpp"
+#include "state/map/map.h"
+#include "state/state.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace bench {
+
+/**
+ * Seed of every random choice in the benchmarks, so that runs of different
+ * commits measure the same work
+ */
+const uint64_t SEED = 2020;
+
+/**
+ * Generates random numbers, identically on every platform. The standard
+ * distributions are implementation defined, so they are not used
+ */
+class Random {
+  private:
+    std::mt19937_64 generator;
+
+  public:
+    explicit Random(uint64_t seed = SEED);
+
+    /**
+     * Uniform in [0, 1)
+     */
+    double_t nextDouble();
+
+    /**
+     * Uniform in [0, bound)
+     */
+    size_t nextIndex(size_t bound);
+};
+
+/**
+ * Builds a map_size x map_size map with each cell water with probability
+ * obstacle_density, and land otherwise. The cells around both bases are
+ * always land
+ *
+ * @param obstacle_density
+ * @param seed
+ * @param map_size Cells per side
+ * @return std::vector<std::vector<state::TerrainType>>
+ */
+std::vector<std::vector<state::TerrainType>>
+buildTerrain(double_t obstacle_density, uint64_t seed = SEED,
+             size_t map_size = Constants::Map::MAP_SIZE);
+
+/**
+ * Picks the center of a random land cell
+ *
+ * @param terrain
+ * @param random
+ * @return DoubleVec2D
+ */
+DoubleVec2D pickLandPosition(
+    const std::vector<std::vector<state::TerrainType>> &terrain,
+    Random &random);
+
+/**
+ * Builds a state on a synthetic map, with num_bots bots per player at random
+ * land positions, each ordered to move to another random land position
+ *
+ * @param obstacle_density
+ * @param num_bots
+ * @param seed
+ * @return std::unique_ptr<state::State>
+ */
+std::unique_ptr<state::State> buildState(double_t obstacle_density,
+                                         size_t num_bots,
+                                         uint64_t seed = SEED);
+} // namespace bench
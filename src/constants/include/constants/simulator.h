@@ -26,11 +26,90 @@ const int64_t GAME_DURATION_MS = 20 * 1000;
 // File names for passing SHM names to player processes
 const auto SHM_FILE_NAMES = std::array<std::string, 2>{"shm1.txt", "shm2.txt"};
 
+// Environment variable holding the directory of the player zygote sockets.
+// If set, the game takes its players from the zygotes started with
+// `player_N --zygote <directory>/player_N.sock` instead of spawning them
+const auto PLAYER_POOL_DIR_ENV_VAR = "CODECHARACTER_PLAYER_POOL";
+
+// File names of the player zygote sockets, inside the player pool directory
+const auto PLAYER_POOL_SOCKET_NAMES =
+    std::array<std::string, 2>{"player_1.sock", "player_2.sock"};
+
+// Environment variable holding how the pages of the SHM are backed, in the
+// main and player processes. "prefault" faults them in before the game starts,
+// "locked" also locks them in memory, and "huge" also backs them with
+// transparent huge pages. Each falls back to the one before it where the
+// system does not allow it
+const auto SHM_PAGING_ENV_VAR = "CODECHARACTER_SHM_PAGING";
+
+// Environment variable holding the CPU placement policy. If set, the main
+// process, its threads and the player processes are each pinned to a CPU.
+// One of "siblings[:<slot>]", "l3[:<slot>]" or
+// "<main>,<player 1>,<player 2>[,<update thread>...]". The presets reserve a
+// CPU in their slot for each update thread besides the main thread, and an
+// explicit list names one, so the update threads never share the main CPU
+const auto CPU_PLACEMENT_ENV_VAR = "CODECHARACTER_CPU_PLACEMENT";
+
+// Environment variable holding the number of threads that plan the moves of
+// bots each turn, including the main thread. Unset or 1 plans them on the main
+// thread. If the processes are placed on CPUs, the threads besides the main
+// thread run on the CPUs the placement reserves for them
+const auto UPDATE_THREADS_ENV_VAR = "CODECHARACTER_UPDATE_THREADS";
+
+// Environment variable holding the heuristic paths are searched with, either
+// "euclidean", the default, or "landmarks", which bounds the cost of a path by
+// the distances of landmark waypoints. Both find equally short paths
+const auto PATH_HEURISTIC_ENV_VAR = "CODECHARACTER_PATH_HEURISTIC";
+
+// Environment variable holding the path finder, either "visibility", the
+// default, which finds the shortest paths over a graph of waypoints,
+// "hierarchical", which plans over chunks of the map and is cheaper to update
+// on large maps, or "jps", which searches the cells of the map and has nothing
+// to update as towers are built
+const auto PATH_PLANNER_ENV_VAR = "CODECHARACTER_PATH_PLANNER";
+
+// Environment variable holding the directory of compiled maps. If set, the
+// game loads the terrain and waypoint graph of the map from the compiled map
+// made for it by `map_compiler <map file> <directory>`, and falls back to
+// reading the map file if there is none
+const auto MAP_CACHE_ENV_VAR = "CODECHARACTER_MAP_CACHE";
+
 // File where the output game binary log will be stored
 const auto GAME_LOG_FILE_NAME = "game.log";
 
-// Shared buffer size in bytes
-const size_t SHARED_BUFFER_SIZE = 262143;
+// Environment variable holding the trace file prefix. If set, the main and
+// player processes write Chrome trace events to <prefix>.<process>.json, and
+// the merged trace of the whole match is written to <prefix>.json
+const auto TRACE_FILE_PREFIX_ENV_VAR = "CODECHARACTER_TRACE";
+
+// Environment variable which, if set, makes the player processes sample
+// perf_event_open counters around each update
+const auto PERF_COUNTERS_ENV_VAR = "CODECHARACTER_PERF_COUNTERS";
+
+// File where the players' per turn perf counters will be stored, as CSV
+const auto PERF_LOG_FILE_NAME = "game.perf.csv";
+
+// Environment variable which, if set, makes the main process write a digest of
+// the state after every turn. Comparing the digests of two runs of a match,
+// such as with compare_digests, finds the first turn they differ in
+const auto STATE_DIGESTS_ENV_VAR = "CODECHARACTER_STATE_DIGESTS";
+
+// File where the per turn state digests will be stored, as CSV
+const auto DIGEST_LOG_FILE_NAME = "game.digests.csv";
+
+// Environment variable which, if set, makes the main process record the
+// players' commands every turn, so that the game can be replayed without the
+// player processes
+const auto RECORD_COMMANDS_ENV_VAR = "CODECHARACTER_RECORD_COMMANDS";
+
+// File where the players' commands will be recorded, in binary
+const auto COMMAND_LOG_FILE_NAME = "game.commands";
+
+// Environment variables naming the strategy each scripted player process
+// plays, one of "idle", "flag_rusher", "tower_spammer" or "blast_swarm".
+// Scripted players left unset stay idle
+const auto SCRIPTED_PLAYER_ENV_VARS = std::array<std::string, 2>{
+    "CODECHARACTER_SCRIPTED_PLAYER_1", "CODECHARACTER_SCRIPTED_PLAYER_2"};
 
 } // namespace Simulator
 } // namespace Constants
@@ -0,0 +1,109 @@
+/**
+ * @file command_recording.h
+ * Declarations for recording the commands players issue each turn, and
+ * reading them back to replay a game without the player processes
+ */
+
+#pragma once
+
+#include "drivers/drivers_export.h"
+#include "state/command_buffer.h"
+#include "state/game_limits.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+namespace drivers {
+
+/**
+ * Everything the main driver passes on from the players in a turn
+ */
+struct RecordedTurn {
+    /**
+     * Commands of each player, with room for as many as the limits of the game
+     * allow
+     */
+    std::array<state::CommandBufferStorage, 2> command_buffers;
+
+    /**
+     * Instructions each player used in the turn, for the game log
+     */
+    std::array<uint64_t, 2> instruction_counts;
+
+    /**
+     * True if a player exceeded the turn instruction limit, and their commands
+     * are ignored
+     */
+    std::array<bool, 2> skip_turns;
+
+    explicit RecordedTurn(size_t max_num_commands =
+                              state::GameLimits{}.getMaxNumCommands())
+        : command_buffers{state::CommandBufferStorage(max_num_commands),
+                          state::CommandBufferStorage(max_num_commands)},
+          instruction_counts{0, 0}, skip_turns{false, false} {}
+};
+
+/**
+ * Writes the turns of a game to a binary stream
+ *
+ * The recording starts with a header, followed by one record per turn holding
+ * the skipped turns, and each player's instruction count and commands. Values
+ * are written in the byte order of the machine, so recordings are only read
+ * back on the machine they were made on, or one like it
+ */
+class DRIVERS_EXPORT CommandRecorder {
+  private:
+    std::ostream &stream;
+
+  public:
+    /**
+     * Constructor, writes the header
+     *
+     * @param stream Binary stream to write to
+     */
+    explicit CommandRecorder(std::ostream &stream);
+
+    /**
+     * Writes a turn
+     *
+     * @param command_buffers Commands of each player
+     * @param instruction_counts Instructions each player used
+     * @param skip_turns Players whose commands are ignored
+     */
+    void recordTurn(std::array<const state::CommandBuffer *, 2> command_buffers,
+                    std::array<uint64_t, 2> instruction_counts,
+                    std::array<bool, 2> skip_turns);
+};
+
+/**
+ * Reads back the turns written by a CommandRecorder
+ */
+class DRIVERS_EXPORT CommandReplayer {
+  private:
+    std::istream &stream;
+
+  public:
+    /**
+     * Constructor, reads the header
+     *
+     * @param stream Binary stream to read from
+     *
+     * @throw std::runtime_error If the stream does not hold a recording
+     */
+    explicit CommandReplayer(std::istream &stream);
+
+    /**
+     * Reads the next turn
+     *
+     * @param[out] turn Turn read
+     * @return false If there are no turns left
+     *
+     * @throw std::runtime_error If the recording ends in the middle of a turn,
+     * or holds more commands than the turn has room for
+     */
+    bool readTurn(RecordedTurn &turn);
+};
+} // namespace drivers
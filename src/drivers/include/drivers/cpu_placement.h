@@ -0,0 +1,144 @@
+/**
+ * @file cpu_placement.h
+ * Declarations for pinning the main and player processes to CPUs
+ */
+
+#pragma once
+
+#include "drivers/drivers_export.h"
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace drivers {
+
+/**
+ * A logical CPU and the resources it shares with other CPUs
+ */
+struct DRIVERS_EXPORT CpuInfo {
+    /**
+     * Logical CPU number
+     */
+    int cpu;
+
+    /**
+     * Lowest CPU among its hyperthread siblings, identifying the physical core
+     */
+    int core;
+
+    /**
+     * Lowest CPU sharing its L3 cache, identifying the cache domain
+     */
+    int l3_cache;
+};
+
+/**
+ * CPUs that the main process and the two player processes run on
+ */
+struct DRIVERS_EXPORT CpuPlacement {
+    int main_cpu;
+    std::array<int, 2> player_cpus;
+
+    /**
+     * CPUs of the main process' threads that plan the moves of bots, besides
+     * the main thread. If empty, they share the main CPU
+     */
+    std::vector<int> worker_cpus;
+};
+
+/**
+ * Ways of placing the three processes of a match close to each other
+ */
+enum class PlacementPreset {
+    /**
+     * The main process and player 1 on hyperthread siblings of one core, which
+     * share L1 and L2 caches, and player 2 on the next core
+     */
+    SIBLING_HYPERTHREADS,
+
+    /**
+     * Each process on its own physical core, with all three cores sharing an
+     * L3 cache
+     */
+    SAME_L3
+};
+
+/**
+ * Reads the topology of the CPUs this process may run on from sysfs
+ *
+ * @return std::vector<CpuInfo> Allowed CPUs, in increasing order
+ *
+ * @throw std::runtime_error If the allowed CPUs cannot be read
+ */
+DRIVERS_EXPORT std::vector<CpuInfo> readCpuTopology();
+
+/**
+ * Places a match on the CPUs following a preset
+ *
+ * Matches running side by side on one host use different slots. Slots are
+ * filled within one L3 cache domain before moving on to the next. Each slot
+ * holds the CPUs of the three processes, followed by the CPUs of the worker
+ * threads, which come after the players' CPUs in the preset's order
+ *
+ * @param topology CPUs available to the match
+ * @param preset
+ * @param slot Index of the match on this host
+ * @param num_worker_cpus Number of CPUs to reserve for worker threads
+ * @return CpuPlacement
+ *
+ * @throw std::invalid_argument If there are not enough CPUs for the slot
+ */
+DRIVERS_EXPORT CpuPlacement placeOnCpus(const std::vector<CpuInfo> &topology,
+                                        PlacementPreset preset, size_t slot,
+                                        size_t num_worker_cpus = 0);
+
+/**
+ * Parses a placement policy, one of
+ * - "siblings" or "siblings:<slot>", for PlacementPreset::SIBLING_HYPERTHREADS
+ * - "l3" or "l3:<slot>", for PlacementPreset::SAME_L3
+ * - "<main>,<player 1>,<player 2>[,<worker>...]", to give the CPUs explicitly,
+ *   with one CPU for each worker thread
+ *
+ * @param policy
+ * @param topology CPUs available to the match
+ * @param num_worker_cpus Number of CPUs to reserve for worker threads
+ * @return CpuPlacement
+ *
+ * @throw std::invalid_argument If the policy is malformed or cannot be met
+ */
+DRIVERS_EXPORT CpuPlacement parseCpuPlacement(
+    const std::string &policy, const std::vector<CpuInfo> &topology,
+    size_t num_worker_cpus = 0);
+
+/**
+ * Pins the calling thread to a CPU. Threads it starts afterwards inherit the
+ * CPU
+ *
+ * @param cpu
+ *
+ * @throw std::runtime_error If the affinity cannot be set
+ */
+DRIVERS_EXPORT void pinCurrentThread(int cpu);
+
+/**
+ * Lets the calling thread run on any of a set of CPUs. Threads it starts
+ * afterwards inherit the set
+ *
+ * @param cpus
+ *
+ * @throw std::runtime_error If the affinity cannot be set
+ */
+DRIVERS_EXPORT void pinCurrentThread(const std::vector<int> &cpus);
+
+/**
+ * Pins all threads of another process to a CPU
+ *
+ * @param pid
+ * @param cpu
+ *
+ * @throw std::runtime_error If the affinity cannot be set
+ */
+DRIVERS_EXPORT void pinProcess(int pid, int cpu);
+} // namespace drivers
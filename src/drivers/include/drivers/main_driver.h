@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "drivers/command_recording.h"
 #include "drivers/drivers_export.h"
 #include "drivers/game_result.h"
 #include "drivers/shared_memory_utils/shared_buffer.h"
@@ -15,6 +16,8 @@
 #include "state/interfaces/i_state_syncer.h"
 
 #include <atomic>
+#include <fstream>
+#include <memory>
 #include <string>
 #include <thread>
 
@@ -41,9 +44,16 @@ class DRIVERS_EXPORT MainDriver {
     std::vector<SharedBuffer *> shared_buffers;
 
     /**
-     * Pointers to transfer state copies
+     * Copies of the commands the players last published. The player may write
+     * its buffer at any time, so the commands are copied out of shared memory
+     * before they are run
      */
-    std::array<transfer_state::State *, 2> transfer_states;
+    std::array<state::CommandBufferStorage, 2> player_commands;
+
+    /**
+     * Pointers to the copies of the players' commands
+     */
+    std::array<const state::CommandBuffer *, 2> command_buffers;
 
     /**
      * Current player states, that are being synced with main state
@@ -101,6 +111,32 @@ class DRIVERS_EXPORT MainDriver {
      */
     std::string log_file_name;
 
+    /**
+     * Filename to write the players' perf counters to. Empty if the players
+     * are not sampling perf counters
+     */
+    std::string perf_log_file_name;
+
+    /**
+     * Filename to write the per turn state digests to. Empty if they are not
+     * to be written
+     */
+    std::string digest_log_file_name;
+
+    /**
+     * Filename to record the players' commands to, for replaying the game
+     * without the players. Empty if they are not to be recorded
+     */
+    std::string command_log_file_name;
+
+    std::ofstream command_log_file;
+
+    /**
+     * Records the commands of each turn to command_log_file, if they are to
+     * be recorded
+     */
+    std::unique_ptr<CommandRecorder> command_recorder;
+
     /**
      * Flag that is set to cancel the game
      */
@@ -113,6 +149,12 @@ class DRIVERS_EXPORT MainDriver {
      */
     std::array<PlayerResult, 2> getPlayerResults();
 
+    /**
+     * Write the player states into the back slots of the players' transfer
+     * states, and publish them
+     */
+    void publishTransferStates();
+
     /**
      * Write final game parameters and stop the timer
      *
@@ -139,7 +181,9 @@ class DRIVERS_EXPORT MainDriver {
                int64_t player_instruction_limit_game, int64_t num_game_turns,
                Timer::Interval game_duration,
                std::unique_ptr<logger::ILogger> logger,
-               std::string log_file_name);
+               std::string log_file_name, std::string perf_log_file_name = "",
+               std::string digest_log_file_name = "",
+               std::string command_log_file_name = "");
 
     /**
      * Set player process ids
@@ -159,7 +203,8 @@ class DRIVERS_EXPORT MainDriver {
     /**
      * Cancels the execution of the main driver.
      *
-     * Blocks until main driver fully exits and returns player results
+     * Does not block. The main driver wakes from waiting on a player and
+     * returns from start, which the caller should join on for the results
      */
     void cancel();
 };
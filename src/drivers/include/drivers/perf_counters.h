@@ -0,0 +1,104 @@
+/**
+ * @file perf_counters.h
+ * Declarations for per thread perf_event_open counters
+ */
+
+#pragma once
+
+#include "drivers/drivers_export.h"
+#include "logger/perf_counts.h"
+
+#include <array>
+#include <cstddef>
+
+namespace drivers {
+
+/**
+ * Counts software and hardware events of the calling thread with
+ * perf_event_open
+ *
+ * Software counters (task clock, context switches, page faults) are always
+ * attempted. Hardware counters (cycles, instructions, cache misses) are
+ * frequently unavailable in containers and VMs, or forbidden by
+ * perf_event_paranoid, in which case they are skipped and reported as not
+ * sampled
+ */
+class DRIVERS_EXPORT PerfCounters {
+  public:
+    /**
+     * Events that are counted
+     */
+    enum class Event {
+        TASK_CLOCK,
+        CONTEXT_SWITCHES,
+        PAGE_FAULTS,
+        CYCLES,
+        INSTRUCTIONS,
+        CACHE_MISSES,
+        EVENT_COUNT
+    };
+
+  private:
+    /**
+     * File descriptor of each event's counter, -1 if the counter could not be
+     * opened
+     */
+    std::array<int, static_cast<size_t>(Event::EVENT_COUNT)> file_descriptors;
+
+    /**
+     * Opens a counter for the calling thread, counting kernel side events
+     * where permitted and falling back to user space only events
+     *
+     * @param event Event to count
+     * @return int File descriptor of the counter, -1 on failure
+     */
+    static int openCounter(Event event);
+
+    /**
+     * Reads a counter, scaling its value if the kernel multiplexed it
+     *
+     * @param event Event to read
+     * @return uint64_t Value of the counter, 0 if it is not open
+     */
+    uint64_t readCounter(Event event) const;
+
+  public:
+    /**
+     * Constructor. Opens counters for the calling thread, which must be the
+     * thread that calls start and stop
+     */
+    PerfCounters();
+
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    /**
+     * Check if an event is being counted
+     *
+     * @param event
+     * @return True if the event's counter is open, false otherwise
+     */
+    bool isAvailable(Event event) const;
+
+    /**
+     * Check if all the hardware counters could be opened
+     *
+     * @return True if cycles, instructions and cache misses are counted
+     */
+    bool isHardwareAvailable() const;
+
+    /**
+     * Resets and enables all open counters
+     */
+    void start();
+
+    /**
+     * Disables all open counters and returns their values since start
+     *
+     * @return logger::PerfCounts Values of the counters
+     */
+    logger::PerfCounts stop();
+};
+} // namespace drivers
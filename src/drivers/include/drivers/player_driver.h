@@ -6,6 +6,7 @@
 #pragma once
 
 #include "drivers/drivers_export.h"
+#include "drivers/perf_counters.h"
 #include "drivers/shared_memory_utils/shared_memory_player.h"
 #include "drivers/timer.h"
 #include "player_wrapper/player_code_wrapper.h"
@@ -90,6 +91,17 @@ class DRIVERS_EXPORT PlayerDriver {
      */
     const uint64_t max_debug_logs_turn_length;
 
+    /**
+     * True if perf counters should be sampled around every update
+     */
+    const bool is_perf_counting_enabled;
+
+    /**
+     * Perf counters of the thread running the player's code. Null unless perf
+     * counting is enabled and the driver has been started
+     */
+    std::unique_ptr<PerfCounters> perf_counters;
+
     /**
      * Writes the count to shared memory
      */
@@ -116,6 +128,9 @@ class DRIVERS_EXPORT PlayerDriver {
      *                                          exceeded per turn limit
      * @param[in]  max_debug_logs_turn_length   Maxiumum length of debug logs
      *                                          per turn
+     * @param[in]  is_perf_counting_enabled     If true, perf counters are
+     *                                          sampled around every update and
+     *                                          written to shared memory
      */
     PlayerDriver(
         std::unique_ptr<player_wrapper::PlayerCodeWrapper> player_code_wrapper,
@@ -123,7 +138,8 @@ class DRIVERS_EXPORT PlayerDriver {
         Timer::Interval game_duration, std::string player_debug_log_file,
         std::string debug_logs_turn_prefix,
         std::string debug_logs_truncate_message,
-        int64_t max_debug_logs_turn_length);
+        int64_t max_debug_logs_turn_length,
+        bool is_perf_counting_enabled = false);
 
     /**
      * Increment instruction_count by count
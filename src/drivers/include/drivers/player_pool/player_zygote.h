@@ -0,0 +1,98 @@
+/**
+ * @file player_zygote.h
+ * Declaration for a pre-spawned player process that forks match workers
+ */
+
+#pragma once
+
+#include "drivers/drivers_export.h"
+
+#include <functional>
+#include <string>
+#include <sys/types.h>
+#include <unordered_map>
+
+namespace drivers {
+
+/**
+ * Keeps a fully started and dynamically linked player process warm, and forks
+ * a worker from it for every match
+ *
+ * The worker inherits the linked player code library and everything the
+ * player process set up before the zygote started, so a match begins without
+ * an exec, dynamic linking, or reading the SHM name from disk. It takes its
+ * working directory and settings from the game, so it writes its logs and
+ * traces where, and behaves as, a spawned player would
+ *
+ * @see pool_protocol.h for the messages exchanged with the game
+ */
+class DRIVERS_EXPORT PlayerZygote {
+  public:
+    /**
+     * Runs a player for a match inside a worker and returns the worker's exit
+     * code. Called with the SHM name received from the game
+     */
+    typedef std::function<int(const std::string &shm_name)> StartPlayerCallback;
+
+  private:
+    /**
+     * Path of the UNIX socket the zygote listens on
+     */
+    std::string socket_path;
+
+    /**
+     * Runs the player in a forked worker
+     */
+    StartPlayerCallback start_player;
+
+    /**
+     * Listening socket
+     */
+    int listen_fd;
+
+    /**
+     * signalfd which becomes readable when a worker exits
+     */
+    int signal_fd;
+
+    /**
+     * Connection to the game of each running worker, to send its exit code to
+     */
+    std::unordered_map<pid_t, int> worker_connections;
+
+    /**
+     * Accepts a connection, reads the SHM name and the match's context, and
+     * forks a worker for them
+     */
+    void acceptMatch();
+
+    /**
+     * Reaps all exited workers and sends their exit codes to the game
+     */
+    void reapWorkers();
+
+  public:
+    /**
+     * Constructor. Binds the socket, replacing any stale socket file
+     *
+     * @param socket_path Path of the UNIX socket to listen on
+     * @param start_player Runs a player for a match inside a worker
+     *
+     * @throw std::runtime_error If the socket cannot be set up
+     */
+    PlayerZygote(std::string socket_path, StartPlayerCallback start_player);
+
+    /**
+     * Closes the sockets and removes the socket file
+     */
+    ~PlayerZygote();
+
+    PlayerZygote(const PlayerZygote &) = delete;
+    PlayerZygote &operator=(const PlayerZygote &) = delete;
+
+    /**
+     * Blocking function that serves matches until the process is terminated
+     */
+    void run();
+};
+} // namespace drivers
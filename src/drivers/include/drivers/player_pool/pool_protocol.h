@@ -0,0 +1,197 @@
+/**
+ * @file pool_protocol.h
+ * Wire format spoken between a player zygote and the game over a UNIX socket
+ *
+ * Every match opens a new connection to the zygote of each player. Strings
+ * are sent as a uint32_t length followed by the characters:
+ * 1. The game sends the SHM name
+ * 2. The game sends its match context: its working directory, then the number
+ *    of its settings as a uint32_t, then each setting as NAME=VALUE
+ * 3. The zygote forks a worker, which runs in the match's directory with the
+ *    match's settings, and replies with the worker's pid, an int32_t
+ * 4. When the worker exits, the zygote sends its exit code, an int32_t, and
+ *    closes the connection. A worker killed by a signal exits with 128 plus
+ *    the signal number, like in a shell
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace drivers {
+namespace pool_protocol {
+
+/**
+ * Maximum length of an SHM name accepted by the zygote
+ */
+const uint32_t MAX_SHM_NAME_LENGTH = 255;
+
+/**
+ * Maximum length of a working directory or a setting accepted by the zygote
+ */
+const uint32_t MAX_CONTEXT_STRING_LENGTH = 4096;
+
+/**
+ * Maximum number of settings accepted by the zygote
+ */
+const uint32_t MAX_NUM_SETTINGS = 64;
+
+/**
+ * Prefix of the environment variables that configure a match. A spawned
+ * player inherits them from the game, so a worker is given the game's in
+ * place of the zygote's
+ */
+const auto SETTING_PREFIX = std::string("CODECHARACTER_");
+
+/**
+ * Where and how a player runs for a match, which a worker takes from the game
+ * rather than from the zygote it was forked from
+ */
+struct MatchContext {
+    /**
+     * Directory the player's logs and traces are written to
+     */
+    std::string working_directory;
+
+    /**
+     * Environment variables starting with SETTING_PREFIX, as NAME=VALUE
+     */
+    std::vector<std::string> settings;
+};
+
+/**
+ * Writes the whole buffer to a socket, retrying on partial writes. Does not
+ * raise SIGPIPE if the peer has gone away
+ *
+ * @param socket_fd
+ * @param buffer
+ * @param length Number of bytes to write
+ * @return True if all bytes were written, false on error
+ */
+inline bool sendAll(int socket_fd, const void *buffer, size_t length) {
+    auto bytes = static_cast<const char *>(buffer);
+    while (length > 0) {
+        auto written = send(socket_fd, bytes, length, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        length -= written;
+    }
+    return true;
+}
+
+/**
+ * Reads exactly length bytes from a socket, retrying on partial reads
+ *
+ * @param socket_fd
+ * @param buffer
+ * @param length Number of bytes to read
+ * @return True if all bytes were read, false on error or end of stream
+ */
+inline bool receiveAll(int socket_fd, void *buffer, size_t length) {
+    auto bytes = static_cast<char *>(buffer);
+    while (length > 0) {
+        auto num_read = read(socket_fd, bytes, length);
+        if (num_read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (num_read <= 0) {
+            return false;
+        }
+        bytes += num_read;
+        length -= num_read;
+    }
+    return true;
+}
+
+/**
+ * Writes a string as its length followed by its characters
+ *
+ * @param socket_fd
+ * @param value
+ * @return True if the string was written, false on error
+ */
+inline bool sendString(int socket_fd, const std::string &value) {
+    uint32_t length = value.size();
+    return sendAll(socket_fd, &length, sizeof(length)) &&
+           sendAll(socket_fd, value.data(), length);
+}
+
+/**
+ * Reads a string written by sendString
+ *
+ * @param socket_fd
+ * @param[out] value
+ * @param max_length Longest string accepted
+ * @return True if a string of at most max_length characters was read, false
+ *         on error, end of stream or a longer string
+ */
+inline bool receiveString(int socket_fd, std::string &value,
+                          uint32_t max_length) {
+    uint32_t length = 0;
+    if (!receiveAll(socket_fd, &length, sizeof(length)) ||
+        length > max_length) {
+        return false;
+    }
+    value.resize(length);
+    return length == 0 || receiveAll(socket_fd, &value[0], length);
+}
+
+/**
+ * Writes the context of a match
+ *
+ * @param socket_fd
+ * @param context
+ * @return True if the context was written, false on error
+ */
+inline bool sendMatchContext(int socket_fd, const MatchContext &context) {
+    uint32_t num_settings = context.settings.size();
+    if (!sendString(socket_fd, context.working_directory) ||
+        !sendAll(socket_fd, &num_settings, sizeof(num_settings))) {
+        return false;
+    }
+    for (const auto &setting : context.settings) {
+        if (!sendString(socket_fd, setting)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Reads the context of a match written by sendMatchContext
+ *
+ * @param socket_fd
+ * @param[out] context
+ * @return True if the context was read and is within the limits, false
+ *         otherwise
+ */
+inline bool receiveMatchContext(int socket_fd, MatchContext &context) {
+    uint32_t num_settings = 0;
+    if (!receiveString(socket_fd, context.working_directory,
+                       MAX_CONTEXT_STRING_LENGTH) ||
+        context.working_directory.empty() ||
+        !receiveAll(socket_fd, &num_settings, sizeof(num_settings)) ||
+        num_settings > MAX_NUM_SETTINGS) {
+        return false;
+    }
+    context.settings.resize(num_settings);
+    for (auto &setting : context.settings) {
+        if (!receiveString(socket_fd, setting, MAX_CONTEXT_STRING_LENGTH)) {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace pool_protocol
+} // namespace drivers
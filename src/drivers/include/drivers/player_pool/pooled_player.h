@@ -0,0 +1,90 @@
+/**
+ * @file pooled_player.h
+ * Declaration for a handle to a player worker forked by a zygote
+ */
+
+#pragma once
+
+#include "drivers/drivers_export.h"
+
+#include <string>
+
+namespace drivers {
+
+/**
+ * A player worker forked by a PlayerZygote for a single match
+ *
+ * Mirrors the parts of boost::process::child used to supervise players. Like
+ * boost::process::child, a worker that is still running when its handle is
+ * destroyed is killed
+ */
+class DRIVERS_EXPORT PooledPlayer {
+  private:
+    /**
+     * Connection to the zygote, over which the exit code arrives
+     */
+    int socket_fd;
+
+    /**
+     * Process ID of the worker
+     */
+    int pid;
+
+    /**
+     * Exit code of the worker, once it has been received
+     */
+    int exit_status;
+
+    /**
+     * True once the worker's exit code has been received
+     */
+    bool has_exited;
+
+  public:
+    /**
+     * Asks the zygote listening on socket_path to start a worker for a match.
+     * The worker runs in the calling process' working directory, with its
+     * CODECHARACTER_ settings in place of the zygote's, as a spawned player
+     * would
+     *
+     * @param socket_path Path of the zygote's UNIX socket
+     * @param shm_name Name of the SHM the worker should attach to
+     *
+     * @throw std::runtime_error If the zygote could not be reached or failed to
+     *                           start a worker
+     */
+    PooledPlayer(const std::string &socket_path, const std::string &shm_name);
+
+    PooledPlayer(PooledPlayer &&other) noexcept;
+
+    PooledPlayer(const PooledPlayer &) = delete;
+    PooledPlayer &operator=(const PooledPlayer &) = delete;
+    PooledPlayer &operator=(PooledPlayer &&) = delete;
+
+    /**
+     * Kills the worker if it is still running and closes the connection
+     */
+    ~PooledPlayer();
+
+    /**
+     * Process ID of the worker
+     */
+    int id() const;
+
+    /**
+     * Descriptor that becomes readable once the worker has exited, after
+     * which wait returns without blocking
+     */
+    int getExitFd() const;
+
+    /**
+     * Blocks until the worker exits
+     */
+    void wait();
+
+    /**
+     * Exit code of the worker. Only valid after wait has returned
+     */
+    int exit_code() const;
+};
+} // namespace drivers
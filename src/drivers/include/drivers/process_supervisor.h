@@ -0,0 +1,191 @@
+/**
+ * @file process_supervisor.h
+ * Declaration for a single threaded supervisor of player processes
+ */
+
+#pragma once
+
+#include "drivers/drivers_export.h"
+
+#include <csignal>
+#include <cstddef>
+#include <functional>
+#include <sys/types.h>
+#include <vector>
+
+namespace drivers {
+
+/**
+ * Exit of a supervised process
+ */
+struct DRIVERS_EXPORT ProcessExit {
+    /**
+     * Index returned when the process was added to the supervisor
+     */
+    size_t process_index;
+
+    /**
+     * Exit code of the process. A process killed by a signal exits with 128
+     * plus the signal number, like in a shell
+     */
+    int exit_code;
+};
+
+/**
+ * Waits on the exit of several processes at once with a single epoll loop
+ *
+ * Child processes are watched through pidfds. On kernels without pidfds, the
+ * supervisor falls back to blocking SIGCHLD and reading it from a signalfd.
+ * Threads started after the supervisor inherit the blocked SIGCHLD, and threads
+ * started before it must block it themselves, as the worker pool's threads do.
+ * Processes that are not children, such as pooled players, are watched
+ * through a descriptor that becomes readable when they exit
+ */
+class DRIVERS_EXPORT ProcessSupervisor {
+  public:
+    /**
+     * Reads the exit code of a process once its exit descriptor is readable
+     */
+    typedef std::function<int()> ExitCodeReader;
+
+  private:
+    /**
+     * A supervised process
+     */
+    struct Process {
+        /**
+         * Process ID
+         */
+        pid_t pid;
+
+        /**
+         * pidfd of the process, -1 if it is not a child or pidfds are not
+         * supported
+         */
+        int pidfd;
+
+        /**
+         * Descriptor registered with epoll for this process, -1 if the
+         * process is watched through the signalfd
+         */
+        int exit_fd;
+
+        /**
+         * Reads the exit code, empty for child processes which are reaped
+         */
+        ExitCodeReader read_exit_code;
+
+        /**
+         * True once the process has exited
+         */
+        bool has_exited;
+
+        /**
+         * True once the exit has been returned from waitForExit
+         */
+        bool is_reported;
+
+        /**
+         * Exit code, once the process has exited
+         */
+        int exit_code;
+    };
+
+    /**
+     * Supervised processes, indexed in the order they were added
+     */
+    std::vector<Process> processes;
+
+    /**
+     * epoll instance all exit descriptors are registered with
+     */
+    int epoll_fd;
+
+    /**
+     * signalfd for SIGCHLD, -1 unless pidfds are not supported
+     */
+    int signal_fd;
+
+    /**
+     * Signal mask of the thread before SIGCHLD was blocked for the signalfd
+     */
+    sigset_t previous_signal_mask;
+
+    /**
+     * Blocks SIGCHLD and creates the signalfd, if not already done
+     */
+    void openSignalFd();
+
+    /**
+     * Reaps a child if it has exited, without blocking
+     *
+     * @param process
+     * @return True if the child has exited
+     */
+    static bool reapChild(Process &process);
+
+    /**
+     * Waits for events and records the exits they signal
+     */
+    void pollExits();
+
+  public:
+    /**
+     * Constructor
+     *
+     * @throw std::runtime_error If the epoll instance cannot be created
+     */
+    ProcessSupervisor();
+
+    /**
+     * Closes all descriptors and restores the signal mask
+     */
+    ~ProcessSupervisor();
+
+    ProcessSupervisor(const ProcessSupervisor &) = delete;
+    ProcessSupervisor &operator=(const ProcessSupervisor &) = delete;
+
+    /**
+     * Supervises a child process of this process. The supervisor reaps the
+     * child when it exits
+     *
+     * If pidfds are not supported, SIGCHLD is blocked in the calling thread,
+     * so threads that should not consume SIGCHLD must be started from it
+     * afterwards
+     *
+     * @param pid
+     * @return size_t Index of the process
+     *
+     * @throw std::runtime_error If the child cannot be watched
+     */
+    size_t addChild(pid_t pid);
+
+    /**
+     * Supervises a process that is not a child of this process
+     *
+     * @param pid
+     * @param exit_fd Descriptor that becomes readable when the process exits
+     * @param read_exit_code Reads the exit code once exit_fd is readable
+     * @return size_t Index of the process
+     *
+     * @throw std::runtime_error If the descriptor cannot be watched
+     */
+    size_t addProcess(pid_t pid, int exit_fd, ExitCodeReader read_exit_code);
+
+    /**
+     * Blocks until a supervised process exits. Each exit is returned once
+     *
+     * @return ProcessExit The process that exited and its exit code
+     *
+     * @throw std::logic_error If all exits have already been returned
+     */
+    ProcessExit waitForExit();
+
+    /**
+     * Sends SIGTERM to a process, unless it has already exited
+     *
+     * @param process_index
+     */
+    void terminate(size_t process_index);
+};
+} // namespace drivers
@@ -6,19 +6,69 @@
 #pragma once
 
 #include "drivers/drivers_export.h"
+#include "logger/perf_counts.h"
 #include "player_wrapper/transfer_state.h"
+#include "state/command_buffer.h"
+#include "state/game_limits.h"
+
+#include <array>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 
 namespace drivers {
 
+/**
+ * Offsets of the blocks of a shared buffer laid out for the limits of a game,
+ * from the start of the buffer
+ */
+struct DRIVERS_EXPORT SharedBufferLayout {
+    /**
+     * Offsets of the slots of the transfer state and the command buffer
+     */
+    std::array<size_t, 2> transfer_state_offsets;
+    std::array<size_t, 2> command_buffer_offsets;
+
+    /**
+     * Bytes taken by the header and the blocks that follow it
+     */
+    size_t size;
+
+    explicit SharedBufferLayout(const state::GameLimits &limits);
+};
+
 /**
  * Struct for using as buffer in shared memory
+ *
+ * The buffer is a header followed by two slots for the player's transfer state
+ * and two for its command buffer, which are sized from the limits of the game.
+ * The header holds their layout, so that the player process finds them without
+ * knowing the limits. Buffers are only created in place, by SharedBufferOwner,
+ * in a block of getSize bytes
+ *
+ * Each direction is double buffered. The writer fills the back slot while the
+ * reader still owns the published one, and publishes it by advancing a
+ * sequence number, whose parity is the index of the published slot. A reader
+ * owns the slot it was handed until it hands the turn back, so the writer
+ * never writes a slot that may still be read
+ *
+ * The player may write anything to the buffer, so only the player side is
+ * found through the header. The main process goes through its SharedBufferOwner
  */
 struct DRIVERS_EXPORT SharedBuffer {
-    SharedBuffer(bool is_player_running, int64_t turn_instruction_counter,
-                 int64_t game_instruction_counter,
-                 transfer_state::State transfer_state);
+  private:
+    /**
+     * Layout the buffer was created with
+     */
+    SharedBufferLayout layout;
+
+    SharedBuffer(const state::GameLimits &limits, bool is_player_running,
+                 int64_t turn_instruction_counter,
+                 int64_t game_instruction_counter);
+
+    friend class SharedBufferOwner;
 
+  public:
     /**
      * True if the player process is executing its turn, false otherwise
      */
@@ -35,8 +85,115 @@ struct DRIVERS_EXPORT SharedBuffer {
     std::atomic<uint64_t> game_instruction_counter;
 
     /**
-     * Player's copy of the state with limited information
+     * Perf counters sampled around the player's update in the present turn.
+     * Written before is_player_running is cleared, so the main driver may read
+     * it once it sees the player's turn is over
+     */
+    logger::PerfCounts turn_perf_counts;
+
+    /**
+     * Number of transfer states the main driver has published. Only the main
+     * driver advances it
+     */
+    std::atomic<uint64_t> state_sequence;
+
+    /**
+     * Number of command buffers the player has published. Only the player
+     * advances it
+     */
+    std::atomic<uint64_t> command_sequence;
+
+    SharedBuffer(const SharedBuffer &) = delete;
+
+    SharedBuffer &operator=(const SharedBuffer &) = delete;
+
+    /**
+     * Bytes taken by a buffer laid out for the limits of a game
+     *
+     * @param limits
+     * @return size_t
+     */
+    static size_t getSize(const state::GameLimits &limits);
+
+    /**
+     * Bytes taken by the buffer, as laid out in the header
+     */
+    size_t getSize() const { return layout.size; }
+
+    /**
+     * Player's copy of the state with limited information, as last published
+     * by the main driver
+     */
+    const transfer_state::State &getTransferState();
+
+    /**
+     * Back slot for the commands the player issues in the present turn.
+     * Written by the player only
+     */
+    state::CommandBuffer &getNextCommandBuffer();
+
+    /**
+     * Publishes the commands of the present turn, which the main driver then
+     * reads instead of the ones they replace
+     */
+    void publishCommandBuffer();
+};
+
+/**
+ * Main process' side of a shared buffer. It keeps the limits and layout the
+ * buffer was created with, and never reads an offset, limit or cap back from
+ * shared memory, so a player that writes over the header cannot make the main
+ * process read or write outside the buffer
+ */
+class DRIVERS_EXPORT SharedBufferOwner {
+  private:
+    SharedBuffer *buffer;
+
+    state::GameLimits limits;
+
+    SharedBufferLayout layout;
+
+    transfer_state::StateLayout state_layout;
+
+    char *getBlock(size_t offset) const;
+
+  public:
+    /**
+     * Creates a buffer in a block of memory, with empty transfer states and
+     * command buffers
+     *
+     * @param memory Block of SharedBuffer::getSize(limits) bytes, aligned for
+     * any type
+     * @param limits
+     */
+    SharedBufferOwner(void *memory, const state::GameLimits &limits,
+                      bool is_player_running, int64_t turn_instruction_counter,
+                      int64_t game_instruction_counter);
+
+    SharedBuffer *getBuffer() const { return buffer; }
+
+    const state::GameLimits &getLimits() const { return limits; }
+
+    /**
+     * Writes a player state into the back slot of the transfer state, and
+     * publishes it
+     *
+     * @param player_state
+     * @throw std::invalid_argument If the player state does not fit the limits
+     */
+    void publishTransferState(const player_state::State &player_state);
+
+    /**
+     * Copies the commands the player last published into a buffer of the
+     * main process, no more than the limits allow
+     *
+     * @param[out] commands
+     */
+    void copyCommands(state::CommandBuffer &commands) const;
+
+    /**
+     * Empties both command slots, as at the start of a game
      */
-    transfer_state::State transfer_state;
+    void clearCommandBuffers();
 };
 } // namespace drivers
@@ -7,10 +7,15 @@
 
 #define BOOST_DATE_TIME_NO_LIB
 
-#include "boost/interprocess/managed_shared_memory.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+#include "boost/interprocess/shared_memory_object.hpp"
 #include "drivers/drivers_export.h"
 #include "drivers/shared_memory_utils/shared_buffer.h"
-#include "player_wrapper/transfer_state.h"
+#include "drivers/shared_memory_utils/shared_memory_paging.h"
+#include "state/game_limits.h"
+
+#include <memory>
+#include <string>
 
 namespace drivers {
 
@@ -24,23 +29,43 @@ class DRIVERS_EXPORT SharedMemoryMain {
      */
     std::string shared_memory_name;
 
+    /**
+     * Shared memory object, sized to hold exactly the buffer, or the whole
+     * huge pages it takes
+     */
+    boost::interprocess::shared_memory_object shared_memory;
+
     /**
      * Mapped region to write to and read from
      */
-    boost::interprocess::managed_shared_memory shared_memory;
+    boost::interprocess::mapped_region region;
+
+    /**
+     * Way the pages of the region are backed
+     */
+    SharedMemoryPaging paging;
+
+    /**
+     * Main process' side of the buffer in the region
+     */
+    std::unique_ptr<SharedBufferOwner> buffer_owner;
 
   public:
     /**
-     * Creates new shm with given name
+     * Creates new shm with given name, holding a buffer laid out for the
+     * limits of the game
      *
      * @param[in]  shared_memory_name  The shared memory name
+     * @param[in]  limits              Limits of the game
+     * @param[in]  paging              Way to back the pages of the shm with
      *
      * @throw      std::exception      If shm already exists
      */
     SharedMemoryMain(const std::string &shared_memory_name,
                      bool is_player_running, uint64_t turn_instruction_count,
                      uint64_t game_instruction_count,
-                     const transfer_state::State &transfer_state);
+                     const state::GameLimits &limits = state::GameLimits{},
+                     SharedMemoryPaging paging = SharedMemoryPaging::DEFAULT);
 
     /**
      * Removes shm
@@ -53,5 +78,21 @@ class DRIVERS_EXPORT SharedMemoryMain {
      * @return     The pointer
      */
     SharedBuffer *getBuffer();
+
+    /**
+     * Gets the main process' side of the buffer, which reads and writes the
+     * blocks of the buffer without trusting its header
+     *
+     * @return     The buffer owner
+     */
+    SharedBufferOwner &getBufferOwner();
+
+    /**
+     * Gets the way the pages of the shm are backed, which falls short of the
+     * way asked for where the system does not allow it
+     *
+     * @return     The paging
+     */
+    SharedMemoryPaging getPaging() const;
 };
 } // namespace drivers
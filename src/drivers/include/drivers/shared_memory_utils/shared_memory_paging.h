@@ -0,0 +1,102 @@
+/**
+ * @file shared_memory_paging.h
+ * Declarations for how the pages of the shared memory are backed
+ */
+
+#pragma once
+
+#define BOOST_DATE_TIME_NO_LIB
+
+#include "boost/interprocess/mapped_region.hpp"
+#include "boost/interprocess/shared_memory_object.hpp"
+#include "drivers/drivers_export.h"
+
+#include <cstddef>
+#include <string>
+
+namespace drivers {
+
+/**
+ * How the pages of a shared memory region are backed. Each way includes the
+ * ones before it
+ */
+enum class SharedMemoryPaging {
+    /**
+     * Pages are faulted in when they are first touched, which happens during
+     * the first turns, and may be swapped out
+     */
+    DEFAULT,
+
+    /**
+     * Pages are faulted in when the region is mapped, before the game starts
+     */
+    PREFAULTED,
+
+    /**
+     * Pages are also locked in memory, so they are never swapped out
+     */
+    LOCKED,
+
+    /**
+     * Pages are also transparent huge pages, so the region takes fewer TLB
+     * entries. The region is rounded up to a whole number of huge pages
+     */
+    HUGE_PAGES
+};
+
+/**
+ * Reads a way of backing shared memory from its name, one of "default",
+ * "prefault", "locked" or "huge"
+ *
+ * @param name
+ * @return SharedMemoryPaging
+ *
+ * @throw std::invalid_argument If the name is unknown
+ */
+DRIVERS_EXPORT SharedMemoryPaging parseSharedMemoryPaging(
+    const std::string &name);
+
+/**
+ * Name of a way of backing shared memory, as parseSharedMemoryPaging reads it
+ *
+ * @param paging
+ * @return std::string
+ */
+DRIVERS_EXPORT std::string getSharedMemoryPagingName(SharedMemoryPaging paging);
+
+/**
+ * Size of the transparent huge pages that named shared memory is backed with.
+ * The kernel only backs it with them if its mount in /dev/shm allows huge
+ * pages, or they are forced for all shared memory
+ *
+ * @return size_t Size in bytes, or 0 if shared memory is not backed with them
+ */
+DRIVERS_EXPORT size_t getSharedMemoryHugePageSize();
+
+/**
+ * Size to make a shared memory object that holds a number of bytes, rounded
+ * up to a whole number of huge pages if it is backed with them
+ *
+ * @param size
+ * @param paging
+ * @return size_t
+ */
+DRIVERS_EXPORT size_t getSharedMemorySize(size_t size,
+                                          SharedMemoryPaging paging);
+
+/**
+ * Maps a shared memory object whole, with its pages backed as asked. Falls
+ * back to the next way down where the system does not allow one, as when huge
+ * pages are not available or locking the region would go over RLIMIT_MEMLOCK
+ *
+ * @param shared_memory
+ * @param paging Way of backing the pages asked for
+ * @param[out] region Region the object is mapped to
+ * @return SharedMemoryPaging Way the pages are backed
+ */
+DRIVERS_EXPORT SharedMemoryPaging
+mapSharedMemory(const boost::interprocess::shared_memory_object &shared_memory,
+                SharedMemoryPaging paging,
+                boost::interprocess::mapped_region &region);
+
+} // namespace drivers
@@ -7,9 +7,13 @@
 
 #define BOOST_DATE_TIME_NO_LIB
 
-#include "boost/interprocess/managed_shared_memory.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+#include "boost/interprocess/shared_memory_object.hpp"
 #include "drivers/drivers_export.h"
 #include "drivers/shared_memory_utils/shared_buffer.h"
+#include "drivers/shared_memory_utils/shared_memory_paging.h"
+
+#include <string>
 
 namespace drivers {
 
@@ -19,19 +23,33 @@ namespace drivers {
 class DRIVERS_EXPORT SharedMemoryPlayer {
   private:
     /**
-     * Mapped region to write to and read from
+     * Shared memory object created by the main process
+     */
+    boost::interprocess::shared_memory_object shared_memory;
+
+    /**
+     * Mapped region to write to and read from, all of the shared memory
      */
-    boost::interprocess::managed_shared_memory shared_memory;
+    boost::interprocess::mapped_region region;
+
+    /**
+     * Way the pages of the region are backed
+     */
+    SharedMemoryPaging paging;
 
   public:
     /**
-     * Opens existing shm with given name
+     * Opens existing shm with given name. The buffer in it is mapped whole,
+     * at the size the main process laid it out with
      *
      * @param[in]  shared_memory_name  The shared memory name
+     * @param[in]  paging              Way to back the pages of the shm with
      *
-     * @throw      std::exception      If shm doesn't already exist
+     * @throw      std::exception      If shm doesn't already exist, or is too
+     *                                 small for the buffer in it
      */
-    SharedMemoryPlayer(const std::string &shared_memory_name);
+    SharedMemoryPlayer(const std::string &shared_memory_name,
+                       SharedMemoryPaging paging = SharedMemoryPaging::DEFAULT);
 
     /**
      * Gets pointer to shared memory
@@ -39,5 +57,13 @@ class DRIVERS_EXPORT SharedMemoryPlayer {
      * @return     The pointer
      */
     SharedBuffer *getBuffer();
+
+    /**
+     * Gets the way the pages of the shm are backed, which falls short of the
+     * way asked for where the system does not allow it
+     *
+     * @return     The paging
+     */
+    SharedMemoryPaging getPaging() const;
 };
 } // namespace drivers
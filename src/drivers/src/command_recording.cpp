@@ -0,0 +1,118 @@
+/**
+ * @file command_recording.cpp
+ * Definitions for recording and replaying the commands players issue
+ */
+
+#include "drivers/command_recording.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace drivers {
+
+namespace {
+
+/**
+ * Identifies a recording, and the version of its format
+ */
+const char RECORDING_MAGIC[8] = {'C', 'C', 'R', 'E', 'C', '0', '0', '1'};
+
+/**
+ * Flag set in a turn's first byte for each player whose turn is skipped
+ */
+const uint8_t SKIP_TURN_FLAGS[2] = {0x1, 0x2};
+
+template <typename T> void writeValue(std::ostream &stream, const T &value) {
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T> void readValue(std::istream &stream, T &value) {
+    stream.read(reinterpret_cast<char *>(&value), sizeof(value));
+    if (!stream) {
+        throw std::runtime_error("Recording ends in the middle of a turn");
+    }
+}
+} // namespace
+
+CommandRecorder::CommandRecorder(std::ostream &stream) : stream(stream) {
+    stream.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+}
+
+void CommandRecorder::recordTurn(
+    std::array<const state::CommandBuffer *, 2> command_buffers,
+    std::array<uint64_t, 2> instruction_counts,
+    std::array<bool, 2> skip_turns) {
+    auto flags = uint8_t{0};
+    for (size_t player_id = 0; player_id < 2; ++player_id) {
+        if (skip_turns[player_id]) {
+            flags |= SKIP_TURN_FLAGS[player_id];
+        }
+    }
+    writeValue(stream, flags);
+
+    for (size_t player_id = 0; player_id < 2; ++player_id) {
+        const auto &command_buffer = *command_buffers[player_id];
+        writeValue(stream, instruction_counts[player_id]);
+
+        // The player may have left a bad count in shared memory, which
+        // getCommands leaves out
+        auto commands = command_buffer.getCommands();
+        writeValue(stream, static_cast<uint32_t>(commands.size()));
+
+        // Fields are written one by one, so that padding is left out
+        for (const auto &command : commands) {
+            writeValue(stream, command.type);
+            writeValue(stream, static_cast<int8_t>(command.error_type));
+            writeValue(stream, command.actor_id);
+            writeValue(stream, command.position.x);
+            writeValue(stream, command.position.y);
+        }
+    }
+}
+
+CommandReplayer::CommandReplayer(std::istream &stream) : stream(stream) {
+    char magic[sizeof(RECORDING_MAGIC)];
+    stream.read(magic, sizeof(magic));
+    if (!stream || std::memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("Not a command recording");
+    }
+}
+
+bool CommandReplayer::readTurn(RecordedTurn &turn) {
+    uint8_t flags;
+    stream.read(reinterpret_cast<char *>(&flags), sizeof(flags));
+    if (stream.gcount() == 0) {
+        return false;
+    }
+
+    for (size_t player_id = 0; player_id < 2; ++player_id) {
+        turn.skip_turns[player_id] = (flags & SKIP_TURN_FLAGS[player_id]) != 0;
+
+        auto &command_buffer = *turn.command_buffers[player_id];
+        readValue(stream, turn.instruction_counts[player_id]);
+
+        uint32_t num_commands;
+        readValue(stream, num_commands);
+        if (num_commands > command_buffer.getMaxNumCommands()) {
+            throw std::runtime_error("Too many commands in a turn: " +
+                                     std::to_string(num_commands));
+        }
+
+        command_buffer.clear();
+        for (uint32_t i = 0; i < num_commands; ++i) {
+            auto command = state::Command{};
+            int8_t error_type;
+            readValue(stream, command.type);
+            readValue(stream, error_type);
+            readValue(stream, command.actor_id);
+            readValue(stream, command.position.x);
+            readValue(stream, command.position.y);
+            command.error_type = static_cast<logger::ErrorType>(error_type);
+            command_buffer.push(command);
+        }
+    }
+
+    return true;
+}
+} // namespace drivers
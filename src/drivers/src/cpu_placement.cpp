@@ -0,0 +1,264 @@
+/**
+ * @file cpu_placement.cpp
+ * Definitions for pinning the main and player processes to CPUs
+ */
+
+#include "drivers/cpu_placement.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <map>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <stdexcept>
+
+namespace drivers {
+
+const auto SYSFS_CPU_PATH = std::string("/sys/devices/system/cpu/cpu");
+
+/**
+ * Reads the lowest CPU from a sysfs CPU list, such as "0-3,8-11"
+ *
+ * @param file_name
+ * @param default_cpu Returned if the file cannot be read
+ * @return int
+ */
+static int readFirstCpu(const std::string &file_name, int default_cpu) {
+    std::ifstream cpu_list(file_name);
+    int cpu = 0;
+    if (cpu_list >> cpu) {
+        return cpu;
+    }
+    return default_cpu;
+}
+
+/**
+ * Finds the lowest CPU sharing the L3 cache of a CPU. Falls back to the lowest
+ * CPU in the same package if the caches are not listed
+ */
+static int readL3CacheDomain(int cpu) {
+    auto cpu_path = SYSFS_CPU_PATH + std::to_string(cpu);
+
+    for (int index = 0;; ++index) {
+        auto cache_path = cpu_path + "/cache/index" + std::to_string(index);
+        std::ifstream level_file(cache_path + "/level");
+        int level = 0;
+        if (!(level_file >> level)) {
+            break;
+        }
+        if (level == 3) {
+            return readFirstCpu(cache_path + "/shared_cpu_list", cpu);
+        }
+    }
+
+    return readFirstCpu(cpu_path + "/topology/core_siblings_list", cpu);
+}
+
+std::vector<CpuInfo> readCpuTopology() {
+    cpu_set_t allowed_cpus;
+    CPU_ZERO(&allowed_cpus);
+    if (sched_getaffinity(0, sizeof(allowed_cpus), &allowed_cpus) == -1) {
+        throw std::runtime_error(std::string("Could not read CPU affinity: ") +
+                                 std::strerror(errno));
+    }
+
+    auto topology = std::vector<CpuInfo>{};
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed_cpus)) {
+            continue;
+        }
+
+        auto siblings_file = SYSFS_CPU_PATH + std::to_string(cpu) +
+                             "/topology/thread_siblings_list";
+        topology.push_back(CpuInfo{cpu, readFirstCpu(siblings_file, cpu),
+                                   readL3CacheDomain(cpu)});
+    }
+
+    return topology;
+}
+
+CpuPlacement placeOnCpus(const std::vector<CpuInfo> &topology,
+                         PlacementPreset preset, size_t slot,
+                         size_t num_worker_cpus) {
+    // Group the CPUs by L3 cache, so that no match spans two caches
+    auto cache_domains = std::map<int, std::vector<CpuInfo>>{};
+    for (const auto &cpu_info : topology) {
+        cache_domains[cpu_info.l3_cache].push_back(cpu_info);
+    }
+
+    auto slot_size = 3 + num_worker_cpus;
+    auto slots = std::vector<std::vector<int>>{};
+    for (auto &cache_domain : cache_domains) {
+        auto &cpus = cache_domain.second;
+
+        // Rank of each CPU among its hyperthread siblings
+        auto sibling_ranks = std::map<int, int>{};
+        auto siblings_seen = std::map<int, int>{};
+        std::sort(cpus.begin(), cpus.end(),
+                  [](const CpuInfo &a, const CpuInfo &b) {
+                      return a.cpu < b.cpu;
+                  });
+        for (const auto &cpu_info : cpus) {
+            sibling_ranks[cpu_info.cpu] = siblings_seen[cpu_info.core]++;
+        }
+
+        switch (preset) {
+        case PlacementPreset::SIBLING_HYPERTHREADS:
+            // Siblings next to each other
+            std::sort(cpus.begin(), cpus.end(),
+                      [](const CpuInfo &a, const CpuInfo &b) {
+                          return std::make_pair(a.core, a.cpu) <
+                                 std::make_pair(b.core, b.cpu);
+                      });
+            break;
+        case PlacementPreset::SAME_L3:
+            // One CPU from every core before any core is used twice
+            std::sort(cpus.begin(), cpus.end(),
+                      [&sibling_ranks](const CpuInfo &a, const CpuInfo &b) {
+                          return std::make_pair(sibling_ranks[a.cpu], a.core) <
+                                 std::make_pair(sibling_ranks[b.cpu], b.core);
+                      });
+            break;
+        }
+
+        for (size_t i = 0; i + slot_size <= cpus.size(); i += slot_size) {
+            auto slot_cpus = std::vector<int>{};
+            for (size_t j = i; j < i + slot_size; ++j) {
+                slot_cpus.push_back(cpus[j].cpu);
+            }
+            slots.push_back(slot_cpus);
+        }
+    }
+
+    if (slot >= slots.size()) {
+        throw std::invalid_argument("Not enough CPUs for match slot " +
+                                    std::to_string(slot) + ", there are " +
+                                    std::to_string(slots.size()) + " slots");
+    }
+
+    auto &cpus = slots[slot];
+    return CpuPlacement{cpus[0],
+                        {cpus[1], cpus[2]},
+                        std::vector<int>(cpus.begin() + 3, cpus.end())};
+}
+
+CpuPlacement parseCpuPlacement(const std::string &policy,
+                               const std::vector<CpuInfo> &topology,
+                               size_t num_worker_cpus) {
+    auto separator = policy.find(':');
+    auto preset_name = policy.substr(0, separator);
+    auto slot = size_t{0};
+
+    if (separator != std::string::npos) {
+        auto slot_stream = std::istringstream(policy.substr(separator + 1));
+        if (!(slot_stream >> slot) || !slot_stream.eof()) {
+            throw std::invalid_argument("Invalid match slot in CPU placement " +
+                                        policy);
+        }
+    }
+
+    if (preset_name == "siblings") {
+        return placeOnCpus(topology, PlacementPreset::SIBLING_HYPERTHREADS,
+                           slot, num_worker_cpus);
+    }
+    if (preset_name == "l3") {
+        return placeOnCpus(topology, PlacementPreset::SAME_L3, slot,
+                           num_worker_cpus);
+    }
+
+    // Otherwise, an explicit list of the three processes' CPUs, followed by
+    // the workers' CPUs
+    auto cpus = std::vector<int>(3 + num_worker_cpus);
+    auto invalid_policy =
+        std::invalid_argument("Invalid CPU placement " + policy +
+                              ", expected " + std::to_string(cpus.size()) +
+                              " CPUs");
+    auto cpu_stream = std::istringstream(policy);
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        auto is_separated = i == 0 || cpu_stream.get() == ',';
+        if (!is_separated || !(cpu_stream >> cpus[i])) {
+            throw invalid_policy;
+        }
+
+        auto is_allowed = std::any_of(
+            topology.begin(), topology.end(),
+            [&cpus, i](const CpuInfo &cpu_info) {
+                return cpu_info.cpu == cpus[i];
+            });
+        if (!is_allowed) {
+            throw std::invalid_argument("CPU " + std::to_string(cpus[i]) +
+                                        " is not available");
+        }
+    }
+    if (cpu_stream.peek() != EOF) {
+        throw invalid_policy;
+    }
+
+    return CpuPlacement{cpus[0],
+                        {cpus[1], cpus[2]},
+                        std::vector<int>(cpus.begin() + 3, cpus.end())};
+}
+
+/**
+ * Sets the affinity of a thread to a single CPU
+ *
+ * @return int 0 on success, an error number on failure
+ */
+static int setThreadAffinity(pid_t tid, int cpu) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    return sched_setaffinity(tid, sizeof(cpu_set), &cpu_set) == -1 ? errno
+                                                                   : 0;
+}
+
+void pinCurrentThread(int cpu) { pinCurrentThread(std::vector<int>{cpu}); }
+
+void pinCurrentThread(const std::vector<int> &cpus) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    auto cpu_names = std::string();
+    for (auto cpu : cpus) {
+        CPU_SET(cpu, &cpu_set);
+        cpu_names += (cpu_names.empty() ? "" : ",") + std::to_string(cpu);
+    }
+    auto error =
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (error != 0) {
+        throw std::runtime_error("Could not pin to CPU " + cpu_names + ": " +
+                                 std::strerror(error));
+    }
+}
+
+void pinProcess(int pid, int cpu) {
+    // Pin the main thread first, so that threads it starts from now on
+    // inherit the CPU, and then any threads that were started before
+    auto error = setThreadAffinity(pid, cpu);
+    if (error != 0) {
+        throw std::runtime_error("Could not pin process " +
+                                 std::to_string(pid) + " to CPU " +
+                                 std::to_string(cpu) + ": " +
+                                 std::strerror(error));
+    }
+
+    auto task_dir = opendir(("/proc/" + std::to_string(pid) + "/task").c_str());
+    if (task_dir == nullptr) {
+        return;
+    }
+
+    while (auto task = readdir(task_dir)) {
+        auto tid = std::atoi(task->d_name);
+        if (tid > 0 && tid != pid) {
+            // The thread may have exited in the meantime
+            setThreadAffinity(tid, cpu);
+        }
+    }
+    closedir(task_dir);
+}
+} // namespace drivers
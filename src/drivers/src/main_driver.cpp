@@ -5,6 +5,7 @@
 
 #include "drivers/main_driver.h"
 #include "drivers/game_result.h"
+#include "tracer/tracer.h"
 
 #include <csignal>
 #include <fstream>
@@ -18,23 +19,42 @@ MainDriver::MainDriver(
     int64_t player_instruction_limit_turn,
     int64_t player_instruction_limit_game, int64_t num_game_turns,
     Timer::Interval game_duration, std::unique_ptr<logger::ILogger> logger,
-    std::string log_file_name)
+    std::string log_file_name, std::string perf_log_file_name,
+    std::string digest_log_file_name, std::string command_log_file_name)
     : state_syncer(std::move(state_syncer)),
       shared_memories(std::move(shared_memories)),
       player_instruction_limit_turn(player_instruction_limit_turn),
       player_instruction_limit_game(player_instruction_limit_game),
       num_game_turns(num_game_turns), is_game_timed_out(false), game_timer(),
       game_duration(game_duration), logger(std::move(logger)),
-      log_file_name(std::move(log_file_name)), cancel_flag(false) {
+      log_file_name(std::move(log_file_name)),
+      perf_log_file_name(std::move(perf_log_file_name)),
+      digest_log_file_name(std::move(digest_log_file_name)),
+      command_log_file_name(std::move(command_log_file_name)),
+      cancel_flag(false) {
     for (auto &shared_memory : this->shared_memories) {
         // Get pointers to shared memory and store
         SharedBuffer *shared_buffer = shared_memory->getBuffer();
         shared_buffers.push_back(shared_buffer);
     }
 
-    // Store pointers to player state
-    this->transfer_states[0] = &shared_buffers[0]->transfer_state;
-    this->transfer_states[1] = &shared_buffers[1]->transfer_state;
+    // Store pointers to the copies of the commands the players issue, with
+    // room for as many as the limits allow
+    for (int player_id = 0; player_id < 2; ++player_id) {
+        auto &limits = this->shared_memories[player_id]
+                           ->getBufferOwner()
+                           .getLimits();
+        player_commands[player_id] =
+            state::CommandBufferStorage(limits.getMaxNumCommands());
+        command_buffers[player_id] = &*player_commands[player_id];
+    }
+}
+
+void MainDriver::publishTransferStates() {
+    for (int player_id = 0; player_id < 2; ++player_id) {
+        shared_memories[player_id]->getBufferOwner().publishTransferState(
+            player_states[player_id]);
+    }
 }
 
 void MainDriver::endGame(state::PlayerId player_id,
@@ -44,6 +64,24 @@ void MainDriver::endGame(state::PlayerId player_id,
     logger->logFinalGameParams(player_id, final_scores);
     logger->writeGame(log_file);
     this->game_timer.stop();
+
+    if (!perf_log_file_name.empty()) {
+        std::ofstream perf_log_file(perf_log_file_name, std::ios::out);
+        logger->writePerfCounts(perf_log_file);
+    }
+
+    if (!digest_log_file_name.empty()) {
+        std::ofstream digest_log_file(digest_log_file_name, std::ios::out);
+        logger->writeDigests(digest_log_file);
+    }
+
+    if (command_recorder) {
+        command_log_file.close();
+        command_recorder.reset();
+    }
+
+    // Write out the spans recorded by the main process
+    tracer::Tracer::flush();
 }
 
 std::array<PlayerResult, 2> MainDriver::getPlayerResults() {
@@ -64,23 +102,30 @@ void MainDriver::setPids(std::array<int, 2> pids) { this->process_pids = pids; }
 
 GameResult MainDriver::start() {
     // Initialize contents of shared memory
-    for (auto buffer : shared_buffers) {
+    for (int player_id = 0; player_id < 2; ++player_id) {
+        auto buffer = shared_buffers[player_id];
         buffer->is_player_running = false;
         buffer->turn_instruction_counter = 0;
+        buffer->turn_perf_counts = logger::PerfCounts{};
+        shared_memories[player_id]->getBufferOwner().clearCommandBuffers();
+        player_commands[player_id]->clear();
     }
 
     // Initialize player states with contents of main state
     this->state_syncer->updatePlayerStates(this->player_states);
 
     // Convert current player states to transfer states
-    for (int i = 0; i < 2; ++i) {
-        *(transfer_states[i]) =
-            transfer_state::ConvertToTransferState(player_states[i]);
-    }
+    publishTransferStates();
 
     // Create turn 0 state in log
     logger->logState();
 
+    if (!command_log_file_name.empty()) {
+        command_log_file.open(command_log_file_name,
+                              std::ios::out | std::ios::binary);
+        command_recorder = std::make_unique<CommandRecorder>(command_log_file);
+    }
+
     // Start a timer. Game is invalid if it does not complete within the timer
     // limit
     this->is_game_timed_out = false;
@@ -159,18 +204,26 @@ GameResult MainDriver::run() {
 
     // Main loop that runs every turn
     for (uint64_t i = 0; i < this->num_game_turns; ++i) {
+        tracer::ScopedSpan turn_span("turn", "main_driver");
         auto skip_player_turn = std::array<bool, 2>{false, false};
+        auto instruction_counts = std::array<uint64_t, 2>{0, 0};
 
         for (int cur_player_id = 0; cur_player_id < 2; ++cur_player_id) {
             auto current_player_buffer = this->shared_buffers[cur_player_id];
 
-            // Let player do their updates
-            current_player_buffer->is_player_running = true;
+            {
+                tracer::ScopedSpan handoff_span(
+                    cur_player_id == 0 ? "player_1_turn" : "player_2_turn",
+                    "shm");
 
-            // Wait for updates, the timer or cancellation
-            while (current_player_buffer->is_player_running &&
-                   !this->is_game_timed_out && !this->cancel_flag)
-                ;
+                // Let player do their updates
+                current_player_buffer->is_player_running = true;
+
+                // Wait for updates, the timer or cancellation
+                while (current_player_buffer->is_player_running &&
+                       !this->is_game_timed_out && !this->cancel_flag)
+                    ;
+            }
 
             // If game has been cancelled, return immediately
             if (this->cancel_flag) {
@@ -210,10 +263,17 @@ GameResult MainDriver::run() {
                 skip_player_turn[cur_player_id] = true;
             }
 
-            // Write the turn's instruction counts
+            // Copy out the commands the player published in its turn
+            shared_memories[cur_player_id]->getBufferOwner().copyCommands(
+                *player_commands[cur_player_id]);
+
+            // Write the turn's instruction counts and perf counters
+            instruction_counts[cur_player_id] =
+                current_player_buffer->turn_instruction_counter;
             logger->logInstructionCount(
                 static_cast<state::PlayerId>(cur_player_id),
-                current_player_buffer->turn_instruction_counter);
+                instruction_counts[cur_player_id],
+                current_player_buffer->turn_perf_counts);
         }
 
         // If the game instruction count has been exceeded by some
@@ -235,27 +295,31 @@ GameResult MainDriver::run() {
 
         // If we're here, the game is not yet over
 
+        if (command_recorder) {
+            command_recorder->recordTurn(command_buffers, instruction_counts,
+                                         skip_player_turn);
+        }
+
         // Validate and run the player's commands. Skips a player if
         // they have exceeded turn instruction limit
-
-        // Convert current transfer states into player states
-        for (int player_id = 0; player_id < 2; ++player_id) {
-            player_states[player_id] = transfer_state::ConvertToPlayerState(
-                *(this->transfer_states[player_id]));
+        {
+            tracer::ScopedSpan span("update_main_state", "main_driver");
+            this->state_syncer->updateMainState(
+                this->command_buffers, this->player_states, skip_player_turn);
         }
 
-        this->state_syncer->updateMainState(this->player_states,
-                                            skip_player_turn);
-
         // Write the updated main state back to the player's state
         // copies
-        this->state_syncer->updatePlayerStates(this->player_states);
+        {
+            tracer::ScopedSpan span("update_player_states", "main_driver");
+            this->state_syncer->updatePlayerStates(this->player_states);
+        }
 
         // Convert these player states back into transfer states
-        for (int player_id = 0; player_id < 2; ++player_id) {
-            *(transfer_states[player_id]) =
-                transfer_state::ConvertToTransferState(
-                    player_states[player_id]);
+        {
+            tracer::ScopedSpan span("convert_to_transfer_states",
+                                    "main_driver");
+            publishTransferStates();
         }
     }
 
@@ -272,12 +336,5 @@ GameResult MainDriver::run() {
     return GameResult{winner, win_type, player_results};
 }
 
-void MainDriver::cancel() {
-    this->cancel_flag = true;
-    auto wait_time = std::chrono::seconds(1);
-    auto end_time = std::chrono::system_clock::now() + wait_time;
-    while (std::chrono::system_clock::now() < end_time)
-        ;
-    this->cancel_flag = false;
-}
+void MainDriver::cancel() { this->cancel_flag = true; }
 } // namespace drivers
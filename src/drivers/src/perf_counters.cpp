@@ -0,0 +1,160 @@
+/**
+ * @file perf_counters.cpp
+ * Defines per thread perf_event_open counters
+ */
+
+#include "drivers/perf_counters.h"
+
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace drivers {
+
+namespace {
+
+/**
+ * Layout of a counter read with PERF_FORMAT_TOTAL_TIME_ENABLED and
+ * PERF_FORMAT_TOTAL_TIME_RUNNING
+ */
+struct CounterReading {
+    uint64_t value;
+    uint64_t time_enabled;
+    uint64_t time_running;
+};
+
+/**
+ * perf_event_open has no glibc wrapper
+ */
+int perfEventOpen(perf_event_attr *attr) {
+    return static_cast<int>(syscall(__NR_perf_event_open, attr, 0, -1, -1,
+                                    PERF_FLAG_FD_CLOEXEC));
+}
+} // namespace
+
+PerfCounters::PerfCounters() {
+    for (size_t i = 0; i < file_descriptors.size(); ++i) {
+        file_descriptors[i] = openCounter(static_cast<Event>(i));
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (auto file_descriptor : file_descriptors) {
+        if (file_descriptor != -1) {
+            close(file_descriptor);
+        }
+    }
+}
+
+int PerfCounters::openCounter(Event event) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (event) {
+    case Event::TASK_CLOCK:
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_TASK_CLOCK;
+        break;
+    case Event::CONTEXT_SWITCHES:
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+        break;
+    case Event::PAGE_FAULTS:
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+        break;
+    case Event::CYCLES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case Event::INSTRUCTIONS:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case Event::CACHE_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case Event::EVENT_COUNT:
+        return -1;
+    }
+
+    // Context switches and page faults are kernel side events, so count the
+    // kernel too if perf_event_paranoid allows it
+    auto file_descriptor = perfEventOpen(&attr);
+    if (file_descriptor == -1) {
+        attr.exclude_kernel = 1;
+        file_descriptor = perfEventOpen(&attr);
+    }
+
+    return file_descriptor;
+}
+
+uint64_t PerfCounters::readCounter(Event event) const {
+    auto file_descriptor = file_descriptors[static_cast<size_t>(event)];
+    if (file_descriptor == -1) {
+        return 0;
+    }
+
+    CounterReading reading{};
+    if (read(file_descriptor, &reading, sizeof(reading)) != sizeof(reading) ||
+        reading.time_running == 0) {
+        return 0;
+    }
+
+    // If the kernel multiplexed the counter, extrapolate to the time it was
+    // enabled for
+    if (reading.time_running < reading.time_enabled) {
+        return static_cast<uint64_t>(static_cast<double>(reading.value) *
+                                     reading.time_enabled /
+                                     reading.time_running);
+    }
+
+    return reading.value;
+}
+
+bool PerfCounters::isAvailable(Event event) const {
+    return file_descriptors[static_cast<size_t>(event)] != -1;
+}
+
+bool PerfCounters::isHardwareAvailable() const {
+    return isAvailable(Event::CYCLES) && isAvailable(Event::INSTRUCTIONS) &&
+           isAvailable(Event::CACHE_MISSES);
+}
+
+void PerfCounters::start() {
+    for (auto file_descriptor : file_descriptors) {
+        if (file_descriptor != -1) {
+            ioctl(file_descriptor, PERF_EVENT_IOC_RESET, 0);
+            ioctl(file_descriptor, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+logger::PerfCounts PerfCounters::stop() {
+    for (auto file_descriptor : file_descriptors) {
+        if (file_descriptor != -1) {
+            ioctl(file_descriptor, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    auto perf_counts = logger::PerfCounts{};
+    perf_counts.is_sampled = true;
+    perf_counts.is_hardware_sampled = isHardwareAvailable();
+    perf_counts.task_clock_ns = readCounter(Event::TASK_CLOCK);
+    perf_counts.context_switches = readCounter(Event::CONTEXT_SWITCHES);
+    perf_counts.page_faults = readCounter(Event::PAGE_FAULTS);
+    perf_counts.cycles = readCounter(Event::CYCLES);
+    perf_counts.instructions = readCounter(Event::INSTRUCTIONS);
+    perf_counts.cache_misses = readCounter(Event::CACHE_MISSES);
+
+    return perf_counts;
+}
+} // namespace drivers
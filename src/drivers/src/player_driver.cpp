@@ -4,6 +4,8 @@
  */
 
 #include "drivers/player_driver.h"
+#include "tracer/tracer.h"
+
 #include <fstream>
 #include <utility>
 
@@ -16,7 +18,8 @@ PlayerDriver::PlayerDriver(
     std::unique_ptr<drivers::SharedMemoryPlayer> shm_player,
     int64_t num_game_turns, Timer::Interval game_duration,
     std::string player_debug_log_file, std::string debug_logs_turn_prefix,
-    std::string debug_logs_truncate_message, int64_t max_debug_logs_turn_length)
+    std::string debug_logs_truncate_message, int64_t max_debug_logs_turn_length,
+    bool is_perf_counting_enabled)
     : player_code_wrapper(std::move(player_code_wrapper)),
       shm_player(std::move(shm_player)),
       shared_buffer(this->shm_player->getBuffer()),
@@ -25,7 +28,9 @@ PlayerDriver::PlayerDriver(
       player_debug_log_file(std::move(player_debug_log_file)),
       debug_logs_turn_prefix(std::move(debug_logs_turn_prefix)),
       debug_logs_truncate_message(std::move(debug_logs_truncate_message)),
-      max_debug_logs_turn_length(max_debug_logs_turn_length) {}
+      max_debug_logs_turn_length(max_debug_logs_turn_length),
+      is_perf_counting_enabled(is_perf_counting_enabled),
+      perf_counters(nullptr) {}
 
 void PlayerDriver::incrementCount(uint64_t count) {
     instruction_count += count;
@@ -39,6 +44,12 @@ void PlayerDriver::writeCountToShm() {
 }
 
 void PlayerDriver::start() {
+    // Counters are opened for the calling thread, which is the one that runs
+    // the player's code
+    if (this->is_perf_counting_enabled) {
+        this->perf_counters = std::make_unique<PerfCounters>();
+    }
+
     // Start a timer. Game is invalid if it does not complete within the timer
     // limit
     this->is_game_timed_out = false;
@@ -55,9 +66,12 @@ void PlayerDriver::run() {
 
         // Wait for the main driver to synchronize states or until the game has
         // timed out
-        while (!this->shared_buffer->is_player_running &&
-               !this->is_game_timed_out)
-            ;
+        {
+            tracer::ScopedSpan span("wait_for_turn", "shm");
+            while (!this->shared_buffer->is_player_running &&
+                   !this->is_game_timed_out)
+                ;
+        }
 
         // If overall game time limit has exceeded
         if (this->is_game_timed_out)
@@ -65,9 +79,20 @@ void PlayerDriver::run() {
 
         // Run player's code and get number of instructions they used and their
         // debug logs
+        tracer::ScopedSpan turn_span("player_turn", "player_driver");
         instruction_count = 0;
+        if (this->perf_counters) {
+            this->perf_counters->start();
+        }
+
         auto logs = this->player_code_wrapper->update(
-            this->shared_buffer->transfer_state);
+            this->shared_buffer->getTransferState(),
+            this->shared_buffer->getNextCommandBuffer());
+        this->shared_buffer->publishCommandBuffer();
+
+        if (this->perf_counters) {
+            this->shared_buffer->turn_perf_counts = this->perf_counters->stop();
+        }
 
         this->player_debug_logs << this->debug_logs_turn_prefix
                                 << logs.substr(0, max_debug_logs_turn_length);
@@ -83,6 +108,9 @@ void PlayerDriver::run() {
         this->shared_buffer->is_player_running = false;
     }
 
+    // Write out the spans recorded by the player process
+    tracer::Tracer::flush();
+
     // Open debug log file and store player's debug logs in it
     std::ofstream debug_log_file(this->player_debug_log_file);
     debug_log_file << this->player_debug_logs.str();
@@ -0,0 +1,228 @@
+/**
+ * @file player_zygote.cpp
+ * Definitions for a pre-spawned player process that forks match workers
+ */
+
+#include "drivers/player_pool/player_zygote.h"
+#include "drivers/player_pool/pool_protocol.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+extern char **environ;
+
+namespace drivers {
+
+using namespace pool_protocol;
+
+/**
+ * Puts a worker in the context of its match. The zygote's own settings are
+ * dropped, so that a setting the game does not give is unset, as it would be
+ * for a spawned player
+ *
+ * @return True if the worker is in the match's context, false otherwise
+ */
+static bool enterMatchContext(const MatchContext &context) {
+    auto names = std::vector<std::string>();
+    for (auto variable = environ; *variable != nullptr; ++variable) {
+        auto setting = std::string(*variable);
+        if (setting.compare(0, SETTING_PREFIX.size(), SETTING_PREFIX) == 0) {
+            names.push_back(setting.substr(0, setting.find('=')));
+        }
+    }
+    for (const auto &name : names) {
+        unsetenv(name.c_str());
+    }
+
+    for (const auto &setting : context.settings) {
+        auto separator = setting.find('=');
+        if (separator == std::string::npos ||
+            setting.compare(0, SETTING_PREFIX.size(), SETTING_PREFIX) != 0) {
+            continue;
+        }
+        setenv(setting.substr(0, separator).c_str(),
+               setting.substr(separator + 1).c_str(), 1);
+    }
+
+    if (chdir(context.working_directory.c_str()) == -1) {
+        std::cerr << "Could not enter match directory "
+                  << context.working_directory << ": " << std::strerror(errno)
+                  << '\n';
+        return false;
+    }
+    return true;
+}
+
+PlayerZygote::PlayerZygote(std::string socket_path,
+                           StartPlayerCallback start_player)
+    : socket_path(std::move(socket_path)),
+      start_player(std::move(start_player)), listen_fd(-1), signal_fd(-1),
+      worker_connections() {
+    auto fail = [this](const std::string &message) {
+        auto error = message + ": " + std::strerror(errno);
+        if (this->listen_fd != -1) {
+            close(this->listen_fd);
+        }
+        throw std::runtime_error(error);
+    };
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (this->socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path is too long: " +
+                                    this->socket_path);
+    }
+    std::strncpy(address.sun_path, this->socket_path.c_str(),
+                 sizeof(address.sun_path) - 1);
+
+    this->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (this->listen_fd == -1) {
+        fail("Could not create zygote socket");
+    }
+
+    // Replace the socket file left behind by a previous zygote
+    unlink(this->socket_path.c_str());
+    if (bind(this->listen_fd, reinterpret_cast<sockaddr *>(&address),
+             sizeof(address)) == -1 ||
+        listen(this->listen_fd, SOMAXCONN) == -1) {
+        fail("Could not listen on " + this->socket_path);
+    }
+
+    // Receive SIGCHLD through a file descriptor, so that the zygote can wait
+    // for new matches and for workers to exit at the same time
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &mask, nullptr);
+
+    this->signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (this->signal_fd == -1) {
+        fail("Could not create signalfd");
+    }
+}
+
+PlayerZygote::~PlayerZygote() {
+    for (auto &worker_connection : worker_connections) {
+        close(worker_connection.second);
+    }
+    close(signal_fd);
+    close(listen_fd);
+    unlink(socket_path.c_str());
+}
+
+void PlayerZygote::run() {
+    while (true) {
+        pollfd poll_fds[] = {{listen_fd, POLLIN, 0}, {signal_fd, POLLIN, 0}};
+
+        if (poll(poll_fds, 2, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("Zygote poll failed: ") +
+                                     std::strerror(errno));
+        }
+
+        // Reap first, so that a pid reused by a new worker is never confused
+        // with an exited one
+        if (poll_fds[1].revents & POLLIN) {
+            reapWorkers();
+        }
+
+        if (poll_fds[0].revents & POLLIN) {
+            acceptMatch();
+        }
+    }
+}
+
+void PlayerZygote::acceptMatch() {
+    auto connection_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (connection_fd == -1) {
+        return;
+    }
+
+    // Don't let a stalled client block the other matches
+    timeval receive_timeout{1, 0};
+    setsockopt(connection_fd, SOL_SOCKET, SO_RCVTIMEO, &receive_timeout,
+               sizeof(receive_timeout));
+
+    std::string shm_name;
+    MatchContext context;
+    if (!receiveString(connection_fd, shm_name, MAX_SHM_NAME_LENGTH) ||
+        shm_name.empty() || !receiveMatchContext(connection_fd, context)) {
+        close(connection_fd);
+        return;
+    }
+
+    // The zygote is single threaded, so forking it is safe
+    auto pid = fork();
+    if (pid == -1) {
+        // The game sees the connection close without a pid
+        close(connection_fd);
+        return;
+    }
+
+    if (pid == 0) {
+        // In the worker, drop everything that belongs to the zygote and play
+        // the match
+        close(listen_fd);
+        close(signal_fd);
+        close(connection_fd);
+        for (auto &worker_connection : worker_connections) {
+            close(worker_connection.second);
+        }
+
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigprocmask(SIG_SETMASK, &mask, nullptr);
+
+        if (!enterMatchContext(context)) {
+            std::exit(EXIT_FAILURE);
+        }
+        std::exit(start_player(shm_name));
+    }
+
+    // If the game has gone away, the worker is still reaped as usual
+    int32_t worker_pid = pid;
+    if (!sendAll(connection_fd, &worker_pid, sizeof(worker_pid))) {
+        kill(pid, SIGKILL);
+    }
+
+    worker_connections[pid] = connection_fd;
+}
+
+void PlayerZygote::reapWorkers() {
+    // Drain the signalfd. Signals coalesce, so the number read says nothing
+    // about how many workers exited
+    signalfd_siginfo signal_info;
+    while (read(signal_fd, &signal_info, sizeof(signal_info)) ==
+           sizeof(signal_info))
+        ;
+
+    int status = 0;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        auto worker_connection = worker_connections.find(pid);
+        if (worker_connection == worker_connections.end()) {
+            continue;
+        }
+
+        int32_t exit_code = WIFEXITED(status) ? WEXITSTATUS(status)
+                                              : 128 + WTERMSIG(status);
+        sendAll(worker_connection->second, &exit_code, sizeof(exit_code));
+
+        close(worker_connection->second);
+        worker_connections.erase(worker_connection);
+    }
+}
+} // namespace drivers
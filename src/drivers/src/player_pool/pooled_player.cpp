@@ -0,0 +1,124 @@
+/**
+ * @file pooled_player.cpp
+ * Definitions for a handle to a player worker forked by a zygote
+ */
+
+#include "drivers/player_pool/pooled_player.h"
+#include "drivers/player_pool/pool_protocol.h"
+
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace drivers {
+
+using namespace pool_protocol;
+
+/**
+ * Context of the match the game is running, its working directory and its
+ * settings
+ *
+ * @throw std::runtime_error If the working directory cannot be read
+ */
+static MatchContext getCurrentMatchContext() {
+    auto context = MatchContext{};
+
+    char working_directory[PATH_MAX];
+    if (getcwd(working_directory, sizeof(working_directory)) == nullptr) {
+        throw std::runtime_error(
+            std::string("Could not read the working directory: ") +
+            std::strerror(errno));
+    }
+    context.working_directory = working_directory;
+
+    for (auto variable = environ; *variable != nullptr; ++variable) {
+        auto setting = std::string(*variable);
+        if (setting.compare(0, SETTING_PREFIX.size(), SETTING_PREFIX) == 0) {
+            context.settings.push_back(setting);
+        }
+    }
+    return context;
+}
+
+PooledPlayer::PooledPlayer(const std::string &socket_path,
+                           const std::string &shm_name)
+    : socket_fd(-1), pid(0), exit_status(0), has_exited(false) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path is too long: " + socket_path);
+    }
+    auto context = getCurrentMatchContext();
+    std::strncpy(address.sun_path, socket_path.c_str(),
+                 sizeof(address.sun_path) - 1);
+
+    socket_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket_fd == -1) {
+        throw std::runtime_error(std::string("Could not create socket: ") +
+                                 std::strerror(errno));
+    }
+
+    if (connect(socket_fd, reinterpret_cast<sockaddr *>(&address),
+                sizeof(address)) == -1) {
+        auto error = "Could not connect to zygote at " + socket_path + ": " +
+                     std::strerror(errno);
+        close(socket_fd);
+        throw std::runtime_error(error);
+    }
+
+    int32_t worker_pid = 0;
+    if (!sendString(socket_fd, shm_name) ||
+        !sendMatchContext(socket_fd, context) ||
+        !receiveAll(socket_fd, &worker_pid, sizeof(worker_pid))) {
+        close(socket_fd);
+        throw std::runtime_error("Zygote at " + socket_path +
+                                 " did not start a worker");
+    }
+
+    pid = worker_pid;
+}
+
+PooledPlayer::PooledPlayer(PooledPlayer &&other) noexcept
+    : socket_fd(other.socket_fd), pid(other.pid),
+      exit_status(other.exit_status), has_exited(other.has_exited) {
+    other.socket_fd = -1;
+}
+
+PooledPlayer::~PooledPlayer() {
+    if (socket_fd == -1) {
+        return;
+    }
+
+    if (!has_exited) {
+        kill(pid, SIGKILL);
+    }
+    close(socket_fd);
+}
+
+int PooledPlayer::id() const { return pid; }
+
+int PooledPlayer::getExitFd() const { return socket_fd; }
+
+void PooledPlayer::wait() {
+    if (has_exited) {
+        return;
+    }
+
+    // If the zygote died before reporting, the worker's fate is unknown, so
+    // treat it as a failure
+    int32_t worker_exit_code = 0;
+    exit_status = receiveAll(socket_fd, &worker_exit_code,
+                             sizeof(worker_exit_code))
+                      ? worker_exit_code
+                      : -1;
+    has_exited = true;
+}
+
+int PooledPlayer::exit_code() const { return exit_status; }
+} // namespace drivers
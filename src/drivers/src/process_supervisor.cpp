@@ -0,0 +1,230 @@
+/**
+ * @file process_supervisor.cpp
+ * Definitions for a single threaded supervisor of player processes
+ */
+
+#include "drivers/process_supervisor.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <pthread.h>
+#include <stdexcept>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+
+namespace drivers {
+
+/**
+ * epoll data of the signalfd, which is not tied to a single process
+ */
+const uint64_t SIGNAL_FD_EVENT = UINT64_MAX;
+
+/**
+ * Opens a pidfd for a process
+ *
+ * @return int The pidfd, -1 with errno set on failure
+ */
+static int openPidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+    (void)pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+ProcessSupervisor::ProcessSupervisor()
+    : processes(), epoll_fd(epoll_create1(EPOLL_CLOEXEC)), signal_fd(-1),
+      previous_signal_mask() {
+    if (epoll_fd == -1) {
+        throw std::runtime_error(std::string("Could not create epoll: ") +
+                                 std::strerror(errno));
+    }
+}
+
+ProcessSupervisor::~ProcessSupervisor() {
+    for (auto &process : processes) {
+        if (process.pidfd != -1) {
+            close(process.pidfd);
+        }
+    }
+
+    if (signal_fd != -1) {
+        close(signal_fd);
+        pthread_sigmask(SIG_SETMASK, &previous_signal_mask, nullptr);
+    }
+    close(epoll_fd);
+}
+
+void ProcessSupervisor::openSignalFd() {
+    if (signal_fd != -1) {
+        return;
+    }
+
+    // SIGCHLD is ignored by default, so it has to be blocked to stay pending
+    // until it is read from the signalfd
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    pthread_sigmask(SIG_BLOCK, &mask, &previous_signal_mask);
+
+    signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = SIGNAL_FD_EVENT;
+    if (signal_fd == -1 ||
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, signal_fd, &event) == -1) {
+        auto error = std::string("Could not watch SIGCHLD: ") +
+                     std::strerror(errno);
+        if (signal_fd != -1) {
+            close(signal_fd);
+            signal_fd = -1;
+        }
+        pthread_sigmask(SIG_SETMASK, &previous_signal_mask, nullptr);
+        throw std::runtime_error(error);
+    }
+}
+
+bool ProcessSupervisor::reapChild(Process &process) {
+    int status = 0;
+    if (waitpid(process.pid, &status, WNOHANG) != process.pid) {
+        return false;
+    }
+
+    process.has_exited = true;
+    if (WIFSIGNALED(status)) {
+        process.exit_code = 128 + WTERMSIG(status);
+    } else {
+        process.exit_code = WEXITSTATUS(status);
+    }
+    return true;
+}
+
+size_t ProcessSupervisor::addChild(pid_t pid) {
+    auto process = Process{pid, openPidfd(pid), -1, nullptr, false, false, 0};
+
+    if (process.pidfd != -1) {
+        process.exit_fd = process.pidfd;
+    } else if (errno == ENOSYS) {
+        openSignalFd();
+
+        // The child may have exited before SIGCHLD was blocked
+        reapChild(process);
+        processes.push_back(std::move(process));
+        return processes.size() - 1;
+    } else {
+        throw std::runtime_error("Could not open pidfd for " +
+                                 std::to_string(pid) + ": " +
+                                 std::strerror(errno));
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = processes.size();
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, process.exit_fd, &event) == -1) {
+        auto error = std::string("Could not watch pidfd: ") +
+                     std::strerror(errno);
+        close(process.pidfd);
+        throw std::runtime_error(error);
+    }
+
+    processes.push_back(std::move(process));
+    return processes.size() - 1;
+}
+
+size_t ProcessSupervisor::addProcess(pid_t pid, int exit_fd,
+                                     ExitCodeReader read_exit_code) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = processes.size();
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, exit_fd, &event) == -1) {
+        throw std::runtime_error(std::string("Could not watch process: ") +
+                                 std::strerror(errno));
+    }
+
+    processes.push_back(
+        Process{pid, -1, exit_fd, std::move(read_exit_code), false, false, 0});
+    return processes.size() - 1;
+}
+
+void ProcessSupervisor::pollExits() {
+    epoll_event events[8];
+    auto num_events = epoll_wait(epoll_fd, events, 8, -1);
+    if (num_events == -1) {
+        if (errno == EINTR) {
+            return;
+        }
+        throw std::runtime_error(std::string("epoll_wait failed: ") +
+                                 std::strerror(errno));
+    }
+
+    for (int i = 0; i < num_events; ++i) {
+        if (events[i].data.u64 == SIGNAL_FD_EVENT) {
+            // Pending SIGCHLDs are merged, so drain the signalfd and reap
+            // every child that is watched through it
+            signalfd_siginfo info;
+            while (read(signal_fd, &info, sizeof(info)) == sizeof(info))
+                ;
+            for (auto &process : processes) {
+                if (process.exit_fd == -1 && !process.has_exited) {
+                    reapChild(process);
+                }
+            }
+            continue;
+        }
+
+        auto &process = processes[events[i].data.u64];
+        if (process.read_exit_code) {
+            process.exit_code = process.read_exit_code();
+            process.has_exited = true;
+        } else if (!reapChild(process)) {
+            continue;
+        }
+
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, process.exit_fd, nullptr);
+    }
+}
+
+ProcessExit ProcessSupervisor::waitForExit() {
+    while (true) {
+        auto has_pending_exits = false;
+        for (size_t i = 0; i < processes.size(); ++i) {
+            auto &process = processes[i];
+            if (process.has_exited && !process.is_reported) {
+                process.is_reported = true;
+                return ProcessExit{i, process.exit_code};
+            }
+            has_pending_exits = has_pending_exits || !process.has_exited;
+        }
+
+        if (!has_pending_exits) {
+            throw std::logic_error("All supervised processes have exited");
+        }
+
+        pollExits();
+    }
+}
+
+void ProcessSupervisor::terminate(size_t process_index) {
+    auto &process = processes.at(process_index);
+    if (process.has_exited) {
+        return;
+    }
+
+#ifdef SYS_pidfd_send_signal
+    // Signalling through the pidfd cannot hit a recycled process ID
+    if (process.pidfd != -1) {
+        syscall(SYS_pidfd_send_signal, process.pidfd, SIGTERM, nullptr, 0);
+        return;
+    }
+#endif
+    kill(process.pid, SIGTERM);
+}
+} // namespace drivers
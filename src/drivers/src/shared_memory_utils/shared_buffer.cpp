@@ -5,16 +5,128 @@
 
 #include "drivers/shared_memory_utils/shared_buffer.h"
 
-#include <utility>
+#include <new>
 
 namespace drivers {
 
-SharedBuffer::SharedBuffer(bool is_player_running,
+namespace {
+
+/**
+ * Blocks of the buffer start on a cache line of their own, so that the
+ * counters the player spins on do not share one with the state
+ */
+const size_t BLOCK_ALIGNMENT = 64;
+
+size_t alignSize(size_t size) {
+    return (size + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+}
+
+/**
+ * Advance a sequence that only the calling process writes, publishing the
+ * slot it wrote before
+ */
+void advance(std::atomic<uint64_t> &sequence) {
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_release);
+}
+} // namespace
+
+SharedBufferLayout::SharedBufferLayout(const state::GameLimits &limits)
+    : transfer_state_offsets(), command_buffer_offsets(), size(0) {
+    auto transfer_state_size =
+        alignSize(transfer_state::State::getSize(limits));
+    auto command_buffer_size = alignSize(
+        state::CommandBuffer::getSize(limits.getMaxNumCommands()));
+
+    size = alignSize(sizeof(SharedBuffer));
+    for (auto &offset : transfer_state_offsets) {
+        offset = size;
+        size += transfer_state_size;
+    }
+    for (auto &offset : command_buffer_offsets) {
+        offset = size;
+        size += command_buffer_size;
+    }
+}
+
+SharedBuffer::SharedBuffer(const state::GameLimits &limits,
+                           bool is_player_running,
                            int64_t turn_instruction_counter,
-                           int64_t game_instruction_counter,
-                           transfer_state::State transfer_state)
-    : is_player_running(is_player_running),
+                           int64_t game_instruction_counter)
+    : layout(limits), is_player_running(is_player_running),
       turn_instruction_counter(turn_instruction_counter),
-      game_instruction_counter(game_instruction_counter),
-      transfer_state(std::move(transfer_state)) {}
+      game_instruction_counter(game_instruction_counter), turn_perf_counts(),
+      state_sequence(0), command_sequence(0) {}
+
+size_t SharedBuffer::getSize(const state::GameLimits &limits) {
+    return SharedBufferLayout(limits).size;
+}
+
+const transfer_state::State &SharedBuffer::getTransferState() {
+    auto sequence = state_sequence.load(std::memory_order_acquire);
+    return *reinterpret_cast<const transfer_state::State *>(
+        reinterpret_cast<char *>(this) +
+        layout.transfer_state_offsets[sequence % 2]);
+}
+
+state::CommandBuffer &SharedBuffer::getNextCommandBuffer() {
+    auto sequence = command_sequence.load(std::memory_order_relaxed) + 1;
+    return *reinterpret_cast<state::CommandBuffer *>(
+        reinterpret_cast<char *>(this) +
+        layout.command_buffer_offsets[sequence % 2]);
+}
+
+void SharedBuffer::publishCommandBuffer() { advance(command_sequence); }
+
+SharedBufferOwner::SharedBufferOwner(void *memory,
+                                     const state::GameLimits &limits,
+                                     bool is_player_running,
+                                     int64_t turn_instruction_counter,
+                                     int64_t game_instruction_counter)
+    : buffer(new (memory) SharedBuffer(limits, is_player_running,
+                                       turn_instruction_counter,
+                                       game_instruction_counter)),
+      limits(limits), layout(limits), state_layout(limits) {
+    for (auto offset : layout.transfer_state_offsets) {
+        transfer_state::State::create(getBlock(offset), limits);
+    }
+    for (auto offset : layout.command_buffer_offsets) {
+        state::CommandBuffer::create(getBlock(offset),
+                                     limits.getMaxNumCommands());
+    }
+}
+
+char *SharedBufferOwner::getBlock(size_t offset) const {
+    return reinterpret_cast<char *>(buffer) + offset;
+}
+
+void SharedBufferOwner::publishTransferState(
+    const player_state::State &player_state) {
+    // Only the parity of the sequence picks the slot, so it is safe to read
+    // even if the player has written over it
+    auto sequence = buffer->state_sequence.load(std::memory_order_relaxed) + 1;
+    auto &transfer_state = *reinterpret_cast<transfer_state::State *>(
+        getBlock(layout.transfer_state_offsets[sequence % 2]));
+    transfer_state::ConvertToTransferState(player_state, transfer_state,
+                                           state_layout);
+    advance(buffer->state_sequence);
+}
+
+void SharedBufferOwner::copyCommands(state::CommandBuffer &commands) const {
+    auto sequence = buffer->command_sequence.load(std::memory_order_acquire);
+    auto &command_buffer = *reinterpret_cast<const state::CommandBuffer *>(
+        getBlock(layout.command_buffer_offsets[sequence % 2]));
+
+    commands.clear();
+    for (const auto &command :
+         command_buffer.getCommands(limits.getMaxNumCommands())) {
+        commands.push(command);
+    }
+}
+
+void SharedBufferOwner::clearCommandBuffers() {
+    for (auto offset : layout.command_buffer_offsets) {
+        reinterpret_cast<state::CommandBuffer *>(getBlock(offset))->clear();
+    }
+}
 } // namespace drivers
@@ -4,7 +4,6 @@
  */
 
 #include "drivers/shared_memory_utils/shared_memory_main.h"
-#include "constants/simulator.h"
 
 namespace drivers {
 
@@ -14,23 +13,32 @@ SharedMemoryMain::SharedMemoryMain(const std::string &shared_memory_name,
                                    bool is_player_running,
                                    uint64_t turn_instruction_counter,
                                    uint64_t game_instruction_counter,
-                                   const transfer_state::State &transfer_state)
+                                   const state::GameLimits &limits,
+                                   SharedMemoryPaging paging)
     : shared_memory_name(shared_memory_name),
       // Creating shared memory
-      shared_memory(create_only, shared_memory_name.c_str(),
-                    Constants::Simulator::SHARED_BUFFER_SIZE) {
-    // Constructing unique instance of SharedBuffer in shared memory
-    this->shared_memory.construct<SharedBuffer>(unique_instance)(
-        is_player_running, turn_instruction_counter, game_instruction_counter,
-        transfer_state);
+      shared_memory(create_only, shared_memory_name.c_str(), read_write) {
+    // Sizing it to fit the buffer, and mapping it whole with its pages backed
+    // as asked
+    shared_memory.truncate(
+        getSharedMemorySize(SharedBuffer::getSize(limits), paging));
+    this->paging = mapSharedMemory(shared_memory, paging, region);
+
+    // Constructing the SharedBuffer at the start of shared memory
+    buffer_owner = std::make_unique<SharedBufferOwner>(
+        region.get_address(), limits, is_player_running,
+        turn_instruction_counter, game_instruction_counter);
 }
 
 SharedBuffer *SharedMemoryMain::getBuffer() {
-    return this->shared_memory.find<SharedBuffer>(unique_instance).first;
+    return buffer_owner->getBuffer();
 }
 
+SharedBufferOwner &SharedMemoryMain::getBufferOwner() { return *buffer_owner; }
+
+SharedMemoryPaging SharedMemoryMain::getPaging() const { return paging; }
+
 SharedMemoryMain::~SharedMemoryMain() {
-    this->shared_memory.destroy<SharedBuffer>(unique_instance);
     shared_memory_object::remove(shared_memory_name.c_str());
 }
 } // namespace drivers
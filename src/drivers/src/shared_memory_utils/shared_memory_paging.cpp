@@ -0,0 +1,171 @@
+/**
+ * @file shared_memory_paging.cpp
+ * Definitions for how the pages of the shared memory are backed
+ */
+
+#include "drivers/shared_memory_utils/shared_memory_paging.h"
+
+#include <array>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace drivers {
+
+using namespace boost::interprocess;
+
+const auto PAGING_NAMES =
+    std::array<std::string, 4>{"default", "prefault", "locked", "huge"};
+
+const auto SHMEM_ENABLED_PATH =
+    std::string("/sys/kernel/mm/transparent_hugepage/shmem_enabled");
+const auto HUGE_PAGE_SIZE_PATH =
+    std::string("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+
+// Mount that named shared memory objects are created in
+const auto SHARED_MEMORY_MOUNT = std::string("/dev/shm");
+
+/**
+ * Reads the selected option of a sysfs setting, such as "never" from
+ * "always [never] deny"
+ *
+ * @param file_name
+ * @return std::string Option, or empty if the setting cannot be read
+ */
+static std::string readSelectedOption(const std::string &file_name) {
+    std::ifstream setting(file_name);
+    std::string option;
+    while (setting >> option) {
+        if (option.size() > 2 && option.front() == '[' &&
+            option.back() == ']') {
+            return option.substr(1, option.size() - 2);
+        }
+    }
+    return "";
+}
+
+/**
+ * Reads the huge= option the shared memory mount was made with. Later mounts
+ * on the same directory hide earlier ones, so the last one is used
+ *
+ * @return std::string Option, or "never", the default, if it is not given
+ */
+static std::string readMountHugeOption() {
+    std::ifstream mounts("/proc/mounts");
+    auto huge_option = std::string("never");
+    std::string line;
+    while (std::getline(mounts, line)) {
+        std::istringstream mount(line);
+        std::string device, directory, type, options;
+        if (!(mount >> device >> directory >> type >> options) ||
+            directory != SHARED_MEMORY_MOUNT) {
+            continue;
+        }
+
+        huge_option = "never";
+        std::istringstream options_stream(options);
+        std::string option;
+        while (std::getline(options_stream, option, ',')) {
+            if (option.compare(0, 5, "huge=") == 0) {
+                huge_option = option.substr(5);
+            }
+        }
+    }
+    return huge_option;
+}
+
+/**
+ * Touches every page of a region, faulting in the pages not yet mapped
+ */
+static void touchPages(const mapped_region &region) {
+    auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    auto pages = static_cast<volatile const char *>(region.get_address());
+    for (size_t offset = 0; offset < region.get_size(); offset += page_size) {
+        pages[offset];
+    }
+}
+
+SharedMemoryPaging parseSharedMemoryPaging(const std::string &name) {
+    for (size_t index = 0; index < PAGING_NAMES.size(); ++index) {
+        if (name == PAGING_NAMES[index]) {
+            return static_cast<SharedMemoryPaging>(index);
+        }
+    }
+    throw std::invalid_argument("Unknown shared memory paging " + name);
+}
+
+std::string getSharedMemoryPagingName(SharedMemoryPaging paging) {
+    return PAGING_NAMES[static_cast<size_t>(paging)];
+}
+
+size_t getSharedMemoryHugePageSize() {
+    // Huge pages can be denied, or forced, for all shared memory. Otherwise
+    // the mount decides, and only "never" keeps them out of a region that has
+    // been advised to use them
+    auto shmem_enabled = readSelectedOption(SHMEM_ENABLED_PATH);
+    if (shmem_enabled.empty() || shmem_enabled == "deny") {
+        return 0;
+    }
+    if (shmem_enabled != "force" && readMountHugeOption() == "never") {
+        return 0;
+    }
+
+    std::ifstream huge_page_size_file(HUGE_PAGE_SIZE_PATH);
+    size_t huge_page_size = 0;
+    huge_page_size_file >> huge_page_size;
+    return huge_page_size;
+}
+
+size_t getSharedMemorySize(size_t size, SharedMemoryPaging paging) {
+    if (paging != SharedMemoryPaging::HUGE_PAGES) {
+        return size;
+    }
+
+    auto huge_page_size = getSharedMemoryHugePageSize();
+    if (huge_page_size == 0) {
+        return size;
+    }
+    return (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+}
+
+SharedMemoryPaging mapSharedMemory(const shared_memory_object &shared_memory,
+                                   SharedMemoryPaging paging,
+                                   mapped_region &region) {
+    if (paging == SharedMemoryPaging::DEFAULT) {
+        region = mapped_region(shared_memory, read_write);
+        return paging;
+    }
+
+    if (paging == SharedMemoryPaging::HUGE_PAGES &&
+        getSharedMemoryHugePageSize() == 0) {
+        paging = SharedMemoryPaging::LOCKED;
+    }
+
+    // Huge pages are only allocated as pages are faulted in, so a region
+    // backed by them is advised before it is prefaulted
+    auto is_prefaulted = paging != SharedMemoryPaging::HUGE_PAGES;
+    region = mapped_region(shared_memory, read_write, 0, 0, nullptr,
+                           is_prefaulted ? MAP_POPULATE : default_map_options);
+    auto address = region.get_address();
+    auto size = region.get_size();
+
+    if (paging == SharedMemoryPaging::HUGE_PAGES &&
+        ::madvise(address, size, MADV_HUGEPAGE) != 0) {
+        paging = SharedMemoryPaging::LOCKED;
+    }
+
+    // Locking the pages faults them in as well. If they cannot be locked,
+    // they are faulted in by hand
+    if (paging >= SharedMemoryPaging::LOCKED && ::mlock(address, size) != 0) {
+        paging = SharedMemoryPaging::PREFAULTED;
+        if (!is_prefaulted) {
+            touchPages(region);
+        }
+    }
+
+    return paging;
+}
+
+} // namespace drivers
@@ -4,16 +4,27 @@
  */
 
 #include "drivers/shared_memory_utils/shared_memory_player.h"
-#include <cstring>
+
+#include <stdexcept>
 
 namespace drivers {
 
 using namespace boost::interprocess;
 
-SharedMemoryPlayer::SharedMemoryPlayer(const std::string &shared_memory_name)
-    : shared_memory(open_only, shared_memory_name.c_str()) {}
+SharedMemoryPlayer::SharedMemoryPlayer(const std::string &shared_memory_name,
+                                       SharedMemoryPaging paging)
+    : shared_memory(open_only, shared_memory_name.c_str(), read_write),
+      paging(mapSharedMemory(shared_memory, paging, region)) {
+    if (region.get_size() < sizeof(SharedBuffer) ||
+        getBuffer()->getSize() > region.get_size()) {
+        throw std::runtime_error("Shared memory " + shared_memory_name +
+                                 " is too small for its buffer");
+    }
+}
 
 SharedBuffer *SharedMemoryPlayer::getBuffer() {
-    return this->shared_memory.find<SharedBuffer>(unique_instance).first;
+    return static_cast<SharedBuffer *>(this->region.get_address());
 }
+
+SharedMemoryPaging SharedMemoryPlayer::getPaging() const { return paging; }
 } // namespace drivers
@@ -23,11 +23,13 @@
 #include "state/state_syncer.h"
 #include "state/utilities.h"
 
+#include <array>
 #include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <random>
+#include <string>
 
 /**
  * Class representing the entire game. Controls the main thread and player
@@ -40,8 +42,38 @@ class GAME_EXPORT Game {
      */
     std::unique_ptr<drivers::MainDriver> main_driver;
 
+    /**
+     * Names of the players' shared memories, sent to pooled players
+     */
+    std::array<std::string, 2> shm_names;
+
+    /**
+     * CPUs to pin the player processes to, -1 to leave a player unpinned
+     */
+    std::array<int, 2> player_cpus;
+
+    /**
+     * Runs the main driver while supervising the player processes. If a
+     * player fails, the other is terminated and the game is cancelled
+     *
+     * @tparam PlayerProcess boost::process::child or drivers::PooledPlayer
+     * @param player_processes The two running player processes
+     * @return GameResult object with winner, win type, and player results
+     */
+    template <typename PlayerProcess>
+    drivers::GameResult
+    superviseGame(std::vector<PlayerProcess> &player_processes);
+
   public:
-    explicit Game(std::unique_ptr<drivers::MainDriver> main_driver);
+    /**
+     * Constructor
+     *
+     * @param main_driver Main driver instance
+     * @param shm_names Names of the players' shared memories. Spawned players
+     *                  read them from SHM_FILE_NAMES instead
+     */
+    Game(std::unique_ptr<drivers::MainDriver> main_driver,
+         std::array<std::string, 2> shm_names);
 
     /**
      * Static helper method to generate a random string
@@ -55,7 +87,17 @@ class GAME_EXPORT Game {
     /**
      * Creates and starts the main driver
      *
+     * Players are taken from the zygotes in the player pool directory if one
+     * is set, falling back to spawning player processes
+     *
      * @return GameResult object with winner, win type, and player results
      */
     drivers::GameResult start();
+
+    /**
+     * Pin the player processes to CPUs once they are launched
+     *
+     * @param player_cpus CPU of each player, -1 to leave a player unpinned
+     */
+    void setPlayerCpus(std::array<int, 2> player_cpus);
 };
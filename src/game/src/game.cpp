@@ -5,12 +5,25 @@
 
 #include "game/game.h"
 #include "boost/process.hpp"
+#include "drivers/cpu_placement.h"
 #include "drivers/game_result.h"
+#include "drivers/player_pool/pooled_player.h"
+#include "drivers/process_supervisor.h"
+#include "tracer/tracer.h"
+
+#include <cstdlib>
+#include <thread>
 
 namespace bp = boost::process;
 
-Game::Game(std::unique_ptr<drivers::MainDriver> main_driver)
-    : main_driver(std::move(main_driver)) {}
+Game::Game(std::unique_ptr<drivers::MainDriver> main_driver,
+           std::array<std::string, 2> shm_names)
+    : main_driver(std::move(main_driver)), shm_names(std::move(shm_names)),
+      player_cpus({-1, -1}) {}
+
+void Game::setPlayerCpus(std::array<int, 2> player_cpus) {
+    this->player_cpus = player_cpus;
+}
 
 std::string Game::generateRandomString(const std::string::size_type length) {
     using namespace std;
@@ -31,6 +44,34 @@ std::string Game::generateRandomString(const std::string::size_type length) {
 }
 
 drivers::GameResult Game::start() {
+    using namespace Constants::Simulator;
+
+    // Take warm players from the pool, if there is one
+    auto player_pool_dir = std::getenv(PLAYER_POOL_DIR_ENV_VAR);
+    if (player_pool_dir != nullptr) {
+        try {
+            std::vector<drivers::PooledPlayer> pooled_players;
+            pooled_players.reserve(2);
+
+            for (int i = 0; i < 2; ++i) {
+                pooled_players.emplace_back(std::string(player_pool_dir) + "/" +
+                                                PLAYER_POOL_SOCKET_NAMES[i],
+                                            shm_names[i]);
+            }
+
+            // Pooled players got their SHM names over the socket
+            for (const auto &shm_file_name : SHM_FILE_NAMES) {
+                std::remove(shm_file_name.c_str());
+            }
+
+            return superviseGame(pooled_players);
+        } catch (const std::runtime_error &error) {
+            // Any worker that did start is killed when its handle goes away
+            std::cerr << "Player pool unavailable, spawning players: "
+                      << error.what() << '\n';
+        }
+    }
+
     // Launching player child processes
     std::vector<bp::child> player_processes;
     std::vector<std::error_code> player_process_errors(2);
@@ -41,6 +82,52 @@ drivers::GameResult Game::start() {
                                       player_process_errors[i]);
     }
 
+    return superviseGame(player_processes);
+}
+
+/**
+ * Adds a spawned player to the supervisor
+ */
+static size_t superviseProcess(drivers::ProcessSupervisor &supervisor,
+                               bp::child &player_process) {
+    return supervisor.addChild(player_process.id());
+}
+
+/**
+ * Adds a pooled player to the supervisor. Its zygote reports its exit
+ */
+static size_t superviseProcess(drivers::ProcessSupervisor &supervisor,
+                               drivers::PooledPlayer &player_process) {
+    return supervisor.addProcess(
+        player_process.id(), player_process.getExitFd(), [&player_process] {
+            player_process.wait();
+            return player_process.exit_code();
+        });
+}
+
+template <typename PlayerProcess>
+drivers::GameResult
+Game::superviseGame(std::vector<PlayerProcess> &player_processes) {
+    // Watch the players before starting the main driver's thread, which must
+    // inherit the signal mask if the supervisor falls back to SIGCHLD
+    drivers::ProcessSupervisor supervisor;
+    for (auto &player_process : player_processes) {
+        superviseProcess(supervisor, player_process);
+    }
+
+    // Pin the players before they take their first turn
+    for (int player_id = 0; player_id < 2; ++player_id) {
+        if (player_cpus[player_id] < 0) {
+            continue;
+        }
+        try {
+            drivers::pinProcess(player_processes[player_id].id(),
+                                player_cpus[player_id]);
+        } catch (const std::runtime_error &error) {
+            std::cerr << "Warning! " << error.what() << '\n';
+        }
+    }
+
     main_driver->setPids(
         std::array<int, 2>{player_processes[0].id(), player_processes[1].id()});
 
@@ -49,72 +136,51 @@ drivers::GameResult Game::start() {
     std::thread main_runner(
         [this, &result] { result = this->main_driver->start(); });
 
-    // Monitor child processes
-    // If one fails, terminate the rest
-
-    std::vector<std::atomic_bool> players_failed(2);
-    std::atomic_bool any_player_failed(false);
-    std::vector<std::thread> player_monitors;
-
-    // For each player...
-    for (int player_id = 0; player_id < 2; ++player_id) {
-
-        // Get both processes, including the opponents'
-        auto &process = player_processes[player_id];
-        auto &other_process = player_processes[1 - player_id];
-
-        players_failed[player_id] = false;
-        auto &player_failed = players_failed[player_id];
-
-        // Start the player_monitors
-        player_monitors.emplace_back(
-            [&process, &other_process, &player_failed, &any_player_failed] {
-                // Wait for the player processes to exit
-                process.wait();
-
-                // If the process did not exit gracefully, suspend the game and
-                // kill the other player process
-                if (process.exit_code() != 0 && !any_player_failed) {
-                    player_failed = true;
-                    any_player_failed = true;
-                    kill(other_process.id(), SIGTERM);
-                }
-            });
+    // Wait for both players to exit. If one fails, terminate the other and
+    // stop the main driver right away
+    auto players_failed = std::array<bool, 2>{false, false};
+    auto any_player_failed = false;
+
+    for (int num_exited = 0; num_exited < 2; ++num_exited) {
+        auto player_exit = supervisor.waitForExit();
+        if (player_exit.exit_code != 0 && !any_player_failed) {
+            players_failed[player_exit.process_index] = true;
+            any_player_failed = true;
+            supervisor.terminate(1 - player_exit.process_index);
+            main_driver->cancel();
+        }
     }
 
-    for (auto &monitor : player_monitors) {
-        monitor.join();
-    }
+    main_runner.join();
 
-    // If any child process failed, stop the main_driver
-    // Otherwise, simply wait for the main_driver to wrap up
-    if (any_player_failed) {
-        main_driver->cancel();
-        main_runner.join();
-        if (result.win_type != drivers::GameResult::WinType::TIMEOUT) {
-            for (int player_id = 0; player_id < 2; ++player_id) {
-                if (players_failed[player_id]) {
-                    result.player_results[player_id].status =
-                        drivers::PlayerResult::Status::RUNTIME_ERROR;
-                    result.win_type =
-                        drivers::GameResult::WinType::RUNTIME_ERROR;
-                }
+    // If any child process failed, the main driver was cancelled
+    if (any_player_failed &&
+        result.win_type != drivers::GameResult::WinType::TIMEOUT) {
+        for (int player_id = 0; player_id < 2; ++player_id) {
+            if (players_failed[player_id]) {
+                result.player_results[player_id].status =
+                    drivers::PlayerResult::Status::RUNTIME_ERROR;
+                result.win_type = drivers::GameResult::WinType::RUNTIME_ERROR;
             }
+        }
 
-            // Assign winner
-            if (players_failed[0] && players_failed[1]) {
-                // This case is currently impossible. Driver quits on Player1
-                // Error
-                result.winner = drivers::GameResult::Winner::TIE;
-            } else if (players_failed[0]) {
-                result.winner = drivers::GameResult::Winner::PLAYER2;
-            } else if (players_failed[1]) {
-                result.winner = drivers::GameResult::Winner::PLAYER1;
-            }
+        // Assign winner
+        if (players_failed[0] && players_failed[1]) {
+            // This case is currently impossible. Driver quits on Player1
+            // Error
+            result.winner = drivers::GameResult::Winner::TIE;
+        } else if (players_failed[0]) {
+            result.winner = drivers::GameResult::Winner::PLAYER2;
+        } else if (players_failed[1]) {
+            result.winner = drivers::GameResult::Winner::PLAYER1;
         }
-    } else {
-        main_runner.join();
     }
 
+    // Both players have flushed their traces by now. Flush again in case the
+    // main driver returned without ending the game, and merge the traces of
+    // all processes into one timeline
+    tracer::Tracer::flush();
+    tracer::Tracer::mergeProcessTraces({"main", "player_1", "player_2"});
+
     return result;
 }
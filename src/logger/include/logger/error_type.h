@@ -70,6 +70,11 @@ enum class ErrorType {
      * Exceding instruction count per turn
      */
     EXCEED_TURN_INSTRUCTION_COUNT,
+
+    /**
+     * Giving a command of an unknown type, or rejected with an unknown error
+     */
+    INVALID_COMMAND,
 };
 
 const std::vector<std::string> ErrorTypeName = {
@@ -78,5 +83,6 @@ const std::vector<std::string> ErrorTypeName = {
     "INVALID_TRANSFORM_POSITION", "NO_ALTER_TOWER_PROPERTY",
     "NO_ALTER_BOT_PROPERTY",      "TOWER_LIMIT_REACHED",
     "NUMBER_OF_BOTS_MISMATCH",    "NUMBER_OF_TOWERS_MISMATCH",
-    "NO_EARLY_BLAST_TOWER",       "EXCEED_TURN_INSTRUCTION_COUNT"};
+    "NO_EARLY_BLAST_TOWER",       "EXCEED_TURN_INSTRUCTION_COUNT",
+    "INVALID_COMMAND"};
 } // namespace logger
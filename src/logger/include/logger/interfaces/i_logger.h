@@ -7,6 +7,7 @@
 
 #include "logger/error_type.h"
 #include "logger/logger_export.h"
+#include "logger/perf_counts.h"
 #include "state/interfaces/i_command_taker.h"
 #include <array>
 #include <ostream>
@@ -25,11 +26,13 @@ class LOGGER_EXPORT ILogger {
      * Takes a player and corresponding instruction count, and logs it in the
      * current turn's game frame
      *
-     * @param[in]   player_id   Player identifier
-     * @param[in]   count       Instruction count
+     * @param[in]   player_id     Player identifier
+     * @param[in]   count         Instruction count
+     * @param[in]   perf_counts   Perf counters sampled around the player's
+     *                            update, if the player sampled them
      */
-    virtual void logInstructionCount(state::PlayerId player_id,
-                                     size_t count) = 0;
+    virtual void logInstructionCount(state::PlayerId player_id, size_t count,
+                                     const PerfCounts &perf_counts) = 0;
 
     /**
      * Takes a player and the error, and logs it into the state. Every distinct
@@ -53,5 +56,18 @@ class LOGGER_EXPORT ILogger {
      * Writes the complete serialized logs to stream
      */
     virtual void writeGame(std::ostream &write_stream) = 0;
+
+    /**
+     * Writes the perf counters of every turn the players sampled them in, as
+     * CSV with one row per player per turn
+     */
+    virtual void writePerfCounts(std::ostream &write_stream) = 0;
+
+    /**
+     * Writes the digest of the state logged in every turn, as CSV with one
+     * row per turn. Two runs of a match went the same way if and only if
+     * their digests match
+     */
+    virtual void writeDigests(std::ostream &write_stream) = 0;
 };
 } // namespace logger
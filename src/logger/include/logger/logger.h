@@ -36,6 +36,25 @@ class LOGGER_EXPORT Logger : public ILogger {
      */
     std::vector<size_t> instruction_counts;
 
+    /**
+     * Stores the perf counts of the current turn until they are appended to
+     * turn_perf_counts along with the remaining state data, every turn
+     */
+    std::array<PerfCounts, 2> perf_counts;
+
+    /**
+     * Perf counts of each turn, indexed by turn number. The game log format
+     * has no field for these, so they are written out separately by
+     * writePerfCounts
+     */
+    std::vector<std::array<PerfCounts, 2>> turn_perf_counts;
+
+    /**
+     * Digest of the state logged in each turn, indexed by turn number.
+     * Written out separately by writeDigests, like the perf counts
+     */
+    std::vector<state::StateDigest> turn_digests;
+
     /**
      * Protobuf object holding complete game logs
      */
@@ -92,7 +111,8 @@ class LOGGER_EXPORT Logger : public ILogger {
     /**
      * @see ILogger#logInstructionCount
      */
-    void logInstructionCount(state::PlayerId player_id, size_t count) override;
+    void logInstructionCount(state::PlayerId player_id, size_t count,
+                             const PerfCounts &perf_counts) override;
 
     /**
      * @see ILogger#logError
@@ -111,6 +131,16 @@ class LOGGER_EXPORT Logger : public ILogger {
      * Defaults to std::cout when no stream passed
      */
     void writeGame(std::ostream &write_stream = std::cout) override;
+
+    /**
+     * @see ILogger#writePerfCounts
+     */
+    void writePerfCounts(std::ostream &write_stream) override;
+
+    /**
+     * @see ILogger#writeDigests
+     */
+    void writeDigests(std::ostream &write_stream) override;
 };
 
 } // namespace logger
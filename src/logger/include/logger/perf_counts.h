@@ -0,0 +1,61 @@
+/**
+ * @file perf_counts.h
+ * Declares the perf counter values sampled around a player's turn
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace logger {
+
+/**
+ * Values of the perf counters sampled around a single player update
+ *
+ * This is trivially copyable, since it is written into shared memory by the
+ * player process and read by the main process
+ */
+struct PerfCounts {
+    /**
+     * True if the player sampled perf counters this turn, false otherwise
+     */
+    bool is_sampled = false;
+
+    /**
+     * True if the hardware counters (cycles, instructions, cache misses) are
+     * valid. The kernel may not permit them, in which case they are zero
+     */
+    bool is_hardware_sampled = false;
+
+    /**
+     * CPU time spent by the player's thread, in nanoseconds
+     */
+    uint64_t task_clock_ns = 0;
+
+    /**
+     * Number of times the player's thread was switched out
+     */
+    uint64_t context_switches = 0;
+
+    /**
+     * Number of page faults, major and minor
+     */
+    uint64_t page_faults = 0;
+
+    /**
+     * Number of CPU cycles
+     */
+    uint64_t cycles = 0;
+
+    /**
+     * Number of retired machine instructions, including library calls that
+     * the LLVM pass does not count
+     */
+    uint64_t instructions = 0;
+
+    /**
+     * Number of last level cache misses
+     */
+    uint64_t cache_misses = 0;
+};
+} // namespace logger
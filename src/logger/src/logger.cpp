@@ -21,6 +21,7 @@ Logger::Logger(ICommandTaker *state, size_t player_instruction_limit_turn,
                size_t tower_max_hp)
     : state(state), turn_count(0), instruction_counts(std::vector<size_t>(
                                        (int) state::PlayerId::PLAYER_COUNT, 0)),
+      perf_counts(), turn_perf_counts(), turn_digests(),
       logs(std::make_unique<proto::Game>()),
       error_map(std::unordered_map<std::string, size_t>()),
       current_error_code(0), errors(std::array<std::vector<size_t>, 2>()),
@@ -100,8 +101,6 @@ void Logger::logState() {
     turn_count++;
     auto *game_state = logs->add_states();
 
-    auto bots = state->getBots();
-    auto towers = state->getTowers();
     auto scores = state->getScores();
 
     // Things logged only in first turn
@@ -129,8 +128,8 @@ void Logger::logState() {
     }
 
     // Log player bots
-    for (auto const &player_bots : bots) {
-        for (auto const &bot : player_bots) {
+    for (auto player_id : {PlayerId::PLAYER1, PlayerId::PLAYER2}) {
+        for (auto *bot : state->getBots(player_id)) {
             proto::Bot *t_bot = game_state->add_bots();
 
             t_bot->set_id(bot->getActorId());
@@ -161,8 +160,8 @@ void Logger::logState() {
     }
 
     // Log player towers
-    for (auto const &player_towers : towers) {
-        for (auto const &tower : player_towers) {
+    for (auto player_id : {PlayerId::PLAYER1, PlayerId::PLAYER2}) {
+        for (auto *tower : state->getTowers(player_id)) {
             proto::Tower *t_tower = game_state->add_towers();
 
             t_tower->set_id(tower->getActorId());
@@ -188,6 +187,12 @@ void Logger::logState() {
         inst_count = 0;
     }
 
+    // Store perf counts and reset them
+    turn_perf_counts.push_back(perf_counts);
+    perf_counts.fill(PerfCounts{});
+
+    turn_digests.push_back(state->getDigest());
+
     // Log the errors, clear the error vectors
     for (auto &player_errors : errors) {
         auto player_error_struct = game_state->add_player_errors();
@@ -198,8 +203,10 @@ void Logger::logState() {
     }
 };
 
-void Logger::logInstructionCount(state::PlayerId player_id, size_t count) {
+void Logger::logInstructionCount(state::PlayerId player_id, size_t count,
+                                 const PerfCounts &perf_counts) {
     this->instruction_counts[(int) player_id] = count;
+    this->perf_counts[(int) player_id] = perf_counts;
 };
 
 void Logger::logError(state::PlayerId player_id, ErrorType error_type,
@@ -253,4 +260,41 @@ void Logger::writeGame(std::ostream &write_stream) {
     logs->SerializeToOstream(&write_stream);
 };
 
+void Logger::writePerfCounts(std::ostream &write_stream) {
+    write_stream << "turn,player_id,task_clock_ns,context_switches,page_faults,"
+                    "cycles,instructions,cache_misses\n";
+
+    for (size_t turn = 0; turn < turn_perf_counts.size(); ++turn) {
+        for (size_t player_id = 0; player_id < 2; ++player_id) {
+            const auto &counts = turn_perf_counts[turn][player_id];
+            if (!counts.is_sampled) {
+                continue;
+            }
+
+            write_stream << turn << ',' << player_id << ','
+                         << counts.task_clock_ns << ','
+                         << counts.context_switches << ','
+                         << counts.page_faults << ',';
+
+            // Leave the hardware counts empty when the kernel did not permit
+            // them, so that they are not mistaken for zeroes
+            if (counts.is_hardware_sampled) {
+                write_stream << counts.cycles << ',' << counts.instructions
+                             << ',' << counts.cache_misses;
+            } else {
+                write_stream << ",,";
+            }
+
+            write_stream << '\n';
+        }
+    }
+};
+
+void Logger::writeDigests(std::ostream &write_stream) {
+    write_stream << "turn,digest\n";
+    for (size_t turn = 0; turn < turn_digests.size(); ++turn) {
+        write_stream << turn << ',' << turn_digests[turn].toString() << '\n';
+    }
+};
+
 } // namespace logger
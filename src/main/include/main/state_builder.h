@@ -0,0 +1,65 @@
+/**
+ * @file state_builder.h
+ * Declarations for building the initial state of a game, shared by the main
+ * process and replay
+ */
+
+#pragma once
+
+#include "state/game_limits.h"
+#include "state/map/map.h"
+#include "state/state.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// The map file contains the terrain layout for initializing the game map
+const auto MAP_FILE_NAME = "map.txt";
+
+/**
+ * Reads the contents of a map file
+ *
+ * @param map_file_name
+ * @return std::string
+ */
+std::string readMapText(const std::string &map_file_name);
+
+/**
+ * Reads the size of the map and the caps on the number of actors from the
+ * header of a map file. The header is made of the lines at the start of the
+ * file that begin with '#', each holding pairs of a limit and its value, like
+ *
+ *     # map_size 200 max_num_bots 2000 max_num_towers 500
+ *
+ * Limits left out are the constants. Exits if the header is malformed
+ *
+ * @param map_text
+ * @return state::GameLimits
+ */
+state::GameLimits readGameLimits(const std::string &map_text);
+
+/**
+ * Builds the map from the contents of a map file, skipping its header. Exits
+ * if it is malformed or not of the map size in the header
+ *
+ * @param map_text
+ * @return std::unique_ptr<state::Map>
+ */
+std::unique_ptr<state::Map> buildMap(const std::string &map_text);
+
+/**
+ * Builds the state a game starts with, from a map file and the limits in its
+ * header. If MAP_CACHE_ENV_VAR names a directory holding a compiled map of the
+ * map file, the map and its waypoint graph are loaded from that instead. Paths
+ * are found by the path finder named by PATH_PLANNER_ENV_VAR, with the
+ * heuristic named by PATH_HEURISTIC_ENV_VAR. Exits if the map file is
+ * malformed or either name unknown
+ *
+ * @param num_update_threads Number of threads that plan the moves of bots
+ * @param map_file_name File holding the map, MAP_FILE_NAME by default
+ * @return std::unique_ptr<state::State>
+ */
+std::unique_ptr<state::State>
+buildState(size_t num_update_threads,
+           const std::string &map_file_name = MAP_FILE_NAME);
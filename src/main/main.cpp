@@ -1,9 +1,12 @@
 #include "constants/constants.h"
+#include "drivers/cpu_placement.h"
 #include "drivers/main_driver.h"
 #include "drivers/shared_memory_utils/shared_memory_main.h"
+#include "drivers/shared_memory_utils/shared_memory_paging.h"
 #include "drivers/timer.h"
 #include "game/game.h"
 #include "logger/logger.h"
+#include "main/state_builder.h"
 #include "physics/vector.hpp"
 #include "state/actor/actor.h"
 #include "state/actor/bot.h"
@@ -15,12 +18,16 @@
 #include "state/state.h"
 #include "state/state_syncer.h"
 #include "state/utilities.h"
+#include "tracer/tracer.h"
 
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <random>
+#include <sstream>
+#include <stdexcept>
 
 using namespace std;
 using namespace drivers;
@@ -31,156 +38,53 @@ using namespace Constants::Actor;
 using namespace Constants::Map;
 using namespace Constants::Simulator;
 
-// The map file contains the terrain layout for initializing the game map
-const auto MAP_FILE_NAME = "map.txt";
-
 // The security key file contains a single string, which is prefixed to the
 // output scores so that the player cannot directly print a score
 const auto KEY_FILE_NAME = "key.txt";
 
 auto shm_names = vector<string>(2);
 
-unique_ptr<Map> buildMap() {
-    auto map_elements = vector<vector<TerrainType>>{};
-
-    auto map_file = ifstream(MAP_FILE_NAME, ifstream::in);
-
-    // Compute file size
-    map_file.seekg(0, basic_ifstream<char>::end);
-    auto map_file_size = map_file.tellg();
-    map_file.seekg(0);
-
-    auto map_file_input = vector<char>(map_file_size, '\0');
-    map_file.read(&map_file_input[0], map_file_size);
-
-    auto map_row = vector<TerrainType>{};
-    for (auto character : map_file_input) {
-        switch (character) {
-        case 'L':
-            map_row.push_back(TerrainType::LAND);
-            break;
-        case 'W':
-            map_row.push_back(TerrainType::WATER);
-            break;
-        case 'F':
-            map_row.push_back(TerrainType::FLAG);
-            break;
-        case ' ':
-            // Ignore all whitespaces
-            break;
-        case '\n':
-            // Ensure that size of the row matches MAP_SIZE
-            if (map_row.size() != MAP_SIZE) {
-                std::cerr << "Bad map file! Match MAP_SIZE " << MAP_SIZE
-                          << '\n';
-                exit(EXIT_FAILURE);
-            }
-
-            map_elements.push_back(map_row);
-            map_row.clear();
-            break;
-        default:
-            std::cerr << "Bad map file! Invalid character: " << character
-                      << "\n";
-            exit(EXIT_FAILURE);
-        }
-    }
-    map_file.close();
-
-    // Ensure that number of rows matches MAP_SIZE
-    if (map_elements.size() != MAP_SIZE) {
-        std::cerr << "Bad map file! Match MAP_SIZE should be " << MAP_SIZE
-                  << '\n';
-        exit(EXIT_FAILURE);
-    }
-
-    return make_unique<Map>(map_elements, MAP_SIZE);
-}
-
-unique_ptr<ScoreManager> buildScoreManager() {
-    return make_unique<ScoreManager>(std::array<uint64_t, 2>{0, 0});
-}
-
-unique_ptr<PathPlanner> buildPathPlanner(Map *map) {
-    return make_unique<PathPlanner>(map);
-}
-
-unique_ptr<Bot> buildBot(PlayerId player_id, PathPlanner *path_planner,
-                         ScoreManager *score_manager) {
-    return make_unique<Bot>(
-        player_id, MAX_BOT_HP, MAX_BOT_HP,
-        PLAYER_BASE_POSITIONS[static_cast<int>(player_id)], BOT_SPEED,
-        BOT_BLAST_IMPACT_RADIUS, BOT_BLAST_DAMAGE_POINTS, score_manager,
-        path_planner, BlastCallback{}, ConstructTowerCallback{});
-}
-
-Bot buildModelBot(PathPlanner *path_planner, ScoreManager *score_manager) {
-    return Bot(PlayerId::PLAYER1, MAX_BOT_HP, MAX_BOT_HP,
-               PLAYER_BASE_POSITIONS[0], BOT_SPEED, BOT_BLAST_IMPACT_RADIUS,
-               BOT_BLAST_DAMAGE_POINTS, score_manager, path_planner,
-               BlastCallback{}, ConstructTowerCallback{});
-}
-
-unique_ptr<Tower> buildTower(PlayerId player_id, ScoreManager *score_manager) {
-    return make_unique<Tower>(
-        player_id, MAX_TOWER_HP, MAX_TOWER_HP,
-        PLAYER_BASE_POSITIONS[static_cast<size_t>(player_id)],
-        TOWER_BLAST_DAMAGE_POINTS, TOWER_BLAST_IMPACT_RADIUS, score_manager,
-        BlastCallback{});
-}
-
-Tower buildModelTower(ScoreManager *score_manager) {
-    return Tower(PlayerId::PLAYER1, MAX_TOWER_HP, MAX_TOWER_HP,
-                 PLAYER_BASE_POSITIONS[0], TOWER_BLAST_DAMAGE_POINTS,
-                 TOWER_BLAST_IMPACT_RADIUS, score_manager, BlastCallback{});
-}
-
-unique_ptr<State> buildState() {
-    auto map = buildMap();
-    auto path_planner = buildPathPlanner(map.get());
-    auto score_manager = buildScoreManager();
-
-    auto model_bot = buildModelBot(path_planner.get(), score_manager.get());
-    auto model_tower = buildModelTower(score_manager.get());
-
-    auto bots = array<vector<unique_ptr<Bot>>, 2>{};
-    auto towers = array<vector<unique_ptr<Tower>>, 2>{};
-
-    auto state = make_unique<State>(
-        move(map), move(score_manager), move(path_planner), move(bots),
-        move(towers), move(model_bot), move(model_tower));
-
-    // Initialize bots list
-    for (int player_id = 0; player_id < 2; ++player_id) {
-        for (size_t i = 0; i < NUM_BOTS_START; ++i) {
-            state->produceBot((PlayerId) player_id);
-        }
-    }
-
-    return state;
-}
-
-unique_ptr<MainDriver> buildMainDriver() {
-    auto state = buildState();
+unique_ptr<MainDriver> buildMainDriver(size_t num_update_threads,
+                                       SharedMemoryPaging shm_paging) {
+    auto state = buildState(num_update_threads);
+    auto game_limits = state->getGameLimits();
     auto logger = make_unique<Logger>(
         state.get(), PLAYER_INSTRUCTION_LIMIT_TURN,
         PLAYER_INSTRUCTION_LIMIT_GAME, MAX_BOT_HP, MAX_TOWER_HP);
 
-    auto command_giver = make_unique<CommandGiver>(state.get(), logger.get());
+    auto command_giver =
+        make_unique<CommandGiver>(state.get(), logger.get(), game_limits);
     auto state_syncer = make_unique<StateSyncer>(
         move(state), move(command_giver), logger.get());
 
+    // The buffers shared with the players are laid out for the limits in the
+    // header of the map file
     vector<unique_ptr<SharedMemoryMain>> shm_mains;
     for (int i = 0; i < 2; ++i) {
         shm_names[i] = Game::generateRandomString(64) + to_string(i);
         shm_mains.push_back(make_unique<SharedMemoryMain>(
-            shm_names[i], false, false, 0, transfer_state::State()));
+            shm_names[i], false, false, 0, game_limits, shm_paging));
+    }
+    if (shm_mains[0]->getPaging() != shm_paging) {
+        cerr << "Warning! Could not back SHM pages as "
+             << getSharedMemoryPagingName(shm_paging) << ". Using "
+             << getSharedMemoryPagingName(shm_mains[0]->getPaging())
+             << " instead...\n";
     }
 
+    // Players sample perf counters if the variable is set, so write them out
+    auto perf_log_file_name =
+        getenv(PERF_COUNTERS_ENV_VAR) != nullptr ? PERF_LOG_FILE_NAME : "";
+    auto digest_log_file_name =
+        getenv(STATE_DIGESTS_ENV_VAR) != nullptr ? DIGEST_LOG_FILE_NAME : "";
+    auto command_log_file_name =
+        getenv(RECORD_COMMANDS_ENV_VAR) != nullptr ? COMMAND_LOG_FILE_NAME : "";
+
     return make_unique<MainDriver>(
         move(state_syncer), move(shm_mains), PLAYER_INSTRUCTION_LIMIT_TURN,
         PLAYER_INSTRUCTION_LIMIT_GAME, NUM_TURNS,
-        Timer::Interval(GAME_DURATION_MS), move(logger), GAME_LOG_FILE_NAME);
+        Timer::Interval(GAME_DURATION_MS), move(logger), GAME_LOG_FILE_NAME,
+        perf_log_file_name, digest_log_file_name, command_log_file_name);
 }
 
 string GetKeyFromFile() {
@@ -220,8 +124,73 @@ int main(int argc, char *argv[]) {
         remove(KEY_FILE_NAME);
     }
 
+    // Record a trace of the match if a trace file prefix has been given
+    auto trace_file_prefix = getenv(TRACE_FILE_PREFIX_ENV_VAR);
+    if (trace_file_prefix != nullptr) {
+        tracer::Tracer::enable(trace_file_prefix, "main");
+    }
+
+    // Plan the moves of bots on several threads if asked to
+    auto num_update_threads = size_t{1};
+    auto update_threads = getenv(UPDATE_THREADS_ENV_VAR);
+    if (update_threads != nullptr) {
+        auto update_threads_stream = istringstream(update_threads);
+        if (!(update_threads_stream >> num_update_threads) ||
+            !update_threads_stream.eof() || num_update_threads == 0) {
+            cerr << "Error! Invalid number of update threads "
+                 << update_threads << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Place the processes on their CPUs. The threads that plan the moves of
+    // bots start with the main driver and inherit the CPUs of this thread, so
+    // it takes the workers' CPUs until they have started, and its own after
+    auto main_cpu = -1;
+    auto player_cpus = array<int, 2>{-1, -1};
+    auto cpu_placement_policy = getenv(CPU_PLACEMENT_ENV_VAR);
+    if (cpu_placement_policy != nullptr) {
+        try {
+            auto placement =
+                parseCpuPlacement(cpu_placement_policy, readCpuTopology(),
+                                  num_update_threads - 1);
+            main_cpu = placement.main_cpu;
+            player_cpus = placement.player_cpus;
+            if (placement.worker_cpus.empty()) {
+                pinCurrentThread(main_cpu);
+            } else {
+                pinCurrentThread(placement.worker_cpus);
+            }
+        } catch (const std::exception &error) {
+            cerr << "Error! Could not apply CPU placement "
+                 << cpu_placement_policy << ": " << error.what() << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Back the pages of the SHM as asked, to keep page faults out of the turns
+    auto shm_paging = SharedMemoryPaging::DEFAULT;
+    auto shm_paging_name = getenv(SHM_PAGING_ENV_VAR);
+    if (shm_paging_name != nullptr) {
+        try {
+            shm_paging = parseSharedMemoryPaging(shm_paging_name);
+        } catch (const std::invalid_argument &error) {
+            cerr << "Error! " << error.what() << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
     // Build main driver
-    auto driver = buildMainDriver();
+    auto driver = buildMainDriver(num_update_threads, shm_paging);
+    if (main_cpu >= 0) {
+        try {
+            pinCurrentThread(main_cpu);
+        } catch (const std::exception &error) {
+            cerr << "Error! Could not apply CPU placement "
+                 << cpu_placement_policy << ": " << error.what() << '\n';
+            return EXIT_FAILURE;
+        }
+    }
 
     // Write the SHM names to file, to be read by the player process
     for (int i = 0; i < 2; ++i) {
@@ -229,7 +198,9 @@ int main(int argc, char *argv[]) {
     }
 
     // Build game object
-    auto game = std::make_unique<Game>(move(driver));
+    auto game = std::make_unique<Game>(
+        move(driver), array<string, 2>{shm_names[0], shm_names[1]});
+    game->setPlayerCpus(player_cpus);
 
     // Start the game
     cout << "Starting game...\n";
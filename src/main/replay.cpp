@@ -0,0 +1,151 @@
+/**
+ * @file replay.cpp
+ * Replays the commands recorded by the main process through the state,
+ * without player processes, shared memory or a game timer, and reports how
+ * long the engine took
+ *
+ * Usage: replay [command_log_file] [num_update_threads]
+ *
+ * Run from the directory holding map.txt. The commands are recorded by main
+ * when CODECHARACTER_RECORD_COMMANDS is set, to game.commands by default. The
+ * replayed game log is written to replay.log, and the state digests to
+ * replay.digests.csv if CODECHARACTER_STATE_DIGESTS is set, which
+ * compare_digests can check against the digests of the recorded game
+ */
+
+#include "constants/constants.h"
+#include "drivers/command_recording.h"
+#include "logger/logger.h"
+#include "main/state_builder.h"
+#include "state/command_giver.h"
+#include "state/player_state.h"
+#include "state/state_syncer.h"
+#include "tracer/tracer.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+using namespace std;
+using namespace drivers;
+using namespace state;
+using namespace logger;
+using namespace Constants::Actor;
+using namespace Constants::Simulator;
+
+using Clock = std::chrono::steady_clock;
+
+// File the replayed game log is written to
+const auto REPLAY_LOG_FILE_NAME = "replay.log";
+
+// File the replayed state digests are written to
+const auto REPLAY_DIGEST_LOG_FILE_NAME = "replay.digests.csv";
+
+PlayerId getWinnerByScore(array<uint64_t, 2> scores) {
+    if (scores[0] > scores[1]) {
+        return PlayerId::PLAYER1;
+    } else if (scores[0] < scores[1]) {
+        return PlayerId::PLAYER2;
+    }
+    return PlayerId::PLAYER_NULL;
+}
+
+int main(int argc, char *argv[]) {
+    auto command_log_file_name =
+        string(argc > 1 ? argv[1] : COMMAND_LOG_FILE_NAME);
+
+    auto num_update_threads = size_t{1};
+    if (argc > 2) {
+        auto update_threads_stream = istringstream(argv[2]);
+        if (!(update_threads_stream >> num_update_threads) ||
+            !update_threads_stream.eof() || num_update_threads == 0) {
+            cerr << "Error! Invalid number of update threads " << argv[2]
+                 << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto command_log_file =
+        ifstream(command_log_file_name, ios::in | ios::binary);
+    if (!command_log_file) {
+        cerr << "Error! Could not open command log " << command_log_file_name
+             << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if (!ifstream(MAP_FILE_NAME)) {
+        cerr << "Error! Could not open map file " << MAP_FILE_NAME << '\n';
+        return EXIT_FAILURE;
+    }
+
+    auto trace_file_prefix = getenv(TRACE_FILE_PREFIX_ENV_VAR);
+    if (trace_file_prefix != nullptr) {
+        tracer::Tracer::enable(trace_file_prefix, "replay");
+    }
+
+    // Build the engine as the main process does, minus the drivers
+    auto state = buildState(num_update_threads);
+    auto game_limits = state->getGameLimits();
+    auto logger = make_unique<Logger>(
+        state.get(), PLAYER_INSTRUCTION_LIMIT_TURN,
+        PLAYER_INSTRUCTION_LIMIT_GAME, MAX_BOT_HP, MAX_TOWER_HP);
+    auto command_giver =
+        make_unique<CommandGiver>(state.get(), logger.get(), game_limits);
+    auto state_syncer = make_unique<StateSyncer>(
+        move(state), move(command_giver), logger.get());
+
+    auto player_states = array<player_state::State, 2>{};
+    state_syncer->updatePlayerStates(player_states);
+    logger->logState();
+
+    auto turn = make_unique<RecordedTurn>(game_limits.getMaxNumCommands());
+    auto num_turns = size_t{0};
+    auto replay_duration = Clock::duration::zero();
+    try {
+        auto replayer = CommandReplayer(command_log_file);
+        auto command_buffers = array<const CommandBuffer *, 2>{
+            &*turn->command_buffers[0], &*turn->command_buffers[1]};
+
+        while (replayer.readTurn(*turn)) {
+            auto turn_start = Clock::now();
+            for (auto player_id : {PlayerId::PLAYER1, PlayerId::PLAYER2}) {
+                logger->logInstructionCount(
+                    player_id, turn->instruction_counts[(int) player_id],
+                    PerfCounts{});
+            }
+            state_syncer->updateMainState(command_buffers, player_states,
+                                          turn->skip_turns);
+            replay_duration += Clock::now() - turn_start;
+            ++num_turns;
+        }
+    } catch (const std::exception &error) {
+        cerr << "Error! Could not replay " << command_log_file_name << ": "
+             << error.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    auto scores = state_syncer->getScores();
+    logger->logFinalGameParams(getWinnerByScore(scores), scores);
+    auto replay_log_file =
+        ofstream(REPLAY_LOG_FILE_NAME, ios::out | ios::binary);
+    logger->writeGame(replay_log_file);
+
+    if (getenv(STATE_DIGESTS_ENV_VAR) != nullptr) {
+        auto digest_log_file = ofstream(REPLAY_DIGEST_LOG_FILE_NAME);
+        logger->writeDigests(digest_log_file);
+    }
+
+    tracer::Tracer::flush();
+
+    auto replay_us =
+        chrono::duration_cast<chrono::microseconds>(replay_duration).count();
+    cout << "Replayed " << num_turns << " turns in " << replay_us / 1000.0
+         << " ms, " << (num_turns ? replay_us / num_turns : 0)
+         << " us per turn\n"
+         << "Scores " << scores[0] << ' ' << scores[1] << '\n';
+
+    return 0;
+}
@@ -0,0 +1,266 @@
+/**
+ * @file state_builder.cpp
+ * Definitions for building the initial state of a game
+ */
+
+#include "main/state_builder.h"
+#include "constants/constants.h"
+#include "physics/vector.hpp"
+#include "state/actor/bot.h"
+#include "state/actor/tower.h"
+#include "state/map/compiled_map.h"
+#include "state/map/map.h"
+#include "state/path_planner/path_planner.h"
+#include "state/score_manager/score_manager.h"
+#include "state/utilities.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace state;
+using namespace Constants::Actor;
+using namespace Constants::Map;
+using namespace Constants::Simulator;
+
+string readMapText(const string &map_file_name) {
+    auto map_file = ifstream(map_file_name, ifstream::in);
+
+    // Compute file size
+    map_file.seekg(0, basic_ifstream<char>::end);
+    auto map_file_size = map_file.tellg();
+    map_file.seekg(0);
+
+    auto map_text = string(map_file_size, '\0');
+    map_file.read(&map_text[0], map_file_size);
+    map_file.close();
+
+    return map_text;
+}
+
+GameLimits readGameLimits(const string &map_text) {
+    auto game_limits = GameLimits{};
+
+    auto map_stream = istringstream(map_text);
+    auto line = string();
+    while (getline(map_stream, line) && !line.empty() && line[0] == '#') {
+        auto line_stream = istringstream(line.substr(1));
+        auto name = string();
+        while (line_stream >> name) {
+            auto value = size_t{0};
+            if (!(line_stream >> value) || value == 0) {
+                std::cerr << "Bad map file! Invalid value of " << name
+                          << '\n';
+                exit(EXIT_FAILURE);
+            }
+
+            if (name == "map_size") {
+                game_limits.map_size = value;
+            } else if (name == "max_num_bots") {
+                game_limits.max_num_bots = value;
+            } else if (name == "max_num_towers") {
+                game_limits.max_num_towers = value;
+            } else {
+                std::cerr << "Bad map file! Unknown limit " << name << '\n';
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    return game_limits;
+}
+
+unique_ptr<Map> buildMap(const string &map_text) {
+    auto map_size = readGameLimits(map_text).map_size;
+    auto map_elements = vector<vector<TerrainType>>{};
+
+    auto map_row = vector<TerrainType>{};
+    for (size_t i = 0; i < map_text.size(); ++i) {
+        auto character = map_text[i];
+
+        // Skip the lines of the header
+        if (character == '#' && (i == 0 || map_text[i - 1] == '\n')) {
+            i = min(map_text.find('\n', i), map_text.size());
+            continue;
+        }
+
+        switch (character) {
+        case 'L':
+            map_row.push_back(TerrainType::LAND);
+            break;
+        case 'W':
+            map_row.push_back(TerrainType::WATER);
+            break;
+        case 'F':
+            map_row.push_back(TerrainType::FLAG);
+            break;
+        case ' ':
+            // Ignore all whitespaces
+            break;
+        case '\n':
+            // Ensure that size of the row matches the map size
+            if (map_row.size() != map_size) {
+                std::cerr << "Bad map file! Match map size " << map_size
+                          << '\n';
+                exit(EXIT_FAILURE);
+            }
+
+            map_elements.push_back(map_row);
+            map_row.clear();
+            break;
+        default:
+            std::cerr << "Bad map file! Invalid character: " << character
+                      << "\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Ensure that number of rows matches the map size
+    if (map_elements.size() != map_size) {
+        std::cerr << "Bad map file! Match map size should be " << map_size
+                  << '\n';
+        exit(EXIT_FAILURE);
+    }
+
+    return make_unique<Map>(map_elements, map_size);
+}
+
+/**
+ * Load the compiled map of a map file from the map cache, if the cache is set
+ * and holds a valid one
+ */
+unique_ptr<CompiledMap> loadCompiledMap(const string &map_text,
+                                        size_t map_size) {
+    auto map_cache = getenv(MAP_CACHE_ENV_VAR);
+    if (map_cache == nullptr)
+        return nullptr;
+
+    auto map_digest = CompiledMap::getMapTextDigest(map_text);
+    auto file_name =
+        string(map_cache) + '/' + CompiledMap::getFileName(map_digest);
+    if (!ifstream(file_name))
+        return nullptr;
+
+    try {
+        auto compiled_map = make_unique<CompiledMap>(file_name);
+        if (compiled_map->getMapDigest() != map_digest ||
+            compiled_map->getMapSize() != map_size) {
+            throw runtime_error("Compiled map is of another map");
+        }
+        return compiled_map;
+    } catch (const runtime_error &error) {
+        std::cerr << "Warning! Ignoring compiled map " << file_name << ": "
+                  << error.what() << '\n';
+        return nullptr;
+    }
+}
+
+unique_ptr<ScoreManager> buildScoreManager() {
+    return make_unique<ScoreManager>(std::array<uint64_t, 2>{0, 0});
+}
+
+unique_ptr<PathPlanner> buildPathPlanner(Map *map) {
+    return make_unique<PathPlanner>(map);
+}
+
+unique_ptr<Bot> buildBot(PlayerId player_id, PathPlanner *path_planner,
+                         ScoreManager *score_manager) {
+    return make_unique<Bot>(
+        player_id, MAX_BOT_HP, MAX_BOT_HP,
+        PLAYER_BASE_POSITIONS[static_cast<int>(player_id)], BOT_SPEED,
+        BOT_BLAST_IMPACT_RADIUS, BOT_BLAST_DAMAGE_POINTS, score_manager,
+        path_planner, BlastCallback{}, ConstructTowerCallback{});
+}
+
+Bot buildModelBot(PathPlanner *path_planner, ScoreManager *score_manager) {
+    return Bot(PlayerId::PLAYER1, MAX_BOT_HP, MAX_BOT_HP,
+               PLAYER_BASE_POSITIONS[0], BOT_SPEED, BOT_BLAST_IMPACT_RADIUS,
+               BOT_BLAST_DAMAGE_POINTS, score_manager, path_planner,
+               BlastCallback{}, ConstructTowerCallback{});
+}
+
+unique_ptr<Tower> buildTower(PlayerId player_id, ScoreManager *score_manager) {
+    return make_unique<Tower>(
+        player_id, MAX_TOWER_HP, MAX_TOWER_HP,
+        PLAYER_BASE_POSITIONS[static_cast<size_t>(player_id)],
+        TOWER_BLAST_DAMAGE_POINTS, TOWER_BLAST_IMPACT_RADIUS, score_manager,
+        BlastCallback{});
+}
+
+Tower buildModelTower(ScoreManager *score_manager) {
+    return Tower(PlayerId::PLAYER1, MAX_TOWER_HP, MAX_TOWER_HP,
+                 PLAYER_BASE_POSITIONS[0], TOWER_BLAST_DAMAGE_POINTS,
+                 TOWER_BLAST_IMPACT_RADIUS, score_manager, BlastCallback{});
+}
+
+unique_ptr<State> buildState(size_t num_update_threads,
+                             const string &map_file_name) {
+    // The compiled map of the map file, if there is one, stands in for it
+    auto map_text = readMapText(map_file_name);
+    auto game_limits = readGameLimits(map_text);
+    auto compiled_map = loadCompiledMap(map_text, game_limits.map_size);
+    auto map = compiled_map ? make_unique<Map>(compiled_map->getTerrain(),
+                                               compiled_map->getMapSize())
+                            : buildMap(map_text);
+    auto path_planner = buildPathPlanner(map.get());
+    if (compiled_map) {
+        try {
+            path_planner->setCompiledMap(move(compiled_map));
+        } catch (const invalid_argument &error) {
+            std::cerr << "Warning! Ignoring compiled map: " << error.what()
+                      << '\n';
+        }
+    }
+    auto score_manager = buildScoreManager();
+
+    // Search paths with landmarks if asked to
+    auto path_heuristic = getenv(PATH_HEURISTIC_ENV_VAR);
+    if (path_heuristic != nullptr) {
+        if (string(path_heuristic) == "landmarks") {
+            path_planner->setPathHeuristic(PathHeuristic::LANDMARKS);
+        } else if (string(path_heuristic) != "euclidean") {
+            std::cerr << "Error! Unknown path heuristic " << path_heuristic
+                      << '\n';
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Plan paths over chunks or cells of the map if asked to
+    auto path_planner_backend = getenv(PATH_PLANNER_ENV_VAR);
+    if (path_planner_backend != nullptr) {
+        if (string(path_planner_backend) == "hierarchical") {
+            path_planner->setBackend(PathPlannerBackend::HIERARCHICAL);
+        } else if (string(path_planner_backend) == "jps") {
+            path_planner->setBackend(PathPlannerBackend::JUMP_POINT_SEARCH);
+        } else if (string(path_planner_backend) != "visibility") {
+            std::cerr << "Error! Unknown path planner " << path_planner_backend
+                      << '\n';
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    auto model_bot = buildModelBot(path_planner.get(), score_manager.get());
+    auto model_tower = buildModelTower(score_manager.get());
+
+    auto bots = array<vector<unique_ptr<Bot>>, 2>{};
+    auto towers = array<vector<unique_ptr<Tower>>, 2>{};
+
+    auto state = make_unique<State>(
+        move(map), move(score_manager), move(path_planner), move(bots),
+        move(towers), move(model_bot), move(model_tower));
+    state->setNumUpdateThreads(num_update_threads);
+    state->setGameLimits(game_limits);
+
+    // Initialize bots list
+    for (int player_id = 0; player_id < 2; ++player_id) {
+        for (size_t i = 0; i < NUM_BOTS_START; ++i) {
+            state->produceBot((PlayerId) player_id);
+        }
+    }
+
+    return state;
+}
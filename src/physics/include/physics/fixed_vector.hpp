@@ -0,0 +1,255 @@
+/**
+ * @file fixed_vector.hpp
+ * 2D vector of fixed-point coordinates, used as the exact form of a position
+ * where positions are compared, hashed or walked over cell by cell
+ */
+
+#pragma once
+
+#include "physics/vector.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace physics {
+
+/**
+ * Bits of a fixed-point coordinate below the cell boundary. A unit is 1/65536
+ * of a cell, finer than the EPS doubles are compared with, so positions that
+ * round to the same fixed-point vector also compare equal as doubles
+ */
+const int64_t FIXED_POINT_FRACTION_BITS = 16;
+
+/**
+ * Fixed-point units in a cell
+ */
+const int64_t FIXED_POINT_ONE = int64_t{1} << FIXED_POINT_FRACTION_BITS;
+
+/**
+ * Floor division, rounding towards negative infinity
+ */
+inline int64_t floorDiv(int64_t numerator, int64_t denominator) {
+    auto quotient = numerator / denominator;
+    if ((numerator % denominator != 0) &&
+        ((numerator < 0) != (denominator < 0))) {
+        --quotient;
+    }
+    return quotient;
+}
+
+/**
+ * Round to the nearest integer, halfway cases away from zero, as std::llround
+ * does but without a call into the math library or a branch on the fraction.
+ * The fraction left over after truncating is exact, so the result is the same
+ * as std::llround's
+ */
+inline int64_t roundHalfAway(double_t value) {
+    auto truncated = static_cast<int64_t>(value);
+    auto fraction = value - static_cast<double_t>(truncated);
+    return truncated + static_cast<int64_t>(fraction >= 0.5) -
+           static_cast<int64_t>(fraction <= -0.5);
+}
+
+/**
+ * 2D vector of coordinates in units of 1/FIXED_POINT_ONE of a cell
+ *
+ * Unlike Vector<double_t>, comparisons are exact, equal vectors always hash
+ * alike, and the cell of a position is found without floating point
+ */
+template <typename T> class FixedVector {
+  public:
+    FixedVector();
+
+    /**
+     * Constructor from coordinates in cells, rounded to the nearest unit.
+     * Coordinates beyond the range of T are clamped to it
+     * @param x
+     * @param y
+     */
+    FixedVector(double_t x, double_t y);
+
+    /**
+     * Conversion from a position in cells, rounded to the nearest unit.
+     * Coordinates beyond the range of T are clamped to it
+     * @param position
+     */
+    FixedVector(const Vector<double_t> &position);
+
+    /**
+     * Null vector, the fixed-point form of Vector<double_t>::null
+     */
+    static FixedVector<T> null;
+
+    /**
+     * Make a vector from coordinates already in fixed-point units
+     * @param x
+     * @param y
+     * @return FixedVector<T>
+     */
+    static FixedVector<T> fromUnits(T x, T y);
+
+    /**
+     * Coordinate in units of a coordinate in cells, rounded to the nearest
+     * unit. Coordinates beyond the range of T are clamped to it, rather than
+     * wrapped onto the map, and NaN is taken as the lowest coordinate
+     * @param coordinate
+     * @return T
+     */
+    static T toUnits(double_t coordinate);
+
+    /**
+     * Cell of a coordinate, the floor of the coordinate in cells
+     * @param units
+     * @return int64_t
+     */
+    static int64_t getCell(int64_t units);
+
+    /**
+     * Check if a coordinate lies on a cell boundary
+     * @param units
+     * @return bool
+     */
+    static bool isIntegral(int64_t units);
+
+    bool operator==(const FixedVector<T> &rhs) const;
+    bool operator!=(const FixedVector<T> &rhs) const;
+
+    /**
+     * Lexicographic order, by x and then by y, as Vector<double_t> orders
+     */
+    bool operator<(const FixedVector<T> &rhs) const;
+    bool operator>(const FixedVector<T> &rhs) const;
+
+    /**
+     * Check for non-null vector
+     * @return true, if non-null vector, false if null vector
+     */
+    explicit operator bool() const;
+
+    /**
+     * Distance to another vector, in cells
+     * @param other
+     * @return double_t
+     */
+    double_t distance(const FixedVector<T> &other) const;
+
+    /**
+     * Convert to a position in cells
+     * @return Vector<double_t>
+     */
+    Vector<double_t> to_double() const;
+
+    /**
+     * Cell containing the vector, the floor of each coordinate
+     * @return Vector<int64_t>
+     */
+    Vector<int64_t> getCell() const;
+
+    /**
+     * Cell containing the vector, or the cell below and to the left of each
+     * coordinate on a cell boundary, the ceiling less one of each coordinate
+     * @return Vector<int64_t>
+     */
+    Vector<int64_t> getCellBelowLeft() const;
+
+    T x, y;
+};
+
+template <typename T>
+FixedVector<T> FixedVector<T>::null =
+    FixedVector<T>::fromUnits(-FIXED_POINT_ONE, -FIXED_POINT_ONE);
+
+template <typename T> FixedVector<T>::FixedVector() : x(), y() {}
+
+template <typename T>
+FixedVector<T>::FixedVector(double_t x, double_t y)
+    : x(toUnits(x)), y(toUnits(y)) {}
+
+template <typename T>
+FixedVector<T>::FixedVector(const Vector<double_t> &position)
+    : FixedVector(position.x, position.y) {}
+
+template <typename T> FixedVector<T> FixedVector<T>::fromUnits(T x, T y) {
+    auto vector = FixedVector<T>();
+    vector.x = x;
+    vector.y = y;
+    return vector;
+}
+
+template <typename T> T FixedVector<T>::toUnits(double_t coordinate) {
+    auto units = coordinate * FIXED_POINT_ONE;
+    if (!(units > static_cast<double_t>(std::numeric_limits<T>::lowest()))) {
+        return std::numeric_limits<T>::lowest();
+    }
+    if (units >= static_cast<double_t>(std::numeric_limits<T>::max())) {
+        return std::numeric_limits<T>::max();
+    }
+    return static_cast<T>(roundHalfAway(units));
+}
+
+template <typename T> int64_t FixedVector<T>::getCell(int64_t units) {
+    return floorDiv(units, FIXED_POINT_ONE);
+}
+
+template <typename T> bool FixedVector<T>::isIntegral(int64_t units) {
+    return units % FIXED_POINT_ONE == 0;
+}
+
+template <typename T>
+bool FixedVector<T>::operator==(const FixedVector<T> &rhs) const {
+    return x == rhs.x && y == rhs.y;
+}
+
+template <typename T>
+bool FixedVector<T>::operator!=(const FixedVector<T> &rhs) const {
+    return !(*this == rhs);
+}
+
+template <typename T>
+bool FixedVector<T>::operator<(const FixedVector<T> &rhs) const {
+    return x < rhs.x || (x == rhs.x && y < rhs.y);
+}
+
+template <typename T>
+bool FixedVector<T>::operator>(const FixedVector<T> &rhs) const {
+    return rhs < *this;
+}
+
+template <typename T> FixedVector<T>::operator bool() const {
+    return *this != null;
+}
+
+template <typename T>
+double_t FixedVector<T>::distance(const FixedVector<T> &other) const {
+    return to_double().distance(other.to_double());
+}
+
+template <typename T> Vector<double_t> FixedVector<T>::to_double() const {
+    return {static_cast<double_t>(x) / FIXED_POINT_ONE,
+            static_cast<double_t>(y) / FIXED_POINT_ONE};
+}
+
+template <typename T> Vector<int64_t> FixedVector<T>::getCell() const {
+    return {getCell(x), getCell(y)};
+}
+
+template <typename T> Vector<int64_t> FixedVector<T>::getCellBelowLeft() const {
+    return {getCell(int64_t{x} - 1), getCell(int64_t{y} - 1)};
+}
+
+template <typename T> std::size_t hash_value(const FixedVector<T> &val) {
+    // Both coordinates are packed into one word and mixed, so that nearby
+    // positions spread over the buckets
+    auto packed = (static_cast<uint64_t>(static_cast<uint32_t>(val.x)) << 32) |
+                  static_cast<uint32_t>(val.y);
+    packed ^= packed >> 33;
+    packed *= 0xff51afd7ed558ccd;
+    packed ^= packed >> 33;
+    return static_cast<std::size_t>(packed);
+}
+
+} // namespace physics
+
+using FixedVec2D = physics::FixedVector<int32_t>;
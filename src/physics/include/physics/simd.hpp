@@ -0,0 +1,151 @@
+/**
+ * @file simd.hpp
+ * Portable wrapper over a batch of doubles processed with one instruction
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace physics {
+
+/**
+ * A batch of doubles in a SIMD register. The width is picked at compile time,
+ * four lanes with AVX, two with SSE2 and a single lane otherwise
+ *
+ * Every operation is IEEE rounded per lane, so a batch computes exactly what
+ * the same expression would on each lane with scalar doubles
+ */
+struct DoubleBatch {
+#if defined(__AVX__)
+    static const size_t WIDTH = 4;
+    __m256d values;
+
+    static DoubleBatch load(const double *source) {
+        return {_mm256_loadu_pd(source)};
+    }
+
+    static DoubleBatch broadcast(double value) {
+        return {_mm256_set1_pd(value)};
+    }
+
+    void store(double *destination) const {
+        _mm256_storeu_pd(destination, values);
+    }
+
+    friend DoubleBatch operator+(DoubleBatch a, DoubleBatch b) {
+        return {_mm256_add_pd(a.values, b.values)};
+    }
+
+    friend DoubleBatch operator-(DoubleBatch a, DoubleBatch b) {
+        return {_mm256_sub_pd(a.values, b.values)};
+    }
+
+    friend DoubleBatch operator*(DoubleBatch a, DoubleBatch b) {
+        return {_mm256_mul_pd(a.values, b.values)};
+    }
+
+    friend DoubleBatch operator/(DoubleBatch a, DoubleBatch b) {
+        return {_mm256_div_pd(a.values, b.values)};
+    }
+
+    friend DoubleBatch sqrt(DoubleBatch a) {
+        return {_mm256_sqrt_pd(a.values)};
+    }
+
+    /**
+     * Lanes of value where a <= b, and 0 in the other lanes, including those
+     * where a or b is NaN
+     */
+    friend DoubleBatch selectLessEqual(DoubleBatch a, DoubleBatch b,
+                                       DoubleBatch value) {
+        auto mask = _mm256_cmp_pd(a.values, b.values, _CMP_LE_OQ);
+        return {_mm256_and_pd(mask, value.values)};
+    }
+#elif defined(__SSE2__)
+    static const size_t WIDTH = 2;
+    __m128d values;
+
+    static DoubleBatch load(const double *source) {
+        return {_mm_loadu_pd(source)};
+    }
+
+    static DoubleBatch broadcast(double value) { return {_mm_set1_pd(value)}; }
+
+    void store(double *destination) const {
+        _mm_storeu_pd(destination, values);
+    }
+
+    friend DoubleBatch operator+(DoubleBatch a, DoubleBatch b) {
+        return {_mm_add_pd(a.values, b.values)};
+    }
+
+    friend DoubleBatch operator-(DoubleBatch a, DoubleBatch b) {
+        return {_mm_sub_pd(a.values, b.values)};
+    }
+
+    friend DoubleBatch operator*(DoubleBatch a, DoubleBatch b) {
+        return {_mm_mul_pd(a.values, b.values)};
+    }
+
+    friend DoubleBatch operator/(DoubleBatch a, DoubleBatch b) {
+        return {_mm_div_pd(a.values, b.values)};
+    }
+
+    friend DoubleBatch sqrt(DoubleBatch a) { return {_mm_sqrt_pd(a.values)}; }
+
+    /**
+     * Lanes of value where a <= b, and 0 in the other lanes, including those
+     * where a or b is NaN
+     */
+    friend DoubleBatch selectLessEqual(DoubleBatch a, DoubleBatch b,
+                                       DoubleBatch value) {
+        auto mask = _mm_cmple_pd(a.values, b.values);
+        return {_mm_and_pd(mask, value.values)};
+    }
+#else
+    static const size_t WIDTH = 1;
+    double values;
+
+    static DoubleBatch load(const double *source) { return {*source}; }
+
+    static DoubleBatch broadcast(double value) { return {value}; }
+
+    void store(double *destination) const { *destination = values; }
+
+    friend DoubleBatch operator+(DoubleBatch a, DoubleBatch b) {
+        return {a.values + b.values};
+    }
+
+    friend DoubleBatch operator-(DoubleBatch a, DoubleBatch b) {
+        return {a.values - b.values};
+    }
+
+    friend DoubleBatch operator*(DoubleBatch a, DoubleBatch b) {
+        return {a.values * b.values};
+    }
+
+    friend DoubleBatch operator/(DoubleBatch a, DoubleBatch b) {
+        return {a.values / b.values};
+    }
+
+    friend DoubleBatch sqrt(DoubleBatch a) { return {std::sqrt(a.values)}; }
+
+    /**
+     * Lanes of value where a <= b, and 0 in the other lanes, including those
+     * where a or b is NaN
+     */
+    friend DoubleBatch selectLessEqual(DoubleBatch a, DoubleBatch b,
+                                       DoubleBatch value) {
+        return {a.values <= b.values ? value.values : 0.0};
+    }
+#endif
+};
+} // namespace physics
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cmath>
+#include <functional>
 #include <iostream>
 
 namespace physics {
@@ -302,7 +303,14 @@ template <typename T> Vector<T>::operator bool() const {
 }
 
 template <typename T> std::size_t hash_value(const Vector<T> &val) {
-    return std::hash<T>{}(val.x * std::hash<T>{}(val.y));
+    // Adding zero turns -0.0 into 0.0, which compares equal to it. Each
+    // coordinate's hash is then mixed in separately, as the product of the
+    // coordinates collides for every vector on an axis or with swapped
+    // coordinates
+    auto seed = std::hash<T>{}(val.x + T{0});
+    seed ^= std::hash<T>{}(val.y + T{0}) + 0x9e3779b97f4a7c15 + (seed << 6) +
+            (seed >> 2);
+    return seed;
 }
 
 } // namespace physics
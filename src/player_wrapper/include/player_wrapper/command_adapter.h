@@ -0,0 +1,30 @@
+/**
+ * @file command_adapter.h
+ * Adapts player code that returns a modified state to the command buffer
+ */
+
+#pragma once
+
+#include "player_wrapper/player_wrapper_export.h"
+#include "state/command_buffer.h"
+#include "state/player_state.h"
+
+namespace player_wrapper {
+
+/**
+ * Compares the state the player was given with the state the player returned,
+ * and appends the commands the player gave through it
+ *
+ * Actors are matched by index. Changes to anything other than the actors'
+ * commands, such as their id, hp, position or state, and adding or removing
+ * actors are appended as rejected commands, to be logged as errors
+ *
+ * @param[in]  state          State given to the player code
+ * @param[in]  updated_state  State returned by the player code
+ * @param[out] commands       Buffer to append the commands to
+ */
+PLAYER_WRAPPER_EXPORT void
+emitCommands(const player_state::State &state,
+             const player_state::State &updated_state,
+             state::CommandBuffer &commands);
+} // namespace player_wrapper
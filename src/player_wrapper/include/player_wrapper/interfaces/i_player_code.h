@@ -6,6 +6,7 @@
 #pragma once
 
 #include "player_wrapper/player_wrapper_export.h"
+#include "state/command_buffer.h"
 #include "state/player_state.h"
 #include <sstream>
 #include <string>
@@ -35,6 +36,24 @@ class PLAYER_WRAPPER_EXPORT IPlayerCode {
      */
     virtual player_state::State update(player_state::State state) = 0;
 
+    /**
+     * Optional AI update that issues commands directly instead of returning a
+     * modified state. Players that override this skip copying and comparing
+     * the whole state every turn
+     *
+     * @param[in]  state     The player state
+     * @param[out] commands  Buffer to append the turn's commands to, empty at
+     *                       the start of the turn
+     *
+     * @return     false if not overridden, in which case update is called
+     */
+    virtual bool issueCommands(const player_state::State &state,
+                               state::CommandBuffer &commands) {
+        (void) state;
+        (void) commands;
+        return false;
+    }
+
     /**
      * Gets and clears player's debug logs
      *
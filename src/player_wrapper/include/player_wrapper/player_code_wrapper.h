@@ -32,8 +32,15 @@ class PLAYER_WRAPPER_EXPORT PlayerCodeWrapper {
     /**
      * Runs the player's update and returns the player's debug logs
      *
+     * Player code that does not issue commands directly is run through the
+     * state based update, and the commands are taken from the returned state
+     *
+     * @param[in]  transfer_state  State of the game for this player
+     * @param[out] commands        Cleared, then filled with the turn's commands
+     *
      * @return     The debug logs
      */
-    std::string update(transfer_state::State &transfer_state);
+    std::string update(const transfer_state::State &transfer_state,
+                       state::CommandBuffer &commands);
 };
 } // namespace player_wrapper
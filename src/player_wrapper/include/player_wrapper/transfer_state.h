@@ -4,14 +4,23 @@
  * TODO: Move transfer_state to drivers
  */
 
-// SHM cannot handle vectors, so this version of the player state uses arrays
-// (stack-allocated) instead
+// SHM cannot handle vectors, so this version of the player state is laid out
+// in one block of memory instead, with its arrays sized from the limits of the
+// game. The actors in it are compact records with no virtual functions, and
+// are copied into the player state classes only when the state is converted
 
 #pragma once
 
+#include "physics/vector.hpp"
+#include "state/game_limits.h"
 #include "state/player_state.h"
+#include "state/span.h"
 
-#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
 
 namespace transfer_state {
 
@@ -20,102 +29,344 @@ using player_state::TowerState;
 
 using player_state::Bot;
 using player_state::MapElement;
+using player_state::TerrainType;
 using player_state::Tower;
 
+using state::GameLimits;
+using state::Span;
+
 using namespace Constants;
 
+/**
+ * Terrain of a cell, as the value of its TerrainType
+ */
+using TerrainRecord = uint8_t;
+
+/**
+ * Position as laid out in SHM, in single precision. On the maps a StateLayout
+ * allows, a position is within 2^-14 of a cell of its double, finer than the
+ * EPS positions are compared with
+ */
+using PositionRecord = physics::Vector<float>;
+
+/**
+ * Bot as laid out in SHM, so a bot read back from its record compares equal
+ * to the bot it was made from. Every field the game sets fits its field in
+ * the record, which is checked at compile time where the constants bound it
+ */
+struct BotRecord {
+    /**
+     * Bits of flags, for the bot's booleans
+     */
+    enum Flag : uint8_t { BLASTING = 1 << 0, TRANSFORMING = 1 << 1 };
+
+    int32_t id;
+    uint16_t hp;
+    BotState state;
+    uint8_t flags;
+
+    PositionRecord position;
+    PositionRecord destination;
+    PositionRecord final_destination;
+    PositionRecord transform_destination;
+
+    uint16_t impact_radius;
+    uint16_t speed;
+
+    /**
+     * Makes the record of a bot
+     *
+     * @param bot
+     * @return BotRecord
+     */
+    static BotRecord fromBot(const Bot &bot);
+
+    /**
+     * Copies the record into a bot, which then compares equal to the bot the
+     * record was made from
+     *
+     * @param[out] bot
+     */
+    void toBot(Bot &bot) const;
+};
+
+/**
+ * Tower as laid out in SHM
+ */
+struct TowerRecord {
+    /**
+     * Bits of flags, for the tower's booleans
+     */
+    enum Flag : uint8_t { BLASTING = 1 << 0 };
+
+    int32_t id;
+    uint16_t hp;
+    TowerState state;
+    uint8_t flags;
+
+    PositionRecord position;
+
+    uint32_t age;
+    uint16_t impact_radius;
+
+    /**
+     * Makes the record of a tower
+     *
+     * @param tower
+     * @return TowerRecord
+     */
+    static TowerRecord fromTower(const Tower &tower);
+
+    /**
+     * Copies the record into a tower, which then compares equal to the tower
+     * the record was made from
+     *
+     * @param[out] tower
+     */
+    void toTower(Tower &tower) const;
+};
+
+static_assert(std::is_trivially_copyable<BotRecord>::value,
+              "Bot records are copied into SHM as they are");
+static_assert(std::is_trivially_copyable<TowerRecord>::value,
+              "Tower records are copied into SHM as they are");
+
+struct State;
+
+/**
+ * Where the arrays of a transfer state laid out for the limits of a game are,
+ * from the start of the state. Every state holds its layout in its header, so
+ * that the player finds the arrays without knowing the limits. The main
+ * process keeps its own copy instead, as the player may write anything to the
+ * header
+ */
+class StateLayout {
+  public:
+    /**
+     * Arrays that follow the header, in the order they are laid out
+     */
+    enum Array : size_t {
+        MAP,
+        FLAG_OFFSETS,
+        BOTS,
+        ENEMY_BOTS,
+        TOWERS,
+        ENEMY_TOWERS,
+        NUM_ARRAYS
+    };
+
+  private:
+    /**
+     * Limits the state is laid out for
+     */
+    GameLimits limits;
+
+    /**
+     * Offset of each array from the start of the state, in bytes
+     */
+    std::array<size_t, NUM_ARRAYS> array_offsets;
+
+    /**
+     * Bytes taken by the header and the arrays
+     */
+    size_t size;
+
+    template <typename T, typename S>
+    Span<T> getArray(S &state, Array index, size_t num_elements) const;
+
+  public:
+    /**
+     * Lays out a state for the limits of a game
+     *
+     * @param limits
+     * @throw std::invalid_argument If the map is too large for the positions
+     * of the records
+     */
+    explicit StateLayout(const GameLimits &limits);
+
+    const GameLimits &getLimits() const { return limits; }
+
+    size_t getSize() const { return size; }
+
+    /**
+     * Terrain of each cell of a state, indexed by x * map_size + y
+     */
+    Span<TerrainRecord> getMap(State &state) const;
+    Span<const TerrainRecord> getMap(const State &state) const;
+
+    /**
+     * Arrays of the flags and actors of a state, with room for as many as the
+     * limits allow. Only the first num_* elements are in use
+     */
+    Span<PositionRecord> getFlagOffsets(State &state) const;
+    Span<const PositionRecord> getFlagOffsets(const State &state) const;
+    Span<BotRecord> getBots(State &state) const;
+    Span<const BotRecord> getBots(const State &state) const;
+    Span<BotRecord> getEnemyBots(State &state) const;
+    Span<const BotRecord> getEnemyBots(const State &state) const;
+    Span<TowerRecord> getTowers(State &state) const;
+    Span<const TowerRecord> getTowers(const State &state) const;
+    Span<TowerRecord> getEnemyTowers(State &state) const;
+    Span<const TowerRecord> getEnemyTowers(const State &state) const;
+};
+
+/**
+ * Player's copy of the state in one block of memory. A header holding the
+ * counts and the layout is followed by the arrays, each with room for as many
+ * elements as the limits of the game allow. States are only created in place,
+ * by create, in a block of getSize bytes
+ */
 struct State {
-    std::array<std::array<MapElement, Map::MAP_SIZE>, Map::MAP_SIZE> map;
-    std::array<DoubleVec2D, Map::MAP_SIZE * Map::MAP_SIZE> flag_offsets;
+  private:
+    /**
+     * Layout the state was created with
+     */
+    StateLayout layout;
+
+    explicit State(const GameLimits &limits);
+
+  public:
     size_t num_flags;
 
-    std::array<Bot, Actor::MAX_NUM_BOTS> bots;
-    std::array<Bot, Actor::MAX_NUM_BOTS> enemy_bots;
     size_t num_bots;
     size_t num_enemy_bots;
 
-    std::array<Tower, Actor::MAX_NUM_TOWERS> towers;
-    std::array<Tower, Actor::MAX_NUM_TOWERS> enemy_towers;
     size_t num_towers;
     size_t num_enemy_towers;
 
     array<uint64_t, 2> scores;
-};
 
-template <typename T, size_t _>
-inline std::vector<T> arrayToVector(const std::array<T, _> &arr,
-                                    const size_t size) {
-    return std::vector<T>(arr.begin(), arr.begin() + size);
-}
+    State(const State &) = delete;
+
+    State &operator=(const State &) = delete;
+
+    /**
+     * Bytes taken by a state laid out for the limits of a game
+     *
+     * @param limits
+     * @return size_t
+     * @throw std::invalid_argument If the map is too large for the positions
+     * of the records
+     */
+    static size_t getSize(const GameLimits &limits);
+
+    /**
+     * Creates an empty state in a block of memory
+     *
+     * @param memory Block of getSize(limits) bytes, aligned for any type
+     * @param limits
+     * @return State*
+     * @throw std::invalid_argument If the map is too large for the positions
+     * of the records
+     */
+    static State *create(void *memory, const GameLimits &limits);
+
+    /**
+     * Layout in the header. Only to be trusted by the process that wrote it
+     */
+    const StateLayout &getLayout() const { return layout; }
+
+    const GameLimits &getLimits() const { return layout.getLimits(); }
+
+    /**
+     * Arrays of the state, found through the layout in its header
+     *
+     * @see StateLayout
+     */
+    Span<TerrainRecord> getMap() { return layout.getMap(*this); }
+
+    Span<const TerrainRecord> getMap() const { return layout.getMap(*this); }
 
-inline player_state::State
-ConvertToPlayerState(const transfer_state::State &ts) {
-    auto ps = player_state::State{};
+    Span<PositionRecord> getFlagOffsets() {
+        return layout.getFlagOffsets(*this);
+    }
 
-    // Copy Map
-    ps.map = ts.map;
+    Span<const PositionRecord> getFlagOffsets() const {
+        return layout.getFlagOffsets(*this);
+    }
 
-    // Copy Bots
-    ps.bots.clear();
-    ps.bots = arrayToVector(ts.bots, ts.num_bots);
+    Span<BotRecord> getBots() { return layout.getBots(*this); }
 
-    ps.enemy_bots.clear();
-    ps.enemy_bots = arrayToVector(ts.enemy_bots, ts.num_enemy_bots);
+    Span<const BotRecord> getBots() const { return layout.getBots(*this); }
 
-    // Copy Towers
-    ps.towers.clear();
-    ps.towers = arrayToVector(ts.towers, ts.num_towers);
+    Span<BotRecord> getEnemyBots() { return layout.getEnemyBots(*this); }
 
-    ps.enemy_towers.clear();
-    ps.enemy_towers = arrayToVector(ts.enemy_towers, ts.num_enemy_towers);
+    Span<const BotRecord> getEnemyBots() const {
+        return layout.getEnemyBots(*this);
+    }
 
-    // Copy flag offset positions
-    ps.flag_offsets.clear();
-    ps.flag_offsets = arrayToVector(ts.flag_offsets, ts.num_flags);
+    Span<TowerRecord> getTowers() { return layout.getTowers(*this); }
 
-    // Copy score
-    std::copy(ts.scores.begin(), ts.scores.end(), ps.scores.begin());
+    Span<const TowerRecord> getTowers() const {
+        return layout.getTowers(*this);
+    }
 
-    return ps;
-}
+    Span<TowerRecord> getEnemyTowers() { return layout.getEnemyTowers(*this); }
 
-template <size_t N, typename T>
-std::array<T, N> vectorToArray(const std::vector<T> &vec) {
-    auto arr = std::array<T, N>{};
-    std::copy_n(vec.begin(), vec.size(), arr.begin());
-    return arr;
-}
+    Span<const TowerRecord> getEnemyTowers() const {
+        return layout.getEnemyTowers(*this);
+    }
+};
 
-inline transfer_state::State
-ConvertToTransferState(const player_state::State &ps) {
-    auto ts = transfer_state::State{};
+/**
+ * Owns a transfer state outside shared memory, as in benchmarks and tests
+ */
+class StateStorage {
+  private:
+    /**
+     * Memory the state is created in, in blocks aligned for any type
+     */
+    std::vector<std::max_align_t> memory;
 
-    // Copy map
-    ts.map = ps.map;
+  public:
+    explicit StateStorage(const GameLimits &limits = GameLimits{});
 
-    // Copy bots
-    ts.bots = vectorToArray<Actor::MAX_NUM_BOTS>(ps.bots);
-    ts.enemy_bots = vectorToArray<Actor::MAX_NUM_BOTS>(ps.enemy_bots);
+    State &operator*() { return *reinterpret_cast<State *>(memory.data()); }
 
-    // Copy Towers
-    ts.towers = vectorToArray<Actor::MAX_NUM_TOWERS>(ps.towers);
-    ts.enemy_towers = vectorToArray<Actor::MAX_NUM_TOWERS>(ps.enemy_towers);
+    const State &operator*() const {
+        return *reinterpret_cast<const State *>(memory.data());
+    }
 
-    // Copy flag offsets
-    ts.flag_offsets =
-        vectorToArray<Map::MAP_SIZE * Map::MAP_SIZE>(ps.flag_offsets);
+    State *operator->() { return &**this; }
 
-    // Copy score
-    std::copy(ps.scores.begin(), ps.scores.end(), ts.scores.begin());
+    const State *operator->() const { return &**this; }
+};
 
-    // Copy sizes
-    ts.num_bots = ps.bots.size();
-    ts.num_enemy_bots = ps.enemy_bots.size();
-    ts.num_towers = ps.towers.size();
-    ts.num_enemy_towers = ps.enemy_towers.size();
-    ts.num_flags = ps.flag_offsets.size();
+/**
+ * Copies a transfer state into a new player state
+ *
+ * @param ts
+ * @return player_state::State
+ */
+player_state::State ConvertToPlayerState(const transfer_state::State &ts);
 
-    return ts;
-}
+/**
+ * Copies a player state into a transfer state, in place, through the layout
+ * in the header of the transfer state
+ *
+ * @param ps
+ * @param[out] ts
+ *
+ * @throw std::invalid_argument If the player state does not fit the limits
+ * the transfer state was laid out for
+ */
+void ConvertToTransferState(const player_state::State &ps,
+                            transfer_state::State &ts);
+
+/**
+ * Copies a player state into a transfer state, in place, through a layout the
+ * caller holds. Nothing is read from the header of the transfer state, so it
+ * may be written by another process
+ *
+ * @param ps
+ * @param[out] ts
+ * @param layout Layout the transfer state was created with
+ *
+ * @throw std::invalid_argument If the player state does not fit the limits
+ * the transfer state was laid out for
+ */
+void ConvertToTransferState(const player_state::State &ps,
+                            transfer_state::State &ts,
+                            const StateLayout &layout);
 
 } // namespace transfer_state
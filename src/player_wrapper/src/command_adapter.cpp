@@ -0,0 +1,96 @@
+/**
+ * @file command_adapter.cpp
+ * Definitions for adapting a modified player state to commands
+ */
+
+#include "player_wrapper/command_adapter.h"
+
+namespace player_wrapper {
+
+using logger::ErrorType;
+
+/**
+ * Appends the command a bot was given, if any
+ */
+static void emitBotCommand(const player_state::Bot &bot,
+                           const player_state::Bot &updated_bot,
+                           state::CommandBuffer &commands) {
+    if (updated_bot.id != bot.id || updated_bot.hp != bot.hp ||
+        updated_bot.position != bot.position ||
+        updated_bot.state != bot.state) {
+        commands.reject(ErrorType::NO_ALTER_BOT_PROPERTY, bot.id);
+        return;
+    }
+
+    bool is_blasting = updated_bot.blasting;
+    bool is_transforming = updated_bot.transforming;
+    bool is_moving_to_blast = (bool) updated_bot.final_destination;
+    bool is_moving_to_transform = (bool) updated_bot.transform_destination;
+    bool is_moving = (bool) updated_bot.destination;
+
+    if (is_blasting + is_transforming + is_moving_to_blast +
+            is_moving_to_transform + is_moving >
+        1) {
+        commands.reject(ErrorType::NO_MULTIPLE_BOT_TASK, bot.id);
+        return;
+    }
+
+    // Blasting and transforming in place target the bot's own position
+    if (is_blasting) {
+        commands.blastBot(bot.id, bot.position);
+    } else if (is_transforming) {
+        commands.transformBot(bot.id, bot.position);
+    } else if (is_moving_to_blast) {
+        commands.blastBot(bot.id, updated_bot.final_destination);
+    } else if (is_moving_to_transform) {
+        commands.transformBot(bot.id, updated_bot.transform_destination);
+    } else if (is_moving) {
+        commands.moveBot(bot.id, updated_bot.destination);
+    }
+}
+
+/**
+ * Appends the command a tower was given, if any
+ */
+static void emitTowerCommand(const player_state::Tower &tower,
+                             const player_state::Tower &updated_tower,
+                             state::CommandBuffer &commands) {
+    if (updated_tower.id != tower.id || updated_tower.hp != tower.hp ||
+        updated_tower.position != tower.position ||
+        updated_tower.state != tower.state) {
+        commands.reject(ErrorType::NO_ALTER_TOWER_PROPERTY, tower.id);
+        return;
+    }
+
+    if (updated_tower.blasting) {
+        commands.blastTower(tower.id);
+    }
+}
+
+void emitCommands(const player_state::State &state,
+                  const player_state::State &updated_state,
+                  state::CommandBuffer &commands) {
+    if (updated_state.bots.size() != state.bots.size() ||
+        updated_state.enemy_bots.size() != state.enemy_bots.size()) {
+        commands.reject(ErrorType::NUMBER_OF_BOTS_MISMATCH, 0);
+        return;
+    }
+
+    for (size_t bot_index = 0; bot_index < state.bots.size(); ++bot_index) {
+        emitBotCommand(state.bots[bot_index], updated_state.bots[bot_index],
+                       commands);
+    }
+
+    if (updated_state.towers.size() != state.towers.size() ||
+        updated_state.enemy_towers.size() != state.enemy_towers.size()) {
+        commands.reject(ErrorType::NUMBER_OF_TOWERS_MISMATCH, 0);
+        return;
+    }
+
+    for (size_t tower_index = 0; tower_index < state.towers.size();
+         ++tower_index) {
+        emitTowerCommand(state.towers[tower_index],
+                         updated_state.towers[tower_index], commands);
+    }
+}
+} // namespace player_wrapper
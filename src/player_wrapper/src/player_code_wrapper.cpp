@@ -4,6 +4,8 @@
  */
 
 #include "player_wrapper/player_code_wrapper.h"
+#include "player_wrapper/command_adapter.h"
+#include "tracer/tracer.h"
 #include <sstream>
 
 namespace player_wrapper {
@@ -11,12 +13,36 @@ namespace player_wrapper {
 PlayerCodeWrapper::PlayerCodeWrapper(std::unique_ptr<IPlayerCode> player_code)
     : player_code(std::move(player_code)) {}
 
-std::string PlayerCodeWrapper::update(transfer_state::State &transfer_state) {
+std::string
+PlayerCodeWrapper::update(const transfer_state::State &transfer_state,
+                          state::CommandBuffer &commands) {
     using namespace transfer_state;
 
-    auto player_state = ConvertToPlayerState(transfer_state);
-    player_state = player_code->update(player_state);
-    transfer_state = ConvertToTransferState(player_state);
+    player_state::State player_state;
+    {
+        tracer::ScopedSpan span("convert_to_player_state", "player_wrapper");
+        player_state = ConvertToPlayerState(transfer_state);
+    }
+
+    commands.clear();
+    auto has_issued_commands = false;
+    player_state::State updated_state;
+    {
+        tracer::ScopedSpan span("player_code_update", "player_wrapper");
+        has_issued_commands =
+            player_code->issueCommands(player_state, commands);
+        if (!has_issued_commands) {
+            updated_state = player_code->update(player_state);
+        }
+    }
+
+    // Player code using the state based update gives its commands through the
+    // returned state
+    if (!has_issued_commands) {
+        tracer::ScopedSpan span("emit_commands", "player_wrapper");
+        emitCommands(player_state, updated_state, commands);
+    }
+
     return player_code->getAndClearDebugLogs();
 }
 } // namespace player_wrapper
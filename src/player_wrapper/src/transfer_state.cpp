@@ -0,0 +1,358 @@
+/**
+ * @file transfer_state.cpp
+ * Definitions for the layout of the transfer state, and for converting it to
+ * and from the player state
+ */
+
+#include "player_wrapper/transfer_state.h"
+#include "constants/actor.h"
+#include "constants/simulator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+namespace transfer_state {
+
+namespace {
+
+/**
+ * Round a size up to a multiple of the alignment of any type, so that every
+ * array starts aligned
+ */
+size_t alignSize(size_t size) {
+    const auto alignment = alignof(std::max_align_t);
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Create default elements in an array of a transfer state
+ */
+template <typename T> void createElements(Span<T> elements) {
+    for (auto &element : elements) {
+        new (&element) T();
+    }
+}
+
+/**
+ * Largest map whose positions are within 2^-14 of a cell of their double in
+ * single precision, which has 24 bits of significand
+ */
+const size_t MAX_MAP_SIZE = 2048;
+
+// Fields are narrowed without a check, so every value the game can give them
+// must fit
+static_assert(Actor::MAX_BOT_HP <= UINT16_MAX &&
+                  Actor::MAX_TOWER_HP <= UINT16_MAX,
+              "Hit points do not fit the records");
+static_assert(Actor::BOT_BLAST_IMPACT_RADIUS <= UINT16_MAX &&
+                  Actor::TOWER_BLAST_IMPACT_RADIUS <= UINT16_MAX &&
+                  Actor::BOT_SPEED <= UINT16_MAX,
+              "Impact radii and speeds do not fit the records");
+static_assert(Simulator::NUM_TURNS <= UINT32_MAX,
+              "Tower ages do not fit the records");
+
+/**
+ * Convert a position to single precision, rounding each coordinate to nearest
+ */
+PositionRecord toRecord(const DoubleVec2D &position) {
+    return {static_cast<float>(position.x), static_cast<float>(position.y)};
+}
+
+/**
+ * Convert the record of a position back to double precision, exactly
+ */
+DoubleVec2D toPosition(const PositionRecord &record) {
+    return {record.x, record.y};
+}
+
+/**
+ * Copy the elements of a vector into an array of a transfer state, converting
+ * each one
+ *
+ * @return size_t Number of elements copied
+ * @throw std::invalid_argument If the array has no room for them
+ */
+template <typename T, typename U, typename Convert>
+size_t copyElements(const std::vector<T> &elements, Span<U> array,
+                    Convert convert) {
+    if (elements.size() > array.size()) {
+        throw std::invalid_argument(
+            "Player state does not fit the transfer state");
+    }
+    std::transform(elements.begin(), elements.end(), array.begin(), convert);
+    return elements.size();
+}
+
+/**
+ * Copy the first elements of an array of a transfer state into a vector,
+ * converting each one into the element in its place
+ */
+template <typename T, typename U, typename Convert>
+void copyElements(Span<const U> array, size_t count, std::vector<T> &elements,
+                  Convert convert) {
+    elements.resize(count);
+    for (size_t index = 0; index < count; ++index) {
+        convert(array[index], elements[index]);
+    }
+}
+} // namespace
+
+BotRecord BotRecord::fromBot(const Bot &bot) {
+    auto record = BotRecord();
+    // Ids are handed out in order, and a game makes far fewer than 2^31 actors
+    record.id = static_cast<int32_t>(bot.id);
+    record.hp = static_cast<uint16_t>(bot.hp);
+    record.state = bot.state;
+    record.flags = (bot.blasting ? BLASTING : 0) |
+                   (bot.transforming ? TRANSFORMING : 0);
+    record.position = toRecord(bot.position);
+    record.destination = toRecord(bot.destination);
+    record.final_destination = toRecord(bot.final_destination);
+    record.transform_destination = toRecord(bot.transform_destination);
+    record.impact_radius = static_cast<uint16_t>(bot.impact_radius);
+    record.speed = static_cast<uint16_t>(bot.speed);
+    return record;
+}
+
+void BotRecord::toBot(Bot &bot) const {
+    bot.id = id;
+    bot.hp = hp;
+    bot.state = state;
+    bot.blasting = flags & BLASTING;
+    bot.transforming = flags & TRANSFORMING;
+    bot.position = toPosition(position);
+    bot.destination = toPosition(destination);
+    bot.final_destination = toPosition(final_destination);
+    bot.transform_destination = toPosition(transform_destination);
+    bot.impact_radius = impact_radius;
+    bot.speed = speed;
+}
+
+TowerRecord TowerRecord::fromTower(const Tower &tower) {
+    auto record = TowerRecord();
+    record.id = static_cast<int32_t>(tower.id);
+    record.hp = static_cast<uint16_t>(tower.hp);
+    record.state = tower.state;
+    record.flags = tower.blasting ? BLASTING : 0;
+    record.position = toRecord(tower.position);
+    record.age = static_cast<uint32_t>(tower.age);
+    record.impact_radius = static_cast<uint16_t>(tower.impact_radius);
+    return record;
+}
+
+void TowerRecord::toTower(Tower &tower) const {
+    tower.id = id;
+    tower.hp = hp;
+    tower.state = state;
+    tower.blasting = flags & BLASTING;
+    tower.position = toPosition(position);
+    tower.age = age;
+    tower.impact_radius = impact_radius;
+}
+
+StateLayout::StateLayout(const GameLimits &limits)
+    : limits(limits), array_offsets(), size(0) {
+    // Positions are stored in single precision, so the map must be small
+    // enough for every position on it to compare equal to its record
+    if (limits.map_size > MAX_MAP_SIZE) {
+        throw std::invalid_argument(
+            "Map is too large for the positions of the transfer state");
+    }
+
+    auto num_cells = limits.map_size * limits.map_size;
+    auto array_sizes = std::array<size_t, NUM_ARRAYS>{};
+    array_sizes[MAP] = num_cells * sizeof(TerrainRecord);
+    array_sizes[FLAG_OFFSETS] = num_cells * sizeof(PositionRecord);
+    array_sizes[BOTS] = limits.max_num_bots * sizeof(BotRecord);
+    array_sizes[ENEMY_BOTS] = limits.max_num_bots * sizeof(BotRecord);
+    array_sizes[TOWERS] = limits.max_num_towers * sizeof(TowerRecord);
+    array_sizes[ENEMY_TOWERS] = limits.max_num_towers * sizeof(TowerRecord);
+
+    size = alignSize(sizeof(State));
+    for (size_t index = 0; index < NUM_ARRAYS; ++index) {
+        array_offsets[index] = size;
+        size += alignSize(array_sizes[index]);
+    }
+}
+
+template <typename T, typename S>
+Span<T> StateLayout::getArray(S &state, Array index,
+                              size_t num_elements) const {
+    using Byte = typename std::conditional<std::is_const<S>::value, const char,
+                                           char>::type;
+    return {reinterpret_cast<T *>(reinterpret_cast<Byte *>(&state) +
+                                  array_offsets[index]),
+            num_elements};
+}
+
+Span<TerrainRecord> StateLayout::getMap(State &state) const {
+    return getArray<TerrainRecord>(state, MAP,
+                                   limits.map_size * limits.map_size);
+}
+
+Span<const TerrainRecord> StateLayout::getMap(const State &state) const {
+    return getArray<const TerrainRecord>(state, MAP,
+                                         limits.map_size * limits.map_size);
+}
+
+Span<PositionRecord> StateLayout::getFlagOffsets(State &state) const {
+    return getArray<PositionRecord>(state, FLAG_OFFSETS,
+                                    limits.map_size * limits.map_size);
+}
+
+Span<const PositionRecord>
+StateLayout::getFlagOffsets(const State &state) const {
+    return getArray<const PositionRecord>(state, FLAG_OFFSETS,
+                                          limits.map_size * limits.map_size);
+}
+
+Span<BotRecord> StateLayout::getBots(State &state) const {
+    return getArray<BotRecord>(state, BOTS, limits.max_num_bots);
+}
+
+Span<const BotRecord> StateLayout::getBots(const State &state) const {
+    return getArray<const BotRecord>(state, BOTS, limits.max_num_bots);
+}
+
+Span<BotRecord> StateLayout::getEnemyBots(State &state) const {
+    return getArray<BotRecord>(state, ENEMY_BOTS, limits.max_num_bots);
+}
+
+Span<const BotRecord> StateLayout::getEnemyBots(const State &state) const {
+    return getArray<const BotRecord>(state, ENEMY_BOTS, limits.max_num_bots);
+}
+
+Span<TowerRecord> StateLayout::getTowers(State &state) const {
+    return getArray<TowerRecord>(state, TOWERS, limits.max_num_towers);
+}
+
+Span<const TowerRecord> StateLayout::getTowers(const State &state) const {
+    return getArray<const TowerRecord>(state, TOWERS, limits.max_num_towers);
+}
+
+Span<TowerRecord> StateLayout::getEnemyTowers(State &state) const {
+    return getArray<TowerRecord>(state, ENEMY_TOWERS, limits.max_num_towers);
+}
+
+Span<const TowerRecord>
+StateLayout::getEnemyTowers(const State &state) const {
+    return getArray<const TowerRecord>(state, ENEMY_TOWERS,
+                                       limits.max_num_towers);
+}
+
+State::State(const GameLimits &limits)
+    : layout(limits), num_flags(0), num_bots(0), num_enemy_bots(0),
+      num_towers(0), num_enemy_towers(0), scores({0, 0}) {}
+
+size_t State::getSize(const GameLimits &limits) {
+    return StateLayout(limits).getSize();
+}
+
+State *State::create(void *memory, const GameLimits &limits) {
+    auto state = new (memory) State(limits);
+    createElements(state->getMap());
+    createElements(state->getFlagOffsets());
+    createElements(state->getBots());
+    createElements(state->getEnemyBots());
+    createElements(state->getTowers());
+    createElements(state->getEnemyTowers());
+    return state;
+}
+
+StateStorage::StateStorage(const GameLimits &limits)
+    : memory((State::getSize(limits) + sizeof(std::max_align_t) - 1) /
+             sizeof(std::max_align_t)) {
+    State::create(memory.data(), limits);
+}
+
+player_state::State ConvertToPlayerState(const transfer_state::State &ts) {
+    auto ps = player_state::State{};
+
+    // Copy Map
+    auto map_size = ts.getLimits().map_size;
+    auto map = ts.getMap();
+    ps.map.resize(map_size);
+    for (size_t x = 0; x < map_size; ++x) {
+        ps.map[x].resize(map_size);
+        for (size_t y = 0; y < map_size; ++y) {
+            ps.map[x][y].setTerrain(
+                static_cast<TerrainType>(map[x * map_size + y]));
+        }
+    }
+
+    // Copy Bots
+    auto toBot = [](const BotRecord &record, Bot &bot) { record.toBot(bot); };
+    copyElements(ts.getBots(), ts.num_bots, ps.bots, toBot);
+    copyElements(ts.getEnemyBots(), ts.num_enemy_bots, ps.enemy_bots, toBot);
+
+    // Copy Towers
+    auto toTower = [](const TowerRecord &record, Tower &tower) {
+        record.toTower(tower);
+    };
+    copyElements(ts.getTowers(), ts.num_towers, ps.towers, toTower);
+    copyElements(ts.getEnemyTowers(), ts.num_enemy_towers, ps.enemy_towers,
+                 toTower);
+
+    // Copy flag offset positions
+    copyElements(ts.getFlagOffsets(), ts.num_flags, ps.flag_offsets,
+                 [](const PositionRecord &offset, DoubleVec2D &flag_offset) {
+                     flag_offset = toPosition(offset);
+                 });
+
+    // Copy score
+    std::copy(ts.scores.begin(), ts.scores.end(), ps.scores.begin());
+
+    return ps;
+}
+
+void ConvertToTransferState(const player_state::State &ps,
+                            transfer_state::State &ts) {
+    ConvertToTransferState(ps, ts, ts.getLayout());
+}
+
+void ConvertToTransferState(const player_state::State &ps,
+                            transfer_state::State &ts,
+                            const StateLayout &layout) {
+    // Copy map
+    auto map_size = layout.getLimits().map_size;
+    if (ps.map.size() != map_size) {
+        throw std::invalid_argument(
+            "Player state map does not fit the transfer state");
+    }
+    auto map = layout.getMap(ts);
+    for (size_t x = 0; x < map_size; ++x) {
+        if (ps.map[x].size() != map_size) {
+            throw std::invalid_argument(
+                "Player state map does not fit the transfer state");
+        }
+        std::transform(ps.map[x].begin(), ps.map[x].end(),
+                       map.begin() + x * map_size,
+                       [](const MapElement &element) {
+                           return static_cast<TerrainRecord>(
+                               element.getTerrain());
+                       });
+    }
+
+    // Copy bots and towers, with their sizes
+    ts.num_bots =
+        copyElements(ps.bots, layout.getBots(ts), BotRecord::fromBot);
+    ts.num_enemy_bots = copyElements(ps.enemy_bots, layout.getEnemyBots(ts),
+                                     BotRecord::fromBot);
+    ts.num_towers =
+        copyElements(ps.towers, layout.getTowers(ts), TowerRecord::fromTower);
+    ts.num_enemy_towers = copyElements(
+        ps.enemy_towers, layout.getEnemyTowers(ts), TowerRecord::fromTower);
+
+    // Copy flag offsets
+    ts.num_flags = copyElements(
+        ps.flag_offsets, layout.getFlagOffsets(ts),
+        [](const DoubleVec2D &offset) { return toRecord(offset); });
+
+    // Copy score
+    std::copy(ps.scores.begin(), ps.scores.end(), ts.scores.begin());
+}
+
+} // namespace transfer_state
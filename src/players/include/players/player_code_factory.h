@@ -0,0 +1,20 @@
+/**
+ * @file player_code_factory.h
+ * Declaration for building the AI a player process runs. Each player
+ * executable links the definition for the code it runs
+ */
+
+#pragma once
+
+#include "player_wrapper/interfaces/i_player_code.h"
+
+#include <memory>
+
+/**
+ * Builds the player's AI
+ *
+ * @param player_number Number of the player, 1 or 2
+ * @return std::unique_ptr<player_wrapper::IPlayerCode>
+ */
+std::unique_ptr<player_wrapper::IPlayerCode>
+buildPlayerCode(int player_number);
@@ -1,19 +1,23 @@
 #include "constants/constants.h"
 #include "drivers/player_driver.h"
+#include "drivers/player_pool/player_zygote.h"
+#include "drivers/shared_memory_utils/shared_memory_paging.h"
 #include "drivers/shared_memory_utils/shared_memory_player.h"
 #include "drivers/timer.h"
-#include "player_code/player_code.h"
 #include "player_wrapper/player_code_wrapper.h"
+#include "players/player_code_factory.h"
+#include "tracer/tracer.h"
 
 #include <cstdio>
 #include <cstdlib>
 #include <fstream>
+#include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <string>
 
 using namespace drivers;
 using namespace player_wrapper;
-using namespace player_code;
 using namespace Constants::Simulator;
 
 const std::string player_debug_log_ext = ".dlog";
@@ -24,18 +28,34 @@ const std::string debug_logs_truncate_message =
 const int64_t max_debug_logs_turn_length = 10000;
 
 std::unique_ptr<PlayerDriver>
-buildPlayerDriver(const std::string &shm_name,
+buildPlayerDriver(int player_number, const std::string &shm_name,
                   const std::string &player_debug_log_file) {
-    auto shm_player = std::make_unique<SharedMemoryPlayer>(shm_name);
+    // Back the SHM pages the way the main process does. Unknown ways are
+    // refused by the main process, so here they fall back to the default
+    auto shm_paging = SharedMemoryPaging::DEFAULT;
+    auto shm_paging_name = std::getenv(SHM_PAGING_ENV_VAR);
+    if (shm_paging_name != nullptr) {
+        try {
+            shm_paging = parseSharedMemoryPaging(shm_paging_name);
+        } catch (const std::invalid_argument &error) {
+            std::cerr << "Warning! " << error.what()
+                      << ". Using default SHM paging...\n";
+        }
+    }
+    auto shm_player =
+        std::make_unique<SharedMemoryPlayer>(shm_name, shm_paging);
 
     auto player_code_wrapper =
-        std::make_unique<PlayerCodeWrapper>(std::make_unique<PlayerCode>());
+        std::make_unique<PlayerCodeWrapper>(buildPlayerCode(player_number));
+
+    auto is_perf_counting_enabled =
+        std::getenv(PERF_COUNTERS_ENV_VAR) != nullptr;
 
     return std::make_unique<PlayerDriver>(
         std::move(player_code_wrapper), std::move(shm_player), NUM_TURNS,
         Timer::Interval(GAME_DURATION_MS), player_debug_log_file,
         debug_logs_turn_prefix, debug_logs_truncate_message,
-        max_debug_logs_turn_length);
+        max_debug_logs_turn_length, is_perf_counting_enabled);
 }
 
 std::string getKeyFromFile(const std::string &file_name) {
@@ -50,12 +70,44 @@ bool fileExists(const std::string &name) {
     return f.good();
 }
 
+int runPlayer(const std::string &process_name, int player_number,
+              const std::string &shm_name) {
+    // Record a trace of the player's turns if the main process is tracing
+    auto trace_file_prefix = std::getenv(TRACE_FILE_PREFIX_ENV_VAR);
+    if (trace_file_prefix != nullptr) {
+        tracer::Tracer::enable(trace_file_prefix,
+                               "player_" + std::to_string(player_number));
+    }
+
+    std::cout << "Running " << process_name << " ..." << std::endl;
+    auto driver = buildPlayerDriver(player_number, shm_name,
+                                    process_name + player_debug_log_ext);
+
+    driver->start();
+    std::cout << process_name << " Done!" << std::endl;
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
     // Get the player number. The process will be named './player_1' or
-    // './player_2'
+    // './player_2', which the scripted player is linked to as well
     auto process_name = std::string{argv[0]};
     auto player_number = process_name[process_name.size() - 1] - '0';
 
+    // In zygote mode, stay warm and fork a worker for every match, which gets
+    // its SHM name, working directory and settings over the zygote's socket
+    if (argc == 3 && std::string{argv[1]} == "--zygote") {
+        PlayerZygote zygote(argv[2], [&process_name, player_number](
+                                         const std::string &shm_name) {
+            return runPlayer(process_name, player_number, shm_name);
+        });
+
+        std::cout << process_name << " zygote listening on " << argv[2]
+                  << std::endl;
+        zygote.run();
+        return 0;
+    }
+
     // Read the SHM file to get the SHM name
     auto shm_file_name = SHM_FILE_NAMES[player_number - 1];
     if (not fileExists(shm_file_name)) {
@@ -68,11 +120,5 @@ int main(int argc, char *argv[]) {
     // We've read the SHM file name, remove the file
     std::remove(shm_file_name.c_str());
 
-    std::cout << "Running " << argv[0] << " ..." << std::endl;
-    auto driver = buildPlayerDriver(shm_name, std::string(argv[0]) +
-                                                  player_debug_log_ext);
-
-    driver->start();
-    std::cout << argv[0] << " Done!" << std::endl;
-    return 0;
+    return runPlayer(process_name, player_number, shm_name);
 }
@@ -0,0 +1,13 @@
+/**
+ * @file player_code_factory.cpp
+ * Builds the player code compiled from the player's submission
+ */
+
+#include "players/player_code_factory.h"
+#include "player_code/player_code.h"
+
+std::unique_ptr<player_wrapper::IPlayerCode>
+buildPlayerCode(int player_number) {
+    (void) player_number;
+    return std::make_unique<player_code::PlayerCode>();
+}
@@ -0,0 +1,30 @@
+/**
+ * @file scripted_player_code_factory.cpp
+ * Builds a scripted player, picked by name from the environment
+ */
+
+#include "constants/constants.h"
+#include "players/player_code_factory.h"
+#include "scripted_players/scripted_players.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+using namespace Constants::Simulator;
+
+std::unique_ptr<player_wrapper::IPlayerCode>
+buildPlayerCode(int player_number) {
+    auto scripted_player_name =
+        std::getenv(SCRIPTED_PLAYER_ENV_VARS[player_number - 1].c_str());
+    if (scripted_player_name == nullptr) {
+        return std::make_unique<scripted_players::IdlePlayer>();
+    }
+
+    try {
+        return scripted_players::buildScriptedPlayer(scripted_player_name);
+    } catch (const std::invalid_argument &error) {
+        std::cerr << error.what() << '\n';
+        std::exit(EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * @file scripted_players.h
+ * Declarations for built in player AIs, which play full matches without the
+ * player code pipeline so that the engine can be benchmarked end to end
+ */
+
+#pragma once
+
+#include "physics/vector.hpp"
+#include "player_wrapper/interfaces/i_player_code.h"
+#include "scripted_players/scripted_players_export.h"
+#include "state/player_state.h"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace scripted_players {
+
+/**
+ * Player that never gives a command. Its bots stay in the base
+ */
+class SCRIPTED_PLAYERS_EXPORT IdlePlayer : public player_wrapper::IPlayerCode {
+  public:
+    player_state::State update(player_state::State state) override;
+};
+
+/**
+ * Player that spreads its bots over the flags, and sends them at the enemy
+ * base if the map has none. Exercises path planning
+ */
+class SCRIPTED_PLAYERS_EXPORT FlagRusher : public player_wrapper::IPlayerCode {
+  public:
+    player_state::State update(player_state::State state) override;
+};
+
+/**
+ * Player that transforms its bots into towers over its half of the map, and
+ * blasts its towers at enemy bots in range. Bots that cannot transform, once
+ * the sites are taken or the tower limit is reached, blast the enemy base.
+ * Exercises transformation and tower blasts
+ */
+class SCRIPTED_PLAYERS_EXPORT TowerSpammer
+    : public player_wrapper::IPlayerCode {
+  private:
+    /**
+     * Cells to build towers on, nearest to the player's base first. Found in
+     * the first turn, as the terrain is only known from the state
+     */
+    std::vector<DoubleVec2D> tower_sites;
+
+    /**
+     * Finds the tower sites of a map
+     */
+    void findTowerSites(const player_state::State &state);
+
+  public:
+    player_state::State update(player_state::State state) override;
+};
+
+/**
+ * Player that sends every bot to blast at the nearest enemy actor, and blasts
+ * bots that are already in range. Exercises blasts and pursuit
+ */
+class SCRIPTED_PLAYERS_EXPORT BlastSwarm : public player_wrapper::IPlayerCode {
+  public:
+    player_state::State update(player_state::State state) override;
+};
+
+/**
+ * Names the scripted players are built by
+ */
+const auto SCRIPTED_PLAYER_NAMES = std::array<std::string, 4>{
+    "idle", "flag_rusher", "tower_spammer", "blast_swarm"};
+
+/**
+ * Builds a scripted player by name
+ *
+ * @param name One of SCRIPTED_PLAYER_NAMES
+ * @return std::unique_ptr<player_wrapper::IPlayerCode>
+ *
+ * @throw std::invalid_argument If there is no scripted player of that name
+ */
+SCRIPTED_PLAYERS_EXPORT std::unique_ptr<player_wrapper::IPlayerCode>
+buildScriptedPlayer(const std::string &name);
+} // namespace scripted_players
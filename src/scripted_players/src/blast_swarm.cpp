@@ -0,0 +1,53 @@
+/**
+ * @file blast_swarm.cpp
+ * Definitions for the scripted player that swarms the enemy with blasts
+ */
+
+#include "scripted_players/scripted_players.h"
+
+#include <limits>
+
+namespace scripted_players {
+
+using namespace player_state;
+using namespace Constants::Actor;
+
+State BlastSwarm::update(State state) {
+    // Live enemy actors, which the bots go after
+    auto targets = std::vector<DoubleVec2D>{};
+    for (const auto &enemy_bot : state.enemy_bots) {
+        if (enemy_bot.state != BotState::DEAD) {
+            targets.push_back(enemy_bot.position);
+        }
+    }
+    for (const auto &enemy_tower : state.enemy_towers) {
+        if (enemy_tower.state != TowerState::DEAD) {
+            targets.push_back(enemy_tower.position);
+        }
+    }
+
+    for (auto &bot : state.bots) {
+        if (bot.state == BotState::DEAD || bot.state == BotState::BLAST) {
+            continue;
+        }
+
+        auto nearest_target = getEnemyBasePosition(state);
+        auto nearest_distance = std::numeric_limits<double>::max();
+        for (const auto &target : targets) {
+            auto distance = bot.position.distance(target);
+            if (distance < nearest_distance) {
+                nearest_target = target;
+                nearest_distance = distance;
+            }
+        }
+
+        if (nearest_distance <= BOT_BLAST_IMPACT_RADIUS) {
+            bot.blast();
+        } else {
+            bot.blast(nearest_target);
+        }
+    }
+
+    return state;
+}
+} // namespace scripted_players
@@ -0,0 +1,30 @@
+/**
+ * @file flag_rusher.cpp
+ * Definitions for the scripted player that rushes the flags
+ */
+
+#include "scripted_players/scripted_players.h"
+
+namespace scripted_players {
+
+using namespace player_state;
+
+State FlagRusher::update(State state) {
+    size_t num_flags = state.flag_offsets.size();
+
+    // Each bot keeps to the same flag from turn to turn
+    for (auto &bot : state.bots) {
+        if (bot.state == BotState::DEAD) {
+            continue;
+        }
+
+        if (num_flags == 0) {
+            bot.move(getEnemyBasePosition(state));
+        } else {
+            bot.move(state.flag_offsets[bot.id % num_flags]);
+        }
+    }
+
+    return state;
+}
+} // namespace scripted_players
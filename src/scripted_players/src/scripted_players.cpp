@@ -0,0 +1,29 @@
+/**
+ * @file scripted_players.cpp
+ * Definitions for the idle player, and for building scripted players by name
+ */
+
+#include "scripted_players/scripted_players.h"
+
+#include <stdexcept>
+
+namespace scripted_players {
+
+using namespace player_state;
+
+State IdlePlayer::update(State state) { return state; }
+
+std::unique_ptr<player_wrapper::IPlayerCode>
+buildScriptedPlayer(const std::string &name) {
+    if (name == "idle") {
+        return std::make_unique<IdlePlayer>();
+    } else if (name == "flag_rusher") {
+        return std::make_unique<FlagRusher>();
+    } else if (name == "tower_spammer") {
+        return std::make_unique<TowerSpammer>();
+    } else if (name == "blast_swarm") {
+        return std::make_unique<BlastSwarm>();
+    }
+    throw std::invalid_argument("No scripted player named " + name);
+}
+} // namespace scripted_players
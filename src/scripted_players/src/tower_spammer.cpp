@@ -0,0 +1,87 @@
+/**
+ * @file tower_spammer.cpp
+ * Definitions for the scripted player that covers its half of the map with
+ * towers
+ */
+
+#include "scripted_players/scripted_players.h"
+
+#include <algorithm>
+
+namespace scripted_players {
+
+using namespace player_state;
+using namespace Constants::Actor;
+
+/**
+ * Cells between tower sites along each axis, so that the towers spread out
+ */
+const size_t TOWER_SITE_SPACING = 3;
+
+void TowerSpammer::findTowerSites(const State &state) {
+    auto map_size = state.map.size();
+    for (size_t x = 0; x < map_size; x += TOWER_SITE_SPACING) {
+        for (size_t y = 0; x + y < map_size; y += TOWER_SITE_SPACING) {
+            if (state.map[x][y].getTerrain() == TerrainType::LAND) {
+                tower_sites.emplace_back(x + 0.5, y + 0.5);
+            }
+        }
+    }
+
+    std::stable_sort(tower_sites.begin(), tower_sites.end(),
+                     [](const DoubleVec2D &a, const DoubleVec2D &b) {
+                         return a.distance(PLAYER1_BASE_POSITION) <
+                                b.distance(PLAYER1_BASE_POSITION);
+                     });
+}
+
+State TowerSpammer::update(State state) {
+    if (tower_sites.empty()) {
+        findTowerSites(state);
+    }
+
+    // Sites that have not been built on yet
+    auto open_sites = std::vector<DoubleVec2D>{};
+    for (const auto &site : tower_sites) {
+        auto x = static_cast<size_t>(site.x), y = static_cast<size_t>(site.y);
+        if (state.map[x][y].getTerrain() == TerrainType::LAND) {
+            open_sites.push_back(site);
+        }
+    }
+
+    auto can_transform = !open_sites.empty() &&
+                         static_cast<size_t>(state.num_towers) < MAX_NUM_TOWERS;
+
+    // Bots keep their site from turn to turn while it stays open
+    for (auto &bot : state.bots) {
+        if (bot.state == BotState::DEAD || bot.state == BotState::BLAST ||
+            bot.state == BotState::TRANSFORM) {
+            continue;
+        }
+
+        if (can_transform) {
+            bot.transform(open_sites[bot.id % open_sites.size()]);
+        } else {
+            bot.blast(getEnemyBasePosition(state));
+        }
+    }
+
+    for (auto &tower : state.towers) {
+        if (tower.state != TowerState::IDLE ||
+            tower.age < TOWER_MIN_BLAST_AGE) {
+            continue;
+        }
+
+        for (const auto &enemy_bot : state.enemy_bots) {
+            if (enemy_bot.state != BotState::DEAD &&
+                tower.position.distance(enemy_bot.position) <=
+                    TOWER_BLAST_IMPACT_RADIUS) {
+                tower.blast();
+                break;
+            }
+        }
+    }
+
+    return state;
+}
+} // namespace scripted_players
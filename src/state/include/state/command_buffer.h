@@ -0,0 +1,258 @@
+/**
+ * @file command_buffer.h
+ * Fixed size records of the commands a player issues in a turn
+ */
+
+#pragma once
+
+#include "logger/error_type.h"
+#include "physics/vector.hpp"
+#include "state/game_limits.h"
+#include "state/span.h"
+#include "state/utilities.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace state {
+
+enum class CommandType : int8_t {
+    /**
+     * Move a bot to a position
+     */
+    MOVE_BOT,
+
+    /**
+     * Blast a bot at a position, moving there first if needed
+     */
+    BLAST_BOT,
+
+    /**
+     * Transform a bot into a tower at a position, moving there first if needed
+     */
+    TRANSFORM_BOT,
+
+    /**
+     * Blast a tower
+     */
+    BLAST_TOWER,
+
+    /**
+     * A command that was rejected on the player's side, to be logged as an
+     * error by the main process
+     */
+    REJECTED
+};
+
+/**
+ * A single command issued by a player
+ */
+struct Command {
+    CommandType type;
+
+    /**
+     * Error to log, for rejected commands
+     */
+    logger::ErrorType error_type;
+
+    /**
+     * Bot or tower the command is given to
+     */
+    ActorId actor_id;
+
+    /**
+     * Target position in the player's frame of reference, unused for tower
+     * blasts and rejected commands
+     */
+    DoubleVec2D position;
+};
+
+/**
+ * Commands issued by a player in one turn. Lives in shared memory, so the
+ * commands are stored right after the buffer in the same block of memory, as
+ * many as the limits of the game allow. Buffers are only created in place, by
+ * create, in a block of getSize bytes
+ *
+ * The player clears the buffer at the start of its turn and appends to it, and
+ * the main process reads it once the turn is over
+ */
+class CommandBuffer {
+  private:
+    /**
+     * Number of commands the buffer has room for
+     */
+    size_t max_num_commands;
+
+    explicit CommandBuffer(size_t max_num_commands)
+        : max_num_commands(max_num_commands), num_commands(0) {}
+
+    Command *getCommandSlots() { return reinterpret_cast<Command *>(this + 1); }
+
+    const Command *getCommandSlots() const {
+        return reinterpret_cast<const Command *>(this + 1);
+    }
+
+  public:
+    /**
+     * Number of commands issued in the present turn
+     */
+    size_t num_commands;
+
+    CommandBuffer(const CommandBuffer &) = delete;
+
+    CommandBuffer &operator=(const CommandBuffer &) = delete;
+
+    /**
+     * Bytes taken by a buffer with room for a number of commands
+     *
+     * @param max_num_commands
+     * @return size_t
+     */
+    static size_t getSize(size_t max_num_commands) {
+        return sizeof(CommandBuffer) + max_num_commands * sizeof(Command);
+    }
+
+    /**
+     * Creates an empty buffer in a block of memory
+     *
+     * @param memory Block of getSize(max_num_commands) bytes, aligned for a
+     * Command
+     * @param max_num_commands
+     * @return CommandBuffer*
+     */
+    static CommandBuffer *create(void *memory, size_t max_num_commands) {
+        return new (memory) CommandBuffer(max_num_commands);
+    }
+
+    /**
+     * Number of commands the buffer has room for
+     */
+    size_t getMaxNumCommands() const { return max_num_commands; }
+
+    /**
+     * Commands issued in the present turn. The player writes the count, so it
+     * is not trusted beyond the room in the buffer
+     *
+     * @return Span<const Command>
+     */
+    Span<const Command> getCommands() const {
+        return getCommands(max_num_commands);
+    }
+
+    /**
+     * Commands issued in the present turn, in a buffer the caller created
+     * with room for max_num_commands. Neither the count nor the room stored in
+     * the buffer is trusted, as another process may write both
+     *
+     * @param max_num_commands
+     * @return Span<const Command>
+     */
+    Span<const Command> getCommands(size_t max_num_commands) const {
+        size_t num_issued = num_commands;
+        return {getCommandSlots(), std::min(num_issued, max_num_commands)};
+    }
+
+    /**
+     * Removes all commands
+     */
+    void clear() { num_commands = 0; }
+
+    /**
+     * Appends a command
+     *
+     * @return false If the buffer is full and the command was dropped
+     */
+    bool push(Command command) {
+        if (num_commands >= max_num_commands) {
+            return false;
+        }
+        getCommandSlots()[num_commands++] = command;
+        return true;
+    }
+
+    /**
+     * Moves a bot to a position
+     */
+    bool moveBot(ActorId bot_id, DoubleVec2D position) {
+        return push(Command{CommandType::MOVE_BOT, logger::ErrorType{}, bot_id,
+                            position});
+    }
+
+    /**
+     * Blasts a bot at a position. Pass the bot's own position to blast in
+     * place
+     */
+    bool blastBot(ActorId bot_id, DoubleVec2D position) {
+        return push(Command{CommandType::BLAST_BOT, logger::ErrorType{}, bot_id,
+                            position});
+    }
+
+    /**
+     * Transforms a bot into a tower at a position. Pass the bot's own position
+     * to transform in place
+     */
+    bool transformBot(ActorId bot_id, DoubleVec2D position) {
+        return push(Command{CommandType::TRANSFORM_BOT, logger::ErrorType{},
+                            bot_id, position});
+    }
+
+    /**
+     * Blasts a tower
+     */
+    bool blastTower(ActorId tower_id) {
+        return push(Command{CommandType::BLAST_TOWER, logger::ErrorType{},
+                            tower_id, DoubleVec2D::null});
+    }
+
+    /**
+     * Records a command that was rejected before it reached the buffer
+     */
+    bool reject(logger::ErrorType error_type, ActorId actor_id) {
+        return push(Command{CommandType::REJECTED, error_type, actor_id,
+                            DoubleVec2D::null});
+    }
+};
+
+static_assert(sizeof(CommandBuffer) % alignof(Command) == 0,
+              "Commands follow the buffer");
+
+/**
+ * Owns a command buffer outside shared memory, as when replaying a game or in
+ * benchmarks and tests. Copies hold copies of the commands
+ */
+class CommandBufferStorage {
+  private:
+    /**
+     * Memory the buffer is created in, in words so that it is aligned for a
+     * Command
+     */
+    std::vector<uint64_t> memory;
+
+    static_assert(alignof(Command) <= alignof(uint64_t),
+                  "Words are aligned for a Command");
+
+  public:
+    explicit CommandBufferStorage(
+        size_t max_num_commands = GameLimits{}.getMaxNumCommands())
+        : memory((CommandBuffer::getSize(max_num_commands) +
+                  sizeof(uint64_t) - 1) /
+                 sizeof(uint64_t)) {
+        CommandBuffer::create(memory.data(), max_num_commands);
+    }
+
+    CommandBuffer &operator*() {
+        return *reinterpret_cast<CommandBuffer *>(memory.data());
+    }
+
+    const CommandBuffer &operator*() const {
+        return *reinterpret_cast<const CommandBuffer *>(memory.data());
+    }
+
+    CommandBuffer *operator->() { return &**this; }
+
+    const CommandBuffer *operator->() const { return &**this; }
+};
+} // namespace state
@@ -7,10 +7,12 @@
 #pragma once
 
 #include "logger/interfaces/i_logger.h"
+#include "state/game_limits.h"
 #include "state/interfaces/i_command_giver.h"
 #include "state/interfaces/i_command_taker.h"
 #include "state/utilities.h"
 #include <memory>
+#include <unordered_set>
 
 namespace state {
 class STATE_EXPORT CommandGiver : public ICommandGiver {
@@ -27,29 +29,46 @@ class STATE_EXPORT CommandGiver : public ICommandGiver {
     logger::ILogger *logger;
 
     /**
-     * Helper function to validate blast request by a bot and make
-     * command_taker call blastBot internally
+     * Size of the map and caps on the number of actors, which limit the towers
+     * built and place the bases that cannot be built on
+     */
+    GameLimits game_limits;
+
+    /**
+     * Actors that have been given a command in the present turn, as each
+     * actor may only be given one. Indexed by whether the actor is a tower, as
+     * a tower keeps the id of the bot it was built from
+     */
+    std::array<std::unordered_set<ActorId>, 2> commanded_actor_ids;
+
+    /**
+     * Helper function to validate a move request and make command_taker call
+     * moveBot internally
      */
-    void blastBot(ActorId actor_id, DoubleVec2D position);
+    void moveBot(PlayerId player_id, ActorId bot_id, DoubleVec2D position);
 
     /**
      * Helper function to validate blast request by a bot and make
-     * command_taker call blastTower internally
-     *
-     * @param actor_id
+     * command_taker call blastBot internally
      */
-    void blastTower(ActorId actor_id);
+    void blastBot(PlayerId player_id, ActorId bot_id, DoubleVec2D position);
 
     /**
      * Helper function to validate transform request and make command_taker call
      * TransformBot internally
+     *
+     * @param num_towers Number of towers the player has
      */
-    void transformBot(ActorId bot_id, DoubleVec2D position);
+    void transformBot(PlayerId player_id, ActorId bot_id, DoubleVec2D position,
+                      size_t num_towers);
 
     /**
-     * Helper function to make command_taker call MoveBot internally
+     * Helper function to validate blast request by a tower and make
+     * command_taker call blastTower internally
+     *
+     * @param tower Tower to blast
      */
-    void moveBot(ActorId bot_id, DoubleVec2D position);
+    void blastTower(PlayerId player_id, const Tower &tower);
 
     /**
      * Helper function to flip a bot position
@@ -60,15 +79,6 @@ class STATE_EXPORT CommandGiver : public ICommandGiver {
      */
     static DoubleVec2D flipBotPosition(const Map &map, DoubleVec2D position);
 
-    /**
-     * Helper function to flip a tower position
-     *
-     * @param map Reference to a map
-     * @param position Position to be flipped
-     * @return Vec2D Flipped position
-     */
-    static DoubleVec2D flipTowerPosition(const Map &map, DoubleVec2D position);
-
     /**
      * Helper function to check if given bot position is within the map
      *
@@ -100,29 +110,6 @@ class STATE_EXPORT CommandGiver : public ICommandGiver {
     static bool isValidTowerPosition(const Map &map, DoubleVec2D position,
                                      PlayerId player_id);
 
-    /**
-     * Helper function to check if the player has changed the bot state or not
-     *
-     * @param state_name  The bot's state according to the main state
-     * @param player_state_name  The bot's state according to the player state
-     * @return true  Player has changed the bot state
-     * @return false Player has not changed the bot state
-     */
-    static bool hasBotStateChanged(BotStateName state_name,
-                                   player_state::BotState player_state_name);
-
-    /**
-     * Helper function to check if the player has changed the tower state or not
-     *
-     * @param state_name The towers's state according to the main state
-     * @param player_state_name The tower's state according to the player state
-     * @return true Player has changed the tower state
-     * @return false Player has not changed the bot state
-     */
-    static bool
-    hasTowerStateChanged(TowerStateName state_name,
-                         player_state::TowerState player_state_name);
-
     /**
      * Helper function to check if given transform position is a spawn position
      *
@@ -131,26 +118,38 @@ class STATE_EXPORT CommandGiver : public ICommandGiver {
      * @return true Position is a spawn position
      * @return false Position is not a spawn position
      */
-    static bool isSpawnOffset(const Map &map, DoubleVec2D position,
-                              PlayerId player_id);
+    bool isSpawnOffset(const Map &map, DoubleVec2D position,
+                       PlayerId player_id) const;
+
+    /**
+     * Helper function to describe a command rejected on the player's side
+     *
+     * @param error_type Error the command was rejected with
+     * @return std::string Message to log
+     */
+    static std::string getRejectionMessage(logger::ErrorType error_type);
 
     /**
-     * Given a double position, make it not dangerous i.e., round it to 6
-     * decimals
-     * @param value
-     * @return sanitized double
+     * Helper function to check that a command has a known type, and a known
+     * error if it was rejected. The player writes the commands, so they may
+     * hold any value
+     *
+     * @param command
+     * @return true Command can be run or logged
+     * @return false Command is invalid
      */
-    static DoubleVec2D sanitize(DoubleVec2D position);
+    static bool isKnownCommand(const Command &command);
 
   public:
     CommandGiver();
 
-    CommandGiver(ICommandTaker *state, logger::ILogger *logger);
+    CommandGiver(ICommandTaker *state, logger::ILogger *logger,
+                 GameLimits game_limits = GameLimits{});
 
     /**
      * @see ICommandGiver#runCommands
      */
-    void runCommands(std::array<player_state::State, 2> &player_states,
+    void runCommands(std::array<const CommandBuffer *, 2> command_buffers,
                      std::array<bool, 2> skip_turns) override;
 };
 
@@ -0,0 +1,70 @@
+/**
+ * @file game_limits.h
+ * Size of the map and caps on the number of actors of a game
+ */
+
+#pragma once
+
+#include "constants/actor.h"
+#include "constants/map.h"
+#include "physics/vector.hpp"
+#include "state/utilities.h"
+
+#include <cstddef>
+
+namespace state {
+
+/**
+ * Size of the map and caps on the number of actors of a game, read from the
+ * header of the map file when the game starts. Everything sized by them, like
+ * the buffers shared with the player processes, is laid out from these rather
+ * than from the constants, which are only the defaults
+ */
+struct GameLimits {
+    /**
+     * Number of cells per side of the map
+     */
+    size_t map_size = Constants::Map::MAP_SIZE;
+
+    /**
+     * Most bots a player may have at once
+     */
+    size_t max_num_bots = Constants::Actor::MAX_NUM_BOTS;
+
+    /**
+     * Most towers a player may have at once
+     */
+    size_t max_num_towers = Constants::Actor::MAX_NUM_TOWERS;
+
+    /**
+     * Most commands a player may issue in a turn. Leaves room for one command
+     * per actor, plus as many again that are rejected
+     */
+    size_t getMaxNumCommands() const {
+        return 2 * (max_num_bots + max_num_towers);
+    }
+
+    /**
+     * Position of a player's base. Player 2's base is the flipped position of
+     * player 1's, in the far corner of the map
+     *
+     * @param player_id
+     * @return DoubleVec2D
+     */
+    DoubleVec2D getBasePosition(PlayerId player_id) const {
+        auto const &base_position = Constants::Map::PLAYER1_BASE_POSITION;
+        if (player_id == PlayerId::PLAYER2) {
+            return {map_size - base_position.x, map_size - base_position.y};
+        }
+        return base_position;
+    }
+
+    bool operator==(const GameLimits &other) const {
+        return map_size == other.map_size &&
+               max_num_bots == other.max_num_bots &&
+               max_num_towers == other.max_num_towers;
+    }
+
+    bool operator!=(const GameLimits &other) const { return !(*this == other); }
+};
+} // namespace state
@@ -5,7 +5,7 @@
 
 #pragma once
 
-#include "state/player_state.h"
+#include "state/command_buffer.h"
 #include "state/state_export.h"
 #include <array>
 
@@ -15,13 +15,15 @@ class STATE_EXPORT ICommandGiver {
     virtual ~ICommandGiver() = default;
 
     /**
-     * Runs the necessary commands on the command taker (state)
+     * Validates the players' commands and runs the valid ones on the command
+     * taker (state)
      *
-     * @param[in] player_states Player state from which we get commands to run
+     * @param[in] command_buffers Commands issued by each player this turn
      * @param[in] skip_turn If true for a player, turn is not processed
      */
-    virtual void runCommands(std::array<player_state::State, 2> &player_states,
-                             std::array<bool, 2> skip_turn) = 0;
+    virtual void
+    runCommands(std::array<const CommandBuffer *, 2> command_buffers,
+                std::array<bool, 2> skip_turn) = 0;
 };
 
 } // namespace state
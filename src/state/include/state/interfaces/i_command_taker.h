@@ -10,6 +10,8 @@
 #include "state/actor/tower.h"
 #include "state/interfaces/i_updatable.h"
 #include "state/map/map.h"
+#include "state/span.h"
+#include "state/state_digest.h"
 #include "state/transform_request.h"
 #include "state/utilities.h"
 
@@ -97,30 +99,64 @@ class STATE_EXPORT ICommandTaker {
     virtual std::array<uint64_t, 2> getScores() const = 0;
 
     /**
-     * Returns all the bots in the state
+     * Get a digest of the whole game state, which is the same for equal
+     * states however the actors happen to be stored
      *
-     * @return bots
+     * @return StateDigest
      */
-    virtual std::array<std::vector<Bot *>, 2> getBots() = 0;
+    virtual StateDigest getDigest() const = 0;
 
     /**
-     * Returns all the towers in the state
+     * Returns the bots of a player, without copying them. The span is
+     * invalidated when bots are added or removed
      *
-     * @return towers
+     * @param player_id
+     * @return Span<Bot *const>
      */
-    virtual std::array<std::vector<Tower *>, 2> getTowers() = 0;
+    virtual Span<Bot *const> getBots(PlayerId player_id) = 0;
 
     /**
-     * Get the Transform Requests object
+     * Returns the towers of a player, without copying them. The span is
+     * invalidated when towers are added or removed
      *
-     * @return std::array<std::vector<TransformRequest *>, 2>
+     * @param player_id
+     * @return Span<Tower *const>
      */
-    virtual std::array<std::vector<TransformRequest *>, 2>
-    getTransformRequests() = 0;
+    virtual Span<Tower *const> getTowers(PlayerId player_id) = 0;
+
+    /**
+     * Finds a bot by its actor id
+     *
+     * @param bot_id
+     * @return Bot* The bot, nullptr if there is no such bot
+     */
+    virtual Bot *getBotById(ActorId bot_id) = 0;
+
+    /**
+     * Finds a tower by its actor id
+     *
+     * @param tower_id
+     * @return Tower* The tower, nullptr if there is no such tower
+     */
+    virtual Tower *getTowerById(ActorId tower_id) = 0;
+
+    /**
+     * Returns the transform requests of a player issued in this turn
+     *
+     * @param player_id
+     * @return Span<TransformRequest *const>
+     */
+    virtual Span<TransformRequest *const>
+    getTransformRequests(PlayerId player_id) = 0;
 
     /**
      * Removes all the dead actors from state
      */
     virtual void removeDeadActors() = 0;
+
+    /**
+     * Releases the data allocated while simulating the present turn
+     */
+    virtual void resetTurnArena() = 0;
 };
 } // namespace state
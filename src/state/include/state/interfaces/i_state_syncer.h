@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "state/command_buffer.h"
 #include "state/player_state.h"
 #include "state/utilities.h"
 
@@ -18,11 +19,13 @@ class STATE_EXPORT IStateSyncer {
 
     /**
      * Method to update the main state
+     * @param [in] command_buffers Commands issued by the two players
      * @param [in] player_states Reference to the two player states
      * @param [in] skip_turn True if player's turns shouldn't be executed
      */
     virtual void
-    updateMainState(std::array<player_state::State, 2> &player_states,
+    updateMainState(std::array<const CommandBuffer *, 2> command_buffers,
+                    std::array<player_state::State, 2> &player_states,
                     std::array<bool, 2> skip_turns) = 0;
 
     /**
@@ -0,0 +1,170 @@
+/**
+ * @file compiled_map.h
+ * Declares the CompiledMap class, a map file with its waypoint graph found
+ * ahead of time and stored in a binary file that is mapped into memory
+ */
+
+#pragma once
+
+#include "physics/vector.hpp"
+#include "state/map/map.h"
+#include "state/path_planner/path_graph.h"
+#include "state/span.h"
+#include "state/state_digest.h"
+#include "state/state_export.h"
+#include "state/utilities.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace state {
+
+/**
+ * Version of the compiled map layout, and of the way its waypoint graph is
+ * found. Files of other versions are rejected, so it must be bumped whenever
+ * either changes
+ */
+const uint32_t COMPILED_MAP_VERSION = 1;
+
+/**
+ * Extension of compiled map files
+ */
+const auto COMPILED_MAP_EXTENSION = ".ccmap";
+
+/**
+ * Static data of a map read straight from a compiled map file, written by the
+ * map_compiler tool. The file holds the terrain, the flags, and the waypoint
+ * graph of the terrain with the visibility tables of its cells and corners,
+ * each in a flat array that is used in place without being parsed or copied.
+ * Optionally, it also holds the distances between every pair of waypoints
+ *
+ * The file is named by the digest of the map file it was compiled from, so a
+ * changed map file never picks up a stale compiled map. Numbers are stored in
+ * the byte order of the machine that wrote them, like any other build output
+ */
+class STATE_EXPORT CompiledMap {
+  private:
+    /**
+     * Mapping of the file, kept open while the views below are in use
+     */
+    boost::interprocess::file_mapping file;
+    boost::interprocess::mapped_region region;
+
+    /**
+     * Number of cells per side of the map
+     */
+    size_t map_size = 0;
+
+    /**
+     * Digest of the map file the compiled map was made from
+     */
+    StateDigest map_digest = {0, 0};
+
+    /**
+     * Terrain of each cell, indexed by x * map_size + y
+     */
+    Span<const uint8_t> terrain;
+
+    /**
+     * Offsets of the flag cells
+     */
+    Span<const Vec2D> flags;
+
+    /**
+     * Waypoint graph of the terrain
+     */
+    WaypointGraphView waypoint_graph;
+
+    /**
+     * Get a section of the file as an array, after checking that it lies
+     * inside the file
+     * @tparam T Element type
+     * @param section Index of the section in the header
+     * @return Span<const T>
+     *
+     * @throw std::runtime_error If the section is out of bounds or misaligned
+     */
+    template <typename T> Span<const T> getSection(size_t section) const;
+
+  public:
+    /**
+     * Map a compiled map file and check it
+     * @param file_name
+     *
+     * @throw std::runtime_error If the file cannot be read, is of another
+     * version, or is malformed
+     */
+    explicit CompiledMap(const std::string &file_name);
+
+    /**
+     * Write a compiled map file. It is written beside the file name first and
+     * then renamed, so that a file being read is never half written
+     * @param file_name
+     * @param map_digest Digest of the map file, from getMapTextDigest
+     * @param map
+     * @param waypoint_graph Waypoint graph of the terrain of the map
+     *
+     * @throw std::runtime_error If the file cannot be written
+     */
+    static void write(const std::string &file_name, StateDigest map_digest,
+                      const Map &map, const WaypointGraphView &waypoint_graph);
+
+    /**
+     * Digest of the contents of a map file, which names its compiled map
+     * @param map_text
+     * @return StateDigest
+     */
+    static StateDigest getMapTextDigest(const std::string &map_text);
+
+    /**
+     * Name of the compiled map file of a map file, inside the map cache
+     * @param map_digest Digest of the map file
+     * @return std::string
+     */
+    static std::string getFileName(StateDigest map_digest);
+
+    /**
+     * Get the number of cells per side of the map
+     * @return size_t
+     */
+    size_t getMapSize() const;
+
+    /**
+     * Get the digest of the map file the compiled map was made from
+     * @return StateDigest
+     */
+    StateDigest getMapDigest() const;
+
+    /**
+     * Get the terrain of a cell
+     * @param x
+     * @param y
+     * @return TerrainType
+     */
+    TerrainType getTerrainType(size_t x, size_t y) const;
+
+    /**
+     * Get the terrain of the map, as Map holds it
+     * @return std::vector<std::vector<TerrainType>>
+     */
+    std::vector<std::vector<TerrainType>> getTerrain() const;
+
+    /**
+     * Get the offsets of the flag cells, in ascending order
+     * @return Span<const Vec2D>
+     */
+    Span<const Vec2D> getFlags() const;
+
+    /**
+     * Get the waypoint graph of the terrain, valid while this is alive
+     * @return const WaypointGraphView&
+     */
+    const WaypointGraphView &getWaypointGraph() const;
+};
+
+} // namespace state
@@ -5,37 +5,76 @@
 
 #pragma once
 
+#include "physics/fixed_vector.hpp"
 #include "physics/vector.hpp"
 #include "state/path_planner/graph/open_list_entry.h"
+#include "state/span.h"
+#include "state/turn_arena.h"
 #include <boost/unordered_map.hpp>
 #include <boost/unordered_set.hpp>
 #include <cstring>
 #include <queue>
+#include <vector>
 
 namespace state {
-typedef std::priority_queue<std::pair<double_t, DoubleVec2D>,
-                            std::vector<std::pair<double_t, DoubleVec2D>>,
+typedef std::priority_queue<std::pair<double_t, FixedVec2D>,
+                            std::vector<std::pair<double_t, FixedVec2D>>,
                             std::greater<>>
     Heap;
 
-typedef boost::unordered::unordered_map<DoubleVec2D, double_t> EdgeList;
+typedef boost::unordered::unordered_map<FixedVec2D, double_t> EdgeList;
 
-class Graph {
-  private:
+/**
+ * Estimates of the cost from a node to the end of a path, which guide a search
+ * towards the end
+ */
+enum class PathHeuristic {
+    // Straight line distance to the end
+    EUCLIDEAN,
+
+    // The larger of the straight line distance and the bound given by the
+    // distances of landmark nodes to the node and to the end, which accounts
+    // for the obstacles between them
+    LANDMARKS
+};
+
+/**
+ * Counts of the work done by path searches
+ */
+struct PathSearchStats {
     /**
-     * List of all nodes in map
+     * Number of searches run
      */
-    boost::unordered_set<DoubleVec2D> nodes;
+    size_t num_searches = 0;
 
     /**
-     * Adjacency List for the nodes in graph
+     * Number of nodes taken off the open list and expanded, over all searches
      */
-    boost::unordered::unordered_map<DoubleVec2D, EdgeList> adjacency_list;
+    size_t num_expanded_nodes = 0;
 
+    /**
+     * Number of path queries answered without a search of their own, as they
+     * were asked before or shared a search with queries to the same end
+     */
+    size_t num_saved_searches = 0;
+
+    PathSearchStats &operator+=(const PathSearchStats &rhs) {
+        num_searches += rhs.num_searches;
+        num_expanded_nodes += rhs.num_expanded_nodes;
+        num_saved_searches += rhs.num_saved_searches;
+        return *this;
+    }
+};
+
+/**
+ * Scratch space for a path search. Searches of the same graph can run on
+ * several threads at once, as long as each has its own search space
+ */
+struct PathSearch {
     /**
      * Map of Node and corresponding open list entry
      */
-    boost::unordered::unordered_map<DoubleVec2D, OpenListEntry>
+    boost::unordered::unordered_map<FixedVec2D, OpenListEntry>
         open_list_entries;
 
     /**
@@ -43,21 +82,163 @@ class Graph {
      */
     Heap open_list_heap;
 
+    /**
+     * Edges from the start to nodes of the graph, used if the start is not
+     * itself a node. Includes the edge to the end, if the end is not a node
+     * either
+     */
+    EdgeList start_edges;
+
+    /**
+     * Edges from nodes of the graph to the end, used if the end is not itself
+     * a node
+     */
+    EdgeList end_edges;
+
+    /**
+     * Distance from each landmark to the end, found through the end's edges
+     * if the end is not a node
+     */
+    std::vector<double_t> landmark_end_distances;
+
+    /**
+     * For each landmark, the greatest distance to a node joined to the end
+     * less the cost of its edge to the end. The same as the distance to the
+     * end if the end is a node
+     */
+    std::vector<double_t> landmark_end_reaches;
+
+    /**
+     * End and landmark epoch the landmark bounds were found for. Searches to
+     * the same end reuse the bounds while the landmarks stay the same
+     */
+    DoubleVec2D landmark_bounds_end = DoubleVec2D::null;
+    uint64_t landmark_bounds_epoch = 0;
+
+    /**
+     * Work done by the searches that used this search space
+     */
+    PathSearchStats stats;
+
+    /**
+     * Arena that the path is allocated from, nullptr to use the heap
+     */
+    TurnArena *turn_arena = nullptr;
+};
+
+/**
+ * Distances between every pair of nodes of a graph, found ahead of time
+ */
+struct NodeDistances {
+    /**
+     * Nodes, in ascending order
+     */
+    Span<const FixedVec2D> nodes;
+
+    /**
+     * Distance between the i-th and j-th nodes at i * nodes.size() + j,
+     * infinite if they are not connected
+     */
+    Span<const double_t> distances;
+};
+
+/**
+ * Graph of positions, which are kept in fixed point so that nodes are compared
+ * and hashed exactly. Paths are found between positions in cells, and only the
+ * start and end of a path need not be nodes
+ */
+class Graph {
+  private:
+    /**
+     * List of all nodes in map
+     */
+    boost::unordered_set<FixedVec2D> nodes;
+
+    /**
+     * Adjacency List for the nodes in graph
+     */
+    boost::unordered::unordered_map<FixedVec2D, EdgeList> adjacency_list;
+
+    /**
+     * Heuristic that paths are searched with
+     */
+    PathHeuristic heuristic = PathHeuristic::EUCLIDEAN;
+
+    /**
+     * Nodes that the landmark heuristic measures distances from
+     */
+    std::vector<FixedVec2D> landmarks;
+
+    /**
+     * Distance of each node from every landmark, in the order of landmarks.
+     * Infinite if the landmark cannot reach the node. Cleared whenever the
+     * graph changes, leaving the straight line distance as the heuristic
+     */
+    boost::unordered::unordered_map<FixedVec2D, std::vector<double_t>>
+        landmark_distances;
+
+    /**
+     * Identifies the landmarks, among those of every graph, so that search
+     * spaces can tell whether the bounds they keep still hold. 0 if there are
+     * no landmarks
+     */
+    uint64_t landmark_epoch = 0;
+
+    /**
+     * Discard the landmarks, when the graph changes
+     */
+    void clearLandmarks();
+
+    /**
+     * Search space for the paths found with getPath
+     */
+    PathSearch search;
+
     /**
      * Initialize the openListEntries and openListHeap for a
      * given start node to destination node
      * @param start_node
-     * @param destination_node
+     * @param start_position Exact position of the start node
+     * @param destination_position
+     * @param search
      */
-    void initOpenList(DoubleVec2D start_node,
-                      const DoubleVec2D &destination_node);
+    static void initOpenList(FixedVec2D start_node,
+                             const DoubleVec2D &start_position,
+                             const DoubleVec2D &destination_position,
+                             PathSearch &search);
 
     /**
      * Get the next position in the open list with smallest total cost
      * @param next_position
+     * @param search
      * @return next node in open list
      */
-    bool getBestNextPosition(DoubleVec2D &next_position);
+    static bool getBestNextPosition(FixedVec2D &next_position,
+                                    PathSearch &search);
+
+    /**
+     * Set the landmark distances to the end of a search, from which the
+     * landmark heuristic bounds the cost of reaching the end
+     * @param destination_node
+     * @param destination_position Exact position of the final destination
+     * @param search Search space, with the edges of the end set
+     */
+    void initLandmarkBounds(FixedVec2D destination_node,
+                            const DoubleVec2D &destination_position,
+                            PathSearch &search) const;
+
+    /**
+     * Estimate the cost from a node to the destination, without
+     * overestimating it
+     * @param node
+     * @param destination_position Exact position of the final destination
+     * @param search
+     * @return double_t Estimated cost, infinite if the node cannot reach the
+     * destination
+     */
+    double_t estimateCost(FixedVec2D node,
+                          const DoubleVec2D &destination_position,
+                          const PathSearch &search) const;
 
     /**
      * Update the open list details of one neighbour of a node
@@ -65,12 +246,25 @@ class Graph {
      * @param neighbour_node
      * @param distance
      * @param destination_node Final destination
+     * @param destination_position Exact position of the final destination
+     * @param search
      */
-    void updateNeighbour(DoubleVec2D current_node, DoubleVec2D neighbour_node,
-                         double_t distance,
-                         const DoubleVec2D &destination_node);
+    void updateNeighbour(FixedVec2D current_node, FixedVec2D neighbour_node,
+                         double_t distance, FixedVec2D destination_node,
+                         const DoubleVec2D &destination_position,
+                         PathSearch &search) const;
 
-    std::vector<DoubleVec2D> generateOpenListPath(DoubleVec2D node);
+    /**
+     * Trace the path back from the destination to the start
+     * @param destination_node
+     * @param destination_position Exact position of the destination, which
+     * ends the path
+     * @param search
+     */
+    static ArenaVector<DoubleVec2D>
+    generateOpenListPath(FixedVec2D destination_node,
+                         const DoubleVec2D &destination_position,
+                         PathSearch &search);
 
   public:
     /**
@@ -81,13 +275,19 @@ class Graph {
     /**
      * Get nodes
      */
-    boost::unordered_set<DoubleVec2D> getNodes() const;
+    boost::unordered_set<FixedVec2D> getNodes() const;
+
+    /**
+     * Get nodes without copying them. The reference is invalidated when nodes
+     * are added or removed
+     */
+    const boost::unordered_set<FixedVec2D> &getNodeSet() const;
 
     /**
      * Check node exists
      * @param node Node to be checked
      */
-    bool checkNodeExists(const DoubleVec2D &node) const;
+    bool checkNodeExists(const FixedVec2D &node) const;
 
     /**
      * Check if edge exists between two positions
@@ -95,20 +295,36 @@ class Graph {
      * @param node_b
      * @return bool true, if there is an edge between two positions
      */
-    bool checkEdgeExists(const DoubleVec2D &position_a,
-                         const DoubleVec2D &position_b);
+    bool checkEdgeExists(const FixedVec2D &position_a,
+                         const FixedVec2D &position_b) const;
+
+    /**
+     * Get the edges of a node
+     * @param node Node of the graph
+     * @return const EdgeList&
+     */
+    const EdgeList &getEdges(const FixedVec2D &node) const;
+
+    /**
+     * Find the distance of every node reachable from a node, with Dijkstra's
+     * algorithm
+     * @param source
+     * @return Distances of the reachable nodes
+     */
+    boost::unordered::unordered_map<FixedVec2D, double_t>
+    findDistances(FixedVec2D source) const;
 
     /**
      * Add a new node to the list of nodes
      * @param position
      */
-    void addNode(DoubleVec2D position);
+    void addNode(FixedVec2D position);
 
     /**
      * Remove a node from the list of nodes
      * @param position
      */
-    void removeNode(DoubleVec2D position);
+    void removeNode(FixedVec2D position);
 
     /**
      * Add an edge between two positions
@@ -116,7 +332,7 @@ class Graph {
      * @param end_position
      * @param cost Cost of traversing from start position to end position
      */
-    void addEdge(DoubleVec2D start_position, DoubleVec2D end_position,
+    void addEdge(FixedVec2D start_position, FixedVec2D end_position,
                  double_t cost);
 
     /**
@@ -124,21 +340,110 @@ class Graph {
      * @param start_position
      * @param end_position
      */
-    void removeEdge(DoubleVec2D start_position, DoubleVec2D end_position);
+    void removeEdge(FixedVec2D start_position, FixedVec2D end_position);
 
     /**
      * Clear all graph nodes and edges
      */
     void resetGraph();
 
+    /**
+     * Set the arena that paths are allocated from
+     * @param turn_arena Arena, nullptr to use the heap
+     */
+    void setTurnArena(TurnArena *turn_arena);
+
+    /**
+     * Set the heuristic that paths are searched with
+     * @param p_heuristic
+     */
+    void setHeuristic(PathHeuristic p_heuristic);
+
+    /**
+     * Get the heuristic that paths are searched with
+     */
+    PathHeuristic getHeuristic() const;
+
+    /**
+     * Pick landmarks spread over the graph, each the node farthest from the
+     * landmarks before it, and find the distance of every node from them.
+     * Called once the graph is complete, as any change to it discards them
+     * @param num_landmarks Largest number of landmarks to pick
+     * @param known_distances Distances between the nodes of this graph found
+     * ahead of time, which are looked up rather than searched for. Empty if
+     * there are none
+     */
+    void computeLandmarks(size_t num_landmarks,
+                          const NodeDistances &known_distances = {});
+
+    /**
+     * Get the landmarks picked by computeLandmarks
+     */
+    const std::vector<FixedVec2D> &getLandmarks() const;
+
+    /**
+     * Get the work done by the searches of getPath
+     */
+    const PathSearchStats &getSearchStats() const;
+
     /**
      * Get the next node to move in the shortest path from start to end
      * @param start_position
      * @param end_position
-     * @return std::vector<DoubleVec2D> next node in the path
+     * @return ArenaVector<DoubleVec2D> next node in the path, valid until the
+     * turn arena is reset
      */
-    std::vector<DoubleVec2D> getPath(DoubleVec2D start_position,
+    ArenaVector<DoubleVec2D> getPath(DoubleVec2D start_position,
                                      DoubleVec2D end_position);
+
+    /**
+     * Get the shortest path from start to end without modifying the graph.
+     * The start and end need not be nodes, in which case they are joined to
+     * the graph by the edges in the search space
+     * @param start_position
+     * @param end_position
+     * @param search Search space, with the edges of the start and end set.
+     * The edges of an end must not change while the graph does not, as the
+     * landmark bounds found from them are kept for later searches to the end
+     * @return ArenaVector<DoubleVec2D> next node in the path, allocated from
+     * the arena of the search space
+     */
+    ArenaVector<DoubleVec2D> findPath(DoubleVec2D start_position,
+                                      DoubleVec2D end_position,
+                                      PathSearch &search) const;
+
+    /**
+     * Find the shortest paths from several starts to one end with a single
+     * search backwards from the end, with Dijkstra's algorithm. Each node
+     * found is left in the open list entries of the search space, with its
+     * distance to the end as its g value and the next node of its path as its
+     * parent
+     * @param end_position
+     * @param start_edges Edges from each start to nodes of the graph, or a
+     * single edge of no cost to the start itself if it is a node. The search
+     * stops once the shortest path from every start is found
+     * @param search Search space, with the edges of the end set
+     */
+    void findPathTree(DoubleVec2D end_position,
+                      const std::vector<EdgeList> &start_edges,
+                      PathSearch &search) const;
+
+    /**
+     * Get the shortest path from a start to the end of the paths found by
+     * findPathTree
+     * @param start_position
+     * @param end_position
+     * @param start_edges Edges from the start to nodes of the graph, used if
+     * the start is not a node
+     * @param search Search space holding the paths to the end, found with
+     * the start among the starts
+     * @return ArenaVector<DoubleVec2D> Waypoints of the path, allocated from
+     * the arena of the search space
+     */
+    ArenaVector<DoubleVec2D> getTreePath(DoubleVec2D start_position,
+                                         DoubleVec2D end_position,
+                                         const EdgeList &start_edges,
+                                         PathSearch &search) const;
 };
 
 } // namespace state
@@ -5,7 +5,7 @@
 
 #pragma once
 
-#include "physics/vector.hpp"
+#include "physics/fixed_vector.hpp"
 
 namespace state {
 
@@ -16,15 +16,15 @@ struct OpenListEntry {
     double_t g_value{0};
 
     /**
-     * Heuristic cost to reach from node to destination in a-star
-     * It is the euclidean distance between them
+     * Heuristic cost to reach from node to destination in a-star, which never
+     * overestimates the cost
      */
     double_t h_value{0};
 
     /**
      * Previous node in the a-star path generated
      */
-    DoubleVec2D parent;
+    FixedVec2D parent;
 
     /**
      * Track whether the node is open
@@ -0,0 +1,272 @@
+/**
+ * @file hierarchical_path_graph.h
+ * Declares a path finder that plans over chunks of the map, for maps too
+ * large for a graph of every waypoint
+ */
+
+#pragma once
+
+#include "state/path_planner/graph/graph.h"
+#include "state/path_planner/path_graph.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace state {
+
+/**
+ * Cells per side of the chunks that the hierarchical path finder divides the
+ * map into
+ */
+const size_t PATH_CHUNK_SIZE = 10;
+
+/**
+ * Open stretches of a chunk border at least this long get an entrance at
+ * each end, and shorter ones a single entrance in the middle
+ */
+const size_t PATH_ENTRANCE_SPLIT_LENGTH = 6;
+
+/**
+ * Hierarchical path finder (HPA*)
+ *
+ * The map is divided into square chunks. Each open stretch of a border
+ * between two chunks gets entrances, pairs of cells facing each other across
+ * the border. The abstract graph has a node at the center of every entrance
+ * cell, joined to the other entrances of its chunk by their shortest distance
+ * inside the chunk, and to the cell facing it by one step. A path is searched
+ * for in the abstract graph, refined into moves between neighbouring cells a
+ * chunk at a time, and smoothed by skipping the cells in line of sight
+ *
+ * Cells are moved between along rows, columns and diagonals. A diagonal move
+ * only touches the corners of the cells beside it, so it is open even if they
+ * are closed, as a straight line between the cells is. Paths are not always
+ * the shortest, but the work to rebuild the graph when a cell changes is
+ * limited to its chunk, and the chunk across the border if the cell's
+ * entrances change
+ */
+class HierarchicalPathGraph {
+  private:
+    /**
+     * Entrances of a chunk, which are joined by edges in the abstract graph
+     * where they are joined inside the chunk
+     */
+    struct Chunk {
+        /**
+         * Cells of the chunk's entrances, as x * map_size + y, in increasing
+         * order
+         */
+        std::vector<int64_t> entrances;
+
+        /**
+         * False once a cell of the chunk or its entrances have changed
+         */
+        bool is_current = false;
+    };
+
+    /**
+     * Pairs of cells facing each other across a chunk border, the first cell
+     * in the chunk to the left of or below the border
+     */
+    typedef std::vector<std::pair<int64_t, int64_t>> BorderEntrances;
+
+    /**
+     * Terrain the paths are found on, and the line of sight checks the paths
+     * are smoothed with
+     */
+    const PathGraph *terrain = nullptr;
+
+    /**
+     * The size of the map
+     */
+    size_t map_size = 0;
+
+    /**
+     * Cells per side of a chunk
+     */
+    size_t chunk_size = PATH_CHUNK_SIZE;
+
+    /**
+     * Chunks per side of the map
+     */
+    size_t num_chunks_per_side = 0;
+
+    /**
+     * Chunks, indexed by chunk_x * num_chunks_per_side + chunk_y
+     */
+    std::vector<Chunk> chunks;
+
+    /**
+     * Entrances across the border on the right and the top of each chunk,
+     * indexed as the chunks are
+     */
+    std::vector<BorderEntrances> right_borders;
+    std::vector<BorderEntrances> top_borders;
+
+    /**
+     * False once a cell beside the border on the right or the top of each
+     * chunk has changed
+     */
+    std::vector<bool> is_right_border_current;
+    std::vector<bool> is_top_border_current;
+
+    /**
+     * Graph of entrances
+     */
+    Graph graph;
+
+    /**
+     * Search space for the paths found with getPath
+     */
+    PathSearch search;
+
+    /**
+     * Cell index of a cell, x * map_size + y
+     * @param x
+     * @param y
+     * @return int64_t
+     */
+    int64_t getCellIndex(int64_t x, int64_t y) const;
+
+    /**
+     * Center of a cell, the abstract graph's node for an entrance cell
+     * @param cell Cell index
+     * @return FixedVec2D
+     */
+    FixedVec2D getCellCenter(int64_t cell) const;
+
+    /**
+     * Chunk holding a cell
+     * @param cell Cell index
+     * @return size_t Chunk index
+     */
+    size_t getChunkIndex(int64_t cell) const;
+
+    /**
+     * Find the open cell that a position lies in, or one of the open cells it
+     * lies on the edge of
+     * @param position
+     * @return int64_t Cell index, -1 if the position touches no open cell
+     */
+    int64_t findCell(const DoubleVec2D &position) const;
+
+    /**
+     * Find the entrances across the border on the right or the top of a chunk
+     * @param chunk_index
+     * @param is_right_border
+     * @return BorderEntrances
+     */
+    BorderEntrances findBorderEntrances(size_t chunk_index,
+                                        bool is_right_border) const;
+
+    /**
+     * Find the distance of every cell of a chunk from one of its cells,
+     * moving inside the chunk only
+     * @param chunk_index
+     * @param source Cell index of a cell in the chunk
+     * @param distances Distance of each cell of the chunk, indexed by
+     * (x - chunk x) * chunk_size + (y - chunk y). Infinite if unreachable
+     * @param parents Cell index each cell is reached from, -1 for the source
+     * and unreachable cells
+     */
+    void searchChunk(size_t chunk_index, int64_t source,
+                     std::vector<double_t> &distances,
+                     std::vector<int64_t> &parents) const;
+
+    /**
+     * Index of a cell in the distances found by searchChunk
+     * @param chunk_index
+     * @param cell Cell index of a cell in the chunk
+     * @return size_t
+     */
+    size_t getChunkCellIndex(size_t chunk_index, int64_t cell) const;
+
+    /**
+     * Recalculate the entrances of a chunk from its borders, and the edges
+     * between them in the abstract graph
+     * @param chunk_index
+     */
+    void recomputeChunk(size_t chunk_index);
+
+    /**
+     * Append the cells of the shortest path inside a chunk from one cell to
+     * another, without the first
+     * @param chunk_index Chunk holding both cells
+     * @param from Cell index
+     * @param to Cell index
+     * @param cells
+     */
+    void appendChunkPath(size_t chunk_index, int64_t from, int64_t to,
+                         std::vector<int64_t> &cells) const;
+
+  public:
+    /**
+     * Default constructor
+     */
+    HierarchicalPathGraph();
+
+    /**
+     * Constructor. Nothing is calculated until recompute is called
+     * @param p_terrain Terrain to find paths on, which must outlive this
+     * @param p_map_size Size of map
+     * @param p_chunk_size Cells per side of a chunk
+     */
+    HierarchicalPathGraph(const PathGraph *p_terrain, size_t p_map_size,
+                          size_t p_chunk_size = PATH_CHUNK_SIZE);
+
+    /**
+     * Set the arena for the vectors made while finding paths
+     * @param turn_arena Arena, nullptr to use the heap
+     */
+    void setTurnArena(TurnArena *turn_arena);
+
+    /**
+     * Mark a cell of the terrain as changed, so that its chunk, and the
+     * borders it lies on, are recalculated by the next recompute
+     * @param cell Offset of the cell
+     */
+    void invalidateCell(const Vec2D &cell);
+
+    /**
+     * Recalculate the entrances and the abstract graph for the cells changed
+     * since the last recompute
+     * @return size_t Number of chunks recalculated
+     */
+    size_t recompute();
+
+    /**
+     * Get the graph of entrances
+     */
+    const Graph &getGraph() const;
+
+    /**
+     * Get the work done by the abstract searches of getPath without a search
+     * space
+     * @return const PathSearchStats&
+     */
+    const PathSearchStats &getSearchStats() const;
+
+    /**
+     * Get path from one position to another
+     * @param start_position
+     * @param end_position
+     * @return Waypoints of the path, valid until the turn arena is reset
+     */
+    ArenaVector<DoubleVec2D> getPath(DoubleVec2D start_position,
+                                     DoubleVec2D end_position);
+
+    /**
+     * Get path from one position to another without modifying the graph, so
+     * that paths can be found on several threads at once
+     * @param start_position
+     * @param end_position
+     * @param search Search space of the calling thread
+     * @return Waypoints of the path, allocated from the arena of the search
+     * space
+     */
+    ArenaVector<DoubleVec2D> getPath(DoubleVec2D start_position,
+                                     DoubleVec2D end_position,
+                                     PathSearch &search) const;
+};
+
+} // namespace state
@@ -0,0 +1,123 @@
+/**
+ * @file jump_point_search.h
+ * Declares a path finder that searches the cells of the map directly, with no
+ * graph to keep up to date
+ */
+
+#pragma once
+
+#include "state/path_planner/graph/graph.h"
+#include "state/path_planner/path_graph.h"
+
+#include <vector>
+
+namespace state {
+
+/**
+ * Jump point search (JPS) over the cells of the terrain
+ *
+ * Cells are moved between along rows, columns and diagonals, as in
+ * HierarchicalPathGraph. The search is A* over the cells, pruned by jumping
+ * along each direction until the end or a cell with a forced neighbour, one
+ * that no path of equal length reaches without passing through the cell. Only
+ * these jump points enter the open list. Nothing is precomputed, so changes to
+ * the terrain cost nothing. The cells between the jump points are smoothed
+ * into a path that turns at the corners of cells, like the waypoint graph, but
+ * along the way the cells led, which is not always the shortest
+ */
+class JumpPointSearch {
+  private:
+    /**
+     * Terrain the paths are found on, and the line of sight checks the paths
+     * are smoothed with
+     */
+    const PathGraph *terrain = nullptr;
+
+    /**
+     * Search space for the paths found with getPath
+     */
+    PathSearch search;
+
+    /**
+     * Check if a cell can be moved through
+     * @param cell
+     * @return bool
+     */
+    bool isOpen(const Vec2D &cell) const;
+
+    /**
+     * Check if a cell entered in a direction has a forced neighbour
+     * @param cell
+     * @param direction Step the cell was entered by
+     * @return bool
+     */
+    bool hasForcedNeighbour(const Vec2D &cell, const Vec2D &direction) const;
+
+    /**
+     * Directions to search in from a cell, the natural and the forced
+     * neighbours of the direction it was entered by
+     * @param cell
+     * @param direction Step the cell was entered by, null for the start
+     * @return std::vector<Vec2D>
+     */
+    std::vector<Vec2D> getDirections(const Vec2D &cell,
+                                     const Vec2D &direction) const;
+
+    /**
+     * Step from a cell in a direction until a jump point
+     * @param cell
+     * @param direction
+     * @param end_cell
+     * @return Vec2D The jump point, null if the steps are blocked first
+     */
+    Vec2D jump(Vec2D cell, const Vec2D &direction,
+               const Vec2D &end_cell) const;
+
+  public:
+    /**
+     * Default constructor
+     */
+    JumpPointSearch();
+
+    /**
+     * Constructor
+     * @param p_terrain Terrain to find paths on, which must outlive this
+     */
+    explicit JumpPointSearch(const PathGraph *p_terrain);
+
+    /**
+     * Set the arena for the vectors made while finding paths
+     * @param turn_arena Arena, nullptr to use the heap
+     */
+    void setTurnArena(TurnArena *turn_arena);
+
+    /**
+     * Get the work done by the searches of getPath without a search space
+     * @return const PathSearchStats&
+     */
+    const PathSearchStats &getSearchStats() const;
+
+    /**
+     * Get path from one position to another
+     * @param start_position
+     * @param end_position
+     * @return Waypoints of the path, valid until the turn arena is reset
+     */
+    ArenaVector<DoubleVec2D> getPath(DoubleVec2D start_position,
+                                     DoubleVec2D end_position);
+
+    /**
+     * Get path from one position to another without modifying the finder, so
+     * that paths can be found on several threads at once
+     * @param start_position
+     * @param end_position
+     * @param search Search space of the calling thread
+     * @return Waypoints of the path, allocated from the arena of the search
+     * space
+     */
+    ArenaVector<DoubleVec2D> getPath(DoubleVec2D start_position,
+                                     DoubleVec2D end_position,
+                                     PathSearch &search) const;
+};
+
+} // namespace state
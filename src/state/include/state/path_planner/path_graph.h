@@ -6,9 +6,99 @@
 #pragma once
 
 #include "state/path_planner/graph/graph.h"
+#include "state/state_digest.h"
+
+#include <cstdint>
+#include <vector>
 
 namespace state {
 
+/**
+ * Waypoints in sight of the positions in a cell
+ */
+struct CellVisibility {
+    /**
+     * Waypoints in sight of every position in the cell
+     */
+    std::vector<FixedVec2D> visible;
+
+    /**
+     * Waypoints in sight of only some positions in the cell, which are
+     * checked for each position
+     */
+    std::vector<FixedVec2D> partly_visible;
+};
+
+/**
+ * Waypoint graph of a terrain laid out in flat arrays, as a compiled map stores
+ * it. Waypoints are referred to by their index in waypoints, and the list of
+ * each waypoint, cell or corner lies between its offset and the next one
+ */
+struct WaypointGraphView {
+    /**
+     * Waypoints, in ascending order
+     */
+    Span<const FixedVec2D> waypoints;
+
+    /**
+     * Neighbours of each waypoint, with the cost of the edge to each. Every
+     * edge is listed from both of its ends
+     */
+    Span<const uint32_t> edge_offsets;
+    Span<const uint32_t> edge_targets;
+    Span<const double_t> edge_costs;
+
+    /**
+     * Waypoints in sight of each cell corner, indexed as corner_visibility
+     */
+    Span<const uint32_t> corner_offsets;
+    Span<const uint32_t> corner_waypoints;
+
+    /**
+     * Waypoints in sight of every position and of some positions of each
+     * cell, indexed as cell_visibility
+     */
+    Span<const uint32_t> visible_offsets;
+    Span<const uint32_t> visible_waypoints;
+    Span<const uint32_t> partly_visible_offsets;
+    Span<const uint32_t> partly_visible_waypoints;
+
+    /**
+     * Distances between every pair of waypoints, as in NodeDistances. Empty
+     * if they were not computed
+     */
+    Span<const double_t> distances;
+};
+
+/**
+ * Storage for the arrays of a WaypointGraphView
+ */
+struct WaypointGraphTables {
+    std::vector<FixedVec2D> waypoints;
+    std::vector<uint32_t> edge_offsets;
+    std::vector<uint32_t> edge_targets;
+    std::vector<double_t> edge_costs;
+    std::vector<uint32_t> corner_offsets;
+    std::vector<uint32_t> corner_waypoints;
+    std::vector<uint32_t> visible_offsets;
+    std::vector<uint32_t> visible_waypoints;
+    std::vector<uint32_t> partly_visible_offsets;
+    std::vector<uint32_t> partly_visible_waypoints;
+    std::vector<double_t> distances;
+
+    /**
+     * View over the tables, valid while they are unchanged
+     * @return WaypointGraphView
+     */
+    WaypointGraphView getView() const;
+};
+
+/**
+ * Largest number of landmarks the landmark heuristic measures distances from.
+ * Each costs a search of the waypoint graph whenever the terrain changes
+ */
+const size_t NUM_PATH_LANDMARKS = 8;
+
 class PathGraph {
   private:
     /**
@@ -23,11 +113,80 @@ class PathGraph {
      */
     std::vector<std::vector<bool>> valid_terrain;
 
+    /**
+     * Digest of the blocked cells of valid_terrain, kept up to date as
+     * obstacles are added and removed
+     */
+    StateDigest terrain_digest = {0, 0};
+
     /**
      * Graph of waypoints
      */
     Graph graph;
 
+    /**
+     * False once valid_terrain has changed since the waypoint graph was last
+     * recomputed
+     */
+    bool is_waypoint_graph_current = false;
+
+    /**
+     * Waypoints in sight of each cell, indexed by x * map_size + y, so that
+     * the ends of a path are joined to the graph without a line of sight
+     * check against every waypoint. Recomputed with the waypoint graph
+     */
+    std::vector<CellVisibility> cell_visibility;
+
+    /**
+     * Waypoints in sight of each cell corner, indexed by
+     * x * (map_size + 1) + y
+     */
+    std::vector<std::vector<FixedVec2D>> corner_visibility;
+
+    /**
+     * Search space for the paths found with getPath
+     */
+    PathSearch search;
+
+    /**
+     * Waypoint graph of the terrain the map starts with, loaded rather than
+     * recalculated whenever the terrain is back to it. Set from a compiled
+     * map, whose storage must outlive this
+     */
+    WaypointGraphView base_waypoint_graph;
+
+    /**
+     * Digest of the terrain base_waypoint_graph belongs to
+     */
+    StateDigest base_terrain_digest = {0, 0};
+
+    /**
+     * True once base_waypoint_graph has been set
+     */
+    bool has_base_waypoint_graph = false;
+
+    /**
+     * Digest of a single blocked cell
+     * @param x
+     * @param y
+     * @return StateDigest
+     */
+    static StateDigest getCellDigest(size_t x, size_t y);
+
+    /**
+     * Recalculate terrain_digest from all of valid_terrain
+     */
+    void recomputeTerrainDigest();
+
+    /**
+     * Marks a cell as traversable or not, updating terrain_digest
+     * @param position Position inside the cell
+     * @param is_valid
+     *
+     * @throw std::domain_error If position is not inside the map
+     */
+    void setCellValidity(const DoubleVec2D &position, bool is_valid);
+
     /**
      * Remove all waypoints and edges
      */
@@ -42,63 +201,86 @@ class PathGraph {
     bool isValidPosition(double_t x, double_t y) const;
 
     /**
-     * Add a new waypoint and create edges
-     * @param position
+     * Recalculate waypoints from valid_terrain graph
      */
-    void addWaypoint(const DoubleVec2D &position);
+    void recomputeWaypoints();
 
     /**
-     * Remove a waypoint and corresponding edges
-     * @param position
+     * Recalculate all edges from a single waypoint
      */
-    void removeWaypoint(const DoubleVec2D &position);
+    void recomputeWaypointEdges(const FixedVec2D &position);
 
     /**
-     * Return all waypoints constructed
-     * @return vector of waypoint positions
+     * Recalculate all edges between all waypoints
      */
-    boost::unordered_set<DoubleVec2D> getWaypoints() const;
+    void recomputeWaypointEdges();
 
     /**
-     * Recalculate waypoints from valid_terrain graph
+     * Recalculate cell_visibility and corner_visibility from the waypoints
      */
-    void recomputeWaypoints();
+    void recomputeVisibility();
 
     /**
-     * Check if two points are directly reachable from each other
+     * Fill the waypoint graph, cell_visibility and corner_visibility from
+     * base_waypoint_graph, with no line of sight checks
+     */
+    void loadBaseWaypointGraph();
+
+    /**
+     * Call visit with each cell whose inside the line between two points
+     * crosses, from left to right, until visit returns false
      * @param point_a
-     * @param point_b
-     * @return bool true, if they are directly reachable
+     * @param point_b Not on the same vertical or horizontal line as point_a
+     * @param visit Callable taking the x and y of a cell and returning bool
+     * @return bool false, if visit stopped the walk
      */
-    bool arePointsDirectlyReachable(DoubleVec2D point_a,
-                                    DoubleVec2D point_b) const;
+    template <typename Visit>
+    static bool walkCells(FixedVec2D point_a, FixedVec2D point_b,
+                          Visit visit);
 
     /**
-     * Recalculate all edges from a single waypoint
+     * Check if the line between two points crosses the inside of a cell
+     * @param point_a
+     * @param point_b Not on the same vertical or horizontal line as point_a
+     * @param x
+     * @param y
+     * @return bool
      */
-    void recomputeWaypointEdges(const DoubleVec2D &position);
+    static bool crossesCell(FixedVec2D point_a, FixedVec2D point_b, int64_t x,
+                            int64_t y);
 
     /**
-     * Recalculate all edges between all waypoints
+     * Check if every cell overlapping the area between a waypoint and a cell
+     * can be traversed, in which case the waypoint is in sight of every
+     * position in the cell
+     * @param waypoint On a cell corner, as every waypoint is
+     * @param x
+     * @param y
+     * @return bool
      */
-    void recomputeWaypointEdges();
+    bool isCellInSight(const FixedVec2D &waypoint, int64_t x,
+                       int64_t y) const;
 
     /**
-     * Return all integers in the range and include x_a and x_b
-     * Eg: For (2.5, 5.5), result = {2.5, 3, 4, 5, 5.5}
-     * @param a
-     * @param b
-     * @return Vector of result
+     * Check if one blocked cell lies across the lines from a waypoint to all
+     * four corners of a cell, in which case it hides the waypoint from every
+     * position in the cell
+     * @param waypoint
+     * @param x
+     * @param y
+     * @return bool
      */
-    std::vector<double_t> generateIntersections(double_t a, double_t b) const;
+    bool isCellHidden(const FixedVec2D &waypoint, int64_t x, int64_t y) const;
 
     /**
-     * Get the slope of line between two points
-     * @param a
-     * @param b
-     * @return Slope
+     * Add an edge from a position to each waypoint in its sight
+     * @param position
+     * @param exact_position Position the edge costs are measured from
+     * @param edges
      */
-    double_t getSlope(const DoubleVec2D &a, const DoubleVec2D &b) const;
+    void addVisibleWaypointEdges(const FixedVec2D &position,
+                                 const DoubleVec2D &exact_position,
+                                 EdgeList &edges) const;
 
     /**
      * Check if a path along same x or same y is traversable
@@ -106,8 +288,8 @@ class PathGraph {
      * @param destination
      * @return True, if traversable. Else, false
      */
-    bool isStraightLineTraversable(DoubleVec2D start,
-                                   DoubleVec2D destination) const;
+    bool isStraightLineTraversable(FixedVec2D start,
+                                   FixedVec2D destination) const;
 
   public:
     /**
@@ -133,10 +315,53 @@ class PathGraph {
     void setValidTerrain(std::vector<std::vector<bool>> p_valid_terrain);
 
     /**
-     * Recalculate waypoints and edges from valid_terrain
+     * Set the arena for the vectors made while finding paths
+     * @param turn_arena Arena, nullptr to use the heap
+     */
+    void setTurnArena(TurnArena *turn_arena);
+
+    /**
+     * Set the heuristic that paths are searched with. Landmarks are picked
+     * when the waypoint graph is next recalculated
+     * @param heuristic
+     */
+    void setPathHeuristic(PathHeuristic heuristic);
+
+    /**
+     * Get the work done by the searches of getPath without a search space
+     * @return const PathSearchStats&
+     */
+    const PathSearchStats &getSearchStats() const;
+
+    /**
+     * Recalculate waypoints and edges from valid_terrain, if it has changed
+     * since they were last calculated
      */
     void recomputeWaypointGraph();
 
+    /**
+     * Set the waypoint graph of the current terrain, as found ahead of time by
+     * getWaypointGraphTables, so that it is loaded rather than recalculated
+     * @param waypoint_graph Graph whose storage outlives this
+     *
+     * @throw std::invalid_argument If the graph does not fit the map
+     */
+    void setBaseWaypointGraph(const WaypointGraphView &waypoint_graph);
+
+    /**
+     * Recalculate the waypoint graph if needed, and lay it out in flat arrays
+     * @param with_distances True, to also find the distances between every
+     * pair of waypoints
+     * @return WaypointGraphTables
+     */
+    WaypointGraphTables getWaypointGraphTables(bool with_distances);
+
+    /**
+     * Return all waypoints constructed
+     * @return vector of waypoint positions
+     */
+    boost::unordered_set<FixedVec2D> getWaypoints() const;
+
     /**
      * Check if given position is on valid terrain
      * @param position
@@ -144,6 +369,48 @@ class PathGraph {
      */
     bool isValidPosition(const DoubleVec2D &position) const;
 
+    /**
+     * Check if a cell is inside the map and on valid terrain
+     * @param x
+     * @param y
+     * @return True, if the cell can be traversed, false otherwise
+     */
+    bool isValidCell(int64_t x, int64_t y) const;
+
+    /**
+     * Check if two points are directly reachable from each other. The cells
+     * the line between them crosses are found exactly, in fixed point
+     * @param point_a
+     * @param point_b
+     * @return bool true, if they are directly reachable
+     */
+    bool arePointsDirectlyReachable(FixedVec2D point_a,
+                                    FixedVec2D point_b) const;
+
+    /**
+     * Find the valid cell that a position lies in, or one of the valid cells
+     * it lies on the edge of
+     * @param position
+     * @return Vec2D Offset of the cell, null if the position touches no valid
+     * cell
+     */
+    Vec2D findValidCell(const DoubleVec2D &position) const;
+
+    /**
+     * Turn a path through cells into waypoints, cutting across each stretch
+     * of the cells in line of sight and turning at the corners of cells
+     * @param start_position Start, in the first cell
+     * @param cells Valid cells, each a row, column or diagonal step from the
+     * one before
+     * @param end_position End, in the last cell
+     * @param turn_arena Arena for the result, nullptr to use the heap
+     * @return ArenaVector<DoubleVec2D> Waypoints of the path, without the start
+     */
+    ArenaVector<DoubleVec2D> smoothCellPath(DoubleVec2D start_position,
+                                            const std::vector<Vec2D> &cells,
+                                            DoubleVec2D end_position,
+                                            TurnArena *turn_arena) const;
+
     /**
      * Adds obstacle in a position
      * @param position
@@ -162,13 +429,49 @@ class PathGraph {
      */
     void removeObstacle(const DoubleVec2D &position);
 
+    /**
+     * Digest of the cells that cannot be traversed, for StateDigest
+     * @return StateDigest
+     */
+    StateDigest getTerrainDigest() const;
+
     /**
      * Get path from one position to another
      * @param start_position
      * @param end_position
+     * @return Waypoints of the path, valid until the turn arena is reset
      */
-    std::vector<DoubleVec2D> getPath(DoubleVec2D start_position,
+    ArenaVector<DoubleVec2D> getPath(DoubleVec2D start_position,
                                      DoubleVec2D end_position);
+
+    /**
+     * Get path from one position to another without modifying the graph, so
+     * that paths can be found on several threads at once. The ends are joined
+     * to the waypoints in their sight, looked up in the visibility tables
+     * @param start_position
+     * @param end_position
+     * @param search Search space of the calling thread
+     * @return Waypoints of the path, allocated from the arena of the search
+     * space
+     */
+    ArenaVector<DoubleVec2D> getPath(DoubleVec2D start_position,
+                                     DoubleVec2D end_position,
+                                     PathSearch &search) const;
+
+    /**
+     * Get paths from several positions to one end, with a single search
+     * backwards from the end rather than a search from each position. The
+     * paths are as short as those of getPath, though of paths equally short
+     * either may be found
+     * @param start_positions
+     * @param end_position
+     * @param search Search space of the calling thread
+     * @return Waypoints of the path from each start, allocated from the arena
+     * of the search space
+     */
+    std::vector<ArenaVector<DoubleVec2D>>
+    getPaths(const std::vector<DoubleVec2D> &start_positions,
+             DoubleVec2D end_position, PathSearch &search) const;
 };
 
 } // namespace state
@@ -5,12 +5,44 @@
 
 #pragma once
 
+#include "state/map/compiled_map.h"
 #include "state/map/map.h"
+#include "state/path_planner/hierarchical_path_graph.h"
 #include "state/path_planner/interfaces/i_path_planner.h"
+#include "state/path_planner/jump_point_search.h"
 #include "state/path_planner/path_graph.h"
+#include "state/worker_pool.h"
+
+#include <memory>
+#include <tuple>
 
 namespace state {
 
+/**
+ * A request for the next position of a unit moving towards a destination
+ */
+struct PathQuery {
+    DoubleVec2D source;
+    DoubleVec2D destination;
+    size_t speed;
+};
+
+/**
+ * Path finders that the planner can find paths with
+ */
+enum class PathPlannerBackend {
+    // Shortest paths over the graph of waypoints at obstacle corners
+    VISIBILITY_GRAPH,
+
+    // Paths over chunks of the map (HPA*), cheaper to update on large maps
+    // but not always the shortest
+    HIERARCHICAL,
+
+    // Paths over the cells of the map (JPS), with nothing to update as the
+    // terrain changes, but not always the shortest
+    JUMP_POINT_SEARCH
+};
+
 class PathPlanner : public IPathPlanner {
 
     /**
@@ -20,12 +52,46 @@ class PathPlanner : public IPathPlanner {
      */
     Map *map;
 
+    /**
+     * Compiled map the waypoint graph of the initial terrain is loaded from,
+     * if any. It holds the storage path_graph loads from
+     */
+    std::unique_ptr<CompiledMap> compiled_map;
+
     /**
      * PathGraph class handles all path calculations
      * PathGraph also keeps track of towers as obstacles
      */
     PathGraph path_graph;
 
+    /**
+     * Hierarchical path finder over the terrain of path_graph, kept up to
+     * date only while it is the backend
+     */
+    HierarchicalPathGraph hierarchical_graph;
+
+    /**
+     * Jump point search over the terrain of path_graph
+     */
+    JumpPointSearch jump_point_search;
+
+    /**
+     * Path finder that paths are found with
+     */
+    PathPlannerBackend backend = PathPlannerBackend::VISIBILITY_GRAPH;
+
+    /**
+     * Find a path with the current backend
+     * @param source
+     * @param destination
+     * @param search Search space of the calling thread, nullptr to use the
+     * backend's own
+     * @return ArenaVector<DoubleVec2D> Waypoints of the path
+     */
+    ArenaVector<DoubleVec2D> findPath(DoubleVec2D source,
+                                      DoubleVec2D destination,
+                                      PathSearch *search);
+
     /**
      * Helper function to get a point along the direction of a line segment
      * given the endpoints at a specific distance
@@ -69,10 +135,49 @@ class PathPlanner : public IPathPlanner {
     std::vector<Vec2D> getAdjoiningOffsets(DoubleVec2D position);
 
     /**
-     * Path cache for given any source and destination, cache the next position
-     * to move to. This cache is invalidated at the start of every turn
+     * Path cache for given any source, destination and speed, cache the next
+     * position to move to. This cache is invalidated at the start of every
+     * turn
+     */
+    std::map<std::tuple<DoubleVec2D, DoubleVec2D, size_t>, DoubleVec2D> cache;
+
+    /**
+     * Queries being planned in parallel, and their next positions
+     */
+    std::vector<PathQuery> planned_queries;
+    std::vector<DoubleVec2D> planned_positions;
+
+    /**
+     * Indices of the planned queries, in groups planned with one search each.
+     * With the visibility graph, the queries to a destination are grouped and
+     * their paths found with one search backwards from it
+     */
+    std::vector<std::vector<size_t>> planned_groups;
+
+    /**
+     * Work done by the searches of each planned group, and by all the
+     * searches planned so far
+     */
+    std::vector<PathSearchStats> planned_search_stats;
+    PathSearchStats planned_search_total;
+
+    /**
+     * Number of queries answered without a search of their own by the last
+     * planNextPositions
+     */
+    size_t num_saved_searches = 0;
+
+    /**
+     * Helper function to get the position reached by moving along a path
+     * @param source Start of the path
+     * @param destination End of the path
+     * @param speed Distance moved
+     * @param path Waypoints of the path from source to destination
+     * @return DoubleVec2D Position reached
      */
-    std::map<std::pair<DoubleVec2D, DoubleVec2D>, DoubleVec2D> cache;
+    static DoubleVec2D moveAlongPath(DoubleVec2D source,
+                                     DoubleVec2D destination, size_t speed,
+                                     const ArenaVector<DoubleVec2D> &path);
 
   public:
     PathPlanner(Map *p_map);
@@ -125,16 +230,96 @@ class PathPlanner : public IPathPlanner {
      */
     bool destroyTower(Vec2D tower_offset);
 
+    /**
+     * Digest of the map cells that cannot be moved through, which changes as
+     * towers are built and destroyed
+     * @return StateDigest
+     */
+    StateDigest getTerrainDigest() const;
+
+    /**
+     * Set the arena for the paths found during a turn
+     * @param turn_arena Arena, nullptr to use the heap
+     */
+    void setTurnArena(TurnArena *turn_arena);
+
     /**
      * Called every turn to update the path graph based on current obstacles
      */
     void recomputePathGraph();
 
+    /**
+     * Set the heuristic that paths are searched with, taking effect from the
+     * next recomputePathGraph
+     * @param heuristic
+     */
+    void setPathHeuristic(PathHeuristic heuristic);
+
+    /**
+     * Set the path finder that paths are found with, taking effect from the
+     * next recomputePathGraph
+     * @param p_backend
+     */
+    void setBackend(PathPlannerBackend p_backend);
+
+    /**
+     * Load the waypoint graph of the initial terrain from a compiled map
+     * rather than recalculating it, whenever the terrain is back to it. Called
+     * before any tower is built
+     * @param p_compiled_map Compiled map of the map of this planner
+     *
+     * @throw std::invalid_argument If the compiled map is of another map
+     */
+    void setCompiledMap(std::unique_ptr<CompiledMap> p_compiled_map);
+
+    /**
+     * Get the waypoint graph of the current terrain, as a compiled map stores
+     * it
+     * @param with_distances True, to also find the distances between every
+     * pair of waypoints
+     * @return WaypointGraphTables
+     */
+    WaypointGraphTables getWaypointGraphTables(bool with_distances);
+
+    /**
+     * Get the path finder that paths are found with
+     * @return PathPlannerBackend
+     */
+    PathPlannerBackend getBackend() const;
+
+    /**
+     * Get the work done by all the path searches so far, to compare
+     * heuristics by
+     * @return PathSearchStats
+     */
+    PathSearchStats getPathSearchStats() const;
+
     /**
      * @see IPathPlanner#GetNextPosition
      */
     DoubleVec2D getNextPosition(DoubleVec2D source, DoubleVec2D destination,
                                 size_t speed) override;
+
+    /**
+     * Finds the next positions of a batch of queries on a pool of threads,
+     * and caches them for getNextPosition. Queries asked more than once are
+     * planned once, and with the visibility graph the paths of all queries to
+     * a destination are found with one search backwards from it. These paths
+     * are as short as those found for each query alone, and the next
+     * positions do not depend on the number of threads
+     * @param queries
+     * @param worker_pool
+     */
+    void planNextPositions(const std::vector<PathQuery> &queries,
+                           WorkerPool &worker_pool);
+
+    /**
+     * Get the number of queries that the last planNextPositions answered
+     * without a search of their own, as they were asked before or shared the
+     * search of their destination
+     * @return size_t
+     */
+    size_t getNumSavedSearches() const;
 };
 
 } // namespace state
@@ -12,6 +12,7 @@
 #include <array>
 #include <functional>
 #include <queue>
+#include <vector>
 
 using namespace std;
 using namespace Constants::Map;
@@ -204,8 +205,12 @@ struct MapElement {
  * Main Player state, the struct interface available to each player.
  */
 struct State {
-    array<array<MapElement, Constants::Map::MAP_SIZE>, Constants::Map::MAP_SIZE>
-        map;
+    /**
+     * Terrain of each cell, indexed by x and then y. As many cells per side as
+     * the map of the game has
+     */
+    vector<vector<MapElement>> map;
+
     vector<DoubleVec2D> flag_offsets;
     int64_t num_flags;
 
@@ -224,7 +229,8 @@ struct State {
     array<int64_t, 2> scores;
 
     State()
-        : map(), bots(Constants::Actor::MAX_NUM_BOTS),
+        : map(MAP_SIZE, vector<MapElement>(MAP_SIZE)),
+          bots(Constants::Actor::MAX_NUM_BOTS),
           enemy_bots(Constants::Actor::MAX_NUM_BOTS),
           num_bots(Constants::Actor::MAX_NUM_BOTS),
           num_enemy_bots(Constants::Actor::MAX_NUM_BOTS),
@@ -238,9 +244,9 @@ struct State {
  * Returns the actor counts in each offset
  *
  * @param state Reference to the player state
- * @return array<array<uint64_t, MAP_SIZE>, MAP_SIZE>
+ * @return vector<vector<uint64_t>> Counts indexed by x and then y
  */
-array<array<uint64_t, MAP_SIZE>, MAP_SIZE> getActorCounts(const State &state);
+vector<vector<uint64_t>> getActorCounts(const State &state);
 
 /**
  * Finds the nearest flag offset from a given position
@@ -299,6 +305,14 @@ Tower &getTowerById(State &state, int64_t tower_id);
  */
 Tower &getTowerByPosition(State &state, DoubleVec2D position);
 
+/**
+ * Returns the position of the enemy base, in the far corner of the map
+ *
+ * @param state Reference to the player state
+ * @return DoubleVec2D
+ */
+DoubleVec2D getEnemyBasePosition(const State &state);
+
 /**
  * Returns the Offset given a position
  *
@@ -307,8 +321,7 @@ Tower &getTowerByPosition(State &state, DoubleVec2D position);
  */
 Vec2D getOffsetFromPosition(DoubleVec2D position);
 
-ostream &operator<<(ostream &os,
-                    const array<array<MapElement, MAP_SIZE>, MAP_SIZE> &map);
+ostream &operator<<(ostream &os, const vector<vector<MapElement>> &map);
 
 ostream &operator<<(ostream &os, const TowerState &tower_state);
 
@@ -0,0 +1,64 @@
+/**
+ * @file span.h
+ * Non owning view over a contiguous range of elements
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace state {
+
+/**
+ * View over elements stored contiguously elsewhere, such as in a vector. It is
+ * cheap to copy, and is invalidated when the underlying storage changes
+ *
+ * @tparam T Element type, const qualified for a read only view
+ */
+template <typename T> class Span {
+  private:
+    /**
+     * First element of the range
+     */
+    T *first;
+
+    /**
+     * Number of elements in the range
+     */
+    size_t length;
+
+  public:
+    /**
+     * Constructs an empty span
+     */
+    Span() : first(nullptr), length(0) {}
+
+    /**
+     * Constructs a span over a range
+     *
+     * @param first
+     * @param length
+     */
+    Span(T *first, size_t length) : first(first), length(length) {}
+
+    /**
+     * Constructs a span over the elements of a vector
+     *
+     * @param elements
+     */
+    Span(const std::vector<std::remove_const_t<T>> &elements)
+        : first(elements.data()), length(elements.size()) {}
+
+    T *begin() const { return first; }
+
+    T *end() const { return first + length; }
+
+    size_t size() const { return length; }
+
+    bool empty() const { return length == 0; }
+
+    T &operator[](size_t index) const { return first[index]; }
+};
+} // namespace state
@@ -9,13 +9,18 @@
 #include "physics/vector.hpp"
 #include "state/actor/bot.h"
 #include "state/actor/tower.h"
+#include "state/game_limits.h"
 #include "state/interfaces/i_command_taker.h"
 #include "state/interfaces/i_updatable.h"
 #include "state/map/map.h"
 #include "state/path_planner/path_planner.h"
 #include "state/score_manager/score_manager.h"
 #include "state/transform_request.h"
+#include "state/turn_arena.h"
 #include "state/utilities.h"
+#include "state/worker_pool.h"
+
+#include <unordered_map>
 
 namespace state {
 
@@ -40,6 +45,12 @@ class STATE_EXPORT State : public ICommandTaker {
 
     Tower model_tower;
 
+    /**
+     * Size of the map and caps on the number of actors, the constants unless
+     * set from the map file
+     */
+    GameLimits game_limits;
+
     /**
      * A list of bots indexed by player
      */
@@ -51,10 +62,144 @@ class STATE_EXPORT State : public ICommandTaker {
     std::array<std::vector<std::unique_ptr<Tower>>, 2> towers;
 
     /**
-     * A list of build requests issued in each turn
+     * Pointers to the bots of each player, in the same order as bots, so
+     * that they can be handed out without copying
+     */
+    std::array<std::vector<Bot *>, 2> bot_ptrs;
+
+    /**
+     * Pointers to the towers of each player, in the same order as towers
+     */
+    std::array<std::vector<Tower *>, 2> tower_ptrs;
+
+    /**
+     * Bots indexed by actor id, for the lookups done by every command
+     */
+    std::unordered_map<ActorId, Bot *> bots_by_id;
+
+    /**
+     * Towers indexed by actor id. A tower keeps the id of the bot it was
+     * built from, so the two are indexed separately
+     */
+    std::unordered_map<ActorId, Tower *> towers_by_id;
+
+    /**
+     * Adds a bot to the list of bots of its player
+     *
+     * @param bot
+     */
+    void addBot(std::unique_ptr<Bot> bot);
+
+    /**
+     * Adds a tower to the list of towers of its player
+     *
+     * @param tower
+     */
+    void addTower(std::unique_ptr<Tower> tower);
+
+    /**
+     * Arena for data that only lives until the end of the turn
+     */
+    TurnArena turn_arena;
+
+    /**
+     * A list of build requests issued in each turn, allocated in the turn
+     * arena
+     */
+    std::array<std::vector<TransformRequest *>, 2> transform_requests;
+
+    /**
+     * A blast issued in the present turn, waiting to be resolved
+     */
+    struct BlastEvent {
+        /**
+         * Player who blasted. Only the other player's actors are damaged
+         */
+        PlayerId player_id;
+
+        DoubleVec2D position;
+
+        double_t impact_radius;
+
+        double_t damage_points;
+    };
+
+    /**
+     * Blasts issued in the present turn, in the order they were issued
+     */
+    std::vector<BlastEvent> blast_events;
+
+    /**
+     * Positions of a player's actors packed for the blast kernel. The
+     * coordinate lists are padded up to a whole number of batches with NaN,
+     * which is never in range of a blast
+     */
+    struct BlastTargets {
+        /**
+         * Bots followed by towers, in the order they are stored in
+         */
+        std::vector<Actor *> actors;
+
+        std::vector<double_t> xs;
+
+        std::vector<double_t> ys;
+
+        /**
+         * Damage to each actor from the blast being resolved
+         */
+        std::vector<double_t> damages;
+
+        /**
+         * Damage to each actor from all blasts resolved so far
+         */
+        std::vector<uint64_t> total_damages;
+    };
+
+    /**
+     * Blast targets indexed by the player who owns them. Kept across turns so
+     * that the lists are only grown, not reallocated
+     */
+    std::array<BlastTargets, 2> blast_targets;
+
+    /**
+     * Threads that plan the moves of bots in parallel, which may be only the
+     * calling thread
+     */
+    std::unique_ptr<WorkerPool> worker_pool;
+
+    /**
+     * Moves the bots are expected to ask the path planner for in the update
+     */
+    std::vector<PathQuery> path_queries;
+
+    /**
+     * Plans the next positions of all moving bots on the worker pool, so that
+     * the updates that follow find them cached. Bots heading to the same
+     * destination share a path search. The updates themselves, and
+     * everything they change, stay in the order of the actors
+     */
+    void planBotMoves();
+
+    /**
+     * Packs the positions of a player's actors into their blast targets
+     *
+     * @param player_id
      */
-    std::array<std::vector<std::unique_ptr<TransformRequest>>, 2>
-        transform_requests;
+    void packBlastTargets(PlayerId player_id);
+
+    /**
+     * Callback for blasters to damage the actors around them
+     *
+     * @return BlastCallback
+     */
+    BlastCallback getBlastCallback();
+
+    /**
+     * Callback for bots to request to be transformed into a tower
+     *
+     * @return ConstructTowerCallback
+     */
+    ConstructTowerCallback getConstructTowerCallback();
 
     /**
      * Returns the Actor By Id of the actor
@@ -82,24 +227,6 @@ class STATE_EXPORT State : public ICommandTaker {
      */
     Blaster *getBlasterById(ActorId id);
 
-    /**
-     * Get the Tower By Id
-     *
-     * @param player_id
-     * @param actor_id
-     * @return Tower*
-     */
-    Tower *getTowerById(ActorId actor_id);
-
-    /**
-     * Get the Bot By Id
-     *
-     * @param player_id
-     * @param actor_id
-     * @return Bot*
-     */
-    Bot *getBotById(ActorId actor_id);
-
   public:
     /**
      * Constructors
@@ -150,15 +277,16 @@ class STATE_EXPORT State : public ICommandTaker {
      *
      * @param blast_position
      * @param impact_range
-     * @return std::vector<Actor *>
+     * @return ArenaVector<Actor *> Actors, valid until the turn arena is reset
      */
-    std::vector<Actor *> getAffectedActors(PlayerId player_id,
+    ArenaVector<Actor *> getAffectedActors(PlayerId player_id,
                                            DoubleVec2D blast_position,
                                            size_t impact_range);
 
     /**
      * Callback passed to all blasters to damage neighbouring actors given a
-     * position
+     * position. The blast is queued, and the damage is dealt when the blasts
+     * of the turn are resolved
      *
      * @param player_id Player id of actor calling callback
      * @param actor_id Actor id of actor calling callback
@@ -167,6 +295,16 @@ class STATE_EXPORT State : public ICommandTaker {
     void damageEnemyActors(PlayerId player_id, ActorId actor_id,
                            DoubleVec2D position);
 
+    /**
+     * Deals the damage of all blasts queued in the present turn, in one pass
+     * over the actors in range of each blast
+     *
+     * Damage is only applied to hp in the late update, and positions do not
+     * change until then, so resolving the blasts after every actor has been
+     * updated gives the same result as dealing each blast when it is issued
+     */
+    void resolveBlasts();
+
     /**
      * Taking model bot as reference, create new bot and add to list of player
      * bots
@@ -219,23 +357,88 @@ class STATE_EXPORT State : public ICommandTaker {
      */
     std::array<uint64_t, 2> getScores() const override;
 
+    /**
+     * @see ICommandTaker#getDigest
+     */
+    StateDigest getDigest() const override;
+
     /**
      * @see ICommandTaker#getTowers
      */
-    std::array<std::vector<Tower *>, 2> getTowers() override;
+    Span<Tower *const> getTowers(PlayerId player_id) override;
 
     /**
      * @see ICommandTaker#getBots
      */
-    std::array<std::vector<Bot *>, 2> getBots() override;
+    Span<Bot *const> getBots(PlayerId player_id) override;
+
+    /**
+     * Copies the towers of both players, for callers that hold on to them
+     * while the state changes
+     *
+     * @return std::array<std::vector<Tower *>, 2>
+     */
+    std::array<std::vector<Tower *>, 2> getTowers();
+
+    /**
+     * Copies the bots of both players, for callers that hold on to them while
+     * the state changes
+     *
+     * @return std::array<std::vector<Bot *>, 2>
+     */
+    std::array<std::vector<Bot *>, 2> getBots();
+
+    /**
+     * @see ICommandTaker#getBotById
+     */
+    Bot *getBotById(ActorId bot_id) override;
+
+    /**
+     * @see ICommandTaker#getTowerById
+     */
+    Tower *getTowerById(ActorId tower_id) override;
+
+    /**
+     * @see ICommandTaker#getTransformRequests
+     */
+    Span<TransformRequest *const>
+    getTransformRequests(PlayerId player_id) override;
+
+    /**
+     * Copies the transform requests of both players
+     *
+     * @return std::array<std::vector<TransformRequest *>, 2>
+     */
+    std::array<std::vector<TransformRequest *>, 2> getTransformRequests();
+
+    /**
+     * @see ICommandTaker#resetTurnArena
+     */
+    void resetTurnArena() override;
+
+    /**
+     * Sets the number of threads that plan the moves of bots in each update.
+     * The outcome of the update does not depend on the number of threads
+     *
+     * @param num_threads Number of threads, including the calling one. 1 plans
+     * the moves on the calling thread
+     */
+    void setNumUpdateThreads(size_t num_threads);
+
+    /**
+     * Sets the size of the map and the caps on the number of actors, which
+     * places the bases and limits the bots spawned and the towers built
+     *
+     * @param game_limits
+     */
+    void setGameLimits(const GameLimits &game_limits);
 
     /**
-     * Get the Transform Requests object
+     * Gets the size of the map and the caps on the number of actors
      *
-     * @return std::array<std::vector<std::unique_ptr<TransformRequest>>, 2>
+     * @return const GameLimits&
      */
-    std::array<std::vector<TransformRequest *>, 2>
-    getTransformRequests() override;
+    const GameLimits &getGameLimits() const;
 
     /**
      * Updates the main state by calling update for each of the state actors
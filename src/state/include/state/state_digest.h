@@ -0,0 +1,73 @@
+/**
+ * @file state_digest.h
+ * Declarations for a digest of the game state, used to check that two runs
+ * of a match stayed identical
+ */
+
+#pragma once
+
+#include "state/state_export.h"
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace state {
+
+/**
+ * 128 bit digest, made of two independently mixed 64 bit halves
+ */
+struct STATE_EXPORT StateDigest {
+    uint64_t high;
+    uint64_t low;
+
+    bool operator==(const StateDigest &other) const;
+    bool operator!=(const StateDigest &other) const;
+
+    /**
+     * Combines two digests irrespective of their order, by adding each half.
+     * Used to digest sets of values, such as the actors of a player
+     */
+    StateDigest &operator+=(const StateDigest &other);
+
+    /**
+     * Combines two digests such that adding one twice cancels it out. Used to
+     * keep digests of sets that values enter and leave
+     */
+    StateDigest &operator^=(const StateDigest &other);
+
+    /**
+     * Digest as 32 hexadecimal digits, high half first
+     *
+     * @return std::string
+     */
+    std::string toString() const;
+};
+
+/**
+ * Builds a digest from a sequence of values. The digest depends on the order
+ * the values are added in
+ *
+ * This is not a cryptographic hash. It only needs to make it very unlikely
+ * that two differing states get the same digest
+ */
+class STATE_EXPORT DigestBuilder {
+  private:
+    StateDigest digest;
+
+  public:
+    DigestBuilder();
+
+    DigestBuilder &add(uint64_t value);
+
+    /**
+     * Adds the bits of a double, with -0.0 and 0.0 added alike, as are
+     * all NaNs
+     */
+    DigestBuilder &add(double_t value);
+
+    DigestBuilder &add(const StateDigest &value);
+
+    StateDigest getDigest() const;
+};
+} // namespace state
@@ -77,7 +77,8 @@ class STATE_EXPORT StateSyncer : public IStateSyncer {
     /**
      * @see IStateSyncer #UpdateMainState
      */
-    void updateMainState(std::array<player_state::State, 2> &player_states,
+    void updateMainState(std::array<const CommandBuffer *, 2> command_buffers,
+                         std::array<player_state::State, 2> &player_states,
                          std::array<bool, 2> skip_turns) override;
 
     /**
@@ -0,0 +1,180 @@
+/**
+ * @file turn_arena.h
+ * Declarations for a monotonic arena holding data that lives for one turn
+ */
+
+#pragma once
+
+#include "state/state_export.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace state {
+
+/**
+ * Monotonic allocator for short lived data created while a turn is simulated
+ *
+ * Allocations bump a pointer through a list of blocks and are never freed
+ * individually. Resetting the arena at the end of the turn rewinds to the
+ * first block, keeping all the blocks, so that once the arena has grown to
+ * the size of a turn it makes no further calls to the heap
+ */
+class STATE_EXPORT TurnArena {
+  public:
+    /**
+     * Size of the blocks the arena is grown by. Larger allocations get a
+     * block of their own
+     */
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+  private:
+    /**
+     * A block of memory allocations are carved out of
+     */
+    struct Block {
+        std::unique_ptr<char[]> memory;
+        size_t size;
+    };
+
+    /**
+     * Blocks owned by the arena, in the order they are used
+     */
+    std::vector<Block> blocks;
+
+    /**
+     * Index of the block allocations are presently carved out of
+     */
+    size_t block_index;
+
+    /**
+     * Bytes used in the present block
+     */
+    size_t block_offset;
+
+    /**
+     * Number of allocations since the last reset
+     */
+    size_t num_allocations;
+
+    /**
+     * Bytes allocated since the last reset, including padding
+     */
+    size_t num_bytes;
+
+  public:
+    /**
+     * Constructs an arena with no blocks
+     */
+    TurnArena();
+
+    TurnArena(const TurnArena &) = delete;
+    TurnArena &operator=(const TurnArena &) = delete;
+
+    /**
+     * Allocates memory that stays valid until the next reset
+     *
+     * @param size
+     * @param alignment Power of two, at most alignof(std::max_align_t)
+     * @return void* Pointer to the memory
+     */
+    void *allocate(size_t size, size_t alignment);
+
+    /**
+     * Constructs an object in the arena. Its destructor is never run, so the
+     * type must not own other resources
+     *
+     * @tparam T
+     * @tparam Args
+     * @param args Arguments to the constructor of T
+     * @return T* Pointer to the object, valid until the next reset
+     */
+    template <typename T, typename... Args> T *create(Args &&... args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "Objects in the arena are never destroyed");
+        return new (allocate(sizeof(T), alignof(T)))
+            T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * Releases all allocations, keeping the blocks for the next turn
+     */
+    void reset();
+
+    /**
+     * Number of allocations since the last reset
+     *
+     * @return size_t
+     */
+    size_t getNumAllocations() const;
+
+    /**
+     * Bytes allocated since the last reset
+     *
+     * @return size_t
+     */
+    size_t getNumBytes() const;
+
+    /**
+     * Total size of the blocks owned by the arena
+     *
+     * @return size_t
+     */
+    size_t getCapacity() const;
+};
+
+/**
+ * Standard allocator backed by a TurnArena. Without an arena, it allocates on
+ * the heap like std::allocator, so containers using it work outside a turn
+ *
+ * @tparam T Element type
+ */
+template <typename T> class ArenaAllocator {
+  private:
+    TurnArena *arena;
+
+  public:
+    typedef T value_type;
+
+    ArenaAllocator(TurnArena *arena = nullptr) noexcept : arena(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept
+        : arena(other.getArena()) {}
+
+    T *allocate(size_t n) {
+        if (arena == nullptr) {
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *pointer, size_t) noexcept {
+        // Arena memory is released all at once on reset
+        if (arena == nullptr) {
+            ::operator delete(pointer);
+        }
+    }
+
+    TurnArena *getArena() const noexcept { return arena; }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.getArena() == b.getArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return !(a == b);
+}
+
+/**
+ * Vector whose storage lives in a TurnArena
+ */
+template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+} // namespace state
@@ -0,0 +1,127 @@
+/**
+ * @file worker_pool.h
+ * Declarations for a fixed pool of threads running indexed tasks
+ */
+
+#pragma once
+
+#include "state/state_export.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace state {
+
+/**
+ * Runs a batch of independent tasks, numbered from 0, on a fixed set of
+ * threads. The calling thread works on the batch too, and waits until every
+ * task is done
+ *
+ * Tasks are handed out in no particular order, so tasks must only write to
+ * results indexed by their number for the outcome to be deterministic
+ */
+class STATE_EXPORT WorkerPool {
+  private:
+    /**
+     * Threads other than the calling one
+     */
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+
+    /**
+     * Signalled when a batch starts, or the pool is stopping
+     */
+    std::condition_variable batch_started;
+
+    /**
+     * Signalled when the last thread leaves a batch
+     */
+    std::condition_variable batch_finished;
+
+    /**
+     * Task of the present batch
+     */
+    const std::function<void(size_t)> *task;
+
+    /**
+     * Number of tasks in the present batch
+     */
+    size_t num_tasks;
+
+    /**
+     * Next task to be handed out
+     */
+    size_t next_task;
+
+    /**
+     * Number of threads, besides the calling one, still in the batch
+     */
+    size_t num_busy_threads;
+
+    /**
+     * Incremented on every batch, so that threads wake up once per batch
+     */
+    uint64_t batch_number;
+
+    /**
+     * First exception thrown by a task of the present batch
+     */
+    std::exception_ptr error;
+
+    bool is_stopping;
+
+    /**
+     * Runs tasks of the present batch until there are none left
+     *
+     * @param lock Lock on mutex, released while a task runs
+     */
+    void runTasks(std::unique_lock<std::mutex> &lock);
+
+    /**
+     * Loop of each thread in the pool
+     */
+    void work();
+
+  public:
+    /**
+     * Constructs a pool
+     *
+     * @param num_threads Number of threads working on a batch, including the
+     * calling one
+     */
+    explicit WorkerPool(size_t num_threads);
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /**
+     * Stops and joins the threads
+     */
+    ~WorkerPool();
+
+    /**
+     * Number of threads working on a batch, including the calling one
+     *
+     * @return size_t
+     */
+    size_t getNumThreads() const;
+
+    /**
+     * Runs task(0) to task(num_tasks - 1) and waits for them to finish
+     *
+     * @param num_tasks
+     * @param task
+     *
+     * @throw Rethrows the first exception thrown by a task, once the others
+     * have finished
+     */
+    void run(size_t num_tasks, const std::function<void(size_t)> &task);
+};
+} // namespace state
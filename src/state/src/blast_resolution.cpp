@@ -0,0 +1,122 @@
+/**
+ * @file blast_resolution.cpp
+ * Definitions for resolving the blasts issued in a turn
+ */
+
+#include "physics/simd.hpp"
+#include "state/state.h"
+
+#include <limits>
+
+namespace state {
+
+using physics::DoubleBatch;
+
+/**
+ * Computes the damage a blast deals to each of a list of positions. Positions
+ * out of range, or NaN, take no damage
+ *
+ * Matches the scalar formula exactly, as every lane is rounded the same way.
+ * The square root of a sum of squares gives the same distance as
+ * DoubleVec2D::distance
+ *
+ * @param xs X coordinates, a whole number of batches long
+ * @param ys Y coordinates, a whole number of batches long
+ * @param num_positions Length of xs, ys and damages
+ * @param position Position of the blast
+ * @param impact_radius
+ * @param damage_points Damage dealt at the position of the blast
+ * @param damages Damage to each position, before truncation
+ */
+static void computeBlastDamages(const double_t *xs, const double_t *ys,
+                                size_t num_positions, DoubleVec2D position,
+                                double_t impact_radius, double_t damage_points,
+                                double_t *damages) {
+    auto blast_x = DoubleBatch::broadcast(position.x);
+    auto blast_y = DoubleBatch::broadcast(position.y);
+    auto radius = DoubleBatch::broadcast(impact_radius);
+    auto damage = DoubleBatch::broadcast(damage_points);
+
+    for (size_t i = 0; i < num_positions; i += DoubleBatch::WIDTH) {
+        auto dx = DoubleBatch::load(xs + i) - blast_x;
+        auto dy = DoubleBatch::load(ys + i) - blast_y;
+        auto distance = sqrt(dx * dx + dy * dy);
+        auto normalized_remaining_distance = (radius - distance) / radius;
+        auto inflicted_damage = damage * normalized_remaining_distance;
+
+        selectLessEqual(distance, radius, inflicted_damage).store(damages + i);
+    }
+}
+
+void State::packBlastTargets(PlayerId player_id) {
+    auto id = static_cast<size_t>(player_id);
+    auto &targets = blast_targets[id];
+
+    targets.actors.clear();
+    for (auto *bot : bot_ptrs[id]) {
+        targets.actors.push_back(bot);
+    }
+    for (auto *tower : tower_ptrs[id]) {
+        targets.actors.push_back(tower);
+    }
+
+    auto num_actors = targets.actors.size();
+    auto num_positions = (num_actors + DoubleBatch::WIDTH - 1) /
+                         DoubleBatch::WIDTH * DoubleBatch::WIDTH;
+
+    targets.xs.resize(num_positions);
+    targets.ys.resize(num_positions);
+    targets.damages.resize(num_positions);
+    targets.total_damages.assign(num_actors, 0);
+
+    for (size_t i = 0; i < num_actors; ++i) {
+        auto position = targets.actors[i]->getPosition();
+        targets.xs[i] = position.x;
+        targets.ys[i] = position.y;
+    }
+    for (size_t i = num_actors; i < num_positions; ++i) {
+        targets.xs[i] = std::numeric_limits<double_t>::quiet_NaN();
+        targets.ys[i] = std::numeric_limits<double_t>::quiet_NaN();
+    }
+}
+
+void State::resolveBlasts() {
+    if (blast_events.empty()) {
+        return;
+    }
+
+    for (size_t id = 0; id < static_cast<size_t>(PlayerId::PLAYER_COUNT);
+         ++id) {
+        packBlastTargets(static_cast<PlayerId>(id));
+    }
+
+    for (const auto &blast_event : blast_events) {
+        auto id = static_cast<size_t>(blast_event.player_id);
+        auto enemy_id = (id + 1) % static_cast<size_t>(PlayerId::PLAYER_COUNT);
+        auto &targets = blast_targets[enemy_id];
+
+        computeBlastDamages(targets.xs.data(), targets.ys.data(),
+                            targets.xs.size(), blast_event.position,
+                            blast_event.impact_radius,
+                            blast_event.damage_points, targets.damages.data());
+
+        // Damage is truncated per blast, as when each blast was dealt alone
+        for (size_t i = 0; i < targets.actors.size(); ++i) {
+            targets.total_damages[i] +=
+                static_cast<uint64_t>(targets.damages[i]);
+        }
+    }
+
+    // Damage incurred is capped at the actor's hp, so adding up the blasts
+    // first gives the same result as dealing them one at a time
+    for (auto &targets : blast_targets) {
+        for (size_t i = 0; i < targets.actors.size(); ++i) {
+            if (targets.total_damages[i] > 0) {
+                targets.actors[i]->damage(targets.total_damages[i]);
+            }
+        }
+    }
+
+    blast_events.clear();
+}
+} // namespace state
@@ -0,0 +1,259 @@
+/**
+ * @file compiled_map.cpp
+ * Defines the CompiledMap class
+ */
+
+#include "state/map/compiled_map.h"
+
+#include <boost/interprocess/exceptions.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace state {
+
+namespace {
+
+/**
+ * Sections of a compiled map file, in the order they are written
+ */
+enum Section : size_t {
+    TERRAIN,
+    FLAGS,
+    WAYPOINTS,
+    EDGE_OFFSETS,
+    EDGE_TARGETS,
+    EDGE_COSTS,
+    CORNER_OFFSETS,
+    CORNER_WAYPOINTS,
+    VISIBLE_OFFSETS,
+    VISIBLE_WAYPOINTS,
+    PARTLY_VISIBLE_OFFSETS,
+    PARTLY_VISIBLE_WAYPOINTS,
+    DISTANCES,
+    NUM_SECTIONS
+};
+
+/**
+ * Start of a compiled map file, followed by its sections. Offsets and
+ * lengths are in bytes, and every section starts at a multiple of
+ * SECTION_ALIGNMENT
+ */
+struct FileHeader {
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t map_size;
+    uint64_t map_digest_high;
+    uint64_t map_digest_low;
+    std::array<uint64_t, NUM_SECTIONS> section_offsets;
+    std::array<uint64_t, NUM_SECTIONS> section_lengths;
+};
+
+const auto FILE_MAGIC = std::array<char, 8>{'C', 'C', 'M', 'A', 'P', 0, 0, 0};
+
+const size_t SECTION_ALIGNMENT = 8;
+
+/**
+ * Largest map size a compiled map is accepted with, well beyond any real map,
+ * so that a corrupt size is not multiplied into a huge allocation
+ */
+const size_t MAX_COMPILED_MAP_SIZE = 1 << 12;
+
+/**
+ * Append the elements of an array to a file buffer as a section
+ */
+template <typename T>
+void appendSection(std::string &buffer, FileHeader &header, Section section,
+                   const Span<const T> &elements) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Sections are copied byte for byte");
+
+    buffer.resize((buffer.size() + SECTION_ALIGNMENT - 1) /
+                      SECTION_ALIGNMENT * SECTION_ALIGNMENT,
+                  '\0');
+    header.section_offsets[section] = buffer.size();
+    header.section_lengths[section] = elements.size() * sizeof(T);
+    buffer.append(reinterpret_cast<const char *>(elements.begin()),
+                  elements.size() * sizeof(T));
+}
+} // namespace
+
+template <typename T>
+Span<const T> CompiledMap::getSection(size_t section) const {
+    auto const &header = *static_cast<const FileHeader *>(region.get_address());
+    auto offset = header.section_offsets[section];
+    auto length = header.section_lengths[section];
+
+    if (offset > region.get_size() || length > region.get_size() - offset)
+        throw std::runtime_error("Compiled map section out of bounds");
+    if (offset % alignof(T) != 0 || length % sizeof(T) != 0)
+        throw std::runtime_error("Compiled map section misaligned");
+
+    auto first = static_cast<const char *>(region.get_address()) + offset;
+    return {reinterpret_cast<const T *>(first), length / sizeof(T)};
+}
+
+CompiledMap::CompiledMap(const std::string &file_name) {
+    try {
+        file = boost::interprocess::file_mapping(
+            file_name.c_str(), boost::interprocess::read_only);
+        region = boost::interprocess::mapped_region(
+            file, boost::interprocess::read_only);
+    } catch (const boost::interprocess::interprocess_exception &error) {
+        throw std::runtime_error("Cannot map compiled map " + file_name +
+                                 ": " + error.what());
+    }
+
+    if (region.get_size() < sizeof(FileHeader))
+        throw std::runtime_error("Compiled map is truncated");
+
+    auto const &header = *static_cast<const FileHeader *>(region.get_address());
+    if (header.magic != FILE_MAGIC)
+        throw std::runtime_error("Not a compiled map");
+    if (header.version != COMPILED_MAP_VERSION)
+        throw std::runtime_error("Compiled map of another version");
+    if (header.map_size == 0 || header.map_size > MAX_COMPILED_MAP_SIZE)
+        throw std::runtime_error("Compiled map size out of range");
+
+    map_size = header.map_size;
+    map_digest = {header.map_digest_high, header.map_digest_low};
+
+    terrain = getSection<uint8_t>(TERRAIN);
+    if (terrain.size() != map_size * map_size)
+        throw std::runtime_error("Compiled map terrain does not fit the map");
+    for (auto cell_terrain : terrain) {
+        if (cell_terrain != static_cast<uint8_t>(TerrainType::LAND) &&
+            cell_terrain != static_cast<uint8_t>(TerrainType::WATER) &&
+            cell_terrain != static_cast<uint8_t>(TerrainType::FLAG))
+            throw std::runtime_error("Compiled map terrain is invalid");
+    }
+
+    flags = getSection<Vec2D>(FLAGS);
+    for (auto const &flag : flags) {
+        if (flag.x < 0 || flag.y < 0 || flag.x >= (int64_t) map_size ||
+            flag.y >= (int64_t) map_size ||
+            getTerrainType(flag.x, flag.y) != TerrainType::FLAG)
+            throw std::runtime_error("Compiled map flag is not on a flag");
+    }
+
+    // The graph is checked against the map when it is handed to PathGraph
+    waypoint_graph.waypoints = getSection<FixedVec2D>(WAYPOINTS);
+    waypoint_graph.edge_offsets = getSection<uint32_t>(EDGE_OFFSETS);
+    waypoint_graph.edge_targets = getSection<uint32_t>(EDGE_TARGETS);
+    waypoint_graph.edge_costs = getSection<double_t>(EDGE_COSTS);
+    waypoint_graph.corner_offsets = getSection<uint32_t>(CORNER_OFFSETS);
+    waypoint_graph.corner_waypoints = getSection<uint32_t>(CORNER_WAYPOINTS);
+    waypoint_graph.visible_offsets = getSection<uint32_t>(VISIBLE_OFFSETS);
+    waypoint_graph.visible_waypoints = getSection<uint32_t>(VISIBLE_WAYPOINTS);
+    waypoint_graph.partly_visible_offsets =
+        getSection<uint32_t>(PARTLY_VISIBLE_OFFSETS);
+    waypoint_graph.partly_visible_waypoints =
+        getSection<uint32_t>(PARTLY_VISIBLE_WAYPOINTS);
+    waypoint_graph.distances = getSection<double_t>(DISTANCES);
+}
+
+void CompiledMap::write(const std::string &file_name, StateDigest map_digest,
+                        const Map &map,
+                        const WaypointGraphView &waypoint_graph) {
+    auto map_size = map.getSize();
+    auto terrain = std::vector<uint8_t>{};
+    auto flags = std::vector<Vec2D>{};
+    for (size_t x = 0; x < map_size; ++x) {
+        for (size_t y = 0; y < map_size; ++y) {
+            auto cell_terrain = map.getTerrainType(x, y);
+            terrain.push_back(static_cast<uint8_t>(cell_terrain));
+            if (cell_terrain == TerrainType::FLAG)
+                flags.emplace_back(x, y);
+        }
+    }
+
+    auto header = FileHeader{};
+    header.magic = FILE_MAGIC;
+    header.version = COMPILED_MAP_VERSION;
+    header.map_size = static_cast<uint32_t>(map_size);
+    header.map_digest_high = map_digest.high;
+    header.map_digest_low = map_digest.low;
+
+    auto buffer = std::string(sizeof(FileHeader), '\0');
+    appendSection<uint8_t>(buffer, header, TERRAIN, terrain);
+    appendSection<Vec2D>(buffer, header, FLAGS, flags);
+    appendSection(buffer, header, WAYPOINTS, waypoint_graph.waypoints);
+    appendSection(buffer, header, EDGE_OFFSETS, waypoint_graph.edge_offsets);
+    appendSection(buffer, header, EDGE_TARGETS, waypoint_graph.edge_targets);
+    appendSection(buffer, header, EDGE_COSTS, waypoint_graph.edge_costs);
+    appendSection(buffer, header, CORNER_OFFSETS,
+                  waypoint_graph.corner_offsets);
+    appendSection(buffer, header, CORNER_WAYPOINTS,
+                  waypoint_graph.corner_waypoints);
+    appendSection(buffer, header, VISIBLE_OFFSETS,
+                  waypoint_graph.visible_offsets);
+    appendSection(buffer, header, VISIBLE_WAYPOINTS,
+                  waypoint_graph.visible_waypoints);
+    appendSection(buffer, header, PARTLY_VISIBLE_OFFSETS,
+                  waypoint_graph.partly_visible_offsets);
+    appendSection(buffer, header, PARTLY_VISIBLE_WAYPOINTS,
+                  waypoint_graph.partly_visible_waypoints);
+    appendSection(buffer, header, DISTANCES, waypoint_graph.distances);
+    std::memcpy(&buffer[0], &header, sizeof(header));
+
+    auto temporary_file_name = file_name + ".tmp";
+    auto file = std::ofstream(temporary_file_name, std::ios::binary);
+    file.write(buffer.data(), buffer.size());
+    file.close();
+    if (!file ||
+        std::rename(temporary_file_name.c_str(), file_name.c_str()) != 0) {
+        std::remove(temporary_file_name.c_str());
+        throw std::runtime_error("Cannot write compiled map " + file_name);
+    }
+}
+
+StateDigest CompiledMap::getMapTextDigest(const std::string &map_text) {
+    auto digest_builder = DigestBuilder();
+    digest_builder.add(uint64_t{map_text.size()});
+
+    // The text is added eight bytes at a time, the last word padded with
+    // zeroes
+    for (size_t offset = 0; offset < map_text.size(); offset += 8) {
+        auto word = uint64_t{0};
+        std::memcpy(&word, map_text.data() + offset,
+                    std::min<size_t>(8, map_text.size() - offset));
+        digest_builder.add(word);
+    }
+    return digest_builder.getDigest();
+}
+
+std::string CompiledMap::getFileName(StateDigest map_digest) {
+    return map_digest.toString() + COMPILED_MAP_EXTENSION;
+}
+
+size_t CompiledMap::getMapSize() const { return map_size; }
+
+StateDigest CompiledMap::getMapDigest() const { return map_digest; }
+
+TerrainType CompiledMap::getTerrainType(size_t x, size_t y) const {
+    return static_cast<TerrainType>(terrain[x * map_size + y]);
+}
+
+std::vector<std::vector<TerrainType>> CompiledMap::getTerrain() const {
+    auto map_terrain = std::vector<std::vector<TerrainType>>(
+        map_size, std::vector<TerrainType>(map_size));
+    for (size_t x = 0; x < map_size; ++x) {
+        for (size_t y = 0; y < map_size; ++y) {
+            map_terrain[x][y] = getTerrainType(x, y);
+        }
+    }
+    return map_terrain;
+}
+
+Span<const Vec2D> CompiledMap::getFlags() const { return flags; }
+
+const WaypointGraphView &CompiledMap::getWaypointGraph() const {
+    return waypoint_graph;
+}
+
+} // namespace state
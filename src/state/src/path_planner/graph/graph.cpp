@@ -5,30 +5,41 @@
 
 #include "state/path_planner/graph/graph.h"
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
 
 namespace state {
 
 size_t Graph::getNumNodes() const { return nodes.size(); }
 
-boost::unordered_set<DoubleVec2D> Graph::getNodes() const { return nodes; }
+boost::unordered_set<FixedVec2D> Graph::getNodes() const { return nodes; }
 
-bool Graph::checkNodeExists(const DoubleVec2D &node) const {
+const boost::unordered_set<FixedVec2D> &Graph::getNodeSet() const {
+    return nodes;
+}
+
+bool Graph::checkNodeExists(const FixedVec2D &node) const {
     return (nodes.find(node) != nodes.end());
 }
 
-bool Graph::checkEdgeExists(const DoubleVec2D &node_a,
-                            const DoubleVec2D &node_b) {
-    if (checkNodeExists(node_a) && checkNodeExists(node_b)) {
-        return (adjacency_list[node_a].find(node_b) !=
-                    adjacency_list[node_a].end() &&
-                adjacency_list[node_b].find(node_a) !=
-                    adjacency_list[node_b].end());
+bool Graph::checkEdgeExists(const FixedVec2D &node_a,
+                            const FixedVec2D &node_b) const {
+    auto edges_a = adjacency_list.find(node_a);
+    auto edges_b = adjacency_list.find(node_b);
+    if (edges_a == adjacency_list.end() || edges_b == adjacency_list.end()) {
+        return false;
     }
 
-    return false;
+    return (edges_a->second.find(node_b) != edges_a->second.end() &&
+            edges_b->second.find(node_a) != edges_b->second.end());
 }
 
-void Graph::addNode(DoubleVec2D node) {
+const EdgeList &Graph::getEdges(const FixedVec2D &node) const {
+    return adjacency_list.at(node);
+}
+
+void Graph::addNode(FixedVec2D node) {
     // Insert the node only if it doesn't exist
     if (checkNodeExists(node))
         return;
@@ -36,9 +47,10 @@ void Graph::addNode(DoubleVec2D node) {
     EdgeList edge_list;
     adjacency_list.insert({node, edge_list});
     nodes.insert(node);
+    clearLandmarks();
 }
 
-void Graph::removeNode(DoubleVec2D node) {
+void Graph::removeNode(FixedVec2D node) {
     if (checkNodeExists(node)) {
         nodes.erase(node);
 
@@ -48,10 +60,11 @@ void Graph::removeNode(DoubleVec2D node) {
         }
 
         adjacency_list.erase(node);
+        clearLandmarks();
     }
 }
 
-void Graph::addEdge(DoubleVec2D start_node, DoubleVec2D end_node,
+void Graph::addEdge(FixedVec2D start_node, FixedVec2D end_node,
                     double_t cost) {
     if (cost < 0)
         throw std::out_of_range("Cost cannot be negative");
@@ -59,10 +72,11 @@ void Graph::addEdge(DoubleVec2D start_node, DoubleVec2D end_node,
     if (checkNodeExists(start_node) && checkNodeExists(end_node)) {
         adjacency_list[start_node].insert({end_node, cost});
         adjacency_list[end_node].insert({start_node, cost});
+        clearLandmarks();
     }
 }
 
-void Graph::removeEdge(DoubleVec2D start_node, DoubleVec2D end_node) {
+void Graph::removeEdge(FixedVec2D start_node, FixedVec2D end_node) {
     if (checkNodeExists(start_node)) {
         adjacency_list[start_node].erase(end_node);
     }
@@ -70,63 +84,286 @@ void Graph::removeEdge(DoubleVec2D start_node, DoubleVec2D end_node) {
     if (checkNodeExists(end_node)) {
         adjacency_list[end_node].erase(start_node);
     }
+
+    clearLandmarks();
 }
 
 void Graph::resetGraph() {
     nodes.clear();
     adjacency_list.clear();
-    open_list_entries.clear();
-    open_list_heap = Heap();
+    clearLandmarks();
+    search.open_list_entries.clear();
+    search.open_list_heap = Heap();
 }
 
-void Graph::initOpenList(DoubleVec2D start_node,
-                         const DoubleVec2D &destination_node) {
-    open_list_entries.clear();
-    open_list_heap = Heap();
+void Graph::initOpenList(FixedVec2D start_node,
+                         const DoubleVec2D &start_position,
+                         const DoubleVec2D &destination_position,
+                         PathSearch &search) {
+    search.open_list_entries.clear();
+    search.open_list_heap = Heap();
 
     // Creating an open list entry for the start node
-    OpenListEntry start_node_entry{0, start_node.distance(destination_node),
-                                   DoubleVec2D::null, true};
+    OpenListEntry start_node_entry{
+        0, start_position.distance(destination_position), FixedVec2D::null,
+        true};
 
-    open_list_entries[start_node] = start_node_entry;
-    open_list_heap.push({start_node_entry.getTotalCost(), start_node});
+    search.open_list_entries[start_node] = start_node_entry;
+    search.open_list_heap.push({start_node_entry.getTotalCost(), start_node});
 }
 
-bool Graph::getBestNextPosition(DoubleVec2D &next_position) {
+bool Graph::getBestNextPosition(FixedVec2D &next_position,
+                                PathSearch &search) {
 
-    if (open_list_heap.empty())
+    if (search.open_list_heap.empty())
         return false;
 
     // Top node in heap has the least total cost
-    auto next_node = (open_list_heap.top()).second;
+    auto next_node = (search.open_list_heap.top()).second;
     next_position = next_node;
 
-    open_list_heap.pop();
+    search.open_list_heap.pop();
 
     return true;
 }
 
-void Graph::updateNeighbour(DoubleVec2D current_node,
-                            DoubleVec2D neighbour_node, double_t distance,
-                            const DoubleVec2D &destination_node) {
+boost::unordered::unordered_map<FixedVec2D, double_t>
+Graph::findDistances(FixedVec2D source) const {
+    auto distances = boost::unordered::unordered_map<FixedVec2D, double_t>{};
+    auto heap = Heap();
+
+    distances[source] = 0;
+    heap.push({0, source});
+
+    while (!heap.empty()) {
+        auto node_distance = heap.top().first;
+        auto node = heap.top().second;
+        heap.pop();
+
+        // Skip entries left behind by a shorter distance to the node
+        if (node_distance > distances[node])
+            continue;
+
+        for (const auto &edge : adjacency_list.at(node)) {
+            auto distance = node_distance + edge.second;
+            auto neighbour_distance = distances.find(edge.first);
+            if (neighbour_distance == distances.end() ||
+                distance < neighbour_distance->second) {
+                distances[edge.first] = distance;
+                heap.push({distance, edge.first});
+            }
+        }
+    }
+
+    return distances;
+}
+
+void Graph::clearLandmarks() {
+    landmarks.clear();
+    landmark_distances.clear();
+    landmark_epoch = 0;
+}
+
+void Graph::computeLandmarks(size_t num_landmarks,
+                             const NodeDistances &known_distances) {
+    clearLandmarks();
+    if (nodes.empty())
+        return;
+
+    // Distances found ahead of time are looked up, keeping only the nodes
+    // that are reached as a search would
+    auto getDistances = [this, &known_distances](const FixedVec2D &source) {
+        const auto &known_nodes = known_distances.nodes;
+        if (known_distances.distances.size() !=
+            known_nodes.size() * known_nodes.size())
+            return findDistances(source);
+
+        auto source_node = std::lower_bound(known_nodes.begin(),
+                                            known_nodes.end(), source);
+        if (source_node == known_nodes.end() || *source_node != source)
+            return findDistances(source);
+
+        auto distances =
+            boost::unordered::unordered_map<FixedVec2D, double_t>{};
+        auto row = static_cast<size_t>(source_node - known_nodes.begin()) *
+                   known_nodes.size();
+        for (size_t index = 0; index < known_nodes.size(); ++index) {
+            auto distance = known_distances.distances[row + index];
+            if (!std::isinf(distance))
+                distances[known_nodes[index]] = distance;
+        }
+        return distances;
+    };
+
+    // Graphs share the count, so that no two sets of landmarks have the same
+    // epoch
+    static std::atomic<uint64_t> last_landmark_epoch{0};
+    landmark_epoch = ++last_landmark_epoch;
+
+    auto infinity = std::numeric_limits<double_t>::infinity();
+    auto getDistance =
+        [infinity](
+            const boost::unordered::unordered_map<FixedVec2D, double_t>
+                &distances,
+            const FixedVec2D &node) {
+            auto distance = distances.find(node);
+            return distance == distances.end() ? infinity : distance->second;
+        };
+
+    // Distance of each node from the nearest landmark picked so far. The
+    // first landmark is the node farthest from the least node. Nodes that no
+    // landmark reaches are the farthest of all, so every part of the graph
+    // gets a landmark before any part gets a second one
+    auto least_node = *std::min_element(nodes.begin(), nodes.end());
+    auto nearest_distances = getDistances(least_node);
+
+    num_landmarks = std::min(num_landmarks, nodes.size());
+    while (landmarks.size() < num_landmarks) {
+        // Ties are broken by position, so that the landmarks do not depend
+        // on the order of the nodes
+        auto landmark = FixedVec2D::null;
+        auto landmark_distance = -infinity;
+        for (const auto &node : nodes) {
+            auto distance = getDistance(nearest_distances, node);
+            if (distance > landmark_distance ||
+                (distance == landmark_distance && node < landmark)) {
+                landmark = node;
+                landmark_distance = distance;
+            }
+        }
+
+        // Every node is already a landmark
+        if (landmark_distance == 0)
+            break;
+
+        auto distances = getDistances(landmark);
+        auto is_first_landmark = landmarks.empty();
+        landmarks.push_back(landmark);
+
+        for (const auto &node : nodes) {
+            auto distance = getDistance(distances, node);
+            landmark_distances[node].push_back(distance);
+
+            if (is_first_landmark) {
+                nearest_distances[node] = distance;
+            } else {
+                nearest_distances[node] = std::min(
+                    getDistance(nearest_distances, node), distance);
+            }
+        }
+    }
+}
+
+void Graph::initLandmarkBounds(FixedVec2D destination_node,
+                               const DoubleVec2D &destination_position,
+                               PathSearch &search) const {
+    if (heuristic != PathHeuristic::LANDMARKS || landmarks.empty()) {
+        search.landmark_end_distances.clear();
+        search.landmark_end_reaches.clear();
+        search.landmark_bounds_epoch = 0;
+        return;
+    }
+
+    // Many searches share an end, such as bots heading for the same flag
+    if (search.landmark_bounds_epoch == landmark_epoch &&
+        search.landmark_bounds_end.x == destination_position.x &&
+        search.landmark_bounds_end.y == destination_position.y) {
+        return;
+    }
+    search.landmark_bounds_end = destination_position;
+    search.landmark_bounds_epoch = landmark_epoch;
+
+    auto destination_distances = landmark_distances.find(destination_node);
+    if (destination_distances != landmark_distances.end()) {
+        search.landmark_end_distances = destination_distances->second;
+        search.landmark_end_reaches = destination_distances->second;
+        return;
+    }
+
+    // A path to an end that is not a node leaves the graph by one of the
+    // end's edges. So a landmark's distance to the end is its least distance
+    // through an edge, and a node's cost to the end is at least its distance
+    // from the landmark less the greatest reach of an edge
+    auto infinity = std::numeric_limits<double_t>::infinity();
+    search.landmark_end_distances.assign(landmarks.size(), infinity);
+    search.landmark_end_reaches.assign(landmarks.size(), -infinity);
+
+    for (const auto &end_edge : search.end_edges) {
+        auto edge_distances = landmark_distances.find(end_edge.first);
+        if (edge_distances == landmark_distances.end())
+            continue;
+
+        for (size_t index = 0; index < landmarks.size(); ++index) {
+            auto distance = edge_distances->second[index];
+            search.landmark_end_distances[index] =
+                std::min(search.landmark_end_distances[index],
+                         distance + end_edge.second);
+            search.landmark_end_reaches[index] =
+                std::max(search.landmark_end_reaches[index],
+                         distance - end_edge.second);
+        }
+    }
+}
+
+double_t Graph::estimateCost(FixedVec2D node,
+                             const DoubleVec2D &destination_position,
+                             const PathSearch &search) const {
+    auto cost = node.to_double().distance(destination_position);
+    if (search.landmark_end_distances.empty())
+        return cost;
+
+    auto node_distances = landmark_distances.find(node);
+    if (node_distances == landmark_distances.end())
+        return cost;
+
+    // By the triangle inequality, the cost between two nodes is at least the
+    // difference of their distances from any landmark. Landmarks that cannot
+    // reach the node bound nothing
+    for (size_t index = 0; index < landmarks.size(); ++index) {
+        auto node_distance = node_distances->second[index];
+        if (std::isinf(node_distance))
+            continue;
+
+        cost = std::max(
+            {cost, search.landmark_end_distances[index] - node_distance,
+             node_distance - search.landmark_end_reaches[index]});
+    }
+
+    return cost;
+}
+
+void Graph::updateNeighbour(FixedVec2D current_node, FixedVec2D neighbour_node,
+                            double_t distance, FixedVec2D destination_node,
+                            const DoubleVec2D &destination_position,
+                            PathSearch &search) const {
+    auto &open_list_entries = search.open_list_entries;
+
     // Neighbour's cost from start is cost of current node + distance between
     // current node and neighbour
     double_t neighbour_g_value =
         open_list_entries[current_node].g_value + distance;
 
-    // Neighbour's heuristic cost to destination is euclidean distance between
-    // them
-    double_t neighbour_h_value = neighbour_node.distance(destination_node);
+    auto neighbour_entry = open_list_entries.find(neighbour_node);
 
     // Neighbour node has not been visited yet
-    if (open_list_entries.find(neighbour_node) == open_list_entries.end()) {
-
+    if (neighbour_entry == open_list_entries.end()) {
+        // Neighbour's heuristic cost to destination. It depends only on the
+        // neighbour, so it is found once, when the neighbour is first seen
+        double_t neighbour_h_value =
+            neighbour_node == destination_node
+                ? 0
+                : estimateCost(neighbour_node, destination_position, search);
+
+        // Neighbours that cannot reach the destination are closed at once
+        auto is_open = !std::isinf(neighbour_h_value);
         open_list_entries[neighbour_node] = OpenListEntry{
-            neighbour_g_value, neighbour_h_value, current_node, true};
-        open_list_heap.push(
-            {neighbour_g_value + neighbour_h_value, neighbour_node});
+            neighbour_g_value, neighbour_h_value, current_node, is_open};
+        if (is_open) {
+            search.open_list_heap.push(
+                {neighbour_g_value + neighbour_h_value, neighbour_node});
+        }
     } else {
-        auto neighbour_open_list_entry = &(open_list_entries[neighbour_node]);
+        auto neighbour_open_list_entry = &neighbour_entry->second;
 
         if (!neighbour_open_list_entry->is_open) {
             // Neighbour node is closed, so ignore
@@ -134,6 +371,7 @@ void Graph::updateNeighbour(DoubleVec2D current_node,
         }
 
         auto current_total_cost = neighbour_open_list_entry->getTotalCost();
+        auto neighbour_h_value = neighbour_open_list_entry->h_value;
 
         // Update only if new total cost is less than previous total
         // cost
@@ -141,64 +379,265 @@ void Graph::updateNeighbour(DoubleVec2D current_node,
 
             neighbour_open_list_entry->parent = current_node;
             neighbour_open_list_entry->g_value = neighbour_g_value;
-            neighbour_open_list_entry->h_value = neighbour_h_value;
 
-            open_list_heap.push(
+            search.open_list_heap.push(
                 {neighbour_g_value + neighbour_h_value, neighbour_node});
         }
     }
 }
 
-std::vector<DoubleVec2D> Graph::generateOpenListPath(DoubleVec2D node) {
-    auto result = std::vector<DoubleVec2D>{};
-    auto result_node = node;
+ArenaVector<DoubleVec2D>
+Graph::generateOpenListPath(FixedVec2D destination_node,
+                            const DoubleVec2D &destination_position,
+                            PathSearch &search) {
+    auto result = ArenaVector<DoubleVec2D>(search.turn_arena);
+    auto result_node = destination_node;
 
-    // Traceback through the nodes' parents to get the complete path
+    // Traceback through the nodes' parents to get the complete path. The
+    // destination itself is given exactly rather than by its node
     while (result_node &&
-           open_list_entries[result_node].parent != DoubleVec2D::null) {
-        result.push_back(result_node);
-        result_node = open_list_entries[result_node].parent;
+           search.open_list_entries[result_node].parent != FixedVec2D::null) {
+        result.push_back(result_node == destination_node
+                             ? destination_position
+                             : result_node.to_double());
+        result_node = search.open_list_entries[result_node].parent;
     }
 
     std::reverse(result.begin(), result.end());
     return result;
 }
 
-std::vector<DoubleVec2D> Graph::getPath(DoubleVec2D start_node,
-                                        DoubleVec2D end_node) {
-    if (!checkNodeExists(start_node) || !checkNodeExists(end_node)) {
-        return std::vector<DoubleVec2D>{};
+void Graph::setTurnArena(TurnArena *turn_arena) {
+    search.turn_arena = turn_arena;
+}
+
+void Graph::setHeuristic(PathHeuristic p_heuristic) {
+    heuristic = p_heuristic;
+}
+
+PathHeuristic Graph::getHeuristic() const { return heuristic; }
+
+const std::vector<FixedVec2D> &Graph::getLandmarks() const {
+    return landmarks;
+}
+
+const PathSearchStats &Graph::getSearchStats() const { return search.stats; }
+
+ArenaVector<DoubleVec2D> Graph::getPath(DoubleVec2D start_position,
+                                        DoubleVec2D end_position) {
+    if (!checkNodeExists(start_position) || !checkNodeExists(end_position)) {
+        return ArenaVector<DoubleVec2D>(search.turn_arena);
     }
 
-    if (start_node == end_node) {
-        return std::vector<DoubleVec2D>{};
+    search.start_edges.clear();
+    search.end_edges.clear();
+    return findPath(start_position, end_position, search);
+}
+
+ArenaVector<DoubleVec2D> Graph::findPath(DoubleVec2D start_position,
+                                         DoubleVec2D end_position,
+                                         PathSearch &search) const {
+    auto start_node = FixedVec2D(start_position);
+    auto end_node = FixedVec2D(end_position);
+    if (start_position == end_position || start_node == end_node) {
+        return ArenaVector<DoubleVec2D>(search.turn_arena);
     }
 
-    initOpenList(start_node, end_node);
+    auto is_start_in_graph = checkNodeExists(start_node);
+    auto is_end_in_graph = checkNodeExists(end_node);
+
+    initOpenList(start_node, start_position, end_position, search);
+    initLandmarkBounds(end_node, end_position, search);
+    ++search.stats.num_searches;
 
     // Current position while traversing through graph
-    auto current_node = DoubleVec2D::null;
+    auto current_node = FixedVec2D::null;
 
-    while (getBestNextPosition(current_node)) {
-        if (!open_list_entries[current_node].is_open)
+    while (getBestNextPosition(current_node, search)) {
+        if (!search.open_list_entries[current_node].is_open)
             continue;
 
-        open_list_entries[current_node].is_open = false;
+        search.open_list_entries[current_node].is_open = false;
+        ++search.stats.num_expanded_nodes;
 
         // Return path
         if (current_node == end_node) {
-            return generateOpenListPath(current_node);
+            return generateOpenListPath(current_node, end_position, search);
+        }
+
+        // Add neighbours to openListHeap and updateOpenListEntries. The
+        // neighbours are independent of each other, so the order they are
+        // visited in does not change the path
+        if (current_node == start_node && !is_start_in_graph) {
+            for (auto neighbour : search.start_edges) {
+                updateNeighbour(current_node, neighbour.first,
+                                neighbour.second, end_node, end_position,
+                                search);
+            }
+            continue;
         }
 
-        // Add neighbours to openListHeap and updateOpenListEntries
-        for (auto neighbour : adjacency_list[current_node]) {
+        for (auto neighbour : adjacency_list.at(current_node)) {
             updateNeighbour(current_node, neighbour.first, neighbour.second,
-                            end_node);
+                            end_node, end_position, search);
+        }
+
+        if (!is_end_in_graph) {
+            auto end_edge = search.end_edges.find(current_node);
+            if (end_edge != search.end_edges.end()) {
+                updateNeighbour(current_node, end_node, end_edge->second,
+                                end_node, end_position, search);
+            }
         }
     }
 
     // No path found
-    return std::vector<DoubleVec2D>{};
+    return ArenaVector<DoubleVec2D>(search.turn_arena);
+}
+
+void Graph::findPathTree(DoubleVec2D end_position,
+                         const std::vector<EdgeList> &start_edges,
+                         PathSearch &search) const {
+    auto end_node = FixedVec2D(end_position);
+    auto is_end_in_graph = checkNodeExists(end_node);
+    auto &open_list_entries = search.open_list_entries;
+
+    open_list_entries.clear();
+    search.open_list_heap = Heap();
+    open_list_entries[end_node] = OpenListEntry{0, 0, FixedVec2D::null, true};
+    search.open_list_heap.push({0, end_node});
+    ++search.stats.num_searches;
+
+    // Cost of the shortest path found so far from each start, through the
+    // nodes its edges lead to. Starts with no edges want no path
+    auto infinity = std::numeric_limits<double_t>::infinity();
+    auto start_costs = std::vector<double_t>(start_edges.size(), 0);
+    auto node_starts = boost::unordered::unordered_map<
+        FixedVec2D, std::vector<std::pair<size_t, double_t>>>{};
+    auto num_unreached_starts = size_t{0};
+    for (size_t index = 0; index < start_edges.size(); ++index) {
+        if (start_edges[index].empty())
+            continue;
+
+        start_costs[index] = infinity;
+        ++num_unreached_starts;
+        for (const auto &edge : start_edges[index]) {
+            node_starts[edge.first].emplace_back(index, edge.second);
+        }
+    }
+    auto max_start_cost = infinity;
+    auto is_max_start_cost_stale = false;
+
+    auto current_node = FixedVec2D::null;
+    while (getBestNextPosition(current_node, search)) {
+        auto &current_entry = open_list_entries[current_node];
+        if (!current_entry.is_open)
+            continue;
+
+        // The nodes left are no nearer the end than this one, so they cannot
+        // shorten the path from any start once every path costs less
+        auto current_g_value = current_entry.g_value;
+        if (num_unreached_starts == 0) {
+            if (is_max_start_cost_stale) {
+                max_start_cost = *std::max_element(start_costs.begin(),
+                                                   start_costs.end());
+                is_max_start_cost_stale = false;
+            }
+            if (current_g_value >= max_start_cost)
+                break;
+        }
+
+        current_entry.is_open = false;
+        ++search.stats.num_expanded_nodes;
+
+        auto current_starts = node_starts.find(current_node);
+        if (current_starts != node_starts.end()) {
+            for (const auto &start : current_starts->second) {
+                auto cost = start.second + current_g_value;
+                if (cost < start_costs[start.first]) {
+                    if (std::isinf(start_costs[start.first]))
+                        --num_unreached_starts;
+                    start_costs[start.first] = cost;
+                    is_max_start_cost_stale = true;
+                }
+            }
+        }
+
+        // Edges cost the same both ways, so the paths to the end are found
+        // by following them out from the end
+        const auto &edges = current_node == end_node && !is_end_in_graph
+                                ? search.end_edges
+                                : adjacency_list.at(current_node);
+
+        for (const auto &edge : edges) {
+            auto neighbour_g_value = current_g_value + edge.second;
+            auto neighbour_entry = open_list_entries.find(edge.first);
+
+            if (neighbour_entry == open_list_entries.end()) {
+                open_list_entries[edge.first] = OpenListEntry{
+                    neighbour_g_value, 0, current_node, true};
+                search.open_list_heap.push({neighbour_g_value, edge.first});
+            } else if (neighbour_entry->second.is_open &&
+                       neighbour_g_value < neighbour_entry->second.g_value) {
+                neighbour_entry->second.g_value = neighbour_g_value;
+                neighbour_entry->second.parent = current_node;
+                search.open_list_heap.push({neighbour_g_value, edge.first});
+            }
+        }
+    }
+}
+
+ArenaVector<DoubleVec2D> Graph::getTreePath(DoubleVec2D start_position,
+                                            DoubleVec2D end_position,
+                                            const EdgeList &start_edges,
+                                            PathSearch &search) const {
+    auto result = ArenaVector<DoubleVec2D>(search.turn_arena);
+    auto start_node = FixedVec2D(start_position);
+    auto end_node = FixedVec2D(end_position);
+    if (start_position == end_position || start_node == end_node) {
+        return result;
+    }
+
+    auto getFoundEntry = [&search](const FixedVec2D &node) {
+        auto entry = search.open_list_entries.find(node);
+        if (entry == search.open_list_entries.end() || entry->second.is_open)
+            return static_cast<const OpenListEntry *>(nullptr);
+        return static_cast<const OpenListEntry *>(&entry->second);
+    };
+
+    // A start in the graph has its path found already. Any other start takes
+    // the edge that its shortest path leaves by, with ties broken by
+    // position, so that the path does not depend on the order of the edges
+    auto next_node = FixedVec2D::null;
+    if (checkNodeExists(start_node)) {
+        auto start_entry = getFoundEntry(start_node);
+        if (start_entry == nullptr)
+            return result;
+        next_node = start_entry->parent;
+    } else {
+        auto best_cost = std::numeric_limits<double_t>::infinity();
+        for (const auto &edge : start_edges) {
+            auto edge_entry = getFoundEntry(edge.first);
+            if (edge_entry == nullptr)
+                continue;
+
+            auto cost = edge.second + edge_entry->g_value;
+            if (cost < best_cost ||
+                (cost == best_cost && edge.first < next_node)) {
+                next_node = edge.first;
+                best_cost = cost;
+            }
+        }
+    }
+
+    // The end itself is given exactly rather than by its node
+    while (next_node) {
+        result.push_back(next_node == end_node ? end_position
+                                               : next_node.to_double());
+        next_node = search.open_list_entries.at(next_node).parent;
+    }
+
+    return result;
 }
 
 } // namespace state
@@ -0,0 +1,433 @@
+/**
+ * @file hierarchical_path_graph.cpp
+ * Defines a path finder that plans over chunks of the map
+ */
+
+#include "state/path_planner/hierarchical_path_graph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <queue>
+
+namespace state {
+
+HierarchicalPathGraph::HierarchicalPathGraph() = default;
+
+HierarchicalPathGraph::HierarchicalPathGraph(const PathGraph *p_terrain,
+                                             size_t p_map_size,
+                                             size_t p_chunk_size)
+    : terrain(p_terrain), map_size(p_map_size), chunk_size(p_chunk_size),
+      num_chunks_per_side((p_map_size + p_chunk_size - 1) / p_chunk_size) {
+    auto num_chunks = num_chunks_per_side * num_chunks_per_side;
+    chunks.resize(num_chunks);
+    right_borders.resize(num_chunks);
+    top_borders.resize(num_chunks);
+    is_right_border_current.assign(num_chunks, false);
+    is_top_border_current.assign(num_chunks, false);
+}
+
+int64_t HierarchicalPathGraph::getCellIndex(int64_t x, int64_t y) const {
+    return x * (int64_t) map_size + y;
+}
+
+FixedVec2D HierarchicalPathGraph::getCellCenter(int64_t cell) const {
+    auto x = cell / (int64_t) map_size;
+    auto y = cell % (int64_t) map_size;
+    return FixedVec2D::fromUnits(
+        static_cast<int32_t>(x * physics::FIXED_POINT_ONE +
+                             physics::FIXED_POINT_ONE / 2),
+        static_cast<int32_t>(y * physics::FIXED_POINT_ONE +
+                             physics::FIXED_POINT_ONE / 2));
+}
+
+size_t HierarchicalPathGraph::getChunkIndex(int64_t cell) const {
+    auto x = static_cast<size_t>(cell) / map_size;
+    auto y = static_cast<size_t>(cell) % map_size;
+    return (x / chunk_size) * num_chunks_per_side + (y / chunk_size);
+}
+
+size_t HierarchicalPathGraph::getChunkCellIndex(size_t chunk_index,
+                                                int64_t cell) const {
+    auto x = static_cast<size_t>(cell) / map_size;
+    auto y = static_cast<size_t>(cell) % map_size;
+    auto chunk_x = (chunk_index / num_chunks_per_side) * chunk_size;
+    auto chunk_y = (chunk_index % num_chunks_per_side) * chunk_size;
+    return (x - chunk_x) * chunk_size + (y - chunk_y);
+}
+
+int64_t HierarchicalPathGraph::findCell(const DoubleVec2D &position) const {
+    auto cell = terrain->findValidCell(position);
+    return cell ? getCellIndex(cell.x, cell.y) : -1;
+}
+
+HierarchicalPathGraph::BorderEntrances
+HierarchicalPathGraph::findBorderEntrances(size_t chunk_index,
+                                           bool is_right_border) const {
+    auto entrances = BorderEntrances{};
+    auto chunk_x = chunk_index / num_chunks_per_side;
+    auto chunk_y = chunk_index % num_chunks_per_side;
+
+    // The chunks on the right and the top edges of the map have no border
+    // there
+    if ((is_right_border ? chunk_x : chunk_y) + 1 >= num_chunks_per_side)
+        return entrances;
+
+    // Cells beside the border, indexed along it, on the near and the far side
+    auto along_start =
+        (int64_t)((is_right_border ? chunk_y : chunk_x) * chunk_size);
+    auto along_end =
+        std::min(along_start + (int64_t) chunk_size, (int64_t) map_size);
+    auto across =
+        (int64_t)(((is_right_border ? chunk_x : chunk_y) + 1) * chunk_size) -
+        1;
+    auto getCellPair = [&](int64_t along) {
+        if (is_right_border) {
+            return std::make_pair(getCellIndex(across, along),
+                                  getCellIndex(across + 1, along));
+        }
+        return std::make_pair(getCellIndex(along, across),
+                              getCellIndex(along, across + 1));
+    };
+    auto isOpen = [&](int64_t along) {
+        if (is_right_border) {
+            return terrain->isValidCell(across, along) &&
+                   terrain->isValidCell(across + 1, along);
+        }
+        return terrain->isValidCell(along, across) &&
+               terrain->isValidCell(along, across + 1);
+    };
+
+    // Each open stretch gets an entrance in its middle, or one at each end
+    // if it is long
+    int64_t run_start = -1;
+    for (auto along = along_start; along <= along_end; ++along) {
+        auto is_open = along < along_end && isOpen(along);
+        if (is_open && run_start < 0) {
+            run_start = along;
+        } else if (!is_open && run_start >= 0) {
+            auto run_end = along - 1;
+            if (run_end - run_start + 1 >=
+                (int64_t) PATH_ENTRANCE_SPLIT_LENGTH) {
+                entrances.push_back(getCellPair(run_start));
+                entrances.push_back(getCellPair(run_end));
+            } else {
+                entrances.push_back(getCellPair((run_start + run_end) / 2));
+            }
+            run_start = -1;
+        }
+    }
+
+    return entrances;
+}
+
+void HierarchicalPathGraph::searchChunk(size_t chunk_index, int64_t source,
+                                        std::vector<double_t> &distances,
+                                        std::vector<int64_t> &parents) const {
+    auto chunk_x = (int64_t)((chunk_index / num_chunks_per_side) * chunk_size);
+    auto chunk_y = (int64_t)((chunk_index % num_chunks_per_side) * chunk_size);
+    auto chunk_x_end =
+        std::min(chunk_x + (int64_t) chunk_size, (int64_t) map_size);
+    auto chunk_y_end =
+        std::min(chunk_y + (int64_t) chunk_size, (int64_t) map_size);
+
+    distances.assign(chunk_size * chunk_size,
+                     std::numeric_limits<double_t>::infinity());
+    parents.assign(chunk_size * chunk_size, -1);
+
+    typedef std::pair<double_t, int64_t> QueueEntry;
+    auto queue = std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                                     std::greater<QueueEntry>>();
+    distances[getChunkCellIndex(chunk_index, source)] = 0;
+    queue.emplace(0, source);
+
+    while (!queue.empty()) {
+        auto entry = queue.top();
+        queue.pop();
+
+        auto cell = entry.second;
+        if (entry.first > distances[getChunkCellIndex(chunk_index, cell)])
+            continue;
+
+        auto x = cell / (int64_t) map_size;
+        auto y = cell % (int64_t) map_size;
+        for (int64_t dx = -1; dx <= 1; ++dx) {
+            for (int64_t dy = -1; dy <= 1; ++dy) {
+                auto next_x = x + dx;
+                auto next_y = y + dy;
+                if ((dx == 0 && dy == 0) || next_x < chunk_x ||
+                    next_x >= chunk_x_end || next_y < chunk_y ||
+                    next_y >= chunk_y_end ||
+                    !terrain->isValidCell(next_x, next_y))
+                    continue;
+
+                auto next_cell = getCellIndex(next_x, next_y);
+                auto next_index = getChunkCellIndex(chunk_index, next_cell);
+                auto distance =
+                    entry.first + (dx != 0 && dy != 0 ? M_SQRT2 : 1.0);
+                if (distance < distances[next_index]) {
+                    distances[next_index] = distance;
+                    parents[next_index] = cell;
+                    queue.emplace(distance, next_cell);
+                }
+            }
+        }
+    }
+}
+
+void HierarchicalPathGraph::recomputeChunk(size_t chunk_index) {
+    auto &chunk = chunks[chunk_index];
+    auto chunk_x = chunk_index / num_chunks_per_side;
+    auto chunk_y = chunk_index % num_chunks_per_side;
+
+    // Remove the old edges inside the chunk
+    for (size_t i = 0; i < chunk.entrances.size(); ++i) {
+        for (size_t j = i + 1; j < chunk.entrances.size(); ++j) {
+            graph.removeEdge(getCellCenter(chunk.entrances[i]),
+                             getCellCenter(chunk.entrances[j]));
+        }
+    }
+
+    // The entrances are the chunk's cells on each of its four borders
+    auto entrances = std::vector<int64_t>{};
+    for (const auto &entrance : right_borders[chunk_index])
+        entrances.push_back(entrance.first);
+    for (const auto &entrance : top_borders[chunk_index])
+        entrances.push_back(entrance.first);
+    if (chunk_x > 0) {
+        for (const auto &entrance :
+             right_borders[chunk_index - num_chunks_per_side])
+            entrances.push_back(entrance.second);
+    }
+    if (chunk_y > 0) {
+        for (const auto &entrance : top_borders[chunk_index - 1])
+            entrances.push_back(entrance.second);
+    }
+    std::sort(entrances.begin(), entrances.end());
+    entrances.erase(std::unique(entrances.begin(), entrances.end()),
+                    entrances.end());
+
+    auto removed_entrances = std::vector<int64_t>{};
+    std::set_difference(chunk.entrances.begin(), chunk.entrances.end(),
+                        entrances.begin(), entrances.end(),
+                        std::back_inserter(removed_entrances));
+    for (auto entrance : removed_entrances)
+        graph.removeNode(getCellCenter(entrance));
+    for (auto entrance : entrances)
+        graph.addNode(getCellCenter(entrance));
+
+    // Join each pair of entrances that are joined inside the chunk
+    auto distances = std::vector<double_t>{};
+    auto parents = std::vector<int64_t>{};
+    for (size_t i = 0; i < entrances.size(); ++i) {
+        searchChunk(chunk_index, entrances[i], distances, parents);
+        for (size_t j = i + 1; j < entrances.size(); ++j) {
+            auto distance =
+                distances[getChunkCellIndex(chunk_index, entrances[j])];
+            if (std::isfinite(distance)) {
+                graph.addEdge(getCellCenter(entrances[i]),
+                              getCellCenter(entrances[j]), distance);
+            }
+        }
+    }
+
+    chunk.entrances = std::move(entrances);
+    chunk.is_current = true;
+}
+
+void HierarchicalPathGraph::appendChunkPath(size_t chunk_index, int64_t from,
+                                            int64_t to,
+                                            std::vector<int64_t> &cells) const {
+    auto distances = std::vector<double_t>{};
+    auto parents = std::vector<int64_t>{};
+    searchChunk(chunk_index, from, distances, parents);
+
+    auto path_start = cells.size();
+    for (auto cell = to; cell != from;
+         cell = parents[getChunkCellIndex(chunk_index, cell)]) {
+        cells.push_back(cell);
+    }
+    std::reverse(cells.begin() + path_start, cells.end());
+}
+
+void HierarchicalPathGraph::setTurnArena(TurnArena *turn_arena) {
+    search.turn_arena = turn_arena;
+    graph.setTurnArena(turn_arena);
+}
+
+void HierarchicalPathGraph::invalidateCell(const Vec2D &cell) {
+    if (cell.x < 0 || cell.y < 0 || cell.x >= (int64_t) map_size ||
+        cell.y >= (int64_t) map_size)
+        return;
+
+    auto chunk_x = (size_t) cell.x / chunk_size;
+    auto chunk_y = (size_t) cell.y / chunk_size;
+    auto chunk_index = chunk_x * num_chunks_per_side + chunk_y;
+    chunks[chunk_index].is_current = false;
+
+    // A cell beside a border can change the entrances across it
+    if ((size_t) cell.x % chunk_size == chunk_size - 1)
+        is_right_border_current[chunk_index] = false;
+    if ((size_t) cell.x % chunk_size == 0 && chunk_x > 0)
+        is_right_border_current[chunk_index - num_chunks_per_side] = false;
+    if ((size_t) cell.y % chunk_size == chunk_size - 1)
+        is_top_border_current[chunk_index] = false;
+    if ((size_t) cell.y % chunk_size == 0 && chunk_y > 0)
+        is_top_border_current[chunk_index - 1] = false;
+}
+
+size_t HierarchicalPathGraph::recompute() {
+    // Borders first, as the entrances of the chunks on either side of a border
+    // change with it
+    auto changed_borders = std::vector<const BorderEntrances *>{};
+    for (size_t chunk_index = 0; chunk_index < chunks.size(); ++chunk_index) {
+        for (auto is_right_border : {true, false}) {
+            auto &borders = is_right_border ? right_borders : top_borders;
+            auto &is_border_current = is_right_border
+                                          ? is_right_border_current
+                                          : is_top_border_current;
+            if (is_border_current[chunk_index])
+                continue;
+            is_border_current[chunk_index] = true;
+
+            auto entrances = findBorderEntrances(chunk_index, is_right_border);
+            if (entrances == borders[chunk_index])
+                continue;
+
+            for (const auto &entrance : borders[chunk_index]) {
+                graph.removeEdge(getCellCenter(entrance.first),
+                                 getCellCenter(entrance.second));
+            }
+            borders[chunk_index] = std::move(entrances);
+            changed_borders.push_back(&borders[chunk_index]);
+
+            auto far_chunk_index =
+                chunk_index + (is_right_border ? num_chunks_per_side : 1);
+            chunks[chunk_index].is_current = false;
+            chunks[far_chunk_index].is_current = false;
+        }
+    }
+
+    size_t num_recomputed_chunks = 0;
+    for (size_t chunk_index = 0; chunk_index < chunks.size(); ++chunk_index) {
+        if (!chunks[chunk_index].is_current) {
+            recomputeChunk(chunk_index);
+            ++num_recomputed_chunks;
+        }
+    }
+
+    // Edges across the changed borders, now that both of their ends are nodes
+    for (const auto *border : changed_borders) {
+        for (const auto &entrance : *border) {
+            graph.addEdge(getCellCenter(entrance.first),
+                          getCellCenter(entrance.second), 1);
+        }
+    }
+
+    return num_recomputed_chunks;
+}
+
+const Graph &HierarchicalPathGraph::getGraph() const { return graph; }
+
+const PathSearchStats &HierarchicalPathGraph::getSearchStats() const {
+    return search.stats;
+}
+
+ArenaVector<DoubleVec2D>
+HierarchicalPathGraph::getPath(DoubleVec2D start_position,
+                               DoubleVec2D end_position) {
+    return getPath(start_position, end_position, search);
+}
+
+ArenaVector<DoubleVec2D>
+HierarchicalPathGraph::getPath(DoubleVec2D start_position,
+                               DoubleVec2D end_position,
+                               PathSearch &search) const {
+    auto result = ArenaVector<DoubleVec2D>(search.turn_arena);
+    search.start_edges.clear();
+    search.end_edges.clear();
+
+    if (FixedVec2D(start_position) == FixedVec2D(end_position))
+        return result;
+
+    auto start_cell = findCell(start_position);
+    auto end_cell = findCell(end_position);
+    if (start_cell < 0 || end_cell < 0)
+        return result;
+
+    // Positions in sight of each other need no search
+    if (terrain->arePointsDirectlyReachable(start_position, end_position)) {
+        result.push_back(end_position);
+        return result;
+    }
+
+    // Join the start and the end to the entrances of their chunks, through
+    // the centers of their cells
+    auto start_chunk = getChunkIndex(start_cell);
+    auto end_chunk = getChunkIndex(end_cell);
+    auto start_offset =
+        start_position.distance(getCellCenter(start_cell).to_double());
+    auto end_offset =
+        end_position.distance(getCellCenter(end_cell).to_double());
+    auto distances = std::vector<double_t>{};
+    auto parents = std::vector<int64_t>{};
+
+    searchChunk(start_chunk, start_cell, distances, parents);
+    for (auto entrance : chunks[start_chunk].entrances) {
+        auto distance = distances[getChunkCellIndex(start_chunk, entrance)];
+        if (std::isfinite(distance))
+            search.start_edges[getCellCenter(entrance)] =
+                start_offset + distance;
+    }
+    if (start_chunk == end_chunk) {
+        auto distance = distances[getChunkCellIndex(start_chunk, end_cell)];
+        if (std::isfinite(distance))
+            search.start_edges[FixedVec2D(end_position)] =
+                start_offset + distance + end_offset;
+    }
+
+    searchChunk(end_chunk, end_cell, distances, parents);
+    for (auto entrance : chunks[end_chunk].entrances) {
+        auto distance = distances[getChunkCellIndex(end_chunk, entrance)];
+        if (std::isfinite(distance))
+            search.end_edges[getCellCenter(entrance)] = distance + end_offset;
+    }
+
+    auto abstract_path = graph.findPath(start_position, end_position, search);
+    if (abstract_path.empty())
+        return result;
+
+    // Refine the path into moves between neighbouring cells. Consecutive
+    // nodes of the abstract path either face each other across a border or
+    // share a chunk
+    auto anchors = std::vector<int64_t>{start_cell};
+    for (size_t i = 0; i + 1 < abstract_path.size(); ++i)
+        anchors.push_back(findCell(abstract_path[i]));
+    anchors.push_back(end_cell);
+
+    auto cells = std::vector<int64_t>{start_cell};
+    for (size_t i = 0; i + 1 < anchors.size(); ++i) {
+        auto from_chunk = getChunkIndex(anchors[i]);
+        if (anchors[i] == anchors[i + 1])
+            continue;
+
+        if (from_chunk != getChunkIndex(anchors[i + 1])) {
+            cells.push_back(anchors[i + 1]);
+        } else {
+            appendChunkPath(from_chunk, anchors[i], anchors[i + 1], cells);
+        }
+    }
+
+    auto cell_offsets = std::vector<Vec2D>{};
+    for (auto cell : cells) {
+        cell_offsets.emplace_back(cell / (int64_t) map_size,
+                                  cell % (int64_t) map_size);
+    }
+
+    return terrain->smoothCellPath(start_position, cell_offsets, end_position,
+                                   search.turn_arena);
+}
+
+} // namespace state
@@ -0,0 +1,243 @@
+/**
+ * @file jump_point_search.cpp
+ * Defines a path finder that searches the cells of the map directly
+ */
+
+#include "state/path_planner/jump_point_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace state {
+
+namespace {
+
+/**
+ * Center of a cell, the node a cell is searched as
+ */
+FixedVec2D getCellCenter(const Vec2D &cell) {
+    return FixedVec2D(cell.x + 0.5, cell.y + 0.5);
+}
+
+/**
+ * Length of the shortest path between two cells moving along rows, columns
+ * and diagonals, with nothing in the way
+ */
+double_t getOctileDistance(const Vec2D &cell_a, const Vec2D &cell_b) {
+    auto dx = std::abs(cell_a.x - cell_b.x);
+    auto dy = std::abs(cell_a.y - cell_b.y);
+    return std::max(dx, dy) + (M_SQRT2 - 1) * std::min(dx, dy);
+}
+
+int64_t getSign(int64_t value) { return (value > 0) - (value < 0); }
+} // namespace
+
+JumpPointSearch::JumpPointSearch() = default;
+
+JumpPointSearch::JumpPointSearch(const PathGraph *p_terrain)
+    : terrain(p_terrain) {}
+
+bool JumpPointSearch::isOpen(const Vec2D &cell) const {
+    return terrain->isValidCell(cell.x, cell.y);
+}
+
+bool JumpPointSearch::hasForcedNeighbour(const Vec2D &cell,
+                                         const Vec2D &direction) const {
+    auto dx = direction.x;
+    auto dy = direction.y;
+
+    // A neighbour beside the way in is forced if the cell beside it that a
+    // path could have cut through instead is blocked
+    auto isForced = [&](Vec2D side, Vec2D neighbour) {
+        return !isOpen(cell + side) && isOpen(cell + neighbour);
+    };
+
+    if (dx != 0 && dy != 0) {
+        return isForced({-dx, 0}, {-dx, dy}) || isForced({0, -dy}, {dx, -dy});
+    }
+    if (dx != 0) {
+        return isForced({0, 1}, {dx, 1}) || isForced({0, -1}, {dx, -1});
+    }
+    return isForced({1, 0}, {1, dy}) || isForced({-1, 0}, {-1, dy});
+}
+
+std::vector<Vec2D>
+JumpPointSearch::getDirections(const Vec2D &cell,
+                               const Vec2D &direction) const {
+    auto directions = std::vector<Vec2D>{};
+
+    // The start is searched from in every direction
+    if (!direction) {
+        for (int64_t dx = -1; dx <= 1; ++dx) {
+            for (int64_t dy = -1; dy <= 1; ++dy) {
+                if (dx != 0 || dy != 0)
+                    directions.emplace_back(dx, dy);
+            }
+        }
+        return directions;
+    }
+
+    auto dx = direction.x;
+    auto dy = direction.y;
+    if (dx != 0 && dy != 0) {
+        directions.emplace_back(dx, 0);
+        directions.emplace_back(0, dy);
+        directions.emplace_back(dx, dy);
+        if (!isOpen(cell + Vec2D(-dx, 0)))
+            directions.emplace_back(-dx, dy);
+        if (!isOpen(cell + Vec2D(0, -dy)))
+            directions.emplace_back(dx, -dy);
+    } else if (dx != 0) {
+        directions.emplace_back(dx, 0);
+        if (!isOpen(cell + Vec2D(0, 1)))
+            directions.emplace_back(dx, 1);
+        if (!isOpen(cell + Vec2D(0, -1)))
+            directions.emplace_back(dx, -1);
+    } else {
+        directions.emplace_back(0, dy);
+        if (!isOpen(cell + Vec2D(1, 0)))
+            directions.emplace_back(1, dy);
+        if (!isOpen(cell + Vec2D(-1, 0)))
+            directions.emplace_back(-1, dy);
+    }
+
+    return directions;
+}
+
+Vec2D JumpPointSearch::jump(Vec2D cell, const Vec2D &direction,
+                            const Vec2D &end_cell) const {
+    auto is_diagonal = direction.x != 0 && direction.y != 0;
+
+    while (true) {
+        cell = cell + direction;
+        if (!isOpen(cell))
+            return Vec2D::null;
+
+        if (cell == end_cell || hasForcedNeighbour(cell, direction))
+            return cell;
+
+        // A diagonal jump stops where a jump along either of its sides finds
+        // a jump point
+        if (is_diagonal && (jump(cell, Vec2D(direction.x, 0), end_cell) ||
+                            jump(cell, Vec2D(0, direction.y), end_cell)))
+            return cell;
+    }
+}
+
+void JumpPointSearch::setTurnArena(TurnArena *turn_arena) {
+    search.turn_arena = turn_arena;
+}
+
+const PathSearchStats &JumpPointSearch::getSearchStats() const {
+    return search.stats;
+}
+
+ArenaVector<DoubleVec2D> JumpPointSearch::getPath(DoubleVec2D start_position,
+                                                  DoubleVec2D end_position) {
+    return getPath(start_position, end_position, search);
+}
+
+ArenaVector<DoubleVec2D>
+JumpPointSearch::getPath(DoubleVec2D start_position, DoubleVec2D end_position,
+                         PathSearch &search) const {
+    if (FixedVec2D(start_position) == FixedVec2D(end_position))
+        return ArenaVector<DoubleVec2D>(search.turn_arena);
+
+    auto start_cell = terrain->findValidCell(start_position);
+    auto end_cell = terrain->findValidCell(end_position);
+    if (!start_cell || !end_cell)
+        return ArenaVector<DoubleVec2D>(search.turn_arena);
+
+    // Positions in sight of each other need no search
+    if (terrain->arePointsDirectlyReachable(start_position, end_position)) {
+        auto result = ArenaVector<DoubleVec2D>(search.turn_arena);
+        result.push_back(end_position);
+        return result;
+    }
+
+    ++search.stats.num_searches;
+    auto &open_list_entries = search.open_list_entries;
+    open_list_entries.clear();
+    search.open_list_heap = Heap();
+
+    auto start_node = getCellCenter(start_cell);
+    auto end_node = getCellCenter(end_cell);
+    auto start_h_value = getOctileDistance(start_cell, end_cell);
+    open_list_entries[start_node] =
+        OpenListEntry{0, start_h_value, FixedVec2D::null, true};
+    search.open_list_heap.push({start_h_value, start_node});
+
+    while (!search.open_list_heap.empty()) {
+        auto node = search.open_list_heap.top().second;
+        search.open_list_heap.pop();
+
+        auto &entry = open_list_entries[node];
+        if (!entry.is_open)
+            continue;
+        entry.is_open = false;
+        ++search.stats.num_expanded_nodes;
+
+        if (node == end_node)
+            break;
+
+        // The direction the node was entered by, from its parent
+        auto cell = node.getCell();
+        auto direction = Vec2D::null;
+        if (entry.parent) {
+            auto parent_cell = entry.parent.getCell();
+            direction = Vec2D(getSign(cell.x - parent_cell.x),
+                              getSign(cell.y - parent_cell.y));
+        }
+        auto g_value = entry.g_value;
+
+        for (const auto &next_direction : getDirections(cell, direction)) {
+            auto jump_cell = jump(cell, next_direction, end_cell);
+            if (!jump_cell)
+                continue;
+
+            auto jump_node = getCellCenter(jump_cell);
+            auto jump_g_value = g_value + getOctileDistance(cell, jump_cell);
+            auto jump_entry = open_list_entries.find(jump_node);
+
+            if (jump_entry == open_list_entries.end()) {
+                auto jump_h_value = getOctileDistance(jump_cell, end_cell);
+                open_list_entries[jump_node] =
+                    OpenListEntry{jump_g_value, jump_h_value, node, true};
+                search.open_list_heap.push(
+                    {jump_g_value + jump_h_value, jump_node});
+            } else if (jump_entry->second.is_open &&
+                       jump_g_value < jump_entry->second.g_value) {
+                jump_entry->second.g_value = jump_g_value;
+                jump_entry->second.parent = node;
+                search.open_list_heap.push(
+                    {jump_entry->second.getTotalCost(), jump_node});
+            }
+        }
+    }
+
+    auto end_entry = open_list_entries.find(end_node);
+    if (end_entry == open_list_entries.end() || end_entry->second.is_open)
+        return ArenaVector<DoubleVec2D>(search.turn_arena);
+
+    // The cells between jump points are filled back in, so that the path can
+    // cut across from any of them rather than only the jump points
+    auto cells = std::vector<Vec2D>{end_cell};
+    for (auto node = end_node; open_list_entries[node].parent;
+         node = open_list_entries[node].parent) {
+        auto cell = node.getCell();
+        auto parent_cell = open_list_entries[node].parent.getCell();
+        auto step = Vec2D(getSign(parent_cell.x - cell.x),
+                          getSign(parent_cell.y - cell.y));
+        while (cell != parent_cell) {
+            cell = cell + step;
+            cells.push_back(cell);
+        }
+    }
+    std::reverse(cells.begin(), cells.end());
+
+    return terrain->smoothCellPath(start_position, cells, end_position,
+                                   search.turn_arena);
+}
+
+} // namespace state
@@ -3,34 +3,152 @@
  * Declares a wrapper for a graph for path calculations
  */
 
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <stdexcept>
 #include <utility>
 
 #include "state/path_planner/path_graph.h"
 
 namespace state {
 
+namespace {
+
+/**
+ * Corner of the cells at the given coordinates
+ */
+FixedVec2D getCellCorner(int64_t x, int64_t y) {
+    return FixedVec2D::fromUnits(
+        static_cast<int32_t>(x * physics::FIXED_POINT_ONE),
+        static_cast<int32_t>(y * physics::FIXED_POINT_ONE));
+}
+/**
+ * Lay out lists of waypoints as offsets and indices, for WaypointGraphTables
+ */
+template <typename Lists>
+void flattenWaypointLists(
+    const Lists &lists,
+    const boost::unordered_map<FixedVec2D, uint32_t> &waypoint_indices,
+    std::vector<uint32_t> &offsets, std::vector<uint32_t> &indices) {
+    offsets.assign(1, 0);
+    for (auto const &list : lists) {
+        for (auto const &waypoint : list) {
+            indices.push_back(waypoint_indices.at(waypoint));
+        }
+        offsets.push_back(static_cast<uint32_t>(indices.size()));
+    }
+}
+
+/**
+ * Check that lists laid out as offsets and indices fit a graph, for
+ * setBaseWaypointGraph
+ */
+void checkWaypointLists(const Span<const uint32_t> &offsets,
+                        const Span<const uint32_t> &indices, size_t num_lists,
+                        size_t num_waypoints) {
+    if (offsets.size() != num_lists + 1 || offsets[0] != 0 ||
+        offsets[num_lists] != indices.size())
+        throw std::invalid_argument("Waypoint lists do not fit the map");
+
+    for (size_t list = 0; list < num_lists; ++list) {
+        if (offsets[list] > offsets[list + 1])
+            throw std::invalid_argument("Waypoint list offsets out of order");
+    }
+    for (auto index : indices) {
+        if (index >= num_waypoints)
+            throw std::invalid_argument("Waypoint index out of range");
+    }
+}
+} // namespace
+
+WaypointGraphView WaypointGraphTables::getView() const {
+    auto view = WaypointGraphView{};
+    view.waypoints = waypoints;
+    view.edge_offsets = edge_offsets;
+    view.edge_targets = edge_targets;
+    view.edge_costs = edge_costs;
+    view.corner_offsets = corner_offsets;
+    view.corner_waypoints = corner_waypoints;
+    view.visible_offsets = visible_offsets;
+    view.visible_waypoints = visible_waypoints;
+    view.partly_visible_offsets = partly_visible_offsets;
+    view.partly_visible_waypoints = partly_visible_waypoints;
+    view.distances = distances;
+    return view;
+}
+
 PathGraph::PathGraph() = default;
 
 PathGraph::PathGraph(size_t p_map_size,
                      std::vector<std::vector<bool>> p_valid_terrain,
                      Graph p_graph)
     : map_size(p_map_size), valid_terrain(std::move(p_valid_terrain)),
-      graph(std::move(p_graph)) {}
+      graph(std::move(p_graph)) {
+    recomputeTerrainDigest();
+}
 
 void PathGraph::setValidTerrain(
     std::vector<std::vector<bool>> p_valid_terrain) {
 
     valid_terrain = std::move(p_valid_terrain);
+    is_waypoint_graph_current = false;
+    recomputeTerrainDigest();
     recomputeWaypointGraph();
 }
 
-void PathGraph::addObstacle(const DoubleVec2D &position) {
+void PathGraph::setTurnArena(TurnArena *turn_arena) {
+    search.turn_arena = turn_arena;
+    graph.setTurnArena(turn_arena);
+}
+
+void PathGraph::setPathHeuristic(PathHeuristic heuristic) {
+    if (graph.getHeuristic() == heuristic)
+        return;
+
+    graph.setHeuristic(heuristic);
+    is_waypoint_graph_current = false;
+}
+
+const PathSearchStats &PathGraph::getSearchStats() const {
+    return search.stats;
+}
+
+StateDigest PathGraph::getCellDigest(size_t x, size_t y) {
+    return DigestBuilder().add(uint64_t{x}).add(uint64_t{y}).getDigest();
+}
+
+void PathGraph::recomputeTerrainDigest() {
+    terrain_digest = {0, 0};
+    for (size_t x = 0; x < valid_terrain.size(); ++x) {
+        for (size_t y = 0; y < valid_terrain[x].size(); ++y) {
+            if (!valid_terrain[x][y]) {
+                terrain_digest ^= getCellDigest(x, y);
+            }
+        }
+    }
+}
+
+void PathGraph::setCellValidity(const DoubleVec2D &position, bool is_valid) {
     if (position.x < 0 || position.x >= map_size || position.y < 0 ||
         position.y >= map_size) {
         throw std::domain_error("Position not inside the range of map");
     }
 
-    valid_terrain[std::floor(position.x)][std::floor(position.y)] = false;
+    auto x = (size_t) std::floor(position.x);
+    auto y = (size_t) std::floor(position.y);
+    if (valid_terrain[x][y] == is_valid) {
+        return;
+    }
+
+    // A cell's digest toggles in and out of the terrain digest
+    valid_terrain[x][y] = is_valid;
+    is_waypoint_graph_current = false;
+    terrain_digest ^= getCellDigest(x, y);
+}
+
+void PathGraph::addObstacle(const DoubleVec2D &position) {
+    setCellValidity(position, false);
 }
 
 void PathGraph::addObstacles(const std::vector<DoubleVec2D> &positions) {
@@ -40,15 +158,12 @@ void PathGraph::addObstacles(const std::vector<DoubleVec2D> &positions) {
 }
 
 void PathGraph::removeObstacle(const DoubleVec2D &position) {
-    if (position.x < 0 || position.x >= map_size || position.y < 0 ||
-        position.y >= map_size) {
-        throw std::domain_error("Position not inside the range of map");
-    }
-
-    valid_terrain[std::floor(position.x)][std::floor(position.y)] = true;
+    setCellValidity(position, true);
 }
 
-boost::unordered_set<DoubleVec2D> PathGraph::getWaypoints() const {
+StateDigest PathGraph::getTerrainDigest() const { return terrain_digest; }
+
+boost::unordered_set<FixedVec2D> PathGraph::getWaypoints() const {
     return graph.getNodes();
 }
 
@@ -66,51 +181,54 @@ bool PathGraph::isValidPosition(const DoubleVec2D &position) const {
     return isValidPosition(position.x, position.y);
 }
 
-void PathGraph::resetWaypointGraph() { graph.resetGraph(); }
+bool PathGraph::isValidCell(int64_t x, int64_t y) const {
+    if (x < 0 || y < 0)
+        return false;
+
+    if (x >= (int64_t) map_size || y >= (int64_t) map_size)
+        return false;
 
-void PathGraph::addWaypoint(const DoubleVec2D &position) {
-    graph.addNode(position);
-    recomputeWaypointEdges(position);
+    return valid_terrain[x][y];
 }
 
-void PathGraph::removeWaypoint(const DoubleVec2D &position) {
-    graph.removeNode(position);
+void PathGraph::resetWaypointGraph() {
+    graph.resetGraph();
+    cell_visibility.clear();
+    corner_visibility.clear();
 }
 
-bool PathGraph::isStraightLineTraversable(DoubleVec2D start,
-                                          DoubleVec2D destination) const {
+bool PathGraph::isStraightLineTraversable(FixedVec2D start,
+                                          FixedVec2D destination) const {
     if (start > destination)
         std::swap(start, destination);
 
+    auto start_cell = start.getCell();
+    auto destination_cell = destination.getCell();
+
     if (start.x == destination.x) {
         // Both points are on a vertical line along the same X value
 
         // True, if x is an integral value
-        bool isIntegralX = (start.x == std::floor(start.x));
+        bool isIntegralX = FixedVec2D::isIntegral(start.x);
 
-        for (int64_t y = std::floor(start.y); y < std::floor(destination.y);
-             y++) {
+        for (int64_t y = start_cell.y; y < destination_cell.y; y++) {
             if (isIntegralX) {
-                if (!isValidPosition(start.x, y) &&
-                    !isValidPosition(start.x - 1, y))
+                if (!isValidCell(start_cell.x, y) &&
+                    !isValidCell(start_cell.x - 1, y))
                     return false;
-            } else if (!isValidPosition(start.x, y)) {
+            } else if (!isValidCell(start_cell.x, y)) {
                 return false;
             }
         }
     } else if (start.y == destination.y) {
-        bool isIntegralY = (start.y == std::floor(start.y));
-
-        for (int64_t x = std::floor(start.x); x < std::floor(destination.x);
-             x++) {
-            if (destination.x == (double_t) x)
-                break;
+        bool isIntegralY = FixedVec2D::isIntegral(start.y);
 
+        for (int64_t x = start_cell.x; x < destination_cell.x; x++) {
             if (isIntegralY) {
-                if (!isValidPosition(x, start.y) &&
-                    !isValidPosition(x, start.y - 1))
+                if (!isValidCell(x, start_cell.y) &&
+                    !isValidCell(x, start_cell.y - 1))
                     return false;
-            } else if (!isValidPosition(x, start.y)) {
+            } else if (!isValidCell(x, start_cell.y)) {
                 return false;
             }
         }
@@ -121,8 +239,74 @@ bool PathGraph::isStraightLineTraversable(DoubleVec2D start,
     return true;
 }
 
-bool PathGraph::arePointsDirectlyReachable(DoubleVec2D point_a,
-                                           DoubleVec2D point_b) const {
+template <typename Visit>
+bool PathGraph::walkCells(FixedVec2D point_a, FixedVec2D point_b,
+                          Visit visit) {
+    if (point_a > point_b)
+        std::swap(point_a, point_b);
+
+    // The line is y = a.y + (x - a.x) * dy / dx, so y * dx is an integer at
+    // every x, and the row it falls in is found by exact division
+    auto dx = int64_t{point_b.x} - point_a.x;
+    auto dy = int64_t{point_b.y} - point_a.y;
+    auto row_size = dx * physics::FIXED_POINT_ONE;
+
+    // Walk the columns the line crosses, from a to b
+    for (int64_t current_x = point_a.x; current_x < point_b.x;) {
+        auto column = FixedVec2D::getCell(current_x);
+        auto next_x = std::min((column + 1) * physics::FIXED_POINT_ONE,
+                               int64_t{point_b.x});
+
+        auto current_y_dx =
+            int64_t{point_a.y} * dx + (current_x - point_a.x) * dy;
+        auto next_y_dx = int64_t{point_a.y} * dx + (next_x - point_a.x) * dy;
+        if (current_y_dx > next_y_dx)
+            std::swap(current_y_dx, next_y_dx);
+
+        // If the line's top in the column is on a row boundary, it needn't
+        // enter the row above
+        auto last_row = physics::floorDiv(next_y_dx, row_size);
+        if (next_y_dx % row_size == 0)
+            last_row--;
+
+        for (auto row = physics::floorDiv(current_y_dx, row_size);
+             row <= last_row; row++) {
+            if (!visit(column, row))
+                return false;
+        }
+
+        current_x = next_x;
+    }
+
+    return true;
+}
+
+bool PathGraph::crossesCell(FixedVec2D point_a, FixedVec2D point_b, int64_t x,
+                            int64_t y) {
+    if (point_a > point_b)
+        std::swap(point_a, point_b);
+
+    // Part of the line within the cell's column, as in walkCells
+    auto left_x = std::max(int64_t{point_a.x}, x * physics::FIXED_POINT_ONE);
+    auto right_x =
+        std::min(int64_t{point_b.x}, (x + 1) * physics::FIXED_POINT_ONE);
+    if (left_x >= right_x)
+        return false;
+
+    auto dx = int64_t{point_b.x} - point_a.x;
+    auto dy = int64_t{point_b.y} - point_a.y;
+    auto row_size = dx * physics::FIXED_POINT_ONE;
+
+    auto left_y_dx = int64_t{point_a.y} * dx + (left_x - point_a.x) * dy;
+    auto right_y_dx = int64_t{point_a.y} * dx + (right_x - point_a.x) * dy;
+    if (left_y_dx > right_y_dx)
+        std::swap(left_y_dx, right_y_dx);
+
+    return left_y_dx < (y + 1) * row_size && right_y_dx > y * row_size;
+}
+
+bool PathGraph::arePointsDirectlyReachable(FixedVec2D point_a,
+                                           FixedVec2D point_b) const {
     // They are the same point
     if (point_a == point_b)
         return true;
@@ -135,32 +319,91 @@ bool PathGraph::arePointsDirectlyReachable(DoubleVec2D point_a,
         return isStraightLineTraversable(point_a, point_b);
     }
 
-    // Get all integral x's which the line joining a and b intersect
-    auto x_intersections = generateIntersections(point_a.x, point_b.x);
-    auto slope = getSlope(point_a, point_b);
+    return walkCells(point_a, point_b, [this](int64_t x, int64_t y) {
+        return isValidCell(x, y);
+    });
+}
 
-    for (size_t i = 0; i < (x_intersections.size() - 1); i++) {
-        auto current_x = x_intersections[i];
-        auto next_x = x_intersections[i + 1];
+Vec2D PathGraph::findValidCell(const DoubleVec2D &position) const {
+    auto fixed_position = FixedVec2D(position);
+    auto cell = fixed_position.getCell();
+    auto cell_below_left = fixed_position.getCellBelowLeft();
 
-        // y = slope*(x - x1) + y1
-        auto current_y = slope * (current_x - point_a.x) + point_a.y;
-        auto next_y = slope * (next_x - point_a.x) + point_a.y;
+    // A position on a cell boundary touches the cells on both sides of it
+    for (auto x : {cell.x, cell_below_left.x}) {
+        for (auto y : {cell.y, cell_below_left.y}) {
+            if (isValidCell(x, y))
+                return {x, y};
+        }
+    }
 
-        if (current_y > next_y)
-            std::swap(current_y, next_y);
+    return Vec2D::null;
+}
 
-        for (int64_t y = std::floor(current_y); y <= std::floor(next_y); y++) {
-            // Check if position being traversed is valid
-            // If y is next_y, ending at next_y so needn't check that
-            // position
-            if (!isValidPosition(current_x, y) && (double_t) y != next_y) {
-                return false;
+ArenaVector<DoubleVec2D>
+PathGraph::smoothCellPath(DoubleVec2D start_position,
+                          const std::vector<Vec2D> &cells,
+                          DoubleVec2D end_position,
+                          TurnArena *turn_arena) const {
+    // The path through the centers of the cells and the corners each cell
+    // shares with the next, each point in line of sight of the next
+    auto points = std::vector<DoubleVec2D>{start_position};
+    for (size_t i = 0; i < cells.size(); ++i) {
+        points.emplace_back(cells[i].x + 0.5, cells[i].y + 0.5);
+        if (i + 1 == cells.size())
+            break;
+
+        for (auto x : {cells[i].x, cells[i].x + 1}) {
+            for (auto y : {cells[i].y, cells[i].y + 1}) {
+                if (x >= cells[i + 1].x && x <= cells[i + 1].x + 1 &&
+                    y >= cells[i + 1].y && y <= cells[i + 1].y + 1)
+                    points.emplace_back(x, y);
+            }
+        }
+    }
+    points.push_back(end_position);
+
+    // Keep a point only if the point after it is out of sight of the last
+    // point kept
+    auto pullString = [this](const std::vector<DoubleVec2D> &path) {
+        auto pulled_path = std::vector<DoubleVec2D>{path.front()};
+        for (size_t i = 1; i + 1 < path.size(); ++i) {
+            if (!arePointsDirectlyReachable(pulled_path.back(), path[i + 1]))
+                pulled_path.push_back(path[i]);
+        }
+        pulled_path.push_back(path.back());
+        return pulled_path;
+    };
+    auto pulled_path = pullString(points);
+
+    // The shortest paths turn at the corners of cells, so each turn still at
+    // the center of a cell moves to the corner that shortens the path most,
+    // and the path is pulled again
+    for (size_t i = 1; i + 1 < pulled_path.size(); ++i) {
+        const auto &previous_point = pulled_path[i - 1];
+        const auto &next_point = pulled_path[i + 1];
+        auto point = pulled_path[i];
+        auto best_length =
+            previous_point.distance(point) + point.distance(next_point);
+
+        for (auto x : {std::floor(point.x), std::ceil(point.x)}) {
+            for (auto y : {std::floor(point.y), std::ceil(point.y)}) {
+                auto corner = DoubleVec2D(x, y);
+                auto length = previous_point.distance(corner) +
+                              corner.distance(next_point);
+                if (length < best_length &&
+                    arePointsDirectlyReachable(previous_point, corner) &&
+                    arePointsDirectlyReachable(corner, next_point)) {
+                    pulled_path[i] = corner;
+                    best_length = length;
+                }
             }
         }
     }
+    pulled_path = pullString(pulled_path);
 
-    return true;
+    return ArenaVector<DoubleVec2D>(pulled_path.begin() + 1, pulled_path.end(),
+                                    turn_arena);
 }
 
 void PathGraph::recomputeWaypoints() {
@@ -190,23 +433,22 @@ void PathGraph::recomputeWaypoints() {
     // If there exists a waypoint which is lying between two adjacent waypoints,
     // it is redundant
     for (auto const &waypoint : graph.getNodes()) {
-        auto x = waypoint.x;
-        auto y = waypoint.y;
+        auto cell = waypoint.getCell();
+        auto x = cell.x;
+        auto y = cell.y;
 
         bool removeNode = false;
 
-        if (!(isValidPosition(x, y) || isValidPosition(x - 1, y))) {
+        if (!(isValidCell(x, y) || isValidCell(x - 1, y))) {
             // Both tiles to the right are blocked
             removeNode = true;
-        } else if (!(isValidPosition(x, y) || isValidPosition(x, y - 1))) {
+        } else if (!(isValidCell(x, y) || isValidCell(x, y - 1))) {
             // Both tiles to the top are blocked
             removeNode = true;
-        } else if (!(isValidPosition(x - 1, y - 1) ||
-                     isValidPosition(x, y - 1))) {
+        } else if (!(isValidCell(x - 1, y - 1) || isValidCell(x, y - 1))) {
             // Both tiles to the left are blocked
             removeNode = true;
-        } else if (!(isValidPosition(x - 1, y - 1) ||
-                     isValidPosition(x - 1, y))) {
+        } else if (!(isValidCell(x - 1, y - 1) || isValidCell(x - 1, y))) {
             // Both tiles to the bottom are blocked
             removeNode = true;
         }
@@ -217,11 +459,12 @@ void PathGraph::recomputeWaypoints() {
     }
 }
 
-void PathGraph::recomputeWaypointEdges(const DoubleVec2D &position) {
+void PathGraph::recomputeWaypointEdges(const FixedVec2D &position) {
     if (!graph.checkNodeExists(position))
         return;
 
-    for (auto const &waypoint : graph.getNodes()) {
+    // Adding edges leaves the set of nodes as it is
+    for (auto const &waypoint : graph.getNodeSet()) {
         if (waypoint == position)
             continue;
 
@@ -232,30 +475,480 @@ void PathGraph::recomputeWaypointEdges(const DoubleVec2D &position) {
 }
 
 void PathGraph::recomputeWaypointEdges() {
-    for (auto const &waypoint : graph.getNodes()) {
+    for (auto const &waypoint : graph.getNodeSet()) {
         recomputeWaypointEdges(waypoint);
     }
 }
 
+bool PathGraph::isCellInSight(const FixedVec2D &waypoint, int64_t x,
+                              int64_t y) const {
+    // The lines from the waypoint to the positions in the cell fill the
+    // triangles between the waypoint and the cell. Within a column, these
+    // span the rows spanned by the cell and by the lines to its corners
+    auto waypoint_cell = waypoint.getCell();
+    auto first_column = std::min(waypoint_cell.x, x);
+    auto last_column = std::max(waypoint_cell.x - 1, x);
+
+    for (auto column = first_column; column <= last_column; column++) {
+        auto first_row = std::numeric_limits<int64_t>::max();
+        auto last_row = std::numeric_limits<int64_t>::min();
+
+        // Adds the rows spanned down to or up to y = numerator / denominator
+        auto spanRows = [&](int64_t numerator, int64_t denominator) {
+            first_row = std::min(first_row,
+                                 physics::floorDiv(numerator, denominator));
+            last_row = std::max(
+                last_row, -physics::floorDiv(-numerator, denominator) - 1);
+        };
+
+        if (column == x) {
+            spanRows(y, 1);
+            spanRows(y + 1, 1);
+        }
+
+        for (auto corner_x : {x, x + 1}) {
+            for (auto corner_y : {y, y + 1}) {
+                // Part of the line to the corner within the column
+                auto left_x =
+                    std::max(column, std::min(waypoint_cell.x, corner_x));
+                auto right_x =
+                    std::min(column + 1, std::max(waypoint_cell.x, corner_x));
+                if (left_x > right_x)
+                    continue;
+
+                if (corner_x == waypoint_cell.x) {
+                    spanRows(waypoint_cell.y, 1);
+                    spanRows(corner_y, 1);
+                    continue;
+                }
+
+                auto dx = corner_x - waypoint_cell.x;
+                auto dy = corner_y - waypoint_cell.y;
+                if (dx < 0) {
+                    dx = -dx;
+                    dy = -dy;
+                }
+                for (auto end_x : {left_x, right_x}) {
+                    spanRows(waypoint_cell.y * dx +
+                                 (end_x - waypoint_cell.x) * dy,
+                             dx);
+                }
+            }
+        }
+
+        for (auto row = first_row; row <= last_row; row++) {
+            if (!isValidCell(column, row))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool PathGraph::isCellHidden(const FixedVec2D &waypoint, int64_t x,
+                             int64_t y) const {
+    // The positions whose lines to the waypoint cross a given cell form a
+    // convex area. So a blocked cell crossed by the lines to all four corners
+    // is crossed by the line to every position in between
+    auto corners = std::array<FixedVec2D, 4>{
+        getCellCorner(x, y), getCellCorner(x + 1, y), getCellCorner(x, y + 1),
+        getCellCorner(x + 1, y + 1)};
+
+    // Vertical and horizontal lines cross no cell
+    for (auto const &corner : corners) {
+        if (corner.x == waypoint.x || corner.y == waypoint.y)
+            return false;
+    }
+
+    // Stops the walk at the first hiding cell
+    return !walkCells(
+        waypoint, corners[0], [&](int64_t cell_x, int64_t cell_y) {
+            return isValidCell(cell_x, cell_y) ||
+                   !crossesCell(waypoint, corners[1], cell_x, cell_y) ||
+                   !crossesCell(waypoint, corners[2], cell_x, cell_y) ||
+                   !crossesCell(waypoint, corners[3], cell_x, cell_y);
+        });
+}
+
+void PathGraph::recomputeVisibility() {
+    auto waypoints = std::vector<FixedVec2D>(graph.getNodeSet().begin(),
+                                             graph.getNodeSet().end());
+    auto num_waypoints = waypoints.size();
+    auto size = static_cast<int64_t>(map_size);
+    auto num_corners = static_cast<size_t>((size + 1) * (size + 1));
+
+    // Whether each waypoint is in sight of each corner, indexed by
+    // corner * num_waypoints + waypoint
+    auto is_corner_visible = std::vector<bool>(num_corners * num_waypoints);
+
+    // Corners between blocked cells have no waypoints in sight
+    corner_visibility.assign(num_corners, {});
+    for (int64_t x = 0; x <= size; x++) {
+        for (int64_t y = 0; y <= size; y++) {
+            if (!isValidCell(x - 1, y - 1) && !isValidCell(x - 1, y) &&
+                !isValidCell(x, y - 1) && !isValidCell(x, y))
+                continue;
+
+            auto corner = x * (size + 1) + y;
+            for (size_t waypoint = 0; waypoint < num_waypoints; waypoint++) {
+                if (arePointsDirectlyReachable(waypoints[waypoint],
+                                               getCellCorner(x, y))) {
+                    is_corner_visible[corner * num_waypoints + waypoint] =
+                        true;
+                    corner_visibility[corner].push_back(waypoints[waypoint]);
+                }
+            }
+        }
+    }
+
+    // Only cells that can be traversed are filled, as positions in blocked
+    // cells have no waypoints in sight
+    cell_visibility.assign(size * size, {});
+    for (int64_t x = 0; x < size; x++) {
+        for (int64_t y = 0; y < size; y++) {
+            if (!isValidCell(x, y))
+                continue;
+
+            auto &visibility = cell_visibility[x * size + y];
+            auto cell_corners = std::array<int64_t, 4>{
+                x * (size + 1) + y, (x + 1) * (size + 1) + y,
+                x * (size + 1) + y + 1, (x + 1) * (size + 1) + y + 1};
+
+            for (size_t waypoint = 0; waypoint < num_waypoints; waypoint++) {
+                auto num_visible_corners = 0;
+                for (auto corner : cell_corners) {
+                    num_visible_corners +=
+                        is_corner_visible[corner * num_waypoints + waypoint];
+                }
+
+                // A waypoint in sight of every position in the cell is in
+                // sight of all four corners, and one hidden from every
+                // position is hidden from all four
+                auto const &position = waypoints[waypoint];
+                if (num_visible_corners == 4 && isCellInSight(position, x, y)) {
+                    visibility.visible.push_back(position);
+                } else if (num_visible_corners > 0 ||
+                           !isCellHidden(position, x, y)) {
+                    visibility.partly_visible.push_back(position);
+                }
+            }
+        }
+    }
+}
+
+void PathGraph::loadBaseWaypointGraph() {
+    auto const &view = base_waypoint_graph;
+    for (auto const &waypoint : view.waypoints) {
+        graph.addNode(waypoint);
+    }
+
+    // Each edge is listed from both ends, and added once
+    for (uint32_t waypoint = 0; waypoint < view.waypoints.size(); ++waypoint) {
+        for (auto edge = view.edge_offsets[waypoint];
+             edge < view.edge_offsets[waypoint + 1]; ++edge) {
+            auto neighbour = view.edge_targets[edge];
+            if (waypoint < neighbour) {
+                graph.addEdge(view.waypoints[waypoint],
+                              view.waypoints[neighbour], view.edge_costs[edge]);
+            }
+        }
+    }
+
+    auto getWaypoints = [&view](const Span<const uint32_t> &offsets,
+                                const Span<const uint32_t> &indices,
+                                size_t list) {
+        auto waypoints = std::vector<FixedVec2D>{};
+        waypoints.reserve(offsets[list + 1] - offsets[list]);
+        for (auto index = offsets[list]; index < offsets[list + 1]; ++index) {
+            waypoints.push_back(view.waypoints[indices[index]]);
+        }
+        return waypoints;
+    };
+
+    corner_visibility.resize(view.corner_offsets.size() - 1);
+    for (size_t corner = 0; corner < corner_visibility.size(); ++corner) {
+        corner_visibility[corner] =
+            getWaypoints(view.corner_offsets, view.corner_waypoints, corner);
+    }
+
+    cell_visibility.resize(view.visible_offsets.size() - 1);
+    for (size_t cell = 0; cell < cell_visibility.size(); ++cell) {
+        cell_visibility[cell].visible =
+            getWaypoints(view.visible_offsets, view.visible_waypoints, cell);
+        cell_visibility[cell].partly_visible =
+            getWaypoints(view.partly_visible_offsets,
+                         view.partly_visible_waypoints, cell);
+    }
+}
+
+void PathGraph::setBaseWaypointGraph(const WaypointGraphView &waypoint_graph) {
+    auto num_waypoints = waypoint_graph.waypoints.size();
+    auto num_cells = map_size * map_size;
+    auto num_corners = (map_size + 1) * (map_size + 1);
+
+    if (!std::is_sorted(waypoint_graph.waypoints.begin(),
+                        waypoint_graph.waypoints.end()))
+        throw std::invalid_argument("Waypoints out of order");
+    if (waypoint_graph.edge_costs.size() != waypoint_graph.edge_targets.size())
+        throw std::invalid_argument("Edge costs do not match the edges");
+    if (!waypoint_graph.distances.empty() &&
+        waypoint_graph.distances.size() != num_waypoints * num_waypoints)
+        throw std::invalid_argument("Waypoint distances do not fit the graph");
+
+    checkWaypointLists(waypoint_graph.edge_offsets, waypoint_graph.edge_targets,
+                       num_waypoints, num_waypoints);
+    checkWaypointLists(waypoint_graph.corner_offsets,
+                       waypoint_graph.corner_waypoints, num_corners,
+                       num_waypoints);
+    checkWaypointLists(waypoint_graph.visible_offsets,
+                       waypoint_graph.visible_waypoints, num_cells,
+                       num_waypoints);
+    checkWaypointLists(waypoint_graph.partly_visible_offsets,
+                       waypoint_graph.partly_visible_waypoints, num_cells,
+                       num_waypoints);
+    for (auto cost : waypoint_graph.edge_costs) {
+        if (!(cost >= 0))
+            throw std::invalid_argument("Edge cost is negative");
+    }
+
+    base_waypoint_graph = waypoint_graph;
+    base_terrain_digest = terrain_digest;
+    has_base_waypoint_graph = true;
+    is_waypoint_graph_current = false;
+}
+
+WaypointGraphTables PathGraph::getWaypointGraphTables(bool with_distances) {
+    recomputeWaypointGraph();
+
+    auto tables = WaypointGraphTables{};
+    tables.waypoints.assign(graph.getNodeSet().begin(),
+                            graph.getNodeSet().end());
+    std::sort(tables.waypoints.begin(), tables.waypoints.end());
+
+    auto waypoint_indices = boost::unordered_map<FixedVec2D, uint32_t>{};
+    for (uint32_t index = 0; index < tables.waypoints.size(); ++index) {
+        waypoint_indices[tables.waypoints[index]] = index;
+    }
+
+    // Neighbours are listed in ascending order
+    tables.edge_offsets.assign(1, 0);
+    for (auto const &waypoint : tables.waypoints) {
+        auto const &edges = graph.getEdges(waypoint);
+        auto neighbours = std::vector<std::pair<uint32_t, double_t>>{};
+        for (auto const &edge : edges) {
+            neighbours.emplace_back(waypoint_indices.at(edge.first),
+                                    edge.second);
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+
+        for (auto const &neighbour : neighbours) {
+            tables.edge_targets.push_back(neighbour.first);
+            tables.edge_costs.push_back(neighbour.second);
+        }
+        tables.edge_offsets.push_back(
+            static_cast<uint32_t>(tables.edge_targets.size()));
+    }
+
+    // Visible waypoints keep the order they were found in
+    flattenWaypointLists(corner_visibility, waypoint_indices,
+                         tables.corner_offsets, tables.corner_waypoints);
+    auto visible = std::vector<std::vector<FixedVec2D>>{};
+    auto partly_visible = std::vector<std::vector<FixedVec2D>>{};
+    for (auto const &visibility : cell_visibility) {
+        visible.push_back(visibility.visible);
+        partly_visible.push_back(visibility.partly_visible);
+    }
+    flattenWaypointLists(visible, waypoint_indices, tables.visible_offsets,
+                         tables.visible_waypoints);
+    flattenWaypointLists(partly_visible, waypoint_indices,
+                         tables.partly_visible_offsets,
+                         tables.partly_visible_waypoints);
+
+    if (with_distances) {
+        auto num_waypoints = tables.waypoints.size();
+        tables.distances.assign(num_waypoints * num_waypoints,
+                                std::numeric_limits<double_t>::infinity());
+        for (size_t source = 0; source < num_waypoints; ++source) {
+            auto row = source * num_waypoints;
+            for (auto const &distance :
+                 graph.findDistances(tables.waypoints[source])) {
+                tables.distances[row + waypoint_indices.at(distance.first)] =
+                    distance.second;
+            }
+        }
+    }
+
+    return tables;
+}
+
 void PathGraph::recomputeWaypointGraph() {
+    // The graph only depends on the terrain
+    if (is_waypoint_graph_current)
+        return;
+
     // Remove any previous waypoints and edges
     resetWaypointGraph();
 
-    recomputeWaypoints();
-    recomputeWaypointEdges();
+    // The terrain the map starts with is loaded from its compiled map, if it
+    // has one
+    auto is_base_terrain =
+        has_base_waypoint_graph && terrain_digest == base_terrain_digest;
+    if (is_base_terrain) {
+        loadBaseWaypointGraph();
+    } else {
+        recomputeWaypoints();
+        recomputeWaypointEdges();
+        recomputeVisibility();
+    }
+
+    if (graph.getHeuristic() == PathHeuristic::LANDMARKS) {
+        auto known_distances = NodeDistances{};
+        if (is_base_terrain) {
+            known_distances = {base_waypoint_graph.waypoints,
+                               base_waypoint_graph.distances};
+        }
+        graph.computeLandmarks(NUM_PATH_LANDMARKS, known_distances);
+    }
+    is_waypoint_graph_current = true;
+}
+
+void PathGraph::addVisibleWaypointEdges(const FixedVec2D &position,
+                                        const DoubleVec2D &exact_position,
+                                        EdgeList &edges) const {
+    auto addEdge = [&](const FixedVec2D &waypoint) {
+        edges.emplace(waypoint, exact_position.distance(waypoint.to_double()));
+    };
+
+    auto size = static_cast<int64_t>(map_size);
+    auto cell = position.getCell();
+    auto is_integral_x = FixedVec2D::isIntegral(position.x);
+    auto is_integral_y = FixedVec2D::isIntegral(position.y);
+
+    if (is_integral_x && is_integral_y && !corner_visibility.empty() &&
+        cell.x >= 0 && cell.y >= 0 && cell.x <= size && cell.y <= size) {
+        for (auto const &waypoint :
+             corner_visibility[cell.x * (size + 1) + cell.y]) {
+            addEdge(waypoint);
+        }
+        return;
+    }
+
+    // A position on the edge of a cell lies in the cell across the edge too,
+    // so either may be looked up if it can be traversed
+    for (auto cell_x : {cell.x, is_integral_x ? cell.x - 1 : cell.x}) {
+        for (auto cell_y : {cell.y, is_integral_y ? cell.y - 1 : cell.y}) {
+            if (cell_visibility.empty() || !isValidCell(cell_x, cell_y))
+                continue;
+
+            auto const &visibility = cell_visibility[cell_x * size + cell_y];
+            for (auto const &waypoint : visibility.visible) {
+                addEdge(waypoint);
+            }
+            for (auto const &waypoint : visibility.partly_visible) {
+                if (arePointsDirectlyReachable(waypoint, position)) {
+                    addEdge(waypoint);
+                }
+            }
+            return;
+        }
+    }
+
+    // Positions off the map or in blocked cells, or any before the tables
+    // are made, are checked against every waypoint
+    for (auto const &waypoint : graph.getNodeSet()) {
+        if (arePointsDirectlyReachable(waypoint, position)) {
+            addEdge(waypoint);
+        }
+    }
 }
 
-std::vector<DoubleVec2D> PathGraph::getPath(DoubleVec2D start_position,
+ArenaVector<DoubleVec2D> PathGraph::getPath(DoubleVec2D start_position,
                                             DoubleVec2D end_position) {
-    addWaypoint(start_position);
-    addWaypoint(end_position);
+    return getPath(start_position, end_position, search);
+}
+
+ArenaVector<DoubleVec2D> PathGraph::getPath(DoubleVec2D start_position,
+                                            DoubleVec2D end_position,
+                                            PathSearch &search) const {
+    search.start_edges.clear();
+    search.end_edges.clear();
+
+    if (start_position == end_position) {
+        return ArenaVector<DoubleVec2D>(search.turn_arena);
+    }
+
+    // Positions that are not waypoints are joined to every waypoint they can
+    // see, as if they had been added to the graph. Reachability is found from
+    // the fixed-point positions, and distances from the exact ones
+    auto start_node = FixedVec2D(start_position);
+    auto end_node = FixedVec2D(end_position);
+    auto is_start_waypoint = graph.checkNodeExists(start_node);
+    auto is_end_waypoint = graph.checkNodeExists(end_node);
+
+    if (!is_start_waypoint) {
+        addVisibleWaypointEdges(start_node, start_position, search.start_edges);
+    }
+    if (!is_end_waypoint) {
+        addVisibleWaypointEdges(end_node, end_position, search.end_edges);
+    }
+
+    if (!is_start_waypoint && !is_end_waypoint &&
+        arePointsDirectlyReachable(start_node, end_node)) {
+        search.start_edges.emplace(end_node,
+                                   end_position.distance(start_position));
+    }
+
+    return graph.findPath(start_position, end_position, search);
+}
 
-    auto result = graph.getPath(start_position, end_position);
+std::vector<ArenaVector<DoubleVec2D>>
+PathGraph::getPaths(const std::vector<DoubleVec2D> &start_positions,
+                    DoubleVec2D end_position, PathSearch &search) const {
+    auto end_node = FixedVec2D(end_position);
+    auto paths = std::vector<ArenaVector<DoubleVec2D>>(
+        start_positions.size(), ArenaVector<DoubleVec2D>(search.turn_arena));
 
-    removeWaypoint(start_position);
-    removeWaypoint(end_position);
+    search.end_edges.clear();
+    if (!graph.checkNodeExists(end_node)) {
+        addVisibleWaypointEdges(end_node, end_position, search.end_edges);
+    }
+
+    // Starts in sight of the end go straight to it. The others are joined to
+    // the graph as getPath joins them, and share the search
+    auto start_edges = std::vector<EdgeList>(start_positions.size());
+    auto is_search_needed = false;
+    for (size_t index = 0; index < start_positions.size(); ++index) {
+        const auto &start_position = start_positions[index];
+        auto start_node = FixedVec2D(start_position);
+        if (start_position == end_position || start_node == end_node)
+            continue;
+
+        if (arePointsDirectlyReachable(start_node, end_node)) {
+            paths[index].push_back(end_position);
+            continue;
+        }
 
-    return result;
+        if (graph.checkNodeExists(start_node)) {
+            start_edges[index].emplace(start_node, 0);
+        } else {
+            addVisibleWaypointEdges(start_node, start_position,
+                                    start_edges[index]);
+        }
+        is_search_needed |= !start_edges[index].empty();
+    }
+
+    if (!is_search_needed)
+        return paths;
+
+    graph.findPathTree(end_position, start_edges, search);
+    for (size_t index = 0; index < start_positions.size(); ++index) {
+        if (!start_edges[index].empty()) {
+            paths[index] = graph.getTreePath(
+                start_positions[index], end_position, start_edges[index],
+                search);
+        }
+    }
+    return paths;
 }
 
 } // namespace state
@@ -4,6 +4,7 @@
 
 #include "state/path_planner/path_planner.h"
 
+#include <stdexcept>
 #include <utility>
 
 namespace state {
@@ -26,6 +27,8 @@ PathPlanner::PathPlanner(Map *p_map) : map(std::move(p_map)) {
 
     Graph graph = Graph();
     path_graph = PathGraph(map_size, valid_terrain, graph);
+    hierarchical_graph = HierarchicalPathGraph(&path_graph, map_size);
+    jump_point_search = JumpPointSearch(&path_graph);
 }
 
 bool PathPlanner::isOffsetBlocked(const Vec2D &position) const {
@@ -72,16 +75,14 @@ Vec2D PathPlanner::getOffset(const DoubleVec2D &position,
     // For player 1, the offset tile is one containing position.
     // In case of integral (x,y) the tile having position as lower left corner
     case PlayerId::PLAYER1: {
-        return {(int64_t) std::floor(position.x),
-                (int64_t) std::floor(position.y)};
+        return FixedVec2D(position).getCell();
     }
 
     // For player 2, the offset tile is one containing position.
     // In case of integral (x,y) the tile having position as upper right corner
     // Return the lower left position of the offset
     case PlayerId::PLAYER2: {
-        return {(int64_t) std::ceil(position.x) - 1,
-                (int64_t) std::ceil(position.y) - 1};
+        return FixedVec2D(position).getCellBelowLeft();
     }
 
     default:
@@ -105,29 +106,30 @@ std::vector<Vec2D> PathPlanner::getAdjoiningOffsets(DoubleVec2D position) {
     // For (1, 1), result = {(0,0), (0,1), (1,0), (1, 1)}
     // For (0.5, 1), result = {(0,0), (0,1)}
 
-    std::vector<double_t> xs;
-    std::vector<double_t> ys;
+    std::vector<int64_t> xs;
+    std::vector<int64_t> ys;
 
-    DoubleVec2D position_floor = {std::floor(position.x),
-                                  std::floor(position.y)};
+    auto fixed_position = FixedVec2D(position);
+    auto cell = fixed_position.getCell();
 
-    xs.push_back(position_floor.x);
+    xs.push_back(cell.x);
     // If x is integral, both offsets including x are taken
-    if (position.x == position_floor.x) {
-        xs.push_back(position_floor.x - 1);
+    if (FixedVec2D::isIntegral(fixed_position.x)) {
+        xs.push_back(cell.x - 1);
     }
 
-    ys.push_back(position_floor.y);
+    ys.push_back(cell.y);
     // If y is integral, both offsets including y are taken
-    if (position.y == position_floor.y) {
-        ys.push_back(position_floor.y - 1);
+    if (FixedVec2D::isIntegral(fixed_position.y)) {
+        ys.push_back(cell.y - 1);
     }
 
     std::vector<Vec2D> ans;
 
     for (auto x : xs) {
         for (auto y : ys) {
-            if (path_graph.isValidPosition({x, y})) {
+            if (path_graph.isValidPosition(
+                    {static_cast<double_t>(x), static_cast<double_t>(y)})) {
                 ans.emplace_back(x, y);
             }
         }
@@ -162,6 +164,7 @@ Vec2D PathPlanner::buildTower(DoubleVec2D position, PlayerId player_id) {
     }
 
     path_graph.addObstacle(tower_offset);
+    hierarchical_graph.invalidateCell(tower_offset);
     return tower_offset;
 }
 
@@ -178,12 +181,76 @@ bool PathPlanner::destroyTower(Vec2D tower_offset) {
     }
 
     path_graph.removeObstacle(tower_offset);
+    hierarchical_graph.invalidateCell(tower_offset);
     return true;
 }
 
+StateDigest PathPlanner::getTerrainDigest() const {
+    return path_graph.getTerrainDigest();
+}
+
+void PathPlanner::setTurnArena(TurnArena *turn_arena) {
+    path_graph.setTurnArena(turn_arena);
+    hierarchical_graph.setTurnArena(turn_arena);
+    jump_point_search.setTurnArena(turn_arena);
+}
+
 void PathPlanner::recomputePathGraph() {
     cache.clear();
-    path_graph.recomputeWaypointGraph();
+
+    switch (backend) {
+    case PathPlannerBackend::VISIBILITY_GRAPH:
+        path_graph.recomputeWaypointGraph();
+        break;
+    case PathPlannerBackend::HIERARCHICAL:
+        hierarchical_graph.recompute();
+        break;
+    case PathPlannerBackend::JUMP_POINT_SEARCH:
+        // Searches read the terrain directly
+        break;
+    }
+}
+
+void PathPlanner::setPathHeuristic(PathHeuristic heuristic) {
+    path_graph.setPathHeuristic(heuristic);
+}
+
+void PathPlanner::setBackend(PathPlannerBackend p_backend) {
+    backend = p_backend;
+    cache.clear();
+}
+
+void PathPlanner::setCompiledMap(std::unique_ptr<CompiledMap> p_compiled_map) {
+    auto map_size = map->getSize();
+    if (p_compiled_map->getMapSize() != map_size)
+        throw std::invalid_argument("Compiled map is of another size");
+
+    for (size_t x = 0; x < map_size; ++x) {
+        for (size_t y = 0; y < map_size; ++y) {
+            if (p_compiled_map->getTerrainType(x, y) !=
+                map->getTerrainType(x, y))
+                throw std::invalid_argument("Compiled map is of another map");
+        }
+    }
+
+    // No towers are built yet, so the terrain is the map's own
+    path_graph.setBaseWaypointGraph(p_compiled_map->getWaypointGraph());
+    compiled_map = std::move(p_compiled_map);
+    cache.clear();
+}
+
+WaypointGraphTables PathPlanner::getWaypointGraphTables(bool with_distances) {
+    return path_graph.getWaypointGraphTables(with_distances);
+}
+
+PathPlannerBackend PathPlanner::getBackend() const { return backend; }
+
+PathSearchStats PathPlanner::getPathSearchStats() const {
+    auto stats = path_graph.getSearchStats();
+    stats += hierarchical_graph.getSearchStats();
+    stats += jump_point_search.getSearchStats();
+    stats += planned_search_total;
+    return stats;
 }
 
 DoubleVec2D PathPlanner::getPointAlongLine(const DoubleVec2D &point_a,
@@ -214,21 +281,24 @@ TerrainType PathPlanner::getTerrainType(DoubleVec2D position,
     return map->getTerrainType(offset);
 }
 
-DoubleVec2D PathPlanner::getNextPosition(DoubleVec2D source,
-                                         DoubleVec2D destination,
-                                         size_t speed) {
-    if (cache.find({source, destination}) != cache.end()) {
-        return cache[{source, destination}];
-    }
-
-    auto result = DoubleVec2D::null;
-
-    std::vector<DoubleVec2D> path = path_graph.getPath(source, destination);
-
-    if (path.empty()) {
-        result = DoubleVec2D::null;
-    }
+/**
+ * Search space of the calling thread, for paths found in parallel. Paths only
+ * live until the next search, so the arena and the counts of work done are
+ * reset every time
+ */
+static PathSearch &getThreadSearch() {
+    static thread_local TurnArena arena;
+    static thread_local PathSearch search;
+
+    arena.reset();
+    search.turn_arena = &arena;
+    search.stats = PathSearchStats{};
+    return search;
+}
 
+DoubleVec2D PathPlanner::moveAlongPath(DoubleVec2D source,
+                                       DoubleVec2D destination, size_t speed,
+                                       const ArenaVector<DoubleVec2D> &path) {
     double distance_left = speed;
     DoubleVec2D current_position = source;
 
@@ -245,10 +315,121 @@ DoubleVec2D PathPlanner::getNextPosition(DoubleVec2D source,
         distance_left -= travel_distance;
     }
 
-    result = current_position;
-    cache[{source, destination}] = result;
+    return current_position;
+}
+
+ArenaVector<DoubleVec2D> PathPlanner::findPath(DoubleVec2D source,
+                                               DoubleVec2D destination,
+                                               PathSearch *search) {
+    if (backend == PathPlannerBackend::HIERARCHICAL) {
+        if (search)
+            return hierarchical_graph.getPath(source, destination, *search);
+        return hierarchical_graph.getPath(source, destination);
+    }
+
+    if (backend == PathPlannerBackend::JUMP_POINT_SEARCH) {
+        if (search)
+            return jump_point_search.getPath(source, destination, *search);
+        return jump_point_search.getPath(source, destination);
+    }
+
+    if (search)
+        return path_graph.getPath(source, destination, *search);
+    return path_graph.getPath(source, destination);
+}
+
+DoubleVec2D PathPlanner::getNextPosition(DoubleVec2D source,
+                                         DoubleVec2D destination,
+                                         size_t speed) {
+    auto key = std::make_tuple(source, destination, speed);
+    auto cached_position = cache.find(key);
+    if (cached_position != cache.end()) {
+        return cached_position->second;
+    }
+
+    auto result = moveAlongPath(source, destination, speed,
+                                findPath(source, destination, nullptr));
+    cache[key] = result;
 
     return result;
 }
 
+void PathPlanner::planNextPositions(const std::vector<PathQuery> &queries,
+                                    WorkerPool &worker_pool) {
+    // Queries that have not been answered yet, each asked once. Only the
+    // visibility graph can search backwards, so the other path finders plan
+    // each query alone
+    planned_queries.clear();
+    planned_groups.clear();
+    auto destination_groups = std::map<DoubleVec2D, size_t>{};
+    for (const auto &query : queries) {
+        auto key =
+            std::make_tuple(query.source, query.destination, query.speed);
+        if (cache.find(key) != cache.end())
+            continue;
+        cache[key] = DoubleVec2D::null;
+
+        auto group = destination_groups.emplace(query.destination,
+                                                planned_groups.size());
+        if (group.second || backend != PathPlannerBackend::VISIBILITY_GRAPH) {
+            planned_groups.emplace_back();
+            group.first->second = planned_groups.size() - 1;
+        }
+        planned_groups[group.first->second].push_back(planned_queries.size());
+        planned_queries.push_back(query);
+    }
+
+    planned_positions.resize(planned_queries.size());
+    planned_search_stats.resize(planned_groups.size());
+    try {
+        worker_pool.run(planned_groups.size(), [this](size_t group_index) {
+            const auto &group = planned_groups[group_index];
+            auto &search = getThreadSearch();
+
+            if (group.size() == 1) {
+                const auto &query = planned_queries[group.front()];
+                auto path = findPath(query.source, query.destination, &search);
+                planned_positions[group.front()] = moveAlongPath(
+                    query.source, query.destination, query.speed, path);
+            } else {
+                auto destination = planned_queries[group.front()].destination;
+                auto sources = std::vector<DoubleVec2D>{};
+                for (auto index : group) {
+                    sources.push_back(planned_queries[index].source);
+                }
+
+                auto paths = path_graph.getPaths(sources, destination, search);
+                for (size_t i = 0; i < group.size(); ++i) {
+                    const auto &query = planned_queries[group[i]];
+                    planned_positions[group[i]] = moveAlongPath(
+                        query.source, destination, query.speed, paths[i]);
+                }
+            }
+
+            planned_search_stats[group_index] = search.stats;
+        });
+    } catch (...) {
+        for (const auto &query : planned_queries) {
+            cache.erase(std::make_tuple(query.source, query.destination,
+                                        query.speed));
+        }
+        throw;
+    }
+
+    for (size_t index = 0; index < planned_queries.size(); ++index) {
+        const auto &query = planned_queries[index];
+        cache[std::make_tuple(query.source, query.destination, query.speed)] =
+            planned_positions[index];
+    }
+
+    // Each group costs one search, where each query would have cost one
+    num_saved_searches = queries.size() - planned_groups.size();
+    planned_search_total.num_saved_searches += num_saved_searches;
+    for (const auto &stats : planned_search_stats) {
+        planned_search_total += stats;
+    }
+}
+
+size_t PathPlanner::getNumSavedSearches() const { return num_saved_searches; }
+
 } // namespace state
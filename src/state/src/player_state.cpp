@@ -7,12 +7,11 @@ Bot Bot::null = {-1};
 Tower Tower::null = {-1};
 
 // Adding player state helper functions
-ostream &operator<<(ostream &os,
-                    const array<array<MapElement, MAP_SIZE>, MAP_SIZE> &map) {
+ostream &operator<<(ostream &os, const vector<vector<MapElement>> &map) {
     os << "Map {";
-    for (size_t x = 0; x < MAP_SIZE; ++x) {
+    for (size_t x = 0; x < map.size(); ++x) {
         os << "{";
-        for (size_t y = 0; y < MAP_SIZE; ++y) {
+        for (size_t y = 0; y < map[x].size(); ++y) {
             auto type = map[x][y].getTerrain();
             switch (type) {
             case TerrainType::FLAG:
@@ -121,8 +120,10 @@ ostream &operator<<(ostream &os, const State &state) {
     return os;
 }
 
-array<array<uint64_t, MAP_SIZE>, MAP_SIZE> getActorCounts(const State &state) {
-    array<array<uint64_t, MAP_SIZE>, MAP_SIZE> actor_counts{};
+vector<vector<uint64_t>> getActorCounts(const State &state) {
+    auto map_size = state.map.size();
+    auto actor_counts =
+        vector<vector<uint64_t>>(map_size, vector<uint64_t>(map_size));
 
     for (auto bot : state.bots) {
         DoubleVec2D bot_position = bot.position;
@@ -182,6 +183,12 @@ Tower &getTowerById(State &state, int64_t tower_id) {
     return Tower::null;
 }
 
+DoubleVec2D getEnemyBasePosition(const State &state) {
+    auto map_size = state.map.size();
+    return {map_size - PLAYER1_BASE_POSITION.x,
+            map_size - PLAYER1_BASE_POSITION.y};
+}
+
 Vec2D getOffsetFromPosition(DoubleVec2D position) {
     uint64_t pos_x = std::floor(position.x), pos_y = std::floor(position.y);
     return Vec2D(pos_x, pos_y);
@@ -254,19 +261,13 @@ Vec2D findNearestOffset(
     std::function<bool(TerrainType terrain, uint64_t position_count)>
         match_position) {
     // Creating a visited array to not revisit the same position twice
-    array<array<bool, MAP_SIZE>, MAP_SIZE> visited;
-
-    for (size_t x = 0; x < MAP_SIZE; ++x) {
-        for (size_t y = 0; y < MAP_SIZE; ++y) {
-            visited[x][y] = false;
-        }
-    }
+    long map_size = state.map.size();
+    auto visited = vector<vector<bool>>(map_size, vector<bool>(map_size));
 
     // Creating a count array of each actor in the map
     auto actor_counts = getActorCounts(state);
 
     // A helper function to check if positions are within the map
-    long map_size = MAP_SIZE;
     auto position_valid = [map_size](Vec2D position) {
         return (position.x >= 0 && position.y >= 0 && position.x < map_size &&
                 position.y < map_size);
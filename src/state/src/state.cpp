@@ -4,10 +4,62 @@
  */
 
 #include "state/state.h"
+#include "physics/fixed_vector.hpp"
+
+#include <algorithm>
+
 using namespace Constants::Actor;
 using namespace Constants::Map;
 
 namespace state {
+
+namespace {
+
+void addPosition(DigestBuilder &builder, DoubleVec2D position) {
+    builder.add(position.x).add(position.y);
+}
+
+void addOptionalPosition(DigestBuilder &builder, bool is_set,
+                         DoubleVec2D position) {
+    builder.add(uint64_t{is_set});
+    if (is_set) {
+        addPosition(builder, position);
+    }
+}
+
+void addActor(DigestBuilder &builder, const Actor &actor) {
+    builder.add((uint64_t) actor.getActorId())
+        .add((uint64_t) actor.getPlayerId())
+        .add((uint64_t) actor.getActorType())
+        .add(uint64_t{actor.getHp()})
+        .add(uint64_t{actor.getDamageIncurred()});
+    addPosition(builder, actor.getPosition());
+}
+
+StateDigest getBotDigest(const Bot &bot) {
+    auto builder = DigestBuilder();
+    addActor(builder, bot);
+    builder.add((uint64_t) bot.getState())
+        .add(uint64_t{bot.isBlasting()})
+        .add(uint64_t{bot.isTransforming()});
+    addOptionalPosition(builder, bot.isDestinationSet(), bot.getDestination());
+    addOptionalPosition(builder, bot.isFinalDestinationSet(),
+                        bot.getFinalDestination());
+    addOptionalPosition(builder, bot.isTransformDestinationSet(),
+                        bot.getTransformDestination());
+    return builder.getDigest();
+}
+
+StateDigest getTowerDigest(Tower &tower) {
+    auto builder = DigestBuilder();
+    addActor(builder, tower);
+    builder.add((uint64_t) tower.getState())
+        .add(uint64_t{tower.isBlasting()})
+        .add(tower.getAge());
+    return builder.getDigest();
+}
+} // namespace
+
 State::State(std::unique_ptr<Map> map,
              std::unique_ptr<ScoreManager> score_manager,
              std::unique_ptr<PathPlanner> path_planner,
@@ -17,7 +69,36 @@ State::State(std::unique_ptr<Map> map,
     : map(std::move(map)), score_manager(std::move(score_manager)),
       path_planner(std::move(path_planner)), bots(std::move(bots)),
       towers(std::move(towers)), model_bot(std::move(model_bot)),
-      model_tower(std::move(model_tower)) {}
+      model_tower(std::move(model_tower)) {
+    for (size_t id = 0; id < static_cast<size_t>(PlayerId::PLAYER_COUNT);
+         ++id) {
+        for (auto &bot : this->bots[id]) {
+            bots_by_id[bot->getActorId()] = bot.get();
+            bot_ptrs[id].push_back(bot.get());
+        }
+        for (auto &tower : this->towers[id]) {
+            towers_by_id[tower->getActorId()] = tower.get();
+            tower_ptrs[id].push_back(tower.get());
+        }
+    }
+
+    this->path_planner->setTurnArena(&turn_arena);
+    setNumUpdateThreads(1);
+}
+
+void State::addBot(std::unique_ptr<Bot> bot) {
+    auto id = static_cast<size_t>(bot->getPlayerId());
+    bots_by_id[bot->getActorId()] = bot.get();
+    bot_ptrs[id].push_back(bot.get());
+    bots[id].push_back(std::move(bot));
+}
+
+void State::addTower(std::unique_ptr<Tower> tower) {
+    auto id = static_cast<size_t>(tower->getPlayerId());
+    towers_by_id[tower->getActorId()] = tower.get();
+    tower_ptrs[id].push_back(tower.get());
+    towers[id].push_back(std::move(tower));
+}
 
 Map *State::getMap() const { return map.get(); }
 
@@ -25,44 +106,80 @@ std::array<uint64_t, 2> State::getScores() const {
     return score_manager->getScores();
 }
 
+StateDigest State::getDigest() const {
+    auto builder = DigestBuilder();
+
+    // Actors are combined by adding their digests, so that the order they
+    // are stored in does not matter
+    for (const auto &player_bots : bots) {
+        auto bots_digest = StateDigest{0, 0};
+        for (const auto &bot : player_bots) {
+            bots_digest += getBotDigest(*bot);
+        }
+        builder.add(uint64_t{player_bots.size()}).add(bots_digest);
+    }
+
+    for (const auto &player_towers : towers) {
+        auto towers_digest = StateDigest{0, 0};
+        for (const auto &tower : player_towers) {
+            towers_digest += getTowerDigest(*tower);
+        }
+        builder.add(uint64_t{player_towers.size()}).add(towers_digest);
+    }
+
+    builder.add(path_planner->getTerrainDigest());
+
+    for (auto counts :
+         {score_manager->getScores(), score_manager->getBotCounts(),
+          score_manager->getTowerCounts()}) {
+        builder.add(uint64_t{counts[0]}).add(uint64_t{counts[1]});
+    }
+
+    return builder.getDigest();
+}
+
 ScoreManager *State::getScoreManager() const { return score_manager.get(); }
 
 PathPlanner *State::getPathPlanner() const { return path_planner.get(); }
 
+void State::resetTurnArena() { turn_arena.reset(); }
+
+// The callbacks only capture this, so std::function stores them without
+// allocating
+BlastCallback State::getBlastCallback() {
+    // The blast damage is looked up from the blaster itself
+    return [this](PlayerId player_id, ActorId actor_id, DoubleVec2D position,
+                  int64_t) {
+        damageEnemyActors(player_id, actor_id, position);
+    };
+}
+
+ConstructTowerCallback State::getConstructTowerCallback() {
+    return [this](Bot *bot) { constructTowerCallback(bot); };
+}
+
 /**
- * Get the Raw Ptrs From Unique Ptrs object
+ * Refills a list of raw pointers from the actors owning them. The list keeps
+ * its capacity, so this does not allocate once the list has grown
  *
- * @tparam T Actor type that needs to be extracted
- * @param actors The actors' vectors
- * @return const std::array<std::vector<T *>, 2>
+ * @tparam T Actor type
+ * @param actors
+ * @param actor_ptrs
  */
 template <typename T>
-std::array<std::vector<T *>, 2> getRawPtrsFromUniquePtrs(
-    std::array<std::vector<std::unique_ptr<T>>, 2> &actors) {
-    auto ret_actors = std::array<std::vector<T *>, 2>{};
-
-    for (size_t id = 0; id < static_cast<size_t>(PlayerId::PLAYER_COUNT);
-         ++id) {
-        std::vector<T *> actor_row;
-        actor_row.resize(actors[id].size());
-
-        for (size_t actor_index = 0; actor_index < actors[id].size();
-             ++actor_index) {
-            actor_row[actor_index] = actors[id][actor_index].get();
-        }
-        ret_actors[id] = actor_row;
+static void copyRawPtrs(const std::vector<std::unique_ptr<T>> &actors,
+                        std::vector<T *> &actor_ptrs) {
+    actor_ptrs.clear();
+    for (const auto &actor : actors) {
+        actor_ptrs.push_back(actor.get());
     }
-    return ret_actors;
 }
 
 Vec2D State::getOffsetFromPosition(DoubleVec2D position, PlayerId player_id) {
     if (player_id == PlayerId::PLAYER1) {
-        int64_t pos_x = std::floor(position.x), pos_y = std::floor(position.y);
-        return {pos_x, pos_y};
+        return FixedVec2D(position).getCell();
     } else {
-        int64_t pos_x = std::ceil(position.x) - 1,
-                pos_y = std::ceil(position.y) - 1;
-        return {pos_x, pos_y};
+        return FixedVec2D(position).getCellBelowLeft();
     }
 }
 
@@ -74,21 +191,21 @@ void State::handleTransformRequests() {
     // NOTE : We do not account for towers because bots cannot move to positions
     // with towers anyway
 
-    using namespace Constants::Map;
-    std::array<std::array<int64_t, MAP_SIZE>, MAP_SIZE> position_counts{};
+    auto map_size = map->getSize();
+    auto position_counts = std::vector<int64_t>(map_size * map_size);
 
     for (int64_t id = 0; id < static_cast<int64_t>(PlayerId::PLAYER_COUNT);
          ++id) {
         for (const auto &bot : bots[id]) {
             DoubleVec2D bot_position = bot->getPosition();
             Vec2D offset = getOffsetFromPosition(bot_position, (PlayerId) id);
-            position_counts[offset.x][offset.y]++;
+            position_counts[offset.x * map_size + offset.y]++;
         }
 
         for (const auto &tower : towers[id]) {
             DoubleVec2D tower_position = tower->getPosition();
             Vec2D offset = getOffsetFromPosition(tower_position, (PlayerId) id);
-            position_counts[offset.x][offset.y]++;
+            position_counts[offset.x * map_size + offset.y]++;
         }
     }
 
@@ -102,8 +219,10 @@ void State::handleTransformRequests() {
             DoubleVec2D bot_position = bot->getPosition();
             Vec2D offset = getOffsetFromPosition(bot_position, (PlayerId) id);
             // Checking if only one actor is in the offset position where
-            // transforming is requested
-            if (position_counts[offset.x][offset.y] == 1) {
+            // transforming is requested, and that the player has room for
+            // another tower
+            if (position_counts[offset.x * map_size + offset.y] == 1 &&
+                towers[id].size() < game_limits.max_num_towers) {
                 produceTower(bot);
             }
         }
@@ -127,10 +246,10 @@ void State::transformBot(ActorId bot_id, DoubleVec2D position) {
     bot->setTransformDestination(position);
 }
 
-std::vector<Actor *> State::getAffectedActors(PlayerId player_id,
+ArenaVector<Actor *> State::getAffectedActors(PlayerId player_id,
                                               DoubleVec2D blast_position,
                                               size_t impact_range) {
-    std::vector<Actor *> affected_actors;
+    auto affected_actors = ArenaVector<Actor *>(&turn_arena);
     int64_t id = static_cast<int64_t>(player_id);
     int64_t enemy_id = (id + 1) % static_cast<int64_t>(PlayerId::PLAYER_COUNT);
 
@@ -155,79 +274,111 @@ void State::damageEnemyActors(PlayerId player_id, ActorId actor_id,
                               DoubleVec2D position) {
     const Blaster *blaster = getBlasterById(actor_id);
 
-    int64_t impact_radius = blaster->getBlastRange();
-    int64_t damage_points = blaster->getBlastDamage();
-
-    // Getting actors around position of size impact radius
-    std::vector<Actor *> affected_actors =
-        getAffectedActors(player_id, position, impact_radius);
-
-    // Adding to the actor's damage incurred
-    for (auto &affected_actor : affected_actors) {
-        DoubleVec2D affected_actor_position = affected_actor->getPosition();
-        double_t distance = position.distance(affected_actor_position);
-        double_t remaining_distance = impact_radius - distance;
-        double_t normalized_remaining_distance =
-            remaining_distance / impact_radius;
-        uint64_t inflicted_damage =
-            damage_points * normalized_remaining_distance;
-        affected_actor->damage(inflicted_damage);
-    }
+    blast_events.push_back(
+        BlastEvent{player_id, position,
+                   static_cast<double_t>(blaster->getBlastRange()),
+                   static_cast<double_t>(blaster->getBlastDamage())});
+}
+
+Span<Tower *const> State::getTowers(PlayerId player_id) {
+    return tower_ptrs[static_cast<size_t>(player_id)];
 }
 
-std::array<std::vector<Tower *>, 2> State::getTowers() {
-    return getRawPtrsFromUniquePtrs(towers);
+Span<Bot *const> State::getBots(PlayerId player_id) {
+    return bot_ptrs[static_cast<size_t>(player_id)];
 }
 
-std::array<std::vector<Bot *>, 2> State::getBots() {
-    return getRawPtrsFromUniquePtrs(bots);
+Span<TransformRequest *const>
+State::getTransformRequests(PlayerId player_id) {
+    return transform_requests[static_cast<size_t>(player_id)];
 }
 
+std::array<std::vector<Tower *>, 2> State::getTowers() { return tower_ptrs; }
+
+std::array<std::vector<Bot *>, 2> State::getBots() { return bot_ptrs; }
+
 std::array<std::vector<TransformRequest *>, 2> State::getTransformRequests() {
-    return getRawPtrsFromUniquePtrs(transform_requests);
+    return transform_requests;
 }
 
 void State::spawnNewBots() {
     // Player 1 spawn
-    using namespace std::placeholders;
     using namespace Constants::Actor;
 
-    auto damage_enemy_actors =
-        std::bind(&State::damageEnemyActors, this, _1, _2, _3);
-    auto create_tower = std::bind(&State::constructTowerCallback, this, _1);
+    auto damage_enemy_actors = getBlastCallback();
+    auto create_tower = getConstructTowerCallback();
 
     // Number of bots to spawn for player 1, bots should be less than max num
     // bots
+    auto max_num_bots = game_limits.max_num_bots;
     auto num_spawn_bots_1 =
-        std::min(BOT_SPAWN_FREQUENCY, MAX_NUM_BOTS - bots[0].size());
+        std::min(BOT_SPAWN_FREQUENCY, max_num_bots - bots[0].size());
     // Number of bots to spawn for player 2
     auto num_spawn_bots_2 =
-        std::min(BOT_SPAWN_FREQUENCY, MAX_NUM_BOTS - bots[1].size());
+        std::min(BOT_SPAWN_FREQUENCY, max_num_bots - bots[1].size());
 
     for (size_t bot_index = 0; bot_index < num_spawn_bots_1; ++bot_index) {
-        bots[0].push_back(
-            make_unique<Bot>(PlayerId::PLAYER1, MAX_BOT_HP, MAX_BOT_HP,
-                             Constants::Map::PLAYER1_BASE_POSITION, BOT_SPEED,
-                             BOT_BLAST_IMPACT_RADIUS, BOT_BLAST_DAMAGE_POINTS,
-                             score_manager.get(), path_planner.get(),
-                             damage_enemy_actors, create_tower));
+        addBot(std::make_unique<Bot>(
+            PlayerId::PLAYER1, MAX_BOT_HP, MAX_BOT_HP,
+            game_limits.getBasePosition(PlayerId::PLAYER1), BOT_SPEED,
+            BOT_BLAST_IMPACT_RADIUS, BOT_BLAST_DAMAGE_POINTS,
+            score_manager.get(), path_planner.get(), damage_enemy_actors,
+            create_tower));
     }
 
     // Player2 spawns
     for (size_t bot_index = 0; bot_index < num_spawn_bots_2; ++bot_index) {
-        bots[1].push_back(
-            make_unique<Bot>(PlayerId::PLAYER2, MAX_BOT_HP, MAX_BOT_HP,
-                             Constants::Map::PLAYER2_BASE_POSITION, BOT_SPEED,
-                             BOT_BLAST_IMPACT_RADIUS, BOT_BLAST_DAMAGE_POINTS,
-                             score_manager.get(), path_planner.get(),
-                             damage_enemy_actors, create_tower));
+        addBot(std::make_unique<Bot>(
+            PlayerId::PLAYER2, MAX_BOT_HP, MAX_BOT_HP,
+            game_limits.getBasePosition(PlayerId::PLAYER2), BOT_SPEED,
+            BOT_BLAST_IMPACT_RADIUS, BOT_BLAST_DAMAGE_POINTS,
+            score_manager.get(), path_planner.get(), damage_enemy_actors,
+            create_tower));
+    }
+}
+
+void State::setNumUpdateThreads(size_t num_threads) {
+    worker_pool =
+        std::make_unique<WorkerPool>(std::max(num_threads, size_t{1}));
+}
+
+void State::planBotMoves() {
+    path_queries.clear();
+
+    for (const auto &player_bots : bot_ptrs) {
+        for (auto *bot : player_bots) {
+            if (bot->getHp() == 0) {
+                continue;
+            }
+
+            // The bot heads for whichever destination is set. If the guess
+            // is wrong, the bot plans its move itself during the update
+            auto destination = DoubleVec2D::null;
+            if (bot->isDestinationSet()) {
+                destination = bot->getDestination();
+            } else if (bot->isFinalDestinationSet()) {
+                destination = bot->getFinalDestination();
+            } else if (bot->isTransformDestinationSet()) {
+                destination = bot->getTransformDestination();
+            }
+
+            if (destination && destination != bot->getPosition()) {
+                path_queries.push_back(PathQuery{
+                    bot->getPosition(), destination, bot->getSpeed()});
+            }
+        }
     }
+
+    path_planner->planNextPositions(path_queries, *worker_pool);
 }
 
 void State::update() {
     // Recalculate paths based on current obstacles
     path_planner->recomputePathGraph();
 
+    // Plan the moves of the bots together, before the bots ask for them
+    planBotMoves();
+
     // Update actors
     for (int64_t player_id = 0;
          player_id < static_cast<int64_t>(PlayerId::PLAYER_COUNT);
@@ -245,6 +396,9 @@ void State::update() {
         }
     }
 
+    // Dealing the damage of the blasts issued during the updates
+    resolveBlasts();
+
     // Performing late updates for each actor
     for (int64_t player_id = 0;
          player_id < static_cast<int64_t>(PlayerId::PLAYER_COUNT);
@@ -272,34 +426,36 @@ void State::update() {
     spawnNewBots();
 }
 
+void State::setGameLimits(const GameLimits &game_limits) {
+    this->game_limits = game_limits;
+}
+
+const GameLimits &State::getGameLimits() const { return game_limits; }
+
 void State::constructTowerCallback(Bot *bot) {
-    transform_requests[(int) bot->getPlayerId()].push_back(
-        std::make_unique<TransformRequest>(
+    transform_requests[static_cast<size_t>(bot->getPlayerId())].push_back(
+        turn_arena.create<TransformRequest>(
             bot->getPlayerId(), bot->getActorId(), bot->getPosition()));
 }
 
 void State::produceBot(PlayerId player_id) {
-    using namespace std::placeholders;
-    ConstructTowerCallback construct_tower_callback =
-        std::bind(&State::constructTowerCallback, this, _1);
-    BlastCallback blast_callback =
-        std::bind(&State::damageEnemyActors, this, _1, _2, _3);
+    auto construct_tower_callback = getConstructTowerCallback();
+    auto blast_callback = getBlastCallback();
 
     auto bot = std::make_unique<Bot>(
         player_id, model_bot.getHp(), model_bot.getMaxHp(),
-        PLAYER_BASE_POSITIONS[(int) player_id], model_bot.getSpeed(),
+        game_limits.getBasePosition(player_id), model_bot.getSpeed(),
         model_bot.getBlastRange(), model_bot.getBlastDamage(),
         model_bot.getScoreManager(), model_bot.getPathPlanner(), blast_callback,
         construct_tower_callback);
 
-    bots[(int) player_id].push_back(move(bot));
+    addBot(std::move(bot));
 }
 
 void State::produceTower(Bot *bot) {
     // Build a tower in given position with the same actor id as the bot and
     // transition the bot into dead state
     auto player_id = bot->getPlayerId();
-    auto id = static_cast<int64_t>(player_id);
     auto bot_id = bot->getActorId();
     auto bot_position = bot->getPosition();
 
@@ -338,12 +494,9 @@ void State::produceTower(Bot *bot) {
     bot->setState(BotStateName::DEAD);
     bot->setPosition(tower_position);
 
-    using namespace std::placeholders;
+    auto damage_enemy_actors = getBlastCallback();
 
-    auto damage_enemy_actors =
-        std::bind(&State::damageEnemyActors, this, _1, _2, _3);
-
-    towers[id].push_back(make_unique<Tower>(
+    addTower(std::make_unique<Tower>(
         bot_id, player_id, tower_hp, Constants::Actor::MAX_TOWER_HP,
         tower_position, Constants::Actor::TOWER_BLAST_DAMAGE_POINTS,
         Constants::Actor::TOWER_BLAST_IMPACT_RADIUS, score_manager.get(),
@@ -351,16 +504,14 @@ void State::produceTower(Bot *bot) {
 }
 
 void State::produceTower(PlayerId player_id) {
-    using namespace std::placeholders;
-    BlastCallback blast_callback =
-        std::bind(&State::damageEnemyActors, this, _1, _2, _3);
+    auto blast_callback = getBlastCallback();
 
     auto tower = std::make_unique<Tower>(
         player_id, model_tower.getHp(), model_tower.getMaxHp(),
-        PLAYER_BASE_POSITIONS[(int) player_id], model_bot.getBlastDamage(),
+        game_limits.getBasePosition(player_id), model_bot.getBlastDamage(),
         model_bot.getBlastRange(), model_bot.getScoreManager(), blast_callback);
 
-    towers[(int) player_id].push_back(move(tower));
+    addTower(std::move(tower));
 }
 
 void State::blastBot(ActorId actor_id, DoubleVec2D position) {
@@ -374,14 +525,20 @@ void State::blastTower(ActorId actor_id) {
 }
 
 void State::removeDeadActors() {
-    for (auto &state_bots : bots) {
+    for (size_t id = 0; id < static_cast<size_t>(PlayerId::PLAYER_COUNT);
+         ++id) {
+        auto &state_bots = bots[id];
         // Dividing the bots into dead and alive bots
         auto partition_point = std::stable_partition(
             state_bots.begin(), state_bots.end(),
             [](auto &s) { return s->getState() != BotStateName::DEAD; });
 
         // Delete the dead bots
+        for (auto bot = partition_point; bot != state_bots.end(); ++bot) {
+            bots_by_id.erase((*bot)->getActorId());
+        }
         state_bots.erase(partition_point, state_bots.end());
+        copyRawPtrs(state_bots, bot_ptrs[id]);
     }
 
     for (auto &state_towers : towers) {
@@ -400,14 +557,22 @@ void State::removeDeadActors() {
         }
     }
 
-    for (auto &state_towers : towers) {
+    for (size_t id = 0; id < static_cast<size_t>(PlayerId::PLAYER_COUNT);
+         ++id) {
+        auto &state_towers = towers[id];
+
         // Dividing tower into dead and alive towers
         auto partition_point = std::stable_partition(
             state_towers.begin(), state_towers.end(),
             [](auto &s) { return s->getState() != TowerStateName::DEAD; });
 
-        // Delete the dead bots
+        // Delete the dead towers
+        for (auto tower = partition_point; tower != state_towers.end();
+             ++tower) {
+            towers_by_id.erase((*tower)->getActorId());
+        }
         state_towers.erase(partition_point, state_towers.end());
+        copyRawPtrs(state_towers, tower_ptrs[id]);
     }
 }
 
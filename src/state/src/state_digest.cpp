@@ -0,0 +1,87 @@
+/**
+ * @file state_digest.cpp
+ * Definitions for a digest of the game state
+ */
+
+#include "state/state_digest.h"
+
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace state {
+
+namespace {
+
+/**
+ * Finalizer of the SplitMix64 generator. Every bit of the input affects
+ * every bit of the output
+ */
+uint64_t mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111eb;
+    value ^= value >> 31;
+    return value;
+}
+} // namespace
+
+bool StateDigest::operator==(const StateDigest &other) const {
+    return high == other.high && low == other.low;
+}
+
+bool StateDigest::operator!=(const StateDigest &other) const {
+    return !(*this == other);
+}
+
+StateDigest &StateDigest::operator+=(const StateDigest &other) {
+    high += other.high;
+    low += other.low;
+    return *this;
+}
+
+StateDigest &StateDigest::operator^=(const StateDigest &other) {
+    high ^= other.high;
+    low ^= other.low;
+    return *this;
+}
+
+std::string StateDigest::toString() const {
+    auto digest_stream = std::ostringstream();
+    digest_stream << std::hex << std::setfill('0') << std::setw(16) << high
+                  << std::setw(16) << low;
+    return digest_stream.str();
+}
+
+DigestBuilder::DigestBuilder()
+    : digest{0x243f6a8885a308d3, 0x13198a2e03707344} {}
+
+DigestBuilder &DigestBuilder::add(uint64_t value) {
+    // The halves use different constants, so that they do not collide
+    // together
+    digest.high = mix(digest.high ^ value) + 0x9e3779b97f4a7c15;
+    digest.low = mix(digest.low + value * 0xff51afd7ed558ccd) ^ value;
+    return *this;
+}
+
+DigestBuilder &DigestBuilder::add(double_t value) {
+    if (value == 0) {
+        value = 0;
+    } else if (std::isnan(value)) {
+        value = std::numeric_limits<double_t>::quiet_NaN();
+    }
+
+    uint64_t bits;
+    static_assert(sizeof(bits) == sizeof(value), "double_t must be 64 bits");
+    std::memcpy(&bits, &value, sizeof(bits));
+    return add(bits);
+}
+
+DigestBuilder &DigestBuilder::add(const StateDigest &value) {
+    return add(value.high).add(value.low);
+}
+
+StateDigest DigestBuilder::getDigest() const { return digest; }
+} // namespace state
@@ -9,29 +9,13 @@
 namespace state {
 
 Bot *State::getBotById(ActorId actor_id) {
-    for (int64_t id = 0; id < static_cast<int64_t>(PlayerId::PLAYER_COUNT);
-         ++id) {
-        for (auto &bot : bots[id]) {
-            if (bot->getActorId() == actor_id) {
-                return bot.get();
-            }
-        }
-    }
-
-    return nullptr;
+    auto bot = bots_by_id.find(actor_id);
+    return bot == bots_by_id.end() ? nullptr : bot->second;
 }
 
 Tower *State::getTowerById(ActorId actor_id) {
-    for (int64_t id = 0; id < static_cast<int64_t>(PlayerId::PLAYER_COUNT);
-         ++id) {
-        for (auto &tower : towers[id]) {
-            if (tower->getActorId() == actor_id) {
-                return tower.get();
-            }
-        }
-    }
-
-    return nullptr;
+    auto tower = towers_by_id.find(actor_id);
+    return tower == towers_by_id.end() ? nullptr : tower->second;
 }
 
 Blaster *State::getBlasterById(ActorId actor_id) {
@@ -3,6 +3,7 @@
  */
 
 #include "state/state_syncer.h"
+#include "tracer/tracer.h"
 
 namespace state {
 StateSyncer::StateSyncer() {}
@@ -14,23 +15,42 @@ StateSyncer::StateSyncer(std::unique_ptr<ICommandTaker> state,
       logger(logger) {}
 
 void StateSyncer::updateMainState(
+    std::array<const CommandBuffer *, 2> command_buffers,
     std::array<player_state::State, 2> &player_states,
     std::array<bool, 2> skip_turns) {
 
     // Running the user's commands
-    command_giver->runCommands(player_states, skip_turns);
+    {
+        tracer::ScopedSpan span("run_commands", "state_syncer");
+        command_giver->runCommands(command_buffers, skip_turns);
+    }
 
     // Removing the dead actors in state
-    state->removeDeadActors();
+    {
+        tracer::ScopedSpan span("remove_dead_actors", "state_syncer");
+        state->removeDeadActors();
+    }
 
     // Updating the main state
-    state->update();
+    {
+        tracer::ScopedSpan span("update_state", "state_syncer");
+        state->update();
+    }
 
     // Logging the state
-    logger->logState();
+    {
+        tracer::ScopedSpan span("log_state", "state_syncer");
+        logger->logState();
+    }
 
     // Updating the player states
-    updatePlayerStates(player_states);
+    {
+        tracer::ScopedSpan span("update_player_states", "state_syncer");
+        updatePlayerStates(player_states);
+    }
+
+    // Nothing allocated during the turn is used past this point
+    state->resetTurnArena();
 }
 
 size_t StateSyncer::getPlayerId(size_t player_id, bool is_enemy) const {
@@ -55,17 +75,15 @@ DoubleVec2D StateSyncer::flipPosition(const Map &map, DoubleVec2D position) {
 void StateSyncer::updatePlayerStates(
     std::array<player_state::State, 2> &player_states) {
     // Getting all the state information
-    auto state_bots = state->getBots();
-    auto state_towers = state->getTowers();
     auto map = state->getMap();
-    std::array<std::array<player_state::MapElement, Constants::Map::MAP_SIZE>,
-               Constants::Map::MAP_SIZE>
-        player_map{};
+    size_t map_size = map->getSize();
+    auto player_map = std::vector<std::vector<player_state::MapElement>>(
+        map_size, std::vector<player_state::MapElement>(map_size));
     std::vector<DoubleVec2D> flag_offsets{};
 
     // Creating a map of player_state map type
-    for (size_t i = 0; i < map->getSize(); ++i) {
-        for (size_t j = 0; j < map->getSize(); ++j) {
+    for (size_t i = 0; i < map_size; ++i) {
+        for (size_t j = 0; j < map_size; ++j) {
             auto &map_element = player_map[i][j];
             switch (map->getTerrainType(i, j)) {
             case TerrainType::LAND:
@@ -99,27 +117,28 @@ void StateSyncer::updatePlayerStates(
         assignTowers(enemy_id, player_states[player_id].enemy_towers, true);
 
         // Assigning the number of bots and towers
-        player_states[player_id].num_bots = state_bots[player_id].size();
-        player_states[enemy_id].num_enemy_bots = state_bots[player_id].size();
-        player_states[player_id].num_towers = state_towers[player_id].size();
-        player_states[enemy_id].num_enemy_towers =
-            state_towers[player_id].size();
+        auto num_bots = state->getBots(static_cast<PlayerId>(player_id)).size();
+        auto num_towers =
+            state->getTowers(static_cast<PlayerId>(player_id)).size();
+        player_states[player_id].num_bots = num_bots;
+        player_states[enemy_id].num_enemy_bots = num_bots;
+        player_states[player_id].num_towers = num_towers;
+        player_states[enemy_id].num_enemy_towers = num_towers;
 
         // Adding the player state map
         // For player1, positions need not be flipped
-        size_t map_size = map->getSize();
+        auto &player_state_map = player_states[player_id].map;
         if (static_cast<PlayerId>(player_id) == PlayerId::PLAYER1) {
-            for (size_t i = 0; i < map_size; ++i) {
-                std::copy(player_map[i].begin(), player_map[i].end(),
-                          player_states[player_id].map[i].begin());
-            }
+            player_state_map = player_map;
         } else {
+            player_state_map.resize(map_size);
             for (size_t i = 0; i < map_size; ++i) {
+                player_state_map[i].resize(map_size);
                 for (size_t j = 0; j < map_size; ++j) {
                     // Flipping the position and assigning the map on the basis
                     // of the flipped position
                     Vec2D position = Vec2D(i, j);
-                    player_states[player_id].map[i][j] =
+                    player_state_map[i][j] =
                         player_map[map_size - 1 - position.x]
                                   [map_size - 1 - position.y];
                 }
@@ -165,17 +184,18 @@ DoubleVec2D StateSyncer::flipTowerPosition(const Map &map,
 void StateSyncer::assignBots(int64_t id,
                              std::vector<player_state::Bot> &player_bots,
                              bool is_enemy) {
-    auto state_bots = state->getBots();
+    auto state_bots = state->getBots(static_cast<PlayerId>(id));
     auto map = state->getMap();
     size_t player_id = getPlayerId(id, is_enemy);
-    std::vector<player_state::Bot> new_bots;
-    size_t num_state_bots = state_bots[id].size();
 
-    for (size_t bot_index = 0; bot_index < num_state_bots; ++bot_index) {
+    // Filling the player bots in place keeps the capacity of the vector from
+    // the previous turn
+    player_bots.clear();
+
+    for (auto state_bot : state_bots) {
         // Creating a new bot with select properties of the player state bot if
         // they exist
         player_state::Bot new_bot;
-        auto state_bot = state_bots[id][bot_index];
 
         new_bot.id = state_bot->getActorId();
         new_bot.hp = state_bot->getHp();
@@ -226,15 +246,8 @@ void StateSyncer::assignBots(int64_t id,
         new_bot.impact_radius = state_bot->getBlastRange();
         new_bot.speed = state_bot->getSpeed();
 
-        // Adding the new bot to the list of new bots
-        new_bots.push_back(new_bot);
-    }
-
-    // Moving the new player soldiers into their player state
-    player_bots.clear();
-
-    for (const auto &player_bot : new_bots) {
-        player_bots.push_back(player_bot);
+        // Adding the new bot to the player's bots
+        player_bots.push_back(new_bot);
     }
 }
 
@@ -249,18 +262,16 @@ DoubleVec2D StateSyncer::changeBotToTowerPosition(DoubleVec2D position) {
 void StateSyncer::assignTowers(int64_t id,
                                std::vector<player_state::Tower> &player_towers,
                                bool is_enemy) {
-    auto state_towers = state->getTowers();
+    auto state_towers = state->getTowers(static_cast<PlayerId>(id));
     size_t player_id = getPlayerId(id, is_enemy);
     auto map = state->getMap();
-    std::vector<player_state::Tower> new_towers;
-    size_t num_state_towers = state_towers[id].size();
 
-    for (size_t tower_index = 0; tower_index < num_state_towers;
-         ++tower_index) {
+    player_towers.clear();
+
+    for (auto state_tower : state_towers) {
         player_state::Tower new_tower;
         // Copying select properties of the player state tower into the new
         // player state tower
-        auto state_tower = state_towers[id][tower_index];
         new_tower.id = state_tower->getActorId();
         new_tower.hp = state_tower->getHp();
 
@@ -289,13 +300,7 @@ void StateSyncer::assignTowers(int64_t id,
         // Assigning the tower's age
         new_tower.age = state_tower->getAge();
 
-        new_towers.push_back(new_tower);
-    }
-
-    player_towers.clear();
-
-    for (const auto &player_tower : new_towers) {
-        player_towers.push_back(player_tower);
+        player_towers.push_back(new_tower);
     }
 }
 
@@ -0,0 +1,67 @@
+/**
+ * @file turn_arena.cpp
+ * Definitions for a monotonic arena holding data that lives for one turn
+ */
+
+#include "state/turn_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace state {
+
+const size_t TurnArena::BLOCK_SIZE;
+
+TurnArena::TurnArena()
+    : blocks(), block_index(0), block_offset(0), num_allocations(0),
+      num_bytes(0) {}
+
+void *TurnArena::allocate(size_t size, size_t alignment) {
+    ++num_allocations;
+
+    while (block_index < blocks.size()) {
+        auto &block = blocks[block_index];
+        auto address =
+            reinterpret_cast<uintptr_t>(block.memory.get()) + block_offset;
+        auto padding = (alignment - address % alignment) % alignment;
+
+        if (block_offset + padding + size <= block.size) {
+            block_offset += padding + size;
+            num_bytes += padding + size;
+            return reinterpret_cast<void *>(address + padding);
+        }
+
+        // Move on to the next block, leaving the rest of this one unused
+        ++block_index;
+        block_offset = 0;
+    }
+
+    // Out of blocks, so grow the arena. Blocks from new[] are aligned for any
+    // fundamental type
+    auto block_size = std::max(BLOCK_SIZE, size);
+    blocks.push_back(Block{std::unique_ptr<char[]>(new char[block_size]),
+                           block_size});
+    block_offset = size;
+    num_bytes += size;
+    return blocks.back().memory.get();
+}
+
+void TurnArena::reset() {
+    block_index = 0;
+    block_offset = 0;
+    num_allocations = 0;
+    num_bytes = 0;
+}
+
+size_t TurnArena::getNumAllocations() const { return num_allocations; }
+
+size_t TurnArena::getNumBytes() const { return num_bytes; }
+
+size_t TurnArena::getCapacity() const {
+    auto capacity = size_t{0};
+    for (const auto &block : blocks) {
+        capacity += block.size;
+    }
+    return capacity;
+}
+} // namespace state
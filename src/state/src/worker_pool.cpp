@@ -0,0 +1,120 @@
+/**
+ * @file worker_pool.cpp
+ * Definitions for a fixed pool of threads running indexed tasks
+ */
+
+#include "state/worker_pool.h"
+
+#include <csignal>
+#include <pthread.h>
+#include <stdexcept>
+
+namespace state {
+
+WorkerPool::WorkerPool(size_t num_threads)
+    : task(nullptr), num_tasks(0), next_task(0), num_busy_threads(0),
+      batch_number(0), error(nullptr), is_stopping(false) {
+    if (num_threads == 0) {
+        throw std::invalid_argument("A worker pool needs at least one thread");
+    }
+
+    // Workers take no signals, so that signals sent to the process, such as
+    // the SIGCHLD a process supervisor reads from a signalfd, go to the
+    // threads waiting on them. Threads start with the mask of their creator
+    sigset_t all_signals;
+    sigset_t signal_mask;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &signal_mask);
+    try {
+        for (size_t i = 1; i < num_threads; ++i) {
+            threads.emplace_back(&WorkerPool::work, this);
+        }
+    } catch (...) {
+        pthread_sigmask(SIG_SETMASK, &signal_mask, nullptr);
+        throw;
+    }
+    pthread_sigmask(SIG_SETMASK, &signal_mask, nullptr);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        auto lock = std::unique_lock<std::mutex>(mutex);
+        is_stopping = true;
+    }
+    batch_started.notify_all();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+size_t WorkerPool::getNumThreads() const { return threads.size() + 1; }
+
+void WorkerPool::runTasks(std::unique_lock<std::mutex> &lock) {
+    while (next_task < num_tasks) {
+        auto task_index = next_task++;
+
+        lock.unlock();
+        try {
+            (*task)(task_index);
+        } catch (...) {
+            lock.lock();
+            if (!error) {
+                error = std::current_exception();
+            }
+            // Skip the tasks that have not started
+            next_task = num_tasks;
+            continue;
+        }
+        lock.lock();
+    }
+}
+
+void WorkerPool::work() {
+    auto lock = std::unique_lock<std::mutex>(mutex);
+
+    // A thread may only get to run after the first batch has started
+    auto last_batch_number = uint64_t{0};
+
+    while (true) {
+        batch_started.wait(lock, [this, last_batch_number] {
+            return is_stopping || batch_number != last_batch_number;
+        });
+        if (is_stopping) {
+            return;
+        }
+        last_batch_number = batch_number;
+
+        runTasks(lock);
+
+        if (--num_busy_threads == 0) {
+            batch_finished.notify_one();
+        }
+    }
+}
+
+void WorkerPool::run(size_t num_tasks,
+                     const std::function<void(size_t)> &task) {
+    auto lock = std::unique_lock<std::mutex>(mutex);
+
+    this->task = &task;
+    this->num_tasks = num_tasks;
+    next_task = 0;
+    error = nullptr;
+
+    // With a single task, there is nothing to share
+    if (!threads.empty() && num_tasks > 1) {
+        num_busy_threads = threads.size();
+        ++batch_number;
+        batch_started.notify_all();
+    }
+
+    runTasks(lock);
+    batch_finished.wait(lock, [this] { return num_busy_threads == 0; });
+
+    this->task = nullptr;
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+} // namespace state
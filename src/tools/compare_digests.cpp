@@ -0,0 +1,85 @@
+/**
+ * @file compare_digests.cpp
+ * Compares the per turn state digests of two runs of the same match, and
+ * reports the first turn in which they diverge
+ *
+ * Usage: compare_digests <digests_a> <digests_b>
+ *
+ * The digest files are the game.digests.csv files the main process writes
+ * when CODECHARACTER_STATE_DIGESTS is set. Exits with 0 if the runs are
+ * identical, 1 if they diverge and 2 if a file could not be read
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Reads the digests of a file, indexed by turn
+ *
+ * @throw std::runtime_error If the file cannot be read, or is malformed
+ */
+std::vector<std::string> readDigests(const std::string &file_name) {
+    auto digest_file = std::ifstream(file_name);
+    if (!digest_file) {
+        throw std::runtime_error("Could not open " + file_name);
+    }
+
+    auto line = std::string();
+    std::getline(digest_file, line);
+    if (line != "turn,digest") {
+        throw std::runtime_error(file_name + " is not a digest file");
+    }
+
+    auto digests = std::vector<std::string>();
+    while (std::getline(digest_file, line)) {
+        auto separator = line.find(',');
+        if (separator == std::string::npos ||
+            line.substr(0, separator) != std::to_string(digests.size())) {
+            throw std::runtime_error("Turn " + std::to_string(digests.size()) +
+                                     " is missing from " + file_name);
+        }
+        digests.push_back(line.substr(separator + 1));
+    }
+
+    return digests;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <digests_a> <digests_b>\n";
+        return 2;
+    }
+
+    std::vector<std::string> digests_a, digests_b;
+    try {
+        digests_a = readDigests(argv[1]);
+        digests_b = readDigests(argv[2]);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return 2;
+    }
+
+    auto num_common_turns = std::min(digests_a.size(), digests_b.size());
+    for (size_t turn = 0; turn < num_common_turns; ++turn) {
+        if (digests_a[turn] != digests_b[turn]) {
+            std::cout << "Runs diverge at turn " << turn << ": "
+                      << digests_a[turn] << " != " << digests_b[turn] << '\n';
+            return 1;
+        }
+    }
+
+    // A run that ended early diverges in the first turn it is missing
+    if (digests_a.size() != digests_b.size()) {
+        auto num_turns = std::max(digests_a.size(), digests_b.size());
+        std::cout << "Runs diverge at turn " << num_common_turns
+                  << ": only one run has " << num_turns << " turns\n";
+        return 1;
+    }
+
+    std::cout << "Runs are identical over " << digests_a.size() << " turns\n";
+    return 0;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file map_compiler.cpp
+ * Compiles a map file into the map cache, so that games on it load its
+ * terrain and waypoint graph instead of finding the graph at startup
+ *
+ * Usage: map_compiler [--distances] <map_file> <map_cache_dir>
+ *
+ * The compiled map is written to <map_cache_dir>/<digest of the map
+ * file>.ccmap, where games look for it when CODECHARACTER_MAP_CACHE is set to
+ * <map_cache_dir>. With --distances it also holds the distances between every
+ * pair of waypoints, which the landmark heuristic looks up. Exits with 0 if
+ * the map was compiled and 1 otherwise
+ */
+
+#include "main/state_builder.h"
+#include "state/map/compiled_map.h"
+#include "state/path_planner/path_planner.h"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace state;
+
+int main(int argc, char *argv[]) {
+    auto with_distances = argc == 4 && std::string(argv[1]) == "--distances";
+    if (argc != 3 && !with_distances) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--distances] <map_file> <map_cache_dir>\n";
+        return 1;
+    }
+    auto map_file_name = std::string(argv[argc - 2]);
+    auto map_cache_dir = std::string(argv[argc - 1]);
+
+    try {
+        auto map_text = readMapText(map_file_name);
+        auto map = buildMap(map_text);
+        auto path_planner = std::make_unique<PathPlanner>(map.get());
+        auto tables = path_planner->getWaypointGraphTables(with_distances);
+
+        auto map_digest = CompiledMap::getMapTextDigest(map_text);
+        auto file_name =
+            map_cache_dir + '/' + CompiledMap::getFileName(map_digest);
+        CompiledMap::write(file_name, map_digest, *map, tables.getView());
+
+        // Read back, to check that games accept it
+        auto compiled_map = CompiledMap(file_name);
+        std::cout << "Compiled " << map_file_name << " to " << file_name
+                  << ": " << compiled_map.getFlags().size() << " flags, "
+                  << tables.waypoints.size() << " waypoints, "
+                  << tables.edge_targets.size() / 2 << " edges"
+                  << (with_distances ? ", with distances" : "") << '\n';
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file tracer.h
+ * Declarations for a Chrome trace event recorder
+ */
+
+#pragma once
+
+#include "tracer/tracer_export.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tracer {
+
+/**
+ * Records timed spans into per-thread buffers and writes them out in the
+ * Chrome trace event JSON array format, viewable in Perfetto or
+ * chrome://tracing
+ *
+ * Tracing is disabled by default. Recording a span on a disabled tracer costs
+ * a single relaxed atomic load. Once enabled, each thread appends to its own
+ * fixed capacity buffer without taking any locks.
+ */
+class TRACER_EXPORT Tracer {
+  public:
+    /**
+     * Clock used for span timestamps
+     *
+     * The steady clock is CLOCK_MONOTONIC on Linux, which is shared between
+     * processes, so traces from the main and player processes line up
+     */
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Maximum number of events recorded per thread. Events recorded after the
+     * buffer is full are dropped
+     */
+    static const size_t THREAD_BUFFER_CAPACITY = 1 << 16;
+
+    /**
+     * Enables tracing for this process
+     *
+     * Must be called before any other thread starts recording spans
+     *
+     * @param file_prefix Prefix of the trace files
+     * @param process_name Name of this process in the trace. Events are
+     *                     flushed to file_prefix.process_name.json
+     */
+    static void enable(const std::string &file_prefix,
+                       const std::string &process_name);
+
+    /**
+     * Stops recording spans. Spans recorded so far are kept and are written
+     * by later flushes once tracing is enabled again
+     */
+    static void disable();
+
+    /**
+     * Check if tracing is enabled for this process
+     *
+     * @return True if spans are being recorded, false otherwise
+     */
+    static bool isEnabled();
+
+    /**
+     * Records a complete event for the calling thread
+     *
+     * @param name Name of the span. Must be a string literal, since only the
+     *             pointer is stored
+     * @param category Category of the span. Must be a string literal
+     * @param start Time at which the span began
+     * @param end Time at which the span ended
+     */
+    static void record(const char *name, const char *category,
+                       Clock::time_point start, Clock::time_point end);
+
+    /**
+     * Writes all events recorded so far by all threads to this process'
+     * trace file, overwriting previous flushes
+     *
+     * Does nothing if tracing is disabled
+     */
+    static void flush();
+
+    /**
+     * Concatenates the trace files of the given processes into a single
+     * trace file named file_prefix.json. Missing files are skipped
+     *
+     * Does nothing if tracing is disabled
+     *
+     * @param process_names Names of the processes whose traces are merged
+     */
+    static void mergeProcessTraces(
+        const std::vector<std::string> &process_names);
+
+    /**
+     * Returns the trace file name of a process
+     *
+     * @param file_prefix Prefix of the trace files
+     * @param process_name Name of the process
+     * @return std::string file_prefix.process_name.json
+     */
+    static std::string getTraceFileName(const std::string &file_prefix,
+                                        const std::string &process_name);
+};
+
+/**
+ * RAII helper that records a span from its construction to its destruction
+ */
+class TRACER_EXPORT ScopedSpan {
+  private:
+    /**
+     * Name of the span
+     */
+    const char *name;
+
+    /**
+     * Category of the span
+     */
+    const char *category;
+
+    /**
+     * True if tracing was enabled when the span began
+     */
+    bool is_active;
+
+    /**
+     * Time at which the span began
+     */
+    Tracer::Clock::time_point start;
+
+  public:
+    /**
+     * Constructor
+     *
+     * @param name Name of the span. Must be a string literal
+     * @param category Category of the span. Must be a string literal
+     */
+    ScopedSpan(const char *name, const char *category);
+
+    /**
+     * Records the span, if tracing is enabled
+     */
+    ~ScopedSpan();
+
+    ScopedSpan(const ScopedSpan &) = delete;
+    ScopedSpan &operator=(const ScopedSpan &) = delete;
+};
+} // namespace tracer
@@ -0,0 +1,220 @@
+/**
+ * @file tracer.cpp
+ * Defines the Chrome trace event recorder
+ */
+
+#include "tracer/tracer.h"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tracer {
+
+namespace {
+
+/**
+ * A single complete ("ph": "X") trace event
+ */
+struct Event {
+    const char *name;
+    const char *category;
+    Tracer::Clock::time_point start;
+    Tracer::Clock::time_point end;
+};
+
+/**
+ * Events recorded by a single thread
+ *
+ * Only the owning thread writes events. It publishes them by storing size
+ * with release semantics, so a flushing thread that loads size with acquire
+ * semantics sees every event before that index fully written
+ */
+struct ThreadBuffer {
+    explicit ThreadBuffer(int64_t tid)
+        : tid(tid), events(new Event[Tracer::THREAD_BUFFER_CAPACITY]),
+          size(0), num_dropped(0), next(nullptr) {}
+
+    int64_t tid;
+    std::unique_ptr<Event[]> events;
+    std::atomic<size_t> size;
+    std::atomic<uint64_t> num_dropped;
+    ThreadBuffer *next;
+};
+
+std::atomic_bool is_enabled(false);
+std::string trace_file_prefix;
+std::string trace_process_name;
+
+/**
+ * Head of an intrusive list of all thread buffers. Buffers are only ever
+ * prepended, and are never freed since threads like the timer's may exit
+ * before the trace is flushed
+ */
+std::atomic<ThreadBuffer *> thread_buffers(nullptr);
+
+ThreadBuffer *getThreadBuffer() {
+    thread_local ThreadBuffer *thread_buffer = nullptr;
+
+    if (thread_buffer == nullptr) {
+        thread_buffer = new ThreadBuffer(syscall(SYS_gettid));
+
+        auto head = thread_buffers.load(std::memory_order_relaxed);
+        do {
+            thread_buffer->next = head;
+        } while (!thread_buffers.compare_exchange_weak(
+            head, thread_buffer, std::memory_order_release,
+            std::memory_order_relaxed));
+    }
+
+    return thread_buffer;
+}
+
+/**
+ * Microseconds since the clock's epoch, which is what the trace format
+ * expects in "ts" and "dur"
+ */
+double toMicroseconds(Tracer::Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+} // namespace
+
+void Tracer::enable(const std::string &file_prefix,
+                    const std::string &process_name) {
+    trace_file_prefix = file_prefix;
+    trace_process_name = process_name;
+    is_enabled.store(true, std::memory_order_release);
+}
+
+void Tracer::disable() { is_enabled.store(false, std::memory_order_release); }
+
+bool Tracer::isEnabled() { return is_enabled.load(std::memory_order_relaxed); }
+
+void Tracer::record(const char *name, const char *category,
+                    Clock::time_point start, Clock::time_point end) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    auto thread_buffer = getThreadBuffer();
+    auto index = thread_buffer->size.load(std::memory_order_relaxed);
+
+    if (index >= THREAD_BUFFER_CAPACITY) {
+        thread_buffer->num_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    thread_buffer->events[index] = Event{name, category, start, end};
+    thread_buffer->size.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::flush() {
+    if (!isEnabled()) {
+        return;
+    }
+
+    auto pid = getpid();
+    std::ofstream trace_file(
+        getTraceFileName(trace_file_prefix, trace_process_name),
+        std::ios::out | std::ios::trunc);
+    trace_file << std::fixed << std::setprecision(3);
+
+    // Name the process, so that it is labelled in the viewer
+    trace_file << "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+               << ",\"tid\":0,\"args\":{\"name\":\"" << trace_process_name
+               << "\"}}";
+
+    for (auto thread_buffer = thread_buffers.load(std::memory_order_acquire);
+         thread_buffer != nullptr; thread_buffer = thread_buffer->next) {
+        auto size = thread_buffer->size.load(std::memory_order_acquire);
+
+        for (size_t i = 0; i < size; ++i) {
+            const auto &event = thread_buffer->events[i];
+            auto timestamp = toMicroseconds(event.start.time_since_epoch());
+            auto duration = toMicroseconds(event.end - event.start);
+
+            trace_file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\""
+                       << event.category << "\",\"ph\":\"X\",\"pid\":" << pid
+                       << ",\"tid\":" << thread_buffer->tid
+                       << ",\"ts\":" << timestamp << ",\"dur\":" << duration
+                       << "}";
+        }
+
+        // Mark the point at which the buffer overflowed
+        auto num_dropped =
+            thread_buffer->num_dropped.load(std::memory_order_relaxed);
+        if (num_dropped > 0 && size > 0) {
+            auto &last_event = thread_buffer->events[size - 1];
+            auto timestamp = toMicroseconds(last_event.end.time_since_epoch());
+
+            trace_file << ",\n{\"name\":\"events_dropped\",\"ph\":\"i\","
+                       << "\"s\":\"t\",\"pid\":" << pid
+                       << ",\"tid\":" << thread_buffer->tid
+                       << ",\"ts\":" << timestamp
+                       << ",\"args\":{\"count\":" << num_dropped << "}}";
+        }
+    }
+
+    trace_file << "\n]\n";
+}
+
+void Tracer::mergeProcessTraces(
+    const std::vector<std::string> &process_names) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    std::ofstream merged_file(trace_file_prefix + ".json",
+                              std::ios::out | std::ios::trunc);
+    merged_file << "[";
+
+    auto is_first = true;
+    for (const auto &process_name : process_names) {
+        std::ifstream trace_file(
+            getTraceFileName(trace_file_prefix, process_name));
+        if (!trace_file.good()) {
+            continue;
+        }
+
+        std::stringstream contents;
+        contents << trace_file.rdbuf();
+        auto events = contents.str();
+
+        // Strip the enclosing brackets of the JSON array
+        auto begin = events.find('[');
+        auto end = events.rfind(']');
+        if (begin == std::string::npos || end == std::string::npos ||
+            end <= begin + 1) {
+            continue;
+        }
+
+        merged_file << (is_first ? "" : ",")
+                    << events.substr(begin + 1, end - begin - 1);
+        is_first = false;
+    }
+
+    merged_file << "]\n";
+}
+
+std::string Tracer::getTraceFileName(const std::string &file_prefix,
+                                     const std::string &process_name) {
+    return file_prefix + "." + process_name + ".json";
+}
+
+ScopedSpan::ScopedSpan(const char *name, const char *category)
+    : name(name), category(category), is_active(Tracer::isEnabled()) {
+    if (is_active) {
+        start = Tracer::Clock::now();
+    }
+}
+
+ScopedSpan::~ScopedSpan() {
+    if (is_active) {
+        Tracer::record(name, category, start, Tracer::Clock::now());
+    }
+}
+} // namespace tracer
@@ -0,0 +1,85 @@
+#include "drivers/command_recording.h"
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+using namespace drivers;
+using namespace state;
+using namespace std;
+
+class CommandRecordingTest : public testing::Test {
+  protected:
+    array<CommandBufferStorage, 2> command_buffers;
+
+    array<const CommandBuffer *, 2> getCommandBuffers() const {
+        return {&*command_buffers[0], &*command_buffers[1]};
+    }
+};
+
+TEST_F(CommandRecordingTest, RecordAndReplay) {
+    auto stream = stringstream();
+    auto recorder = CommandRecorder(stream);
+
+    command_buffers[0]->moveBot(1, DoubleVec2D(2.5, 3));
+    command_buffers[0]->reject(logger::ErrorType::NO_ALTER_BOT_PROPERTY, 4);
+    command_buffers[1]->blastTower(7);
+    recorder.recordTurn(getCommandBuffers(), {100, 200}, {false, true});
+
+    command_buffers[0]->clear();
+    command_buffers[1]->clear();
+    command_buffers[1]->transformBot(8, DoubleVec2D(0, 1));
+    recorder.recordTurn(getCommandBuffers(), {300, 400}, {false, false});
+
+    auto replayer = CommandReplayer(stream);
+    auto turn = make_unique<RecordedTurn>();
+
+    ASSERT_TRUE(replayer.readTurn(*turn));
+    EXPECT_EQ(turn->instruction_counts, (array<uint64_t, 2>{100, 200}));
+    EXPECT_EQ(turn->skip_turns, (array<bool, 2>{false, true}));
+    ASSERT_EQ(turn->command_buffers[0]->num_commands, 2);
+    EXPECT_EQ(turn->command_buffers[0]->getCommands()[0].type,
+              CommandType::MOVE_BOT);
+    EXPECT_EQ(turn->command_buffers[0]->getCommands()[0].actor_id, 1);
+    EXPECT_EQ(turn->command_buffers[0]->getCommands()[0].position,
+              DoubleVec2D(2.5, 3));
+    EXPECT_EQ(turn->command_buffers[0]->getCommands()[1].type,
+              CommandType::REJECTED);
+    EXPECT_EQ(turn->command_buffers[0]->getCommands()[1].error_type,
+              logger::ErrorType::NO_ALTER_BOT_PROPERTY);
+    ASSERT_EQ(turn->command_buffers[1]->num_commands, 1);
+    EXPECT_EQ(turn->command_buffers[1]->getCommands()[0].type,
+              CommandType::BLAST_TOWER);
+    EXPECT_EQ(turn->command_buffers[1]->getCommands()[0].actor_id, 7);
+
+    // The buffers are cleared between turns
+    ASSERT_TRUE(replayer.readTurn(*turn));
+    EXPECT_EQ(turn->instruction_counts, (array<uint64_t, 2>{300, 400}));
+    EXPECT_EQ(turn->skip_turns, (array<bool, 2>{false, false}));
+    EXPECT_EQ(turn->command_buffers[0]->num_commands, 0);
+    ASSERT_EQ(turn->command_buffers[1]->num_commands, 1);
+    EXPECT_EQ(turn->command_buffers[1]->getCommands()[0].type,
+              CommandType::TRANSFORM_BOT);
+    EXPECT_EQ(turn->command_buffers[1]->getCommands()[0].position,
+              DoubleVec2D(0, 1));
+
+    EXPECT_FALSE(replayer.readTurn(*turn));
+}
+
+TEST_F(CommandRecordingTest, BadRecordings) {
+    auto not_a_recording = stringstream("game.log");
+    EXPECT_THROW(CommandReplayer{not_a_recording}, runtime_error);
+
+    auto stream = stringstream();
+    auto recorder = CommandRecorder(stream);
+    command_buffers[0]->moveBot(1, DoubleVec2D(2, 3));
+    recorder.recordTurn(getCommandBuffers(), {0, 0}, {false, false});
+
+    // Cut the recording short in the middle of the command
+    auto recording = stream.str();
+    auto truncated = stringstream(recording.substr(0, recording.size() - 4));
+    auto replayer = CommandReplayer(truncated);
+    auto turn = make_unique<RecordedTurn>();
+    EXPECT_THROW(replayer.readTurn(*turn), runtime_error);
+}
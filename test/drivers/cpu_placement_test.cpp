@@ -0,0 +1,89 @@
+#include "drivers/cpu_placement.h"
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace drivers;
+using namespace std;
+
+class CpuPlacementTest : public testing::Test {
+  protected:
+    // Two L3 caches, each with 3 cores of 2 hyperthreads. Like on most x86
+    // hosts, the siblings of CPU n are n and n + 6
+    vector<CpuInfo> topology;
+
+    CpuPlacementTest() {
+        for (int cpu = 0; cpu < 12; ++cpu) {
+            auto core = cpu % 6;
+            topology.push_back(CpuInfo{cpu, core, core < 3 ? 0 : 3});
+        }
+    }
+};
+
+TEST_F(CpuPlacementTest, SiblingHyperthreads) {
+    auto placement =
+        placeOnCpus(topology, PlacementPreset::SIBLING_HYPERTHREADS, 0);
+
+    EXPECT_EQ(placement.main_cpu, 0);
+    EXPECT_EQ(placement.player_cpus[0], 6);
+    EXPECT_EQ(placement.player_cpus[1], 1);
+}
+
+TEST_F(CpuPlacementTest, SameL3) {
+    auto placement = placeOnCpus(topology, PlacementPreset::SAME_L3, 0);
+    EXPECT_EQ(placement.main_cpu, 0);
+    EXPECT_EQ(placement.player_cpus[0], 1);
+    EXPECT_EQ(placement.player_cpus[1], 2);
+
+    // The next slot takes the remaining siblings in the same cache
+    placement = placeOnCpus(topology, PlacementPreset::SAME_L3, 1);
+    EXPECT_EQ(placement.main_cpu, 6);
+    EXPECT_EQ(placement.player_cpus[0], 7);
+    EXPECT_EQ(placement.player_cpus[1], 8);
+
+    // Followed by the other cache
+    placement = placeOnCpus(topology, PlacementPreset::SAME_L3, 2);
+    EXPECT_EQ(placement.main_cpu, 3);
+
+    EXPECT_THROW(placeOnCpus(topology, PlacementPreset::SAME_L3, 4),
+                 invalid_argument);
+}
+
+TEST_F(CpuPlacementTest, WorkerCpus) {
+    // Workers take the CPUs after the players' in the slot
+    auto placement = placeOnCpus(topology, PlacementPreset::SAME_L3, 0, 2);
+    EXPECT_EQ(placement.main_cpu, 0);
+    EXPECT_EQ(placement.player_cpus[1], 2);
+    EXPECT_EQ(placement.worker_cpus, (vector<int>{6, 7}));
+
+    // Slots are larger, so fewer fit in each cache
+    placement = placeOnCpus(topology, PlacementPreset::SAME_L3, 1, 2);
+    EXPECT_EQ(placement.main_cpu, 3);
+    EXPECT_THROW(placeOnCpus(topology, PlacementPreset::SAME_L3, 2, 2),
+                 invalid_argument);
+
+    placement = parseCpuPlacement("5,3,11,0,1", topology, 2);
+    EXPECT_EQ(placement.main_cpu, 5);
+    EXPECT_EQ(placement.worker_cpus, (vector<int>{0, 1}));
+    EXPECT_TRUE(parseCpuPlacement("5,3,11", topology).worker_cpus.empty());
+    EXPECT_THROW(parseCpuPlacement("5,3,11", topology, 2), invalid_argument);
+}
+
+TEST_F(CpuPlacementTest, ParsePolicy) {
+    auto placement = parseCpuPlacement("l3:2", topology);
+    EXPECT_EQ(placement.main_cpu, 3);
+
+    placement = parseCpuPlacement("siblings", topology);
+    EXPECT_EQ(placement.player_cpus[0], 6);
+
+    placement = parseCpuPlacement("5,3,11", topology);
+    EXPECT_EQ(placement.main_cpu, 5);
+    EXPECT_EQ(placement.player_cpus[0], 3);
+    EXPECT_EQ(placement.player_cpus[1], 11);
+
+    EXPECT_THROW(parseCpuPlacement("l3:x", topology), invalid_argument);
+    EXPECT_THROW(parseCpuPlacement("1,2", topology), invalid_argument);
+    EXPECT_THROW(parseCpuPlacement("1,2,3,4", topology), invalid_argument);
+    EXPECT_THROW(parseCpuPlacement("1,2,12", topology), invalid_argument);
+}
@@ -3,7 +3,6 @@
 #include "drivers/shared_memory_utils/shared_memory_player.h"
 #include "drivers/timer.h"
 #include "logger/mocks/logger_mock.h"
-#include "player_wrapper/transfer_state.h"
 #include "state/mocks/state_syncer_mock.h"
 #include "gtest/gtest.h"
 #include <atomic>
@@ -45,8 +44,7 @@ class MainDriverTest : public testing::Test {
             // Remove shm if it already exists
             boost::interprocess::shared_memory_object::remove(shm_name.c_str());
             // Create new shm
-            shms.emplace_back(new SharedMemoryMain(shm_name, false, 0, 0,
-                                                   transfer_state::State()));
+            shms.emplace_back(new SharedMemoryMain(shm_name, false, 0, 0));
         }
 
         return std::make_unique<MainDriver>(
@@ -72,8 +70,7 @@ class MainDriverTest : public testing::Test {
             // Remove shm if it already exists
             boost::interprocess::shared_memory_object::remove(shm_name.c_str());
             // Create new shm
-            shms.emplace_back(new SharedMemoryMain(shm_name, false, 0, 0,
-                                                   transfer_state::State()));
+            shms.emplace_back(new SharedMemoryMain(shm_name, false, 0, 0));
         }
 
         driver = std::make_unique<MainDriver>(
@@ -97,16 +94,16 @@ TEST_F(MainDriverTest, CleanRunByScore) {
     // Player states is updated num_turns times when running and once before
     // running
     EXPECT_CALL(*logger_mock, logState());
-    EXPECT_CALL(*state_syncer_mock, updateMainState(_, _)).Times(num_turns);
+    EXPECT_CALL(*state_syncer_mock, updateMainState(_, _, _)).Times(num_turns);
     EXPECT_CALL(*state_syncer_mock, updatePlayerStates(_)).Times(num_turns + 1);
 
     // Expect scores calls
     EXPECT_CALL(*state_syncer_mock, getScores())
         .WillOnce(Return(array<uint64_t, 2>{10, 10}));
 
-    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER1, _))
+    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER1, _, _))
         .Times(num_turns);
-    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER2, _))
+    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER2, _, _))
         .Times(num_turns);
     EXPECT_CALL(*logger_mock, logFinalGameParams(_, _)).Times(1);
     EXPECT_CALL(*logger_mock, writeGame(_)).Times(1);
@@ -149,7 +146,8 @@ TEST_F(MainDriverTest, CleanRunByScore) {
 TEST_F(MainDriverTest, EarlyPlayerExit) {
     // Expect only half the number of turns to be run
     EXPECT_CALL(*logger_mock, logState());
-    EXPECT_CALL(*state_syncer_mock, updateMainState(_, _)).Times(num_turns / 2);
+    EXPECT_CALL(*state_syncer_mock, updateMainState(_, _, _))
+        .Times(num_turns / 2);
     EXPECT_CALL(*state_syncer_mock, updatePlayerStates(_))
         .Times(num_turns / 2 + 1);
 
@@ -157,9 +155,9 @@ TEST_F(MainDriverTest, EarlyPlayerExit) {
     EXPECT_CALL(*state_syncer_mock, getScores()).Times(0);
 
     // Logger called num_turns / 2 times before the driver exits
-    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER1, _))
+    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER1, _, _))
         .Times(num_turns / 2);
-    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER2, _))
+    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER2, _, _))
         .Times(num_turns / 2);
 
     GameResult game_result{};
@@ -201,16 +199,17 @@ TEST_F(MainDriverTest, EarlyPlayerExit) {
 TEST_F(MainDriverTest, InstructionLimitReached) {
     // Expect only half the turns to run
     EXPECT_CALL(*logger_mock, logState());
-    EXPECT_CALL(*state_syncer_mock, updateMainState(_, _)).Times(num_turns / 2);
+    EXPECT_CALL(*state_syncer_mock, updateMainState(_, _, _))
+        .Times(num_turns / 2);
     EXPECT_CALL(*state_syncer_mock, updatePlayerStates(_))
         .Times(num_turns / 2 + 1);
 
     // Get Scores WILL NOT be called
     EXPECT_CALL(*state_syncer_mock, getScores()).Times(0);
 
-    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER1, _))
+    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER1, _, _))
         .Times(num_turns / 2 + 1);
-    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER2, _))
+    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER2, _, _))
         .Times(num_turns / 2 + 1);
     EXPECT_CALL(*logger_mock, logFinalGameParams(_, _)).Times(1);
     EXPECT_CALL(*logger_mock, writeGame(_)).Times(1);
@@ -279,16 +278,17 @@ TEST_F(MainDriverTest, InstructionLimitReachedSinglePlayer) {
 
     // Expect only half the turns to run
     EXPECT_CALL(*logger_mock, logState());
-    EXPECT_CALL(*state_syncer_mock, updateMainState(_, _)).Times(num_turns / 2);
+    EXPECT_CALL(*state_syncer_mock, updateMainState(_, _, _))
+        .Times(num_turns / 2);
     EXPECT_CALL(*state_syncer_mock, updatePlayerStates(_))
         .Times(num_turns / 2 + 1);
 
     // Get Scores WILL NOT be called
     EXPECT_CALL(*state_syncer_mock, getScores()).Times(0);
 
-    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER1, _))
+    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER1, _, _))
         .Times(num_turns / 2 + 1);
-    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER2, _))
+    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER2, _, _))
         .Times(num_turns / 2 + 1);
     EXPECT_CALL(*logger_mock, logFinalGameParams(_, _)).Times(1);
     EXPECT_CALL(*logger_mock, writeGame(_)).Times(1);
@@ -364,15 +364,15 @@ TEST_F(MainDriverTest, InstructionLimitReachedSinglePlayer) {
 TEST_F(MainDriverTest, Cancellation) {
     // Expect only one turn to run
     EXPECT_CALL(*logger_mock, logState());
-    EXPECT_CALL(*state_syncer_mock, updateMainState(_, _)).Times(1);
+    EXPECT_CALL(*state_syncer_mock, updateMainState(_, _, _)).Times(1);
     EXPECT_CALL(*state_syncer_mock, updatePlayerStates(_)).Times(2);
 
     // Get Scores WILL NOT be called
     EXPECT_CALL(*state_syncer_mock, getScores()).Times(0);
 
-    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER1, _))
+    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER1, _, _))
         .Times(1);
-    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER2, _))
+    EXPECT_CALL(*logger_mock, logInstructionCount(PlayerId::PLAYER2, _, _))
         .Times(1);
     EXPECT_CALL(*logger_mock, logFinalGameParams(_, _)).Times(1);
     EXPECT_CALL(*logger_mock, writeGame(_)).Times(1);
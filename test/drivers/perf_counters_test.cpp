@@ -0,0 +1,65 @@
+#include "drivers/perf_counters.h"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace drivers;
+using namespace std;
+
+// Touches fresh memory, so that there is work to count
+uint64_t doWork() {
+    auto values = vector<uint64_t>(1 << 20);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = i * i;
+        sum += values[i];
+    }
+    return sum;
+}
+
+TEST(PerfCountersTest, SamplesAvailableCounters) {
+    PerfCounters perf_counters;
+
+    perf_counters.start();
+    EXPECT_NE(doWork(), 0);
+    auto perf_counts = perf_counters.stop();
+
+    EXPECT_TRUE(perf_counts.is_sampled);
+    EXPECT_EQ(perf_counts.is_hardware_sampled,
+              perf_counters.isHardwareAvailable());
+
+    // Counters may be forbidden in the environment running the tests, in
+    // which case they must read as zero rather than fail
+    if (perf_counters.isAvailable(PerfCounters::Event::TASK_CLOCK)) {
+        EXPECT_GT(perf_counts.task_clock_ns, 0);
+    } else {
+        EXPECT_EQ(perf_counts.task_clock_ns, 0);
+    }
+
+    if (perf_counters.isAvailable(PerfCounters::Event::PAGE_FAULTS)) {
+        EXPECT_GT(perf_counts.page_faults, 0);
+    }
+
+    if (perf_counters.isHardwareAvailable()) {
+        EXPECT_GT(perf_counts.instructions, 0);
+        EXPECT_GT(perf_counts.cycles, 0);
+    } else {
+        EXPECT_EQ(perf_counts.instructions, 0);
+        EXPECT_EQ(perf_counts.cycles, 0);
+    }
+}
+
+TEST(PerfCountersTest, CountersAreResetOnStart) {
+    PerfCounters perf_counters;
+
+    perf_counters.start();
+    doWork();
+    auto first_counts = perf_counters.stop();
+
+    // An empty sample must not carry over the previous one
+    perf_counters.start();
+    auto second_counts = perf_counters.stop();
+
+    EXPECT_LE(second_counts.task_clock_ns, first_counts.task_clock_ns);
+    EXPECT_LE(second_counts.page_faults, first_counts.page_faults);
+}
@@ -0,0 +1,137 @@
+#include "drivers/player_pool/player_zygote.h"
+#include "drivers/player_pool/pooled_player.h"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace drivers;
+using namespace std;
+
+namespace {
+
+const string setting_name = "CODECHARACTER_ZYGOTE_TEST";
+const string zygote_setting_name = "CODECHARACTER_ZYGOTE_TEST_ZYGOTE";
+const string worker_log_name = "worker.log";
+
+// Exit code of a worker that found itself in the match's context
+const int worker_exit_code = 7;
+
+/**
+ * Player run by the workers. Checks it has the match's settings and not the
+ * zygote's, and writes its pid to its working directory, as a player writes
+ * its logs
+ */
+int runTestPlayer(const string &shm_name) {
+    auto setting = getenv(setting_name.c_str());
+    if (shm_name != "ShmTestZygote" || setting == nullptr ||
+        string(setting) != "match" ||
+        getenv(zygote_setting_name.c_str()) != nullptr) {
+        return 1;
+    }
+
+    ofstream(worker_log_name) << getpid();
+    return worker_exit_code;
+}
+} // namespace
+
+class PlayerZygoteTest : public testing::Test {
+  protected:
+    string directory, match_directory, socket_path, original_directory;
+
+    pid_t zygote_pid;
+
+    PlayerZygoteTest() : zygote_pid(-1) {}
+
+    void SetUp() override {
+        char directory_template[] = "/tmp/ZygoteTestXXXXXX";
+        ASSERT_NE(mkdtemp(directory_template), nullptr);
+        directory = directory_template;
+        match_directory = directory + "/match";
+        socket_path = directory + "/zygote.sock";
+        ASSERT_EQ(mkdir(match_directory.c_str(), 0700), 0);
+
+        char working_directory[PATH_MAX];
+        ASSERT_NE(getcwd(working_directory, sizeof(working_directory)),
+                  nullptr);
+        original_directory = working_directory;
+
+        // The zygote is started with settings of its own, which its workers
+        // must not see
+        setenv(zygote_setting_name.c_str(), "zygote", 1);
+        zygote_pid = fork();
+        if (zygote_pid == 0) {
+            try {
+                PlayerZygote zygote(socket_path, runTestPlayer);
+                zygote.run();
+            } catch (...) {
+            }
+            _exit(EXIT_FAILURE);
+        }
+        unsetenv(zygote_setting_name.c_str());
+
+        for (int attempt = 0; attempt < 500; ++attempt) {
+            if (access(socket_path.c_str(), F_OK) == 0) {
+                return;
+            }
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+        FAIL() << "Zygote did not start listening";
+    }
+
+    void TearDown() override {
+        if (zygote_pid > 0) {
+            kill(zygote_pid, SIGKILL);
+            waitpid(zygote_pid, nullptr, 0);
+        }
+        chdir(original_directory.c_str());
+        unsetenv(setting_name.c_str());
+
+        remove((match_directory + "/" + worker_log_name).c_str());
+        remove(match_directory.c_str());
+        remove(socket_path.c_str());
+        remove(directory.c_str());
+    }
+};
+
+TEST_F(PlayerZygoteTest, WorkerRunsInMatchContext) {
+    ASSERT_EQ(chdir(match_directory.c_str()), 0);
+    setenv(setting_name.c_str(), "match", 1);
+
+    auto player = PooledPlayer(socket_path, "ShmTestZygote");
+    EXPECT_GT(player.id(), 0);
+    EXPECT_NE(player.id(), zygote_pid);
+    player.wait();
+    EXPECT_EQ(player.exit_code(), worker_exit_code);
+
+    // The worker wrote to the match's directory, not the zygote's
+    int worker_pid = 0;
+    ifstream(match_directory + "/" + worker_log_name) >> worker_pid;
+    EXPECT_EQ(worker_pid, player.id());
+}
+
+TEST_F(PlayerZygoteTest, WorkerDropsMissingSettings) {
+    // A match that does not give the setting runs without it, even after a
+    // match that did
+    ASSERT_EQ(chdir(match_directory.c_str()), 0);
+    setenv(setting_name.c_str(), "match", 1);
+    auto first_player = PooledPlayer(socket_path, "ShmTestZygote");
+    first_player.wait();
+    EXPECT_EQ(first_player.exit_code(), worker_exit_code);
+
+    unsetenv(setting_name.c_str());
+    auto second_player = PooledPlayer(socket_path, "ShmTestZygote");
+    EXPECT_GT(second_player.id(), 0);
+    EXPECT_NE(second_player.id(), first_player.id());
+    second_player.wait();
+    EXPECT_EQ(second_player.exit_code(), 1);
+}
@@ -0,0 +1,72 @@
+#include "drivers/process_supervisor.h"
+#include "gtest/gtest.h"
+
+#include <array>
+#include <csignal>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace drivers;
+using namespace std;
+
+// Forks a child that exits with the given code, or waits to be killed if the
+// code is negative
+pid_t forkChild(int exit_code) {
+    auto pid = fork();
+    if (pid == 0) {
+        if (exit_code < 0) {
+            pause();
+        }
+        _exit(exit_code);
+    }
+    return pid;
+}
+
+TEST(ProcessSupervisorTest, ReportsChildExits) {
+    ProcessSupervisor supervisor;
+    auto failing_child = supervisor.addChild(forkChild(3));
+    auto clean_child = supervisor.addChild(forkChild(0));
+
+    auto exit_codes = array<int, 2>{-1, -1};
+    for (int i = 0; i < 2; ++i) {
+        auto process_exit = supervisor.waitForExit();
+        exit_codes[process_exit.process_index] = process_exit.exit_code;
+    }
+
+    EXPECT_EQ(exit_codes[failing_child], 3);
+    EXPECT_EQ(exit_codes[clean_child], 0);
+    EXPECT_THROW(supervisor.waitForExit(), logic_error);
+}
+
+TEST(ProcessSupervisorTest, TerminatesChild) {
+    ProcessSupervisor supervisor;
+    auto child = supervisor.addChild(forkChild(-1));
+
+    supervisor.terminate(child);
+    auto process_exit = supervisor.waitForExit();
+
+    EXPECT_EQ(process_exit.process_index, child);
+    EXPECT_EQ(process_exit.exit_code, 128 + SIGTERM);
+}
+
+TEST(ProcessSupervisorTest, ReadsExitCodeFromDescriptor) {
+    int pipe_fds[2];
+    ASSERT_EQ(pipe(pipe_fds), 0);
+
+    ProcessSupervisor supervisor;
+    auto process = supervisor.addProcess(getpid(), pipe_fds[0], [&pipe_fds] {
+        char exit_code = 0;
+        EXPECT_EQ(read(pipe_fds[0], &exit_code, 1), 1);
+        return static_cast<int>(exit_code);
+    });
+
+    char exit_code = 7;
+    ASSERT_EQ(write(pipe_fds[1], &exit_code, 1), 1);
+    auto process_exit = supervisor.waitForExit();
+
+    EXPECT_EQ(process_exit.process_index, process);
+    EXPECT_EQ(process_exit.exit_code, 7);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
@@ -0,0 +1,252 @@
+#include "drivers/shared_memory_utils/shared_memory_main.h"
+#include "drivers/shared_memory_utils/shared_memory_paging.h"
+#include "drivers/shared_memory_utils/shared_memory_player.h"
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace drivers;
+using namespace std;
+
+namespace {
+
+const string shared_memory_name = "ShmTestSharedBuffer";
+} // namespace
+
+class SharedBufferTest : public testing::Test {
+  protected:
+    // A map larger than the default, with many more actors
+    state::GameLimits limits;
+
+    SharedBufferTest() { limits = state::GameLimits{200, 2000, 500}; }
+
+    void TearDown() override {
+        boost::interprocess::shared_memory_object::remove(
+            shared_memory_name.c_str());
+    }
+
+    player_state::State makePlayerState() {
+        auto state = player_state::State{};
+        state.map.assign(limits.map_size,
+                         vector<player_state::MapElement>(limits.map_size));
+        state.map[199][1].setTerrain(player_state::TerrainType::FLAG);
+        state.flag_offsets.assign(1, DoubleVec2D(199, 1));
+        state.bots.clear();
+        state.enemy_bots.clear();
+        state.towers.clear();
+        for (int64_t bot_id = 0; bot_id < 2000; ++bot_id) {
+            state.bots.push_back(player_state::Bot(bot_id));
+        }
+        state.enemy_towers.clear();
+        state.enemy_towers.push_back(player_state::Tower(2000));
+        state.scores = {3, 4};
+        return state;
+    }
+};
+
+TEST_F(SharedBufferTest, LayoutTest) {
+    boost::interprocess::shared_memory_object::remove(
+        shared_memory_name.c_str());
+    auto shm_main =
+        make_unique<SharedMemoryMain>(shared_memory_name, false, 0, 0, limits);
+    auto main_buffer = shm_main->getBuffer();
+
+    // The buffer grows with the limits, and the player finds it whole without
+    // knowing them
+    EXPECT_EQ(main_buffer->getSize(), SharedBuffer::getSize(limits));
+    EXPECT_GT(SharedBuffer::getSize(limits),
+              SharedBuffer::getSize(state::GameLimits{}));
+
+    auto shm_player = make_unique<SharedMemoryPlayer>(shared_memory_name);
+    auto player_buffer = shm_player->getBuffer();
+    EXPECT_EQ(player_buffer->getSize(), main_buffer->getSize());
+    EXPECT_EQ(player_buffer->getTransferState().getLimits(), limits);
+    EXPECT_EQ(player_buffer->getNextCommandBuffer().getMaxNumCommands(),
+              limits.getMaxNumCommands());
+
+    // Commands written by the player are seen by the main process once they
+    // are published
+    auto commands = state::CommandBufferStorage(limits.getMaxNumCommands());
+    player_buffer->getNextCommandBuffer().moveBot(1999, DoubleVec2D(150, 150));
+    shm_main->getBufferOwner().copyCommands(*commands);
+    EXPECT_EQ(commands->num_commands, 0);
+    player_buffer->publishCommandBuffer();
+    shm_main->getBufferOwner().copyCommands(*commands);
+    ASSERT_EQ(commands->num_commands, 1);
+    EXPECT_EQ(commands->getCommands()[0].actor_id, 1999);
+}
+
+TEST_F(SharedBufferTest, PagingTest) {
+    EXPECT_EQ(parseSharedMemoryPaging("locked"), SharedMemoryPaging::LOCKED);
+    EXPECT_EQ(getSharedMemoryPagingName(SharedMemoryPaging::HUGE_PAGES),
+              "huge");
+    EXPECT_THROW(parseSharedMemoryPaging("pinned"), invalid_argument);
+
+    // Huge pages are not always available, or may not be lockable, but the
+    // pages are at least faulted in and the buffer is found whole
+    boost::interprocess::shared_memory_object::remove(
+        shared_memory_name.c_str());
+    auto shm_main =
+        make_unique<SharedMemoryMain>(shared_memory_name, false, 0, 0, limits,
+                                      SharedMemoryPaging::HUGE_PAGES);
+    EXPECT_GE(shm_main->getPaging(), SharedMemoryPaging::PREFAULTED);
+    auto shm_player = make_unique<SharedMemoryPlayer>(
+        shared_memory_name, SharedMemoryPaging::LOCKED);
+    EXPECT_GE(shm_player->getPaging(), SharedMemoryPaging::PREFAULTED);
+    EXPECT_LE(shm_player->getPaging(), SharedMemoryPaging::LOCKED);
+
+    auto player_buffer = shm_player->getBuffer();
+    EXPECT_EQ(player_buffer->getSize(), SharedBuffer::getSize(limits));
+    EXPECT_EQ(player_buffer->getTransferState().getLimits(), limits);
+
+    // Objects backed by huge pages are a whole number of them
+    auto huge_page_size = getSharedMemoryHugePageSize();
+    auto size = getSharedMemorySize(player_buffer->getSize(),
+                                    SharedMemoryPaging::HUGE_PAGES);
+    if (huge_page_size == 0) {
+        EXPECT_EQ(size, player_buffer->getSize());
+    } else {
+        EXPECT_EQ(size % huge_page_size, 0);
+    }
+}
+
+TEST_F(SharedBufferTest, DoubleBufferTest) {
+    auto memory = vector<std::max_align_t>(
+        SharedBuffer::getSize(limits) / sizeof(std::max_align_t) + 1);
+    SharedBufferOwner owner(memory.data(), limits, false, 0, 0);
+    auto buffer = owner.getBuffer();
+
+    // The next state is written while the published one is still read
+    auto state = makePlayerState();
+    owner.publishTransferState(state);
+    auto &published_state = buffer->getTransferState();
+    EXPECT_EQ(buffer->state_sequence.load(), 1);
+    EXPECT_EQ(published_state.num_bots, 2000);
+
+    state.scores = {5, 6};
+    owner.publishTransferState(state);
+    EXPECT_EQ(buffer->state_sequence.load(), 2);
+    EXPECT_NE(&buffer->getTransferState(), &published_state);
+    EXPECT_EQ(published_state.scores, (array<uint64_t, 2>{3, 4}));
+    EXPECT_EQ(buffer->getTransferState().scores, (array<uint64_t, 2>{5, 6}));
+
+    // Commands alternate between slots the same way
+    auto commands = state::CommandBufferStorage(limits.getMaxNumCommands());
+    buffer->getNextCommandBuffer().blastTower(1);
+    buffer->publishCommandBuffer();
+    buffer->getNextCommandBuffer().clear();
+    owner.copyCommands(*commands);
+    EXPECT_EQ(commands->num_commands, 1);
+    buffer->publishCommandBuffer();
+    owner.copyCommands(*commands);
+    EXPECT_EQ(commands->num_commands, 0);
+    EXPECT_EQ(buffer->command_sequence.load(), 2);
+
+    buffer->getNextCommandBuffer().blastTower(1);
+    owner.clearCommandBuffers();
+    EXPECT_EQ(buffer->getNextCommandBuffer().num_commands, 0);
+}
+
+TEST_F(SharedBufferTest, CorruptHeaderTest) {
+    auto memory = vector<std::max_align_t>(
+        SharedBuffer::getSize(limits) / sizeof(std::max_align_t) + 1);
+    SharedBufferOwner owner(memory.data(), limits, false, 0, 0);
+    auto buffer = owner.getBuffer();
+    auto state = makePlayerState();
+    owner.publishTransferState(state);
+
+    // The player writes over every header it can find, and claims more
+    // commands than the buffer has room for
+    auto &command_buffer = buffer->getNextCommandBuffer();
+    for (int command = 0; command < 10; ++command) {
+        command_buffer.blastTower(command);
+    }
+    buffer->publishCommandBuffer();
+    auto overwrite = [](void *header, size_t size) {
+        memset(header, 0xff, size);
+    };
+    auto &transfer_state = buffer->getTransferState();
+    overwrite((void *) &transfer_state, sizeof(transfer_state::State));
+    overwrite(&command_buffer, sizeof(state::CommandBuffer));
+    command_buffer.num_commands = 5;
+    auto command_sequence = buffer->command_sequence.load();
+    overwrite(buffer, sizeof(SharedBuffer));
+    buffer->state_sequence = 1;
+    buffer->command_sequence = command_sequence;
+
+    // The main process still reads and writes only the blocks it laid out
+    auto commands = state::CommandBufferStorage(limits.getMaxNumCommands());
+    owner.copyCommands(*commands);
+    ASSERT_EQ(commands->num_commands, 5);
+    EXPECT_EQ(commands->getCommands()[4].actor_id, 4);
+    command_buffer.num_commands = SIZE_MAX;
+    owner.copyCommands(*commands);
+    EXPECT_EQ(commands->num_commands, limits.getMaxNumCommands());
+
+    auto layout = SharedBufferLayout(limits);
+    auto state_layout = transfer_state::StateLayout(limits);
+    for (int turn = 0; turn < 2; ++turn) {
+        owner.publishTransferState(state);
+        auto offset = layout.transfer_state_offsets[buffer->state_sequence % 2];
+        auto &next_state = *reinterpret_cast<const transfer_state::State *>(
+            reinterpret_cast<const char *>(buffer) + offset);
+        EXPECT_EQ(next_state.num_bots, 2000);
+        auto bots = state_layout.getBots(next_state);
+        ASSERT_EQ(bots.size(), 2000);
+        EXPECT_EQ(bots[1999].id, 1999);
+        EXPECT_EQ(state_layout.getEnemyTowers(next_state)[0].id, 2000);
+    }
+}
+
+TEST_F(SharedBufferTest, TransferStateTest) {
+    auto storage = transfer_state::StateStorage(limits);
+    auto state = makePlayerState();
+    transfer_state::ConvertToTransferState(state, *storage);
+
+    auto copied_state = transfer_state::ConvertToPlayerState(*storage);
+    EXPECT_EQ(copied_state.map.size(), limits.map_size);
+    EXPECT_EQ(copied_state.map[199][1].getTerrain(),
+              player_state::TerrainType::FLAG);
+    EXPECT_EQ(copied_state.flag_offsets, state.flag_offsets);
+    ASSERT_EQ(copied_state.bots.size(), 2000);
+    EXPECT_EQ(copied_state.bots[1999].id, 1999);
+    EXPECT_TRUE(copied_state.enemy_bots.empty());
+    ASSERT_EQ(copied_state.enemy_towers.size(), 1);
+    EXPECT_EQ(copied_state.enemy_towers[0].id, 2000);
+    EXPECT_EQ(copied_state.scores, state.scores);
+
+    // Bots and towers come back from their compact records as they were
+    auto &bot = state.bots[0];
+    bot.position = DoubleVec2D(1.3, 2.7);
+    bot.hp = 150;
+    bot.state = player_state::BotState::MOVE;
+    bot.transform(DoubleVec2D(4.25, 5.5));
+    auto &tower = state.enemy_towers[0];
+    tower.position = DoubleVec2D(7.5, 8.5);
+    tower.age = 12;
+    tower.blast();
+    transfer_state::ConvertToTransferState(state, *storage);
+    copied_state = transfer_state::ConvertToPlayerState(*storage);
+    EXPECT_EQ(copied_state.bots[0], bot);
+    EXPECT_EQ(copied_state.bots[0].position, bot.position);
+    EXPECT_EQ(copied_state.enemy_towers[0], tower);
+    EXPECT_EQ(copied_state.enemy_towers[0].age, 12);
+
+    // States that do not fit the limits are refused, and maps too large for
+    // the positions of the records are refused when they are laid out
+    state.bots.push_back(player_state::Bot(2001));
+    EXPECT_THROW(transfer_state::ConvertToTransferState(state, *storage),
+                 invalid_argument);
+    state = makePlayerState();
+    state.map.pop_back();
+    EXPECT_THROW(transfer_state::ConvertToTransferState(state, *storage),
+                 invalid_argument);
+    EXPECT_NO_THROW(transfer_state::StateLayout(state::GameLimits{2048}));
+    EXPECT_THROW(transfer_state::StateLayout(state::GameLimits{2049}),
+                 invalid_argument);
+}
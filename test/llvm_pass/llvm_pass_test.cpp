@@ -35,8 +35,7 @@ class LLVMPassTest : public Test {
         // Remove if SHM with name already exists
         boost::interprocess::shared_memory_object::remove(shm_name.c_str());
 
-        this->shm_main = make_unique<SharedMemoryMain>(shm_name, false, 0, 0,
-                                                       transfer_state::State());
+        this->shm_main = make_unique<SharedMemoryMain>(shm_name, false, 0, 0);
         this->buf = shm_main->getBuffer();
     }
 
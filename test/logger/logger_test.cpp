@@ -129,15 +129,18 @@ TEST_F(LoggerTest, WriteReadTest) {
                                BlastCallback(), score_manager.get(), true);
 
     EXPECT_CALL(*state, getMap()).WillOnce(Return(map.get()));
-    EXPECT_CALL(*state, getTowers())
-        .WillOnce(Return(towers))
-        .WillRepeatedly(Return(towers_2));
-
-    EXPECT_CALL(*state, getBots())
-        .WillOnce(Return(bots))
-        .WillOnce(Return(bots_2))
-        .WillOnce(Return(bots_3))
-        .WillRepeatedly(Return(bots_4));
+    for (auto player_id : {PlayerId::PLAYER1, PlayerId::PLAYER2}) {
+        auto id = static_cast<size_t>(player_id);
+        EXPECT_CALL(*state, getTowers(player_id))
+            .WillOnce(Return(Span<Tower *const>(towers[id])))
+            .WillRepeatedly(Return(Span<Tower *const>(towers_2[id])));
+
+        EXPECT_CALL(*state, getBots(player_id))
+            .WillOnce(Return(Span<Bot *const>(bots[id])))
+            .WillOnce(Return(Span<Bot *const>(bots_2[id])))
+            .WillOnce(Return(Span<Bot *const>(bots_3[id])))
+            .WillRepeatedly(Return(Span<Bot *const>(bots_4[id])));
+    }
 
     std::array<uint64_t, 2> scores1 = {100, 100};
     std::array<uint64_t, 2> scores2 = {300, 200};
@@ -145,9 +148,25 @@ TEST_F(LoggerTest, WriteReadTest) {
         .WillOnce(Return(scores1))
         .WillRepeatedly(Return(scores2));
 
+    auto digest1 = StateDigest{0x1, 0xabcdef};
+    auto digest2 = StateDigest{0xffffffffffffffff, 0};
+    EXPECT_CALL(*state, getDigest())
+        .WillOnce(Return(digest1))
+        .WillRepeatedly(Return(digest2));
+
     vector<int64_t> inst_counts = {123456, 654321};
-    logger->logInstructionCount(PlayerId::PLAYER1, inst_counts[0]);
-    logger->logInstructionCount(PlayerId::PLAYER2, inst_counts[1]);
+
+    // Player 1 sampled software counters only, player 2 did not sample
+    auto perf_counts = PerfCounts{};
+    perf_counts.is_sampled = true;
+    perf_counts.task_clock_ns = 1000;
+    perf_counts.context_switches = 2;
+    perf_counts.page_faults = 3;
+
+    logger->logInstructionCount(PlayerId::PLAYER1, inst_counts[0],
+                                perf_counts);
+    logger->logInstructionCount(PlayerId::PLAYER2, inst_counts[1],
+                                PerfCounts{});
 
     logger->logError(PlayerId::PLAYER1, ErrorType::INVALID_MOVE_POSITION,
                      "Sample Error 1");
@@ -245,4 +264,22 @@ TEST_F(LoggerTest, WriteReadTest) {
 
     // Check if tower blasts
     ASSERT_EQ(game->states(1).towers(0).state(), proto::TOWER_DEAD);
+
+    // Check that only the sampled perf counts of the first turn are written,
+    // without hardware counts
+    ostringstream perf_stream;
+    logger->writePerfCounts(perf_stream);
+    ASSERT_EQ(perf_stream.str(),
+              "turn,player_id,task_clock_ns,context_switches,page_faults,"
+              "cycles,instructions,cache_misses\n"
+              "0,0,1000,2,3,,,\n");
+
+    // Check that the digest of every logged state is written
+    ostringstream digest_stream;
+    logger->writeDigests(digest_stream);
+    ASSERT_EQ(digest_stream.str(), "turn,digest\n"
+                                   "0,00000000000000010000000000abcdef\n"
+                                   "1,ffffffffffffffff0000000000000000\n"
+                                   "2,ffffffffffffffff0000000000000000\n"
+                                   "3,ffffffffffffffff0000000000000000\n");
 }
@@ -11,11 +11,15 @@ using namespace logger;
 class LoggerMock : public ILogger {
   public:
     MOCK_METHOD0(logState, void());
-    MOCK_METHOD2(logInstructionCount, void(PlayerId player_id, size_t count));
+    MOCK_METHOD3(logInstructionCount,
+                 void(PlayerId player_id, size_t count,
+                      const PerfCounts &perf_counts));
     MOCK_METHOD3(logError, void(state::PlayerId player_id, ErrorType error_type,
                                 std::string message));
     MOCK_METHOD2(logFinalGameParams,
                  void(state::PlayerId player_id,
                       std::array<uint64_t, 2> final_scores));
     MOCK_METHOD1(writeGame, void(std::ostream &write_stream));
+    MOCK_METHOD1(writePerfCounts, void(std::ostream &write_stream));
+    MOCK_METHOD1(writeDigests, void(std::ostream &write_stream));
 };
@@ -0,0 +1,106 @@
+#include "physics/fixed_vector.hpp"
+#include "gtest/gtest.h"
+#include <boost/functional/hash.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+using namespace std;
+using namespace physics;
+using namespace testing;
+
+TEST(FixedVectorTest, ConversionTest) {
+    auto a = FixedVec2D(2.5, 4);
+
+    ASSERT_EQ(a.x, 5 * FIXED_POINT_ONE / 2);
+    ASSERT_EQ(a.y, 4 * FIXED_POINT_ONE);
+    ASSERT_EQ(a.to_double(), DoubleVec2D(2.5, 4));
+    ASSERT_EQ(FixedVec2D(DoubleVec2D(2.5, 4)), a);
+}
+
+TEST(FixedVectorTest, RoundingTest) {
+    // Positions a little off a cell boundary round onto it
+    auto a = FixedVec2D(2.9999999, 3.0000001);
+
+    ASSERT_EQ(a, FixedVec2D(3, 3));
+    ASSERT_EQ(a.getCell(), Vector<int64_t>(3, 3));
+    ASSERT_EQ(a.getCellBelowLeft(), Vector<int64_t>(2, 2));
+
+    // Halfway cases round away from zero, as std::llround rounds them
+    for (auto value : {0.5, 1.5, -0.5, -2.5, 0.49999999999999994, -1.25,
+                       123456.75, -65536.0}) {
+        ASSERT_EQ(roundHalfAway(value), llround(value));
+    }
+}
+
+TEST(FixedVectorTest, ClampTest) {
+    // Coordinates beyond the range of a coordinate are clamped, not wrapped
+    // back onto the map
+    auto max = numeric_limits<int32_t>::max();
+    auto lowest = numeric_limits<int32_t>::lowest();
+    ASSERT_EQ(FixedVec2D(65536.5, 65541.5), FixedVec2D::fromUnits(max, max));
+    ASSERT_EQ(FixedVec2D(70000.3, -1e300),
+              FixedVec2D::fromUnits(max, lowest));
+    ASSERT_EQ(FixedVec2D(65536.5, 0).getCell(), Vector<int64_t>(32767, 0));
+
+    // Non-finite coordinates are clamped as well
+    auto infinity = numeric_limits<double>::infinity();
+    auto nan = numeric_limits<double>::quiet_NaN();
+    ASSERT_EQ(FixedVec2D(infinity, -infinity),
+              FixedVec2D::fromUnits(max, lowest));
+    ASSERT_EQ(FixedVec2D(nan, nan), FixedVec2D::fromUnits(lowest, lowest));
+
+    // The largest coordinates still in range are kept
+    ASSERT_EQ(FixedVec2D(32767.5, -32768).x, 32767 * FIXED_POINT_ONE +
+                                                 FIXED_POINT_ONE / 2);
+    ASSERT_EQ(FixedVec2D(32767.5, -32768).y, lowest);
+}
+
+TEST(FixedVectorTest, CellTest) {
+    auto a = FixedVec2D(1.5, 2);
+    ASSERT_EQ(a.getCell(), Vector<int64_t>(1, 2));
+    ASSERT_EQ(a.getCellBelowLeft(), Vector<int64_t>(1, 1));
+
+    // Cells are floored towards negative infinity
+    auto b = FixedVec2D(-0.5, -1);
+    ASSERT_EQ(b.getCell(), Vector<int64_t>(-1, -1));
+    ASSERT_EQ(b.getCellBelowLeft(), Vector<int64_t>(-1, -2));
+}
+
+TEST(FixedVectorTest, IntegralTest) {
+    ASSERT_TRUE(FixedVec2D::isIntegral(FixedVec2D(3, 0).x));
+    ASSERT_TRUE(FixedVec2D::isIntegral(FixedVec2D(-2, 0).x));
+    ASSERT_FALSE(FixedVec2D::isIntegral(FixedVec2D(3.25, 0).x));
+    ASSERT_FALSE(FixedVec2D::isIntegral(FixedVec2D(-0.5, 0).x));
+}
+
+TEST(FixedVectorTest, OrderTest) {
+    auto a = FixedVec2D(1, 5);
+    auto b = FixedVec2D(2, 1);
+    auto c = FixedVec2D(2, 3);
+
+    ASSERT_TRUE(a < b);
+    ASSERT_TRUE(b < c);
+    ASSERT_TRUE(c > a);
+    ASSERT_FALSE(a < a);
+}
+
+TEST(FixedVectorTest, HashTest) {
+    auto hasher = boost::hash<FixedVec2D>();
+
+    // Equal vectors hash alike
+    ASSERT_EQ(hasher(FixedVec2D(1.5, 2)), hasher(FixedVec2D(1.5, 2)));
+
+    // Nearby and mirrored positions hash apart
+    ASSERT_NE(hasher(FixedVec2D(1, 2)), hasher(FixedVec2D(2, 1)));
+    ASSERT_NE(hasher(FixedVec2D(1, 2)),
+              hasher(FixedVec2D::fromUnits(FIXED_POINT_ONE,
+                                           2 * FIXED_POINT_ONE + 1)));
+    ASSERT_NE(hasher(FixedVec2D(0, 0)), hasher(FixedVec2D(-1, -1)));
+}
+
+TEST(FixedVectorTest, NullTest) {
+    ASSERT_FALSE(FixedVec2D::null);
+    ASSERT_TRUE(FixedVec2D(0, 0));
+    ASSERT_EQ(FixedVec2D(DoubleVec2D::null), FixedVec2D::null);
+}
@@ -0,0 +1,47 @@
+#include "physics/simd.hpp"
+#include "gtest/gtest.h"
+#include <array>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+using namespace physics;
+using namespace testing;
+
+// Holds a whole number of batches whatever the width
+using Lanes = array<double, 4>;
+
+TEST(SimdTest, ArithmeticMatchesScalar) {
+    Lanes a = {1.5, -2.25, 1e10, 0.1};
+    Lanes b = {3.0, 7.0, 3.0, 0.2};
+
+    for (size_t i = 0; i < a.size(); i += DoubleBatch::WIDTH) {
+        auto x = DoubleBatch::load(a.data() + i);
+        auto y = DoubleBatch::load(b.data() + i);
+
+        Lanes result;
+        (sqrt(x * x + y * y) - x / y).store(result.data());
+
+        for (size_t lane = 0; lane < DoubleBatch::WIDTH; ++lane) {
+            auto expected = std::sqrt(a[i + lane] * a[i + lane] +
+                                      b[i + lane] * b[i + lane]) -
+                            a[i + lane] / b[i + lane];
+            ASSERT_EQ(result[lane], expected);
+        }
+    }
+}
+
+TEST(SimdTest, SelectLessEqual) {
+    auto nan = numeric_limits<double>::quiet_NaN();
+    Lanes a = {1, 2, 3, nan};
+    auto limit = DoubleBatch::broadcast(2);
+    auto value = DoubleBatch::broadcast(5);
+
+    Lanes result;
+    for (size_t i = 0; i < a.size(); i += DoubleBatch::WIDTH) {
+        selectLessEqual(DoubleBatch::load(a.data() + i), limit, value)
+            .store(result.data() + i);
+    }
+
+    ASSERT_EQ(result, (Lanes{5, 5, 0, 0}));
+}
@@ -0,0 +1,183 @@
+#include "player_wrapper/command_adapter.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace testing;
+using namespace player_wrapper;
+using logger::ErrorType;
+using state::CommandBufferStorage;
+using state::CommandType;
+
+class CommandAdapterTest : public Test {
+  protected:
+    player_state::State state;
+    player_state::State updated_state;
+    CommandBufferStorage commands;
+
+    CommandAdapterTest() : state(), updated_state(), commands() {
+        commands->clear();
+        state.bots.clear();
+        state.enemy_bots.clear();
+        state.towers.clear();
+        state.enemy_towers.clear();
+
+        // Two bots and a tower for the player, and one of each for the enemy
+        for (int64_t bot_id = 1; bot_id <= 2; ++bot_id) {
+            auto bot = player_state::Bot();
+            bot.id = bot_id;
+            bot.position = DoubleVec2D(bot_id, bot_id);
+            bot.state = player_state::BotState::IDLE;
+            bot.reset();
+            state.bots.push_back(bot);
+        }
+
+        auto tower = player_state::Tower();
+        tower.id = 3;
+        tower.position = DoubleVec2D(0.5, 0.5);
+        tower.state = player_state::TowerState::IDLE;
+        tower.reset();
+        state.towers.push_back(tower);
+
+        state.enemy_bots.push_back(state.bots[0]);
+        state.enemy_towers.push_back(tower);
+
+        updated_state = state;
+    }
+
+    void emit() { emitCommands(state, updated_state, *commands); }
+
+    /**
+     * Expects exactly one command, and returns it
+     */
+    state::Command onlyCommand() {
+        EXPECT_EQ(commands->num_commands, 1);
+        return commands->getCommands()[0];
+    }
+};
+
+TEST_F(CommandAdapterTest, NoCommands) {
+    emit();
+    EXPECT_EQ(commands->num_commands, 0);
+}
+
+TEST_F(CommandAdapterTest, BotCommands) {
+    updated_state.bots[0].move(DoubleVec2D(2, 3));
+    updated_state.bots[1].blast(DoubleVec2D(4, 4));
+    emit();
+
+    ASSERT_EQ(commands->num_commands, 2);
+    EXPECT_EQ(commands->getCommands()[0].type, CommandType::MOVE_BOT);
+    EXPECT_EQ(commands->getCommands()[0].actor_id, 1);
+    EXPECT_EQ(commands->getCommands()[0].position, DoubleVec2D(2, 3));
+    EXPECT_EQ(commands->getCommands()[1].type, CommandType::BLAST_BOT);
+    EXPECT_EQ(commands->getCommands()[1].actor_id, 2);
+    EXPECT_EQ(commands->getCommands()[1].position, DoubleVec2D(4, 4));
+
+    // Blasting and transforming in place target the bot's own position
+    commands->clear();
+    updated_state = state;
+    updated_state.bots[0].blast();
+    updated_state.bots[1].transform();
+    emit();
+
+    ASSERT_EQ(commands->num_commands, 2);
+    EXPECT_EQ(commands->getCommands()[0].type, CommandType::BLAST_BOT);
+    EXPECT_EQ(commands->getCommands()[0].position, state.bots[0].position);
+    EXPECT_EQ(commands->getCommands()[1].type, CommandType::TRANSFORM_BOT);
+    EXPECT_EQ(commands->getCommands()[1].position, state.bots[1].position);
+
+    commands->clear();
+    updated_state = state;
+    updated_state.bots[0].transform(DoubleVec2D(3.5, 2.5));
+    emit();
+
+    auto command = onlyCommand();
+    EXPECT_EQ(command.type, CommandType::TRANSFORM_BOT);
+    EXPECT_EQ(command.position, DoubleVec2D(3.5, 2.5));
+}
+
+TEST_F(CommandAdapterTest, TowerCommands) {
+    updated_state.towers[0].blast();
+    emit();
+
+    auto command = onlyCommand();
+    EXPECT_EQ(command.type, CommandType::BLAST_TOWER);
+    EXPECT_EQ(command.actor_id, 3);
+}
+
+TEST_F(CommandAdapterTest, AlterActorProperties) {
+    auto expectRejected = [this](ErrorType error_type) {
+        emit();
+        auto command = onlyCommand();
+        EXPECT_EQ(command.type, CommandType::REJECTED);
+        EXPECT_EQ(command.error_type, error_type);
+        commands->clear();
+        updated_state = state;
+    };
+
+    // The bot's command is dropped along with the change
+    updated_state.bots[0].id = -1;
+    updated_state.bots[0].move(DoubleVec2D(2, 3));
+    expectRejected(ErrorType::NO_ALTER_BOT_PROPERTY);
+
+    updated_state.bots[0].hp = -1;
+    expectRejected(ErrorType::NO_ALTER_BOT_PROPERTY);
+
+    updated_state.bots[0].position = DoubleVec2D(200, 200);
+    expectRejected(ErrorType::NO_ALTER_BOT_PROPERTY);
+
+    updated_state.bots[0].state = player_state::BotState::TRANSFORM;
+    expectRejected(ErrorType::NO_ALTER_BOT_PROPERTY);
+
+    updated_state.towers[0].hp = -1;
+    expectRejected(ErrorType::NO_ALTER_TOWER_PROPERTY);
+
+    updated_state.towers[0].id = -1;
+    expectRejected(ErrorType::NO_ALTER_TOWER_PROPERTY);
+
+    updated_state.towers[0].position = DoubleVec2D(12, 25);
+    expectRejected(ErrorType::NO_ALTER_TOWER_PROPERTY);
+
+    updated_state.towers[0].state = player_state::TowerState::BLAST;
+    expectRejected(ErrorType::NO_ALTER_TOWER_PROPERTY);
+}
+
+TEST_F(CommandAdapterTest, MultipleBotTasks) {
+    updated_state.bots[0].destination = DoubleVec2D(0, 0);
+    updated_state.bots[0].blasting = true;
+    updated_state.bots[1].transforming = true;
+    updated_state.bots[1].final_destination = DoubleVec2D(0, 0);
+    emit();
+
+    ASSERT_EQ(commands->num_commands, 2);
+    for (size_t i = 0; i < commands->num_commands; ++i) {
+        EXPECT_EQ(commands->getCommands()[i].type, CommandType::REJECTED);
+        EXPECT_EQ(commands->getCommands()[i].error_type,
+                  ErrorType::NO_MULTIPLE_BOT_TASK);
+    }
+}
+
+// Additional actors are added into the player state, which rejects all of the
+// player's commands for those actors
+TEST_F(CommandAdapterTest, AddAndRemoveActors) {
+    updated_state.bots.push_back(player_state::Bot());
+    updated_state.towers[0].blast();
+    emit();
+
+    auto command = onlyCommand();
+    EXPECT_EQ(command.type, CommandType::REJECTED);
+    EXPECT_EQ(command.error_type, ErrorType::NUMBER_OF_BOTS_MISMATCH);
+
+    // Bot commands are still given when only the towers are changed
+    commands->clear();
+    updated_state = state;
+    updated_state.bots[0].move(DoubleVec2D(2, 3));
+    updated_state.enemy_towers.clear();
+    emit();
+
+    ASSERT_EQ(commands->num_commands, 2);
+    EXPECT_EQ(commands->getCommands()[0].type, CommandType::MOVE_BOT);
+    EXPECT_EQ(commands->getCommands()[1].type, CommandType::REJECTED);
+    EXPECT_EQ(commands->getCommands()[1].error_type,
+              ErrorType::NUMBER_OF_TOWERS_MISMATCH);
+}
@@ -0,0 +1,95 @@
+#include "scripted_players/scripted_players.h"
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+
+using namespace std;
+using namespace testing;
+using namespace scripted_players;
+using namespace player_state;
+
+class ScriptedPlayersTest : public Test {
+  protected:
+    State state;
+
+    ScriptedPlayersTest() : state() {
+        state.bots.clear();
+        state.enemy_bots.clear();
+        state.towers.clear();
+        state.enemy_towers.clear();
+        state.flag_offsets.clear();
+    }
+
+    Bot &addBot(vector<Bot> &bots, int64_t id, DoubleVec2D position) {
+        auto bot = Bot(id);
+        bot.position = position;
+        bot.state = BotState::IDLE;
+        bots.push_back(bot);
+        return bots.back();
+    }
+};
+
+TEST_F(ScriptedPlayersTest, BuildByName) {
+    for (const auto &name : SCRIPTED_PLAYER_NAMES) {
+        EXPECT_NE(buildScriptedPlayer(name), nullptr);
+    }
+    EXPECT_THROW(buildScriptedPlayer("turtle"), invalid_argument);
+}
+
+TEST_F(ScriptedPlayersTest, IdlePlayerGivesNoCommands) {
+    addBot(state.bots, 1, DoubleVec2D(2, 2));
+
+    auto updated_state = IdlePlayer().update(state);
+
+    EXPECT_EQ(updated_state.bots[0], state.bots[0]);
+}
+
+TEST_F(ScriptedPlayersTest, FlagRusherSpreadsOverFlags) {
+    state.flag_offsets = {DoubleVec2D(5.5, 5.5), DoubleVec2D(7.5, 3.5)};
+    addBot(state.bots, 4, DoubleVec2D(1, 1));
+    addBot(state.bots, 5, DoubleVec2D(1, 1));
+    addBot(state.bots, 6, DoubleVec2D(1, 1)).state = BotState::DEAD;
+
+    auto updated_state = FlagRusher().update(state);
+
+    EXPECT_EQ(updated_state.bots[0].destination, DoubleVec2D(5.5, 5.5));
+    EXPECT_EQ(updated_state.bots[1].destination, DoubleVec2D(7.5, 3.5));
+    EXPECT_EQ(updated_state.bots[2].destination, DoubleVec2D::null);
+}
+
+TEST_F(ScriptedPlayersTest, BlastSwarmChasesNearestEnemy) {
+    addBot(state.bots, 1, DoubleVec2D(10, 10));
+    addBot(state.bots, 2, DoubleVec2D(20, 20));
+    addBot(state.enemy_bots, 3, DoubleVec2D(11, 10));
+    addBot(state.enemy_bots, 4, DoubleVec2D(25, 20));
+
+    auto updated_state = BlastSwarm().update(state);
+
+    // In range of an enemy, blasts in place
+    EXPECT_TRUE(updated_state.bots[0].blasting);
+
+    // Out of range, goes after the nearest enemy
+    EXPECT_FALSE(updated_state.bots[1].blasting);
+    EXPECT_EQ(updated_state.bots[1].final_destination, DoubleVec2D(25, 20));
+}
+
+TEST_F(ScriptedPlayersTest, TowerSpammerBuildsAndBlasts) {
+    addBot(state.bots, 1, DoubleVec2D(1, 1));
+    state.num_towers = 0;
+
+    auto tower = Tower(2);
+    tower.position = DoubleVec2D(15.5, 15.5);
+    tower.age = Constants::Actor::TOWER_MIN_BLAST_AGE;
+    state.towers.push_back(tower);
+    addBot(state.enemy_bots, 3, DoubleVec2D(17, 15));
+
+    auto updated_state = TowerSpammer().update(state);
+
+    // The bot is sent to a site on the player's half of the map
+    auto site = updated_state.bots[0].transform_destination;
+    ASSERT_TRUE(static_cast<bool>(site));
+    EXPECT_LT(site.x + site.y, MAP_SIZE);
+
+    // The tower has an enemy bot in range
+    EXPECT_TRUE(updated_state.towers[0].blasting);
+}
@@ -1,5 +1,6 @@
 #include "constants/actor.h"
 #include "logger/mocks/logger_mock.h"
+#include "state/command_buffer.h"
 #include "state/command_giver.h"
 #include "state/map/map.h"
 #include "state/mocks/state_mock.h"
@@ -8,10 +9,12 @@
 #include "state/score_manager/score_manager.h"
 #include "gtest/gtest.h"
 
+#include <limits>
+#include <vector>
+
 using namespace state;
 using namespace std;
 using namespace testing;
-using namespace player_state;
 
 class CommandGiverTest : public Test {
   protected:
@@ -23,22 +26,39 @@ class CommandGiverTest : public Test {
     unique_ptr<ScoreManager> score_manager;
     unique_ptr<PathPlanner> path_planner;
     unique_ptr<CommandGiver> command_giver;
-    array<player_state::State, 2> player_states;
+    array<CommandBufferStorage, 2> command_buffers;
     array<vector<state::Bot *>, 2> state_bots;
     array<vector<state::Tower *>, 2> state_towers;
     vector<DoubleVec2D> bot_positions, tower_positions;
 
   public:
-    void
-    manageActorExpectations(array<vector<state::Bot *>, 2> state_bots,
-                            array<vector<state::Tower *>, 2> state_towers) {
-        EXPECT_CALL(*state, getBots).WillOnce(Return(state_bots));
-        EXPECT_CALL(*state, getTowers).WillOnce(Return(state_towers));
+    void manageActorExpectations() {
+        EXPECT_CALL(*state, getBotById(_)).WillRepeatedly(Return(nullptr));
+        EXPECT_CALL(*state, getTowerById(_)).WillRepeatedly(Return(nullptr));
+        for (const auto &player_bots : state_bots) {
+            for (auto bot : player_bots) {
+                EXPECT_CALL(*state, getBotById(bot->getActorId()))
+                    .WillRepeatedly(Return(bot));
+            }
+        }
+        for (const auto &player_towers : state_towers) {
+            for (auto tower : player_towers) {
+                EXPECT_CALL(*state, getTowerById(tower->getActorId()))
+                    .WillRepeatedly(Return(tower));
+            }
+        }
+        for (auto player_id : {PlayerId::PLAYER1, PlayerId::PLAYER2}) {
+            const auto &towers = state_towers[static_cast<size_t>(player_id)];
+            EXPECT_CALL(*state, getTowers(player_id))
+                .WillRepeatedly(Return(Span<state::Tower *const>(towers)));
+        }
     }
 
-    void runCommands(array<player_state::State, 2> &temp_player_states) {
-        command_giver->runCommands(temp_player_states, {false, false});
-        temp_player_states = player_states;
+    void runCommands(array<bool, 2> skip_turns = {false, false}) {
+        command_giver->runCommands(
+            {&*command_buffers[0], &*command_buffers[1]}, skip_turns);
+        command_buffers[0]->clear();
+        command_buffers[1]->clear();
     }
 
     CommandGiverTest() {
@@ -71,27 +91,16 @@ class CommandGiverTest : public Test {
          *
          */
 
-        const auto L = player_state::TerrainType::LAND;
-        const auto W = player_state::TerrainType::WATER;
-        const auto F = player_state::TerrainType::FLAG;
-        const auto T = player_state::TerrainType::TOWER;
-
-        // Creating the player state map
+        // Creating the map
         vector<vector<state::TerrainType>> test_map;
         for (size_t x = 0; x < map_size; ++x) {
             vector<state::TerrainType> map_row;
-            MapElement map_element{};
             for (size_t y = 0; y < map_size; ++y) {
                 if (x + y == map_size - 1) {
-                    map_element.setTerrain(W);
                     map_row.push_back(state::TerrainType::WATER);
                 } else {
-                    map_element.setTerrain(L);
                     map_row.push_back(state::TerrainType::LAND);
                 }
-                player_states[0].map[x][y] = map_element;
-                player_states[1].map[map_size - 1 - x][map_size - 1 - y] =
-                    map_element;
             }
             test_map.push_back(map_row);
         }
@@ -103,108 +112,18 @@ class CommandGiverTest : public Test {
 
         // Assigning the flag locations
         test_map[2][2] = state::TerrainType::FLAG;
-        player_states[0].map[2][2].setTerrain(F);
-        player_states[1].map[2][2].setTerrain(F);
 
         // Assigning tower locations
         test_map[tower_positions[0].y][tower_positions[0].x] =
             state::TerrainType::TOWER;
         test_map[tower_positions[1].y][tower_positions[1].x] =
             state::TerrainType::TOWER;
-        player_states[0]
-            .map[tower_positions[0].y][tower_positions[0].x]
-            .setTerrain(T);
-        player_states[0]
-            .map[tower_positions[1].y][tower_positions[1].x]
-            .setTerrain(T);
-        player_states[1]
-            .map[tower_positions[0].y][tower_positions[0].x]
-            .setTerrain(T);
-        player_states[1]
-            .map[tower_positions[1].y][tower_positions[1].x]
-            .setTerrain(T);
 
         map = new Map(test_map, map_size);
         path_planner = make_unique<PathPlanner>(map);
 
-        // Clearing player state
-        for (int player_id = 0; player_id < 2; ++player_id) {
-            player_states[player_id].bots.clear();
-            player_states[player_id].enemy_bots.clear();
-            player_states[player_id].towers.clear();
-            player_states[player_id].enemy_towers.clear();
-            player_states[player_id].num_bots = 0;
-            player_states[player_id].num_enemy_bots = 0;
-            player_states[player_id].num_towers = 0;
-            player_states[player_id].num_enemy_towers = 0;
-        }
-
-        // Creating an incrementing actor id
-        size_t actor_id = 1;
-
-        // Creating bots for both players
-        for (int player_id = 0;
-             player_id < static_cast<int64_t>(PlayerId::PLAYER_COUNT);
-             ++player_id) {
-            int enemy_id =
-                (player_id + 1) % static_cast<size_t>(PlayerId::PLAYER_COUNT);
-
-            // Assigning bot positions
-            DoubleVec2D position = bot_positions[0];
-            DoubleVec2D flipped_position =
-                DoubleVec2D(map_size - position.x, map_size - position.y);
-
-            player_states[player_id].num_bots = 1;
-            player_states[player_id].num_enemy_bots = 1;
-
-            player_state::Bot player_bot;
-            player_bot.id = actor_id++;
-
-            // Assigning player_bot's position for each player and appending
-            // it to player's towers
-            player_bot.position = position;
-            player_states[player_id].bots.push_back(player_bot);
-
-            // Flipping the bot position and appending it to the enemy bots
-            // of other player
-            player_bot.position = flipped_position;
-            player_states[enemy_id].enemy_bots.push_back(player_bot);
-        }
-
-        // Creating towers for both players
-        for (int player_id = 0;
-             player_id < static_cast<int64_t>(PlayerId::PLAYER_COUNT);
-             ++player_id) {
-            player_states[player_id].num_towers = 1;
-            player_states[player_id].num_enemy_towers = 1;
-
-            // Assigning bot positions
-            DoubleVec2D position = tower_positions[0];
-            DoubleVec2D flipped_position =
-                DoubleVec2D(map_size - position.x, map_size - position.y);
-
-            int enemy_id =
-                (player_id + 1) % static_cast<size_t>(PlayerId::PLAYER_COUNT);
-
-            player_state::Tower player_tower;
-            player_tower.id = actor_id++;
-
-            // Assigning player_tower's position for each player and appending
-            // it to player's towers
-            player_tower.position = position;
-
-            player_states[player_id].towers.push_back(player_tower);
-
-            // Flipping the bot position and appending it to the enemy bots of
-            // other player
-            player_tower.position = flipped_position;
-
-            player_states[enemy_id].enemy_towers.push_back(player_tower);
-        }
-
-        player_states[0].scores = {1000, 1000};
-
-        player_states[1].scores = {1000, 1000};
+        command_buffers[0]->clear();
+        command_buffers[1]->clear();
 
         // Creating state bots and towers
         auto state_bot1 =
@@ -235,146 +154,178 @@ class CommandGiverTest : public Test {
     }
 };
 
-TEST_F(CommandGiverTest, AlterActorProperties) {
-    // Creating a temporary player state to modify
-    array<player_state::State, 2> temp_player_states = player_states;
+TEST_F(CommandGiverTest, ValidCommands) {
+    // Returning the map repeatedly
+    EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
+    manageActorExpectations();
+    EXPECT_CALL(*logger, logError(_, _, _)).Times(0);
+
+    // Player 2's positions are flipped into the main state's frame
+    EXPECT_CALL(*state, moveBot(1, DoubleVec2D(2, 3)));
+    EXPECT_CALL(*state, moveBot(2, DoubleVec2D(4, 3)));
+    command_buffers[0]->moveBot(1, DoubleVec2D(2, 3));
+    command_buffers[1]->moveBot(2, DoubleVec2D(1, 2));
+    runCommands();
+
+    EXPECT_CALL(*state, blastBot(1, bot_positions[0]));
+    EXPECT_CALL(*state, transformBot(2, DoubleVec2D(3.5, 1.5)));
+    command_buffers[0]->blastBot(1, bot_positions[0]);
+    command_buffers[1]->transformBot(2, DoubleVec2D(1.5, 3.5));
+    runCommands();
+
+    // Towers can blast once they are old enough
+    for (uint64_t turn = 0; turn < Constants::Actor::TOWER_MIN_BLAST_AGE;
+         ++turn) {
+        state_towers[0][0]->update();
+    }
+    EXPECT_CALL(*state, blastTower(3));
+    command_buffers[0]->blastTower(3);
+    runCommands();
+}
 
+TEST_F(CommandGiverTest, ForeignActors) {
     // Returning the map repeatedly
     EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
+    manageActorExpectations();
+    EXPECT_CALL(*state, moveBot(_, _)).Times(0);
+    EXPECT_CALL(*state, blastTower(_)).Times(0);
 
-    // ------------- Alter bot properties -----------
-    manageActorExpectations(state_bots, state_towers);
+    // Commanding the enemy's bot
     EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
                                   ErrorType::NO_ALTER_BOT_PROPERTY, _));
-    temp_player_states[0].bots[0].id = -1;
-    runCommands(temp_player_states);
+    command_buffers[0]->moveBot(2, DoubleVec2D(2, 3));
+    runCommands();
 
-    manageActorExpectations(state_bots, state_towers);
+    // Commanding a bot that does not exist
     EXPECT_CALL(*logger, logError(PlayerId::PLAYER2,
                                   ErrorType::NO_ALTER_BOT_PROPERTY, _));
-    temp_player_states[1].bots[0].hp = -1;
-    runCommands(temp_player_states);
-
-    manageActorExpectations(state_bots, state_towers);
-    EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
-                                  ErrorType::NO_ALTER_BOT_PROPERTY, _));
-    temp_player_states[0].bots[0].position = DoubleVec2D(200, 200);
-    runCommands(temp_player_states);
+    command_buffers[1]->moveBot(42, DoubleVec2D(2, 3));
+    runCommands();
 
-    manageActorExpectations(state_bots, state_towers);
+    // Commanding the enemy's tower, or a bot as if it were a tower
     EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
-                                  ErrorType::NO_ALTER_BOT_PROPERTY, _));
-    temp_player_states[0].bots[0].state = player_state::BotState::TRANSFORM;
-    runCommands(temp_player_states);
-
-    // ------------- TOWER TESTS ------------------
-
-    // Alter tower properties
-    manageActorExpectations(state_bots, state_towers);
-    EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
-                                  ErrorType::NO_ALTER_TOWER_PROPERTY, _));
-    temp_player_states[0].towers[0].hp = -1;
-    runCommands(temp_player_states);
-
-    manageActorExpectations(state_bots, state_towers);
-    EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
-                                  ErrorType::NO_ALTER_TOWER_PROPERTY, _));
-    temp_player_states[0].towers[0].id = -1;
-    runCommands(temp_player_states);
-
-    manageActorExpectations(state_bots, state_towers);
-    EXPECT_CALL(*logger, logError(PlayerId::PLAYER2,
-                                  ErrorType::NO_ALTER_TOWER_PROPERTY, _));
-    temp_player_states[1].towers[0].position = DoubleVec2D(12, 25);
-    runCommands(temp_player_states);
-
-    manageActorExpectations(state_bots, state_towers);
-    EXPECT_CALL(*logger, logError(PlayerId::PLAYER2,
-                                  ErrorType::NO_ALTER_TOWER_PROPERTY, _));
-    temp_player_states[1].towers[0].state = player_state::TowerState::BLAST;
-    runCommands(temp_player_states);
+                                  ErrorType::NO_ALTER_TOWER_PROPERTY, _))
+        .Times(2);
+    command_buffers[0]->blastTower(4);
+    command_buffers[0]->blastTower(1);
+    runCommands();
 }
 
 TEST_F(CommandGiverTest, MultipleBotTasks) {
-    // Creating a temporary player state to modify
-    array<player_state::State, 2> temp_player_states = player_states;
-
     // Returning the map repeatedly
     EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
+    manageActorExpectations();
 
-    manageActorExpectations(state_bots, state_towers);
-    EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
-                                  ErrorType::NO_MULTIPLE_BOT_TASK, _));
-    temp_player_states[0].bots[0].destination = DoubleVec2D(0, 0);
-    temp_player_states[0].bots[0].blasting = true;
-    runCommands(temp_player_states);
-
-    manageActorExpectations(state_bots, state_towers);
+    // Only the first command given to a bot in a turn is run
+    EXPECT_CALL(*state, moveBot(1, DoubleVec2D(2, 3)));
+    EXPECT_CALL(*state, blastBot(_, _)).Times(0);
     EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
                                   ErrorType::NO_MULTIPLE_BOT_TASK, _));
-    temp_player_states[0].bots[0].blasting = true;
-    temp_player_states[0].bots[0].transform_destination = DoubleVec2D(0, 0);
-    runCommands(temp_player_states);
+    command_buffers[0]->moveBot(1, DoubleVec2D(2, 3));
+    command_buffers[0]->blastBot(1, bot_positions[0]);
+    runCommands();
+
+    // Each turn starts afresh
+    EXPECT_CALL(*state, blastBot(1, bot_positions[0]));
+    command_buffers[0]->blastBot(1, bot_positions[0]);
+    runCommands();
+}
 
-    manageActorExpectations(state_bots, state_towers);
-    EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
-                                  ErrorType::NO_MULTIPLE_BOT_TASK, _));
-    temp_player_states[0].bots[0].transforming = true;
-    temp_player_states[0].bots[0].final_destination = DoubleVec2D(0, 0);
-    runCommands(temp_player_states);
+// A tower keeps the id of the bot it was built from, and the two may both be
+// given a command in the turn the tower is built
+TEST_F(CommandGiverTest, TowerSharingBotId) {
+    // Returning the map repeatedly
+    EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
 
-    manageActorExpectations(state_bots, state_towers);
-    EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
-                                  ErrorType::NO_MULTIPLE_BOT_TASK, _));
-    temp_player_states[0].bots[0].final_destination = DoubleVec2D(0, 0);
-    temp_player_states[0].bots[0].transform_destination = DoubleVec2D(0, 0);
-    runCommands(temp_player_states);
+    auto tower = new state::Tower(1, PlayerId::PLAYER1, 100, 100,
+                                  DoubleVec2D(1.5, 1.5), 2, 2,
+                                  score_manager.get(), BlastCallback{});
+    for (uint64_t turn = 0; turn < Constants::Actor::TOWER_MIN_BLAST_AGE;
+         ++turn) {
+        tower->update();
+    }
+    state_towers[0].push_back(tower);
+    manageActorExpectations();
+
+    EXPECT_CALL(*logger, logError(_, _, _)).Times(0);
+    EXPECT_CALL(*state, moveBot(1, DoubleVec2D(2, 3)));
+    EXPECT_CALL(*state, blastTower(1));
+    command_buffers[0]->moveBot(1, DoubleVec2D(2, 3));
+    command_buffers[0]->blastTower(1);
+    runCommands();
 }
 
 TEST_F(CommandGiverTest, InvalidPositionTests) {
-    // Creating a temporary player state to modify
-    array<player_state::State, 2> temp_player_states = player_states;
-
     // Returning the map repeatedly
     EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
+    manageActorExpectations();
+    EXPECT_CALL(*state, moveBot(_, _)).Times(0);
+    EXPECT_CALL(*state, blastBot(_, _)).Times(0);
+    EXPECT_CALL(*state, transformBot(_, _)).Times(0);
 
     // Trying to move bot to an invalid position
-    manageActorExpectations(state_bots, state_towers);
     EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
                                   ErrorType::INVALID_MOVE_POSITION, _));
-    temp_player_states[0].bots[0].destination = DoubleVec2D(-10, -5);
-    runCommands(temp_player_states);
+    command_buffers[0]->moveBot(1, DoubleVec2D(-10, -5));
+    runCommands();
 
     // Trying to blast a bot in an invalid position
-    manageActorExpectations(state_bots, state_towers);
     EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
                                   ErrorType::INVALID_BLAST_POSITION, _));
-    temp_player_states[0].bots[0].final_destination = DoubleVec2D(-10, -5);
-    runCommands(temp_player_states);
+    command_buffers[0]->blastBot(1, DoubleVec2D(-10, -5));
+    runCommands();
 
     // Trying to transform a bot in an invalid position
-    manageActorExpectations(state_bots, state_towers);
     EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
                                   ErrorType::INVALID_TRANSFORM_POSITION, _));
-    temp_player_states[0].bots[0].transform_destination = DoubleVec2D(-10, -5);
-    runCommands(temp_player_states);
+    command_buffers[0]->transformBot(1, DoubleVec2D(-10, -5));
+    runCommands();
 
-    // // Trying to build tower at invalid position
-    manageActorExpectations(state_bots, state_towers);
+    // Positions just outside the map, for both players
     EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
                                   ErrorType::INVALID_MOVE_POSITION, _));
     EXPECT_CALL(*logger, logError(PlayerId::PLAYER2,
                                   ErrorType::INVALID_BLAST_POSITION, _));
+    command_buffers[0]->moveBot(1, DoubleVec2D(5, 5));
+    command_buffers[1]->blastBot(2, DoubleVec2D(0, 0));
+    runCommands();
+}
 
-    temp_player_states[0].bots[0].destination = DoubleVec2D(5, 5);
-    temp_player_states[1].bots[0].final_destination = DoubleVec2D(0, 0);
-    runCommands(temp_player_states);
+TEST_F(CommandGiverTest, FarOutOfMapPositions) {
+    // Returning the map repeatedly
+    EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
+    manageActorExpectations();
+    EXPECT_CALL(*state, moveBot(_, _)).Times(0);
+    EXPECT_CALL(*state, transformBot(_, _)).Times(0);
+
+    // Positions far off the map, which would wrap back onto it in fixed
+    // point, and positions that are not finite are all refused
+    auto infinity = numeric_limits<double>::infinity();
+    auto nan = numeric_limits<double>::quiet_NaN();
+    auto positions = vector<DoubleVec2D>{
+        {65536.5, 65536.5}, {65537.5, 65537.5}, {70000.3, 1},
+        {-65532.5, 1},      {infinity, 1},      {1, -infinity},
+        {nan, 1},           {1, nan}};
+    for (auto position : positions) {
+        EXPECT_CALL(*logger,
+                    logError(PlayerId::PLAYER1,
+                             ErrorType::INVALID_TRANSFORM_POSITION, _));
+        EXPECT_CALL(*logger,
+                    logError(PlayerId::PLAYER2,
+                             ErrorType::INVALID_TRANSFORM_POSITION, _));
+        command_buffers[0]->transformBot(1, position);
+        command_buffers[1]->transformBot(
+            2, DoubleVec2D(map_size - position.x, map_size - position.y));
+        runCommands();
+
+        EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
+                                      ErrorType::INVALID_MOVE_POSITION, _));
+        command_buffers[0]->moveBot(1, position);
+        runCommands();
+    }
 }
 
 TEST_F(CommandGiverTest, ExceedTowerLimit) {
-    // Creating a temporary player state to modify
-    array<player_state::State, 2> temp_player_states = player_states;
-
     // Returning the map repeatedly
     EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
 
@@ -386,87 +337,118 @@ TEST_F(CommandGiverTest, ExceedTowerLimit) {
             actor_id, PlayerId::PLAYER1, 100, 100, DoubleVec2D(0, 0), 2, 2,
             score_manager.get(), BlastCallback{});
         state_towers[0].push_back(state_tower);
-
-        // Creating the player state tower
-        player_state::Tower player_tower;
-        player_tower.id = actor_id;
-        player_tower.hp = 100;
-        player_tower.position = DoubleVec2D(0, 0);
-        player_tower.reset();
-
-        // Inserting tower into player state
-        temp_player_states[0].towers.push_back(player_tower);
-
-        // Flipping position and appending to enemy towers
-        player_tower.position = DoubleVec2D(4, 4);
-        temp_player_states[1].enemy_towers.push_back(player_tower);
     }
 
-    manageActorExpectations(state_bots, state_towers);
+    manageActorExpectations();
+    EXPECT_CALL(*state, transformBot(_, _)).Times(0);
     EXPECT_CALL(*logger,
                 logError(PlayerId::PLAYER1, ErrorType::TOWER_LIMIT_REACHED, _));
-    temp_player_states[0].bots[0].transforming = true;
-    runCommands(temp_player_states);
-}
-
-// Additional actors are added into the player state and checks are done to
-// see if errors are triggered
-TEST_F(CommandGiverTest, AddAndRemoveActors) {
-    // Creating a temporary player state to modify
-    array<player_state::State, 2> temp_player_states = player_states;
-
-    // Returning the map repeatedly
-    EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
-
-    auto extra_bot = player_state::Bot();
-    auto extra_tower = player_state::Tower();
-
-    manageActorExpectations(state_bots, state_towers);
-    EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
-                                  ErrorType::NUMBER_OF_BOTS_MISMATCH, _));
-    EXPECT_CALL(*logger, logError(PlayerId::PLAYER2,
-                                  ErrorType::NUMBER_OF_TOWERS_MISMATCH, _));
-    temp_player_states[0].bots.push_back(extra_bot);
-    temp_player_states[1].enemy_towers.push_back(extra_tower);
-    runCommands(temp_player_states);
+    command_buffers[0]->transformBot(1, bot_positions[0]);
+    runCommands();
 }
 
 TEST_F(CommandGiverTest, EarlyBlastTower) {
-    // Creating a temporary player state to modify
-    array<player_state::State, 2> temp_player_states = player_states;
-
     // Returning the map repeatedly
     EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
+    manageActorExpectations();
 
-    manageActorExpectations(state_bots, state_towers);
+    EXPECT_CALL(*state, blastTower(_)).Times(0);
     EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
                                   ErrorType::NO_EARLY_BLAST_TOWER, _));
 
     // Trying to make tower blast prematurely
-    temp_player_states[0].towers[0].blasting = true;
-    runCommands(temp_player_states);
+    command_buffers[0]->blastTower(3);
+    runCommands();
 }
 
 TEST_F(CommandGiverTest, TransformBasePosition) {
-    // Creating a temporary player state to modify
-    array<player_state::State, 2> temp_player_states = player_states;
-
     // Returning the map repeatedly
     EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
+    manageActorExpectations();
 
     // Trying to make a bot move to transform into a spawn position
-    manageActorExpectations(state_bots, state_towers);
     EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
                                   ErrorType::INVALID_TRANSFORM_POSITION, _));
-
-    temp_player_states[0].bots[0].transform_destination = DoubleVec2D(0.5, 0.5);
-    runCommands(temp_player_states);
+    command_buffers[0]->transformBot(1, DoubleVec2D(0.5, 0.5));
+    runCommands();
 
     // Trying to make a bot transform in a spawn position
-    manageActorExpectations(state_bots, state_towers);
     EXPECT_CALL(*logger, logError(PlayerId::PLAYER2,
                                   ErrorType::INVALID_TRANSFORM_POSITION, _));
+    command_buffers[1]->transformBot(2, DoubleVec2D(4.5, 4.5));
+    runCommands();
+}
 
-    temp_player_states[1].bots[0].transform_destination = DoubleVec2D(4.5, 4.5);
-    runCommands(temp_player_states);
+// Commands rejected on the player's side are logged with their error
+TEST_F(CommandGiverTest, RejectedCommands) {
+    // Returning the map repeatedly
+    EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
+    manageActorExpectations();
+
+    EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
+                                  ErrorType::NO_ALTER_BOT_PROPERTY, _));
+    EXPECT_CALL(*logger, logError(PlayerId::PLAYER2,
+                                  ErrorType::NUMBER_OF_TOWERS_MISMATCH, _));
+    command_buffers[0]->reject(ErrorType::NO_ALTER_BOT_PROPERTY, 1);
+    command_buffers[1]->reject(ErrorType::NUMBER_OF_TOWERS_MISMATCH, 0);
+    runCommands();
+}
+
+// The player writes the commands, so unknown types and errors are only logged
+TEST_F(CommandGiverTest, UnknownCommands) {
+    // Returning the map repeatedly
+    EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
+    manageActorExpectations();
+
+    EXPECT_CALL(*logger,
+                logError(PlayerId::PLAYER1, ErrorType::INVALID_COMMAND, _))
+        .Times(2);
+    EXPECT_CALL(*logger,
+                logError(PlayerId::PLAYER2, ErrorType::INVALID_COMMAND, _))
+        .Times(2);
+    EXPECT_CALL(*state, moveBot(_, _)).Times(0);
+    command_buffers[0]->push(Command{static_cast<CommandType>(42),
+                                     ErrorType{}, 1, DoubleVec2D(2, 3)});
+    command_buffers[0]->push(Command{static_cast<CommandType>(-1),
+                                     ErrorType{}, 1, DoubleVec2D(2, 3)});
+    command_buffers[1]->push(Command{CommandType::REJECTED,
+                                     static_cast<ErrorType>(1000000), 0,
+                                     DoubleVec2D::null});
+    command_buffers[1]->push(Command{CommandType::REJECTED,
+                                     static_cast<ErrorType>(-1), 0,
+                                     DoubleVec2D::null});
+    runCommands();
+}
+
+TEST_F(CommandGiverTest, SkipTurn) {
+    // Returning the map repeatedly
+    EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
+    manageActorExpectations();
+
+    // Commands of a player whose turn is skipped are not run
+    EXPECT_CALL(*logger,
+                logError(PlayerId::PLAYER2,
+                         ErrorType::EXCEED_TURN_INSTRUCTION_COUNT, _));
+    EXPECT_CALL(*state, moveBot(1, DoubleVec2D(2, 3)));
+    EXPECT_CALL(*state, moveBot(2, _)).Times(0);
+    command_buffers[0]->moveBot(1, DoubleVec2D(2, 3));
+    command_buffers[1]->moveBot(2, DoubleVec2D(1, 2));
+    runCommands({false, true});
+}
+
+// The player writes the buffer, so a corrupt count must not be trusted
+TEST_F(CommandGiverTest, CorruptCommandCount) {
+    // Returning the map repeatedly
+    EXPECT_CALL(*state, getMap).WillRepeatedly(Return(map));
+    manageActorExpectations();
+
+    auto max_num_commands = command_buffers[0]->getMaxNumCommands();
+    while (command_buffers[0]->reject(ErrorType::NO_ALTER_BOT_PROPERTY, 0)) {
+    }
+    command_buffers[0]->num_commands = max_num_commands * 2;
+
+    EXPECT_CALL(*logger, logError(PlayerId::PLAYER1,
+                                  ErrorType::NO_ALTER_BOT_PROPERTY, _))
+        .Times(max_num_commands);
+    runCommands();
 }
@@ -0,0 +1,204 @@
+#include "state/map/compiled_map.h"
+#include "state/path_planner/path_planner.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+using namespace std;
+using namespace state;
+
+namespace {
+
+const auto COMPILED_MAP_SIZE = size_t{20};
+
+const string compiled_map_file_name = "compiled_map_test.ccmap";
+} // namespace
+
+class CompiledMapTest : public testing::Test {
+  protected:
+    vector<vector<TerrainType>> terrain;
+    unique_ptr<Map> map;
+    StateDigest map_digest;
+    vector<DoubleVec2D> land_positions;
+
+    CompiledMapTest() {
+        // About a quarter of the cells water, and a few flags
+        terrain = vector<vector<TerrainType>>(
+            COMPILED_MAP_SIZE,
+            vector<TerrainType>(COMPILED_MAP_SIZE, TerrainType::LAND));
+        auto generator = mt19937(2020);
+        for (size_t x = 0; x < COMPILED_MAP_SIZE; ++x) {
+            for (size_t y = 0; y < COMPILED_MAP_SIZE; ++y) {
+                auto roll = generator() % 100;
+                if (roll < 25) {
+                    terrain[x][y] = TerrainType::WATER;
+                    continue;
+                }
+                if (roll < 30)
+                    terrain[x][y] = TerrainType::FLAG;
+                land_positions.emplace_back(x + 0.5, y + 0.5);
+            }
+        }
+
+        map = make_unique<Map>(terrain, COMPILED_MAP_SIZE);
+        map_digest = CompiledMap::getMapTextDigest("compiled map test");
+    }
+
+    void TearDown() override { remove(compiled_map_file_name.c_str()); }
+
+    void compile(bool with_distances) {
+        auto path_planner = make_unique<PathPlanner>(map.get());
+        auto tables = path_planner->getWaypointGraphTables(with_distances);
+        CompiledMap::write(compiled_map_file_name, map_digest, *map,
+                           tables.getView());
+    }
+
+    /**
+     * Check that a planner with the compiled map moves bots as one without
+     */
+    void checkNextPositions(PathPlanner &path_planner,
+                            PathPlanner &compiled_path_planner) {
+        path_planner.recomputePathGraph();
+        compiled_path_planner.recomputePathGraph();
+        for (size_t i = 0; i < 100; ++i) {
+            auto source = land_positions[(i * 7919) % land_positions.size()];
+            auto destination =
+                land_positions[(i * 104729 + 13) % land_positions.size()];
+            ASSERT_EQ(
+                compiled_path_planner.getNextPosition(source, destination, 3),
+                path_planner.getNextPosition(source, destination, 3));
+        }
+    }
+};
+
+TEST_F(CompiledMapTest, RoundTripTest) {
+    compile(true);
+    auto compiled_map = CompiledMap(compiled_map_file_name);
+
+    EXPECT_EQ(compiled_map.getMapSize(), COMPILED_MAP_SIZE);
+    EXPECT_EQ(compiled_map.getMapDigest(), map_digest);
+    EXPECT_EQ(compiled_map.getTerrain(), terrain);
+
+    auto num_flags = size_t{0};
+    for (auto const &column : terrain) {
+        num_flags += count(column.begin(), column.end(), TerrainType::FLAG);
+    }
+    EXPECT_EQ(compiled_map.getFlags().size(), num_flags);
+    for (auto const &flag : compiled_map.getFlags()) {
+        EXPECT_EQ(terrain[flag.x][flag.y], TerrainType::FLAG);
+    }
+
+    // The graph is as found from the map, with a distance for every pair of
+    // waypoints
+    auto waypoints =
+        PathPlanner(map.get()).getWaypointGraphTables(false).waypoints;
+    auto const &waypoint_graph = compiled_map.getWaypointGraph();
+    ASSERT_EQ(waypoint_graph.waypoints.size(), waypoints.size());
+    EXPECT_TRUE(equal(waypoints.begin(), waypoints.end(),
+                      waypoint_graph.waypoints.begin()));
+    EXPECT_EQ(waypoint_graph.distances.size(),
+              waypoints.size() * waypoints.size());
+    EXPECT_EQ(waypoint_graph.distances[0], 0);
+
+    // Distances are optional
+    compile(false);
+    auto compiled_map_without_distances = CompiledMap(compiled_map_file_name);
+    EXPECT_TRUE(
+        compiled_map_without_distances.getWaypointGraph().distances.empty());
+
+    // Names are the same for the same map file, and differ between map files
+    EXPECT_EQ(CompiledMap::getFileName(map_digest),
+              CompiledMap::getFileName(
+                  CompiledMap::getMapTextDigest("compiled map test")));
+    EXPECT_NE(CompiledMap::getMapTextDigest("compiled map test"),
+              CompiledMap::getMapTextDigest("compiled map tesT"));
+}
+
+TEST_F(CompiledMapTest, PathTest) {
+    compile(true);
+    auto path_planner = make_unique<PathPlanner>(map.get());
+    auto compiled_path_planner = make_unique<PathPlanner>(map.get());
+    compiled_path_planner->setCompiledMap(
+        make_unique<CompiledMap>(compiled_map_file_name));
+    checkNextPositions(*path_planner, *compiled_path_planner);
+
+    // The graph is found afresh once towers change the terrain, and loaded
+    // again once they are gone
+    auto tower_offset = Vec2D::null;
+    for (auto const &position : land_positions) {
+        tower_offset = path_planner->buildTower(position, PlayerId::PLAYER1);
+        compiled_path_planner->buildTower(position, PlayerId::PLAYER1);
+        if (tower_offset != Vec2D::null)
+            break;
+    }
+    land_positions.erase(remove(land_positions.begin(), land_positions.end(),
+                                DoubleVec2D(tower_offset.x + 0.5,
+                                            tower_offset.y + 0.5)),
+                         land_positions.end());
+    checkNextPositions(*path_planner, *compiled_path_planner);
+
+    path_planner->destroyTower(tower_offset);
+    compiled_path_planner->destroyTower(tower_offset);
+    checkNextPositions(*path_planner, *compiled_path_planner);
+
+    // Landmarks are measured with the distances of the compiled map
+    path_planner->setPathHeuristic(PathHeuristic::LANDMARKS);
+    compiled_path_planner->setPathHeuristic(PathHeuristic::LANDMARKS);
+    checkNextPositions(*path_planner, *compiled_path_planner);
+}
+
+TEST_F(CompiledMapTest, InvalidFileTest) {
+    EXPECT_THROW(CompiledMap("missing.ccmap"), runtime_error);
+
+    compile(true);
+    auto contents = string();
+    {
+        auto file = ifstream(compiled_map_file_name, ios::binary);
+        contents.assign(istreambuf_iterator<char>(file),
+                        istreambuf_iterator<char>());
+    }
+    auto writeFile = [](const string &file_contents) {
+        auto file = ofstream(compiled_map_file_name, ios::binary);
+        file.write(file_contents.data(), file_contents.size());
+    };
+
+    // Truncated anywhere
+    writeFile(contents.substr(0, 16));
+    EXPECT_THROW(CompiledMap{compiled_map_file_name}, runtime_error);
+    writeFile(contents.substr(0, contents.size() - 8));
+    EXPECT_THROW(CompiledMap{compiled_map_file_name}, runtime_error);
+
+    // Not a compiled map
+    auto other_contents = contents;
+    other_contents[0] = 'X';
+    writeFile(other_contents);
+    EXPECT_THROW(CompiledMap{compiled_map_file_name}, runtime_error);
+
+    // Of another map
+    writeFile(contents);
+    auto other_terrain = terrain;
+    other_terrain[0][0] = other_terrain[0][0] == TerrainType::WATER
+                              ? TerrainType::LAND
+                              : TerrainType::WATER;
+    auto other_map = make_unique<Map>(other_terrain, COMPILED_MAP_SIZE);
+    auto path_planner = make_unique<PathPlanner>(other_map.get());
+    EXPECT_THROW(path_planner->setCompiledMap(
+                     make_unique<CompiledMap>(compiled_map_file_name)),
+                 invalid_argument);
+
+    // With a graph that does not fit the map
+    auto tables = PathPlanner(map.get()).getWaypointGraphTables(false);
+    tables.corner_offsets.pop_back();
+    auto path_graph = PathGraph(
+        COMPILED_MAP_SIZE,
+        vector<vector<bool>>(COMPILED_MAP_SIZE,
+                             vector<bool>(COMPILED_MAP_SIZE, true)),
+        Graph());
+    EXPECT_THROW(path_graph.setBaseWaypointGraph(tables.getView()),
+                 invalid_argument);
+}
@@ -78,30 +78,60 @@ TEST_F(GraphTest, RemoveEdgeTest) {
 }
 
 TEST_F(GraphTest, GetBasicPathTest) {
-    std::vector<DoubleVec2D> path = graph->getPath(nodes[0], nodes[4]);
+    auto path = graph->getPath(nodes[0], nodes[4]);
     EXPECT_EQ(path.size(), 4);
     EXPECT_EQ(path[0], nodes[7]);
     EXPECT_EQ(path[1], nodes[6]);
     EXPECT_EQ(path[2], nodes[5]);
     EXPECT_EQ(path[3], nodes[4]);
 
-    std::vector<DoubleVec2D> path2 = graph->getPath(nodes[3], nodes[5]);
+    auto path2 = graph->getPath(nodes[3], nodes[5]);
     EXPECT_EQ(path2.size(), 2);
     EXPECT_EQ(path2[0], nodes[2]);
     EXPECT_EQ(path2[1], nodes[5]);
 }
 
 TEST_F(GraphTest, GetInvalidPathTest) {
-    std::vector<DoubleVec2D> path = graph->getPath(nodes[0], nodes[9]);
+    auto path = graph->getPath(nodes[0], nodes[9]);
     EXPECT_EQ(path.size(), 0);
 }
 
 TEST_F(GraphTest, GetInvalidPositionPathTest) {
-    std::vector<DoubleVec2D> path = graph->getPath(nodes[0], {10, 1});
+    auto path = graph->getPath(nodes[0], {10, 1});
     EXPECT_EQ(path.size(), 0);
 }
 
 TEST_F(GraphTest, GetSelfPathTest) {
-    std::vector<DoubleVec2D> path = graph->getPath(nodes[0], nodes[0]);
+    auto path = graph->getPath(nodes[0], nodes[0]);
     EXPECT_EQ(path.size(), 0);
 }
+
+TEST_F(GraphTest, LandmarkTest) {
+    // Unreachable nodes are the farthest of all, then each landmark is the
+    // node farthest from those before it
+    graph->setHeuristic(state::PathHeuristic::LANDMARKS);
+    graph->computeLandmarks(3);
+    auto landmarks = graph->getLandmarks();
+    ASSERT_EQ(landmarks.size(), 3);
+    EXPECT_EQ(landmarks[0], FixedVec2D(nodes[9]));
+    EXPECT_EQ(landmarks[1], FixedVec2D(nodes[0]));
+    EXPECT_EQ(landmarks[2], FixedVec2D(nodes[4]));
+
+    // Paths are the same with the landmark heuristic, and the unreachable
+    // node is found so without expanding any node but the start
+    auto path = graph->getPath(nodes[0], nodes[4]);
+    EXPECT_EQ(path.size(), 4);
+    EXPECT_EQ(path[0], nodes[7]);
+    EXPECT_EQ(path[1], nodes[6]);
+    EXPECT_EQ(path[2], nodes[5]);
+    EXPECT_EQ(path[3], nodes[4]);
+
+    auto num_expanded_nodes = graph->getSearchStats().num_expanded_nodes;
+    EXPECT_EQ(graph->getPath(nodes[0], nodes[9]).size(), 0);
+    EXPECT_EQ(graph->getSearchStats().num_expanded_nodes,
+              num_expanded_nodes + 1);
+
+    // Changing the graph discards the landmarks
+    graph->addEdge(nodes[4], nodes[9], 1);
+    EXPECT_TRUE(graph->getLandmarks().empty());
+}
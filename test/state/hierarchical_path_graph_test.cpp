@@ -0,0 +1,145 @@
+#include "state/path_planner/hierarchical_path_graph.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+
+using namespace std;
+using namespace state;
+
+namespace {
+
+const auto HPA_MAP_SIZE = size_t{30};
+
+double_t getPathLength(DoubleVec2D start,
+                       const ArenaVector<DoubleVec2D> &path) {
+    auto length = 0.0;
+    for (auto waypoint : path) {
+        length += start.distance(waypoint);
+        start = waypoint;
+    }
+    return length;
+}
+} // namespace
+
+class HierarchicalPathGraphTest : public testing::Test {
+  protected:
+    unique_ptr<PathGraph> terrain;
+    unique_ptr<HierarchicalPathGraph> hierarchical_graph;
+    vector<DoubleVec2D> land_positions;
+
+    HierarchicalPathGraphTest() {
+        // A map of 3 x 3 chunks with about 30% of the cells blocked
+        auto valid_terrain = vector<vector<bool>>(
+            HPA_MAP_SIZE, vector<bool>(HPA_MAP_SIZE, true));
+        auto generator = mt19937(2020);
+        for (size_t x = 0; x < HPA_MAP_SIZE; ++x) {
+            for (size_t y = 0; y < HPA_MAP_SIZE; ++y) {
+                valid_terrain[x][y] = generator() % 100 >= 30;
+                if (valid_terrain[x][y])
+                    land_positions.emplace_back(x + 0.5, y + 0.5);
+            }
+        }
+
+        terrain = make_unique<PathGraph>(HPA_MAP_SIZE, valid_terrain, Graph());
+        terrain->recomputeWaypointGraph();
+        hierarchical_graph =
+            make_unique<HierarchicalPathGraph>(terrain.get(), HPA_MAP_SIZE);
+        hierarchical_graph->recompute();
+    }
+
+    /**
+     * Check paths between pairs of land positions against the shortest paths
+     * of the waypoint graph
+     */
+    void checkPaths() {
+        terrain->recomputeWaypointGraph();
+        for (size_t i = 0; i < 100; ++i) {
+            auto start = land_positions[(i * 7919) % land_positions.size()];
+            auto end =
+                land_positions[(i * 104729 + 13) % land_positions.size()];
+            if (start == end)
+                continue;
+
+            auto shortest_path = terrain->getPath(start, end);
+            auto path = hierarchical_graph->getPath(start, end);
+
+            // A path is found exactly when one exists
+            ASSERT_EQ(path.empty(), shortest_path.empty());
+            if (path.empty())
+                continue;
+
+            // Every step of it is clear, and it is no shorter than the
+            // shortest path
+            ASSERT_EQ(path.back(), end);
+            auto position = start;
+            for (auto waypoint : path) {
+                ASSERT_TRUE(
+                    terrain->arePointsDirectlyReachable(position, waypoint));
+                position = waypoint;
+            }
+            ASSERT_GE(getPathLength(start, path) + 1e-6,
+                      getPathLength(start, shortest_path));
+        }
+    }
+};
+
+TEST_F(HierarchicalPathGraphTest, PathTest) {
+    checkPaths();
+
+    // Positions in sight of each other are joined directly
+    auto nearby_position = land_positions[0] + DoubleVec2D(0.25, 0.25);
+    auto path = hierarchical_graph->getPath(land_positions[0], nearby_position);
+    ASSERT_EQ(path.size(), 1);
+    ASSERT_EQ(path[0], nearby_position);
+
+    // There is no path to or from a blocked cell
+    for (size_t x = 0; x < HPA_MAP_SIZE; ++x) {
+        if (!terrain->isValidCell(x, 0)) {
+            ASSERT_TRUE(hierarchical_graph
+                            ->getPath(land_positions[0], {x + 0.5, 0.5})
+                            .empty());
+            break;
+        }
+    }
+}
+
+TEST_F(HierarchicalPathGraphTest, RecomputeTest) {
+    // Nothing changed, nothing is recalculated
+    ASSERT_EQ(hierarchical_graph->recompute(), 0);
+
+    // A cell away from the borders of its chunk changes only that chunk
+    auto interior_cell = Vec2D::null;
+    for (int64_t x = 11; x < 19 && !interior_cell; ++x) {
+        for (int64_t y = 11; y < 19 && !interior_cell; ++y) {
+            if (terrain->isValidCell(x, y))
+                interior_cell = Vec2D(x, y);
+        }
+    }
+    ASSERT_TRUE(interior_cell);
+
+    terrain->addObstacle(interior_cell);
+    hierarchical_graph->invalidateCell(interior_cell);
+    ASSERT_EQ(hierarchical_graph->recompute(), 1);
+    checkPaths();
+
+    terrain->removeObstacle(interior_cell);
+    hierarchical_graph->invalidateCell(interior_cell);
+    ASSERT_EQ(hierarchical_graph->recompute(), 1);
+    checkPaths();
+
+    // A cell beside a border can change the chunk across it too
+    auto border_cell = Vec2D::null;
+    for (int64_t y = 11; y < 19 && !border_cell; ++y) {
+        if (terrain->isValidCell(19, y) && terrain->isValidCell(20, y))
+            border_cell = Vec2D(19, y);
+    }
+    ASSERT_TRUE(border_cell);
+
+    terrain->addObstacle(border_cell);
+    hierarchical_graph->invalidateCell(border_cell);
+    auto num_recomputed_chunks = hierarchical_graph->recompute();
+    ASSERT_GE(num_recomputed_chunks, 1);
+    ASSERT_LE(num_recomputed_chunks, 2);
+    checkPaths();
+}
@@ -0,0 +1,139 @@
+#include "state/path_planner/jump_point_search.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+
+using namespace std;
+using namespace state;
+
+namespace {
+
+const auto JPS_MAP_SIZE = size_t{30};
+
+double_t getPathLength(DoubleVec2D start,
+                       const ArenaVector<DoubleVec2D> &path) {
+    auto length = 0.0;
+    for (auto waypoint : path) {
+        length += start.distance(waypoint);
+        start = waypoint;
+    }
+    return length;
+}
+} // namespace
+
+class JumpPointSearchTest : public testing::Test {
+  protected:
+    unique_ptr<PathGraph> terrain;
+    unique_ptr<JumpPointSearch> jump_point_search;
+    vector<DoubleVec2D> land_positions;
+
+    JumpPointSearchTest() {
+        // About 30% of the cells blocked
+        auto valid_terrain = vector<vector<bool>>(
+            JPS_MAP_SIZE, vector<bool>(JPS_MAP_SIZE, true));
+        auto generator = mt19937(2020);
+        for (size_t x = 0; x < JPS_MAP_SIZE; ++x) {
+            for (size_t y = 0; y < JPS_MAP_SIZE; ++y) {
+                valid_terrain[x][y] = generator() % 100 >= 30;
+                if (valid_terrain[x][y])
+                    land_positions.emplace_back(x + 0.5, y + 0.5);
+            }
+        }
+
+        terrain = make_unique<PathGraph>(JPS_MAP_SIZE, valid_terrain, Graph());
+        jump_point_search = make_unique<JumpPointSearch>(terrain.get());
+    }
+
+    /**
+     * Check paths between pairs of land positions against the shortest paths
+     * of the waypoint graph
+     */
+    void checkPaths() {
+        terrain->recomputeWaypointGraph();
+        for (size_t i = 0; i < 100; ++i) {
+            auto start = land_positions[(i * 7919) % land_positions.size()];
+            auto end =
+                land_positions[(i * 104729 + 13) % land_positions.size()];
+            if (start == end)
+                continue;
+
+            auto shortest_path = terrain->getPath(start, end);
+            auto path = jump_point_search->getPath(start, end);
+
+            // A path is found exactly when one exists
+            ASSERT_EQ(path.empty(), shortest_path.empty());
+            if (path.empty())
+                continue;
+
+            // Every step of it is clear, and it is no shorter than the
+            // shortest path. Cells are searched rather than the corners paths
+            // turn at, so it can be somewhat longer
+            ASSERT_EQ(path.back(), end);
+            auto position = start;
+            for (auto waypoint : path) {
+                ASSERT_TRUE(
+                    terrain->arePointsDirectlyReachable(position, waypoint));
+                position = waypoint;
+            }
+            auto length = getPathLength(start, path);
+            auto shortest_length = getPathLength(start, shortest_path);
+            ASSERT_GE(length + 1e-6, shortest_length);
+            ASSERT_LE(length, shortest_length * 1.25);
+        }
+    }
+};
+
+TEST_F(JumpPointSearchTest, PathTest) {
+    checkPaths();
+
+    // Positions in sight of each other are joined directly
+    auto nearby_position = land_positions[0] + DoubleVec2D(0.25, 0.25);
+    auto path = jump_point_search->getPath(land_positions[0], nearby_position);
+    ASSERT_EQ(path.size(), 1);
+    ASSERT_EQ(path[0], nearby_position);
+
+    // Searches are counted, but not the paths that need none
+    ASSERT_GT(jump_point_search->getSearchStats().num_searches, 0);
+    ASSERT_GT(jump_point_search->getSearchStats().num_expanded_nodes, 0);
+}
+
+TEST_F(JumpPointSearchTest, SqueezeTest) {
+    /**
+     * Cells that only share a corner can be moved between
+     * . # #
+     * # . #
+     * . # .
+     */
+    auto valid_terrain = vector<vector<bool>>(3, vector<bool>(3, false));
+    valid_terrain[0][0] = valid_terrain[1][1] = true;
+    valid_terrain[0][2] = valid_terrain[2][0] = true;
+    auto small_terrain = PathGraph(3, valid_terrain, Graph());
+    auto small_search = JumpPointSearch(&small_terrain);
+
+    auto path = small_search.getPath({0.5, 0.5}, {0.5, 2.5});
+    ASSERT_EQ(path.size(), 2);
+    ASSERT_EQ(path[0], DoubleVec2D(1.5, 1.5));
+    ASSERT_EQ(path[1], DoubleVec2D(0.5, 2.5));
+
+    // Nothing leads to a blocked cell
+    ASSERT_TRUE(small_search.getPath({0.5, 0.5}, {1.5, 0.5}).empty());
+}
+
+TEST_F(JumpPointSearchTest, ObstacleTest) {
+    // Obstacles take effect at once, with nothing to recompute
+    for (size_t x = 10; x < 20; ++x) {
+        for (size_t y = 10; y < 20; ++y) {
+            if (terrain->isValidCell(x, y))
+                terrain->addObstacle({(double_t) x, (double_t) y});
+        }
+    }
+    land_positions.erase(
+        remove_if(land_positions.begin(), land_positions.end(),
+                  [this](const DoubleVec2D &position) {
+                      return !terrain->isValidPosition(position);
+                  }),
+        land_positions.end());
+
+    checkPaths();
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "state/interfaces/i_command_giver.h"
+#include "state/player_state.h"
 #include "gmock/gmock.h"
 
 using namespace testing;
@@ -10,6 +11,7 @@ using namespace state;
 
 class CommandGiverMock : public ICommandGiver {
   public:
-    MOCK_METHOD2(runCommands, void(array<player_state::State, 2> &player_states,
-                                   array<bool, 2> skip_turn));
+    MOCK_METHOD2(runCommands,
+                 void(array<const CommandBuffer *, 2> command_buffers,
+                      array<bool, 2> skip_turn));
 };
@@ -14,14 +14,19 @@ class StateMock : public ICommandTaker {
     MOCK_METHOD2(blastBot, void(ActorId bot_id, DoubleVec2D position));
     MOCK_METHOD1(blastTower, void(ActorId bot_id));
     MOCK_CONST_METHOD0(getScores, array<uint64_t, 2>());
+    MOCK_CONST_METHOD0(getDigest, StateDigest());
     MOCK_METHOD1(isGameOver, bool(PlayerId &winner));
-    MOCK_METHOD0(getBots, array<vector<state::Bot *>, 2>());
-    MOCK_METHOD0(getTowers, array<vector<state::Tower *>, 2>());
-    MOCK_METHOD0(getTransformRequests, array<vector<TransformRequest *>, 2>());
+    MOCK_METHOD1(getBots, Span<state::Bot *const>(PlayerId player_id));
+    MOCK_METHOD1(getTowers, Span<state::Tower *const>(PlayerId player_id));
+    MOCK_METHOD1(getBotById, state::Bot *(ActorId bot_id));
+    MOCK_METHOD1(getTowerById, state::Tower *(ActorId tower_id));
+    MOCK_METHOD1(getTransformRequests,
+                 Span<TransformRequest *const>(PlayerId player_id));
     MOCK_CONST_METHOD0(getMap, Map *());
     MOCK_CONST_METHOD0(getScoreManager, ScoreManager *());
     MOCK_CONST_METHOD0(getPathPlanner, PathPlanner *());
     MOCK_METHOD0(update, void());
     MOCK_METHOD0(lateUpdate, void());
     MOCK_METHOD0(removeDeadActors, void());
+    MOCK_METHOD0(resetTurnArena, void());
 };
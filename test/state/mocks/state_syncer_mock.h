@@ -9,8 +9,9 @@ using namespace state;
 
 class StateSyncerMock : public IStateSyncer {
   public:
-    MOCK_METHOD2(updateMainState,
-                 void(std::array<player_state::State, 2> &player_states,
+    MOCK_METHOD3(updateMainState,
+                 void(std::array<const CommandBuffer *, 2> command_buffers,
+                      std::array<player_state::State, 2> &player_states,
                       std::array<bool, 2> skip_turns));
     MOCK_METHOD1(updatePlayerStates,
                  void(std::array<player_state::State, 2> &player_states));
@@ -46,6 +46,34 @@ class PathGraphTest : public testing::Test {
     }
 };
 
+TEST_F(PathGraphTest, TerrainDigestTest) {
+    auto digest = waypointGraph->getTerrainDigest();
+
+    // The digest kept as obstacles were added matches one computed afresh
+    auto blocked_terrain = valid_terrain;
+    for (size_t i = 1; i <= 7; i++)
+        blocked_terrain[2][i] = false;
+    for (size_t i = 3; i <= 7; i++) {
+        blocked_terrain[i][7] = false;
+        blocked_terrain[i][4] = false;
+    }
+    EXPECT_EQ(PathGraph(MAP_SIZE, blocked_terrain, Graph()).getTerrainDigest(),
+              digest);
+
+    // Blocking a blocked cell changes nothing
+    waypointGraph->addObstacle({2, 1});
+    EXPECT_EQ(waypointGraph->getTerrainDigest(), digest);
+
+    // Freeing a cell changes the digest until it is blocked again
+    waypointGraph->removeObstacle({2, 1});
+    EXPECT_NE(waypointGraph->getTerrainDigest(), digest);
+    waypointGraph->addObstacle({2.5, 1.5});
+    EXPECT_EQ(waypointGraph->getTerrainDigest(), digest);
+
+    EXPECT_EQ(PathGraph(MAP_SIZE, valid_terrain, Graph()).getTerrainDigest(),
+              StateDigest({0, 0}));
+}
+
 TEST_F(PathGraphTest, FMapTest1) {
     auto path = waypointGraph->getPath({5, 6}, {0, 4});
     ASSERT_EQ(path.size(), 5);
@@ -110,6 +138,49 @@ TEST_F(PathGraphTest, UnreachablityTest) {
     waypointGraph->recomputeWaypointGraph();
 }
 
+TEST_F(PathGraphTest, DirectReachabilityTest) {
+    ASSERT_TRUE(waypointGraph->arePointsDirectlyReachable({0.5, 0.5},
+                                                          {1.5, 9.5}));
+    ASSERT_TRUE(waypointGraph->arePointsDirectlyReachable({1.5, 9.5},
+                                                          {0.5, 0.5}));
+    ASSERT_FALSE(waypointGraph->arePointsDirectlyReachable({0.5, 0.5},
+                                                           {9.5, 9.5}));
+
+    // The line passes through the corner of an obstacle without entering it
+    ASSERT_TRUE(waypointGraph->arePointsDirectlyReachable({1.5, 7.5},
+                                                          {2.5, 8.5}));
+    ASSERT_FALSE(waypointGraph->arePointsDirectlyReachable({1.5, 7.5},
+                                                           {2.5, 8.25}));
+}
+
+TEST_F(PathGraphTest, VisibilityTableTest) {
+    auto waypoints = waypointGraph->getWaypoints();
+    auto search = PathSearch();
+
+    // Positions are joined to exactly the waypoints in their sight, whether
+    // they are corners, on cell edges, inside cells or on the map border
+    for (double_t x = 0; x <= MAP_SIZE; x += 0.2) {
+        for (double_t y = 0; y <= MAP_SIZE; y += 0.2) {
+            auto position = FixedVec2D(x, y);
+            if (waypoints.count(position)) {
+                continue;
+            }
+
+            waypointGraph->getPath({x, y}, {8, 5}, search);
+
+            auto num_visible = size_t{0};
+            for (auto const &waypoint : waypoints) {
+                if (waypointGraph->arePointsDirectlyReachable(waypoint,
+                                                              position)) {
+                    ASSERT_EQ(search.start_edges.count(waypoint), 1);
+                    num_visible++;
+                }
+            }
+            ASSERT_EQ(search.start_edges.size(), num_visible);
+        }
+    }
+}
+
 TEST_F(PathGraphTest, InvalidStartTest) {
     auto path = waypointGraph->getPath({2.5, 2}, {0, 7});
     ASSERT_EQ(path.size(), 0);
@@ -196,3 +267,124 @@ TEST_F(PathGraphTest, SpiralPathTest) {
     ASSERT_EQ(path[7], DoubleVec2D(9, 8));
     ASSERT_EQ(path[8], DoubleVec2D(9.5, 0.5));
 }
+
+TEST_F(PathGraphTest, PathFromWaypointKeepsWaypointTest) {
+    // (3, 1) is a waypoint, which must stay in the graph after a path from it
+    // has been found
+    auto path = waypointGraph->getPath({3, 1}, {8, 4});
+    ASSERT_EQ(path.size(), 1);
+
+    path = waypointGraph->getPath({5, 6}, {0, 4});
+    ASSERT_EQ(path.size(), 5);
+    ASSERT_EQ(path[2], DoubleVec2D(3, 1));
+}
+
+TEST_F(PathGraphTest, SeparateSearchTest) {
+    auto positions = vector<DoubleVec2D>{{5, 6},     {0, 4}, {0, 7},
+                                         {3, 1},     {8, 4}, {9.5, 0.5},
+                                         {5.5, 5.5}, {2.5, 2}};
+
+    auto search = PathSearch{};
+    for (auto start : positions) {
+        for (auto end : positions) {
+            auto path = waypointGraph->getPath(start, end, search);
+            auto expected_path = waypointGraph->getPath(start, end);
+            ASSERT_TRUE(std::equal(path.begin(), path.end(),
+                                   expected_path.begin(),
+                                   expected_path.end()));
+        }
+    }
+}
+
+TEST_F(PathGraphTest, LandmarkHeuristicTest) {
+    auto landmark_graph = PathGraph(MAP_SIZE, valid_terrain, Graph());
+    landmark_graph.setPathHeuristic(PathHeuristic::LANDMARKS);
+    for (double_t i = 1; i <= 7; i++)
+        landmark_graph.addObstacle({2, i});
+    for (double_t i = 3; i <= 7; i++) {
+        landmark_graph.addObstacle({i, 7});
+        landmark_graph.addObstacle({i, 4});
+    }
+    landmark_graph.recomputeWaypointGraph();
+
+    auto getLength = [](DoubleVec2D start,
+                        const ArenaVector<DoubleVec2D> &path) {
+        auto length = 0.0;
+        for (auto position : path) {
+            length += start.distance(position);
+            start = position;
+        }
+        return length;
+    };
+
+    // Landmarks never overestimate, so paths are as short as with the
+    // straight line distance, but fewer nodes are expanded finding them
+    for (double_t x = 0.5; x < MAP_SIZE; x += 1.5) {
+        for (double_t y = 0.5; y < MAP_SIZE; y += 1.5) {
+            for (auto end : {DoubleVec2D(5.5, 5.5), DoubleVec2D(0, 4),
+                             DoubleVec2D(8, 4)}) {
+                auto path = landmark_graph.getPath({x, y}, end);
+                auto euclidean_path = waypointGraph->getPath({x, y}, end);
+
+                ASSERT_EQ(path.size() == 0, euclidean_path.size() == 0);
+                ASSERT_NEAR(getLength({x, y}, path),
+                            getLength({x, y}, euclidean_path), 1e-9);
+            }
+        }
+    }
+
+    auto stats = landmark_graph.getSearchStats();
+    auto euclidean_stats = waypointGraph->getSearchStats();
+    ASSERT_EQ(stats.num_searches, euclidean_stats.num_searches);
+    ASSERT_LT(stats.num_expanded_nodes, euclidean_stats.num_expanded_nodes);
+}
+
+TEST_F(PathGraphTest, SharedSearchTest) {
+    auto getLength = [](DoubleVec2D start,
+                        const ArenaVector<DoubleVec2D> &path) {
+        auto length = 0.0;
+        for (auto position : path) {
+            length += start.distance(position);
+            start = position;
+        }
+        return length;
+    };
+
+    // Starts inside cells, on their corners and edges, on waypoints, in
+    // sight of the ends or not, and in blocked cells
+    auto starts = vector<DoubleVec2D>{};
+    for (double_t x = 0; x < MAP_SIZE; x += 1.5) {
+        for (double_t y = 0; y < MAP_SIZE; y += 1.5) {
+            starts.emplace_back(x, y);
+            starts.emplace_back(x + 0.5, y + 0.5);
+        }
+    }
+    starts.emplace_back(3, 1);
+
+    // One search finds paths as short as a search from each start
+    auto search = PathSearch{};
+    for (auto end : {DoubleVec2D(5.5, 5.5), DoubleVec2D(0, 4),
+                     DoubleVec2D(8, 4), DoubleVec2D(2.5, 2)}) {
+        auto num_searches = search.stats.num_searches;
+        auto paths = waypointGraph->getPaths(starts, end, search);
+        ASSERT_EQ(paths.size(), starts.size());
+        ASSERT_LE(search.stats.num_searches, num_searches + 1);
+
+        for (size_t i = 0; i < starts.size(); ++i) {
+            auto expected_path = waypointGraph->getPath(starts[i], end);
+            ASSERT_EQ(paths[i].empty(), expected_path.empty());
+            if (paths[i].empty())
+                continue;
+
+            ASSERT_EQ(paths[i].back(), end);
+            auto position = starts[i];
+            for (auto waypoint : paths[i]) {
+                ASSERT_TRUE(waypointGraph->arePointsDirectlyReachable(
+                    position, waypoint));
+                position = waypoint;
+            }
+            ASSERT_NEAR(getLength(starts[i], paths[i]),
+                        getLength(starts[i], expected_path), 1e-9);
+        }
+    }
+}
@@ -230,3 +230,49 @@ TEST_F(PathPlannerTest, GetNextPositionSingleMoveTest) {
 
     ASSERT_EQ(current_position, end);
 }
+
+TEST_F(PathPlannerTest, PlanNextPositionsTest) {
+    auto destinations =
+        vector<DoubleVec2D>{{15.5, 6.5}, {0, 0}, {8, 5}, {19.5, 19.5}};
+
+    auto queries = vector<PathQuery>{};
+    for (size_t x = 0; x < MAP_SIZE; x += 3) {
+        for (size_t y = 0; y < MAP_SIZE; y += 3) {
+            for (auto destination : destinations) {
+                queries.push_back({DoubleVec2D(x, y), destination, 2});
+                queries.push_back(
+                    {DoubleVec2D(x + 0.5, y + 0.5), destination, 2});
+            }
+        }
+    }
+
+    auto expected_positions = vector<DoubleVec2D>{};
+    for (const auto &query : queries) {
+        expected_positions.push_back(path_planner->getNextPosition(
+            query.source, query.destination, query.speed));
+    }
+
+    // Clears the cache
+    path_planner->recomputePathGraph();
+
+    WorkerPool worker_pool(4);
+    auto num_searches = path_planner->getPathSearchStats().num_searches;
+    path_planner->planNextPositions(queries, worker_pool);
+
+    for (size_t i = 0; i < queries.size(); ++i) {
+        ASSERT_EQ(path_planner->getNextPosition(queries[i].source,
+                                                queries[i].destination,
+                                                queries[i].speed),
+                  expected_positions[i]);
+    }
+
+    // The queries to each destination share one search
+    ASSERT_LE(path_planner->getPathSearchStats().num_searches,
+              num_searches + destinations.size());
+    ASSERT_EQ(path_planner->getNumSavedSearches(),
+              queries.size() - destinations.size());
+
+    // Queries already answered need no search at all
+    path_planner->planNextPositions(queries, worker_pool);
+    ASSERT_EQ(path_planner->getNumSavedSearches(), queries.size());
+}
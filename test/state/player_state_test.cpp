@@ -14,9 +14,9 @@ const auto F = player_state::TerrainType::FLAG;
 class PlayerStateTest : public Test {
   public:
     array<State, 2> player_states;
-    array<array<MapElement, MAP_SIZE>, MAP_SIZE> player_map;
+    vector<vector<MapElement>> player_map;
 
-    PlayerStateTest() {
+    PlayerStateTest() : player_map(MAP_SIZE, vector<MapElement>(MAP_SIZE)) {
         // Creating a basic map and player state
         vector<vector<player_state::TerrainType>> map = {{L, L, L, L, L},
                                                          {L, W, F, W, L},
@@ -0,0 +1,49 @@
+#include "state/state_digest.h"
+
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace state;
+
+TEST(StateDigestTest, OrderOfValuesMatters) {
+    auto digest = DigestBuilder().add(uint64_t{1}).add(uint64_t{2});
+
+    EXPECT_EQ(digest.getDigest(),
+              DigestBuilder().add(uint64_t{1}).add(uint64_t{2}).getDigest());
+    EXPECT_NE(digest.getDigest(),
+              DigestBuilder().add(uint64_t{2}).add(uint64_t{1}).getDigest());
+    EXPECT_NE(digest.getDigest(), DigestBuilder().add(uint64_t{1}).getDigest());
+}
+
+TEST(StateDigestTest, CanonicalDoubles) {
+    EXPECT_EQ(DigestBuilder().add(0.0).getDigest(),
+              DigestBuilder().add(-0.0).getDigest());
+    EXPECT_NE(DigestBuilder().add(1.0).getDigest(),
+              DigestBuilder().add(1.0 + 1e-12).getDigest());
+    EXPECT_NE(DigestBuilder().add(1.0).getDigest(),
+              DigestBuilder().add(uint64_t{1}).getDigest());
+}
+
+TEST(StateDigestTest, CombineDigests) {
+    auto a = DigestBuilder().add(uint64_t{1}).getDigest();
+    auto b = DigestBuilder().add(uint64_t{2}).getDigest();
+
+    // Sums do not depend on the order of the digests
+    auto a_then_b = a;
+    a_then_b += b;
+    auto b_then_a = b;
+    b_then_a += a;
+    EXPECT_EQ(a_then_b, b_then_a);
+
+    // Xoring a digest twice cancels it out
+    auto toggled = a;
+    toggled ^= b;
+    EXPECT_NE(toggled, a);
+    toggled ^= b;
+    EXPECT_EQ(toggled, a);
+}
+
+TEST(StateDigestTest, HexString) {
+    EXPECT_EQ((StateDigest{0x0123456789abcdef, 0xf}).toString(),
+              "0123456789abcdef000000000000000f");
+}
@@ -33,14 +33,18 @@ class StateSyncerTest : public Test {
     array<vector<state::Bot *>, 2> state_bots;
     array<vector<state::Tower *>, 2> state_towers;
 
-    void manageStateExpectations(array<vector<state::Bot *>, 2> bots,
-                                 array<vector<state::Tower *>, 2> towers) {
-        EXPECT_CALL(*this->state, getBots)
-            .Times(5)
-            .WillRepeatedly(Return(bots));
-        EXPECT_CALL(*this->state, getTowers)
-            .Times(5)
-            .WillRepeatedly(Return(towers));
+    void
+    manageStateExpectations(const array<vector<state::Bot *>, 2> &bots,
+                            const array<vector<state::Tower *>, 2> &towers) {
+        for (auto player_id : {PlayerId::PLAYER1, PlayerId::PLAYER2}) {
+            auto id = static_cast<size_t>(player_id);
+            EXPECT_CALL(*this->state, getBots(player_id))
+                .Times(3)
+                .WillRepeatedly(Return(Span<state::Bot *const>(bots[id])));
+            EXPECT_CALL(*this->state, getTowers(player_id))
+                .Times(3)
+                .WillRepeatedly(Return(Span<state::Tower *const>(towers[id])));
+        }
         EXPECT_CALL(*this->state, getMap)
             .Times(9)
             .WillRepeatedly(Return(map.get()));
@@ -114,6 +114,47 @@ TEST_F(StateTest, MoveBotTest) {
     EXPECT_EQ(bot_destination, DoubleVec2D(2, 2));
 }
 
+TEST_F(StateTest, ParallelUpdateTest) {
+    auto bots = state->getBots();
+    state->moveBot(bots[0][0]->getActorId(), DoubleVec2D(3.5, 4.5));
+    state->moveBot(bots[1][0]->getActorId(), DoubleVec2D(0.5, 1.5));
+
+    // Positions the bots would move to if updated one after the other
+    auto path_planner = state->getPathPlanner();
+    path_planner->recomputePathGraph();
+    auto expected_positions = array<DoubleVec2D, 2>{};
+    for (size_t id = 0; id < 2; ++id) {
+        auto bot = bots[id][0];
+        expected_positions[id] = path_planner->getNextPosition(
+            bot->getPosition(), bot->getDestination(), bot->getSpeed());
+    }
+
+    state->setNumUpdateThreads(3);
+    state->update();
+
+    EXPECT_EQ(bots[0][0]->getPosition(), expected_positions[0]);
+    EXPECT_EQ(bots[1][0]->getPosition(), expected_positions[1]);
+}
+
+TEST_F(StateTest, DigestTest) {
+    auto digest = state->getDigest();
+    EXPECT_EQ(state->getDigest(), digest);
+
+    // Orders to bots are part of the state
+    auto bots = state->getBots();
+    state->moveBot(bots[0][0]->getActorId(), DoubleVec2D(3.5, 4.5));
+    auto moving_digest = state->getDigest();
+    EXPECT_NE(moving_digest, digest);
+
+    state->update();
+    EXPECT_NE(state->getDigest(), moving_digest);
+
+    // Building a tower changes the terrain
+    auto terrain_digest = state->getPathPlanner()->getTerrainDigest();
+    state->getPathPlanner()->buildTower(DoubleVec2D(2, 2), PlayerId::PLAYER1);
+    EXPECT_NE(state->getPathPlanner()->getTerrainDigest(), terrain_digest);
+}
+
 TEST_F(StateTest, CreateTowerTest) {
     // Transforming the first bot of PLAYER2 into a tower
     auto bots = state->getBots();
@@ -305,6 +346,10 @@ TEST_F(StateTest, DamageEnemyActorsTest) {
     state->damageEnemyActors(PlayerId::PLAYER1, bot->getActorId(),
                              bot->getPosition());
 
+    // The blast only deals damage once resolved
+    EXPECT_EQ(bots[1][0]->getDamageIncurred(), 0);
+    state->resolveBlasts();
+
     // Checking the damage incurred of PLAYER1 and PLAYER2
     bots = state->getBots();
     towers = state->getTowers();
@@ -329,6 +374,57 @@ TEST_F(StateTest, DamageEnemyActorsTest) {
     EXPECT_EQ(towers[1][0]->getDamageIncurred(), damage_incurred_tower);
 }
 
+TEST_F(StateTest, ResolveBlastsAccumulatesDamage) {
+    auto bots = state->getBots();
+    auto towers = state->getTowers();
+
+    auto bot = bots[0][0];
+    auto tower = towers[0][0];
+    auto enemy_bot = bots[1][0];
+    auto enemy_tower = towers[1][0];
+
+    bot->setPosition(DoubleVec2D(2, 2));
+    tower->setPosition(DoubleVec2D(2, 3));
+    enemy_bot->setPosition(DoubleVec2D(2.5, 2.5));
+    enemy_tower->setPosition(DoubleVec2D(40, 40));
+
+    // Damage each blast would deal to the enemy bot on its own
+    auto blastDamage = [&enemy_bot](Blaster *blaster, DoubleVec2D position) {
+        double_t impact_radius = blaster->getBlastRange();
+        double_t distance = position.distance(enemy_bot->getPosition());
+        return static_cast<uint64_t>(blaster->getBlastDamage() *
+                                     ((impact_radius - distance) /
+                                      impact_radius));
+    };
+    auto expected_damage = blastDamage(bot, bot->getPosition()) +
+                           blastDamage(tower, tower->getPosition());
+
+    state->damageEnemyActors(PlayerId::PLAYER1, bot->getActorId(),
+                             bot->getPosition());
+    state->damageEnemyActors(PlayerId::PLAYER1, tower->getActorId(),
+                             tower->getPosition());
+    state->resolveBlasts();
+
+    EXPECT_EQ(enemy_bot->getDamageIncurred(),
+              std::min<uint64_t>(expected_damage, enemy_bot->getHp()));
+    EXPECT_EQ(enemy_tower->getDamageIncurred(), 0);
+    EXPECT_EQ(bot->getDamageIncurred(), 0);
+    EXPECT_EQ(tower->getDamageIncurred(), 0);
+
+    // Blasts are only resolved once
+    state->resolveBlasts();
+    EXPECT_EQ(enemy_bot->getDamageIncurred(),
+              std::min<uint64_t>(expected_damage, enemy_bot->getHp()));
+
+    // Damage incurred is capped at the actor's hp
+    for (size_t i = 0; i < 10; ++i) {
+        state->damageEnemyActors(PlayerId::PLAYER1, bot->getActorId(),
+                                 bot->getPosition());
+    }
+    state->resolveBlasts();
+    EXPECT_EQ(enemy_bot->getDamageIncurred(), enemy_bot->getHp());
+}
+
 TEST_F(StateTest, GetAffectedActorsTest) {
     // Moving PLAYER1 bot to center and making the PLAYER2 tower in it's blast
     // range but not the PLAYER2 bot
@@ -0,0 +1,78 @@
+#include "state/turn_arena.h"
+#include "physics/vector.hpp"
+#include "state/transform_request.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace state;
+
+class TurnArenaTest : public testing::Test {
+  protected:
+    TurnArena arena;
+};
+
+TEST_F(TurnArenaTest, AlignedAllocations) {
+    auto *byte = arena.allocate(1, 1);
+    auto *number = arena.allocate(sizeof(double), alignof(double));
+
+    EXPECT_NE(byte, number);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(number) % alignof(double), 0);
+    EXPECT_EQ(arena.getNumAllocations(), 2);
+    EXPECT_EQ(arena.getNumBytes(), 2 * sizeof(double));
+    EXPECT_EQ(arena.getCapacity(), TurnArena::BLOCK_SIZE);
+}
+
+TEST_F(TurnArenaTest, ResetReusesBlocks) {
+    auto *first = arena.allocate(64, 8);
+    for (int i = 0; i < 3; ++i) {
+        arena.allocate(TurnArena::BLOCK_SIZE / 2, 8);
+    }
+    auto capacity = arena.getCapacity();
+    EXPECT_EQ(capacity, 2 * TurnArena::BLOCK_SIZE);
+
+    // The next turn starts again from the first block, without growing
+    arena.reset();
+    EXPECT_EQ(arena.getNumAllocations(), 0);
+    EXPECT_EQ(arena.getNumBytes(), 0);
+    EXPECT_EQ(arena.allocate(64, 8), first);
+    for (int i = 0; i < 3; ++i) {
+        arena.allocate(TurnArena::BLOCK_SIZE / 2, 8);
+    }
+    EXPECT_EQ(arena.getCapacity(), capacity);
+}
+
+TEST_F(TurnArenaTest, LargeAllocation) {
+    arena.allocate(8, 8);
+    arena.allocate(3 * TurnArena::BLOCK_SIZE, 8);
+
+    EXPECT_EQ(arena.getCapacity(), 4 * TurnArena::BLOCK_SIZE);
+}
+
+TEST_F(TurnArenaTest, CreateObjects) {
+    auto *request =
+        arena.create<TransformRequest>(PlayerId::PLAYER2, 4, DoubleVec2D(1, 2));
+
+    EXPECT_EQ(request->getPlayerId(), PlayerId::PLAYER2);
+    EXPECT_EQ(request->getBotId(), 4);
+    EXPECT_EQ(request->getPosition(), DoubleVec2D(1, 2));
+}
+
+TEST_F(TurnArenaTest, ArenaVectors) {
+    auto numbers = ArenaVector<int64_t>(&arena);
+    for (int64_t i = 0; i < 1000; ++i) {
+        numbers.push_back(i);
+    }
+
+    EXPECT_EQ(numbers.size(), 1000);
+    EXPECT_EQ(numbers[999], 999);
+    EXPECT_GE(arena.getNumBytes(), 1000 * sizeof(int64_t));
+
+    // Without an arena, the vector uses the heap
+    auto heap_numbers = ArenaVector<int64_t>();
+    heap_numbers.assign(numbers.begin(), numbers.end());
+    EXPECT_TRUE(equal(numbers.begin(), numbers.end(), heap_numbers.begin()));
+    EXPECT_EQ(heap_numbers.get_allocator().getArena(), nullptr);
+}
@@ -0,0 +1,82 @@
+#include "state/worker_pool.h"
+
+#include <csignal>
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace state;
+
+TEST(WorkerPoolTest, RunsEveryTaskOnce) {
+    WorkerPool worker_pool(4);
+    ASSERT_EQ(worker_pool.getNumThreads(), 4);
+
+    // Several batches on the same pool
+    for (size_t num_tasks : {0, 1, 3, 100, 1000}) {
+        auto results = vector<size_t>(num_tasks, 0);
+        worker_pool.run(num_tasks, [&results](size_t task) {
+            results[task] += task + 1;
+        });
+
+        for (size_t task = 0; task < num_tasks; ++task) {
+            ASSERT_EQ(results[task], task + 1);
+        }
+    }
+}
+
+TEST(WorkerPoolTest, SingleThread) {
+    WorkerPool worker_pool(1);
+    auto tasks = vector<size_t>{};
+    worker_pool.run(5, [&tasks](size_t task) { tasks.push_back(task); });
+
+    // The calling thread runs the tasks in order
+    ASSERT_EQ(tasks, (vector<size_t>{0, 1, 2, 3, 4}));
+}
+
+TEST(WorkerPoolTest, RethrowsTaskErrors) {
+    WorkerPool worker_pool(4);
+
+    ASSERT_THROW(worker_pool.run(100,
+                                 [](size_t task) {
+                                     if (task == 42) {
+                                         throw runtime_error("Task failed");
+                                     }
+                                 }),
+                 runtime_error);
+
+    // The pool is still usable afterwards
+    auto results = vector<int>(10, 0);
+    worker_pool.run(10, [&results](size_t task) { results[task] = 1; });
+    ASSERT_EQ(results, vector<int>(10, 1));
+}
+
+TEST(WorkerPoolTest, WorkersBlockSignals) {
+    WorkerPool worker_pool(4);
+    auto calling_thread = this_thread::get_id();
+
+    // SIGCHLD stays with the threads that wait on it, as the process
+    // supervisor's signalfd does
+    auto is_blocked = vector<int>(100, -1);
+    worker_pool.run(is_blocked.size(), [&](size_t task) {
+        if (this_thread::get_id() == calling_thread) {
+            return;
+        }
+        sigset_t signal_mask;
+        pthread_sigmask(SIG_SETMASK, nullptr, &signal_mask);
+        is_blocked[task] = sigismember(&signal_mask, SIGCHLD);
+    });
+    for (auto blocked : is_blocked) {
+        EXPECT_NE(blocked, 0);
+    }
+
+    sigset_t signal_mask;
+    pthread_sigmask(SIG_SETMASK, nullptr, &signal_mask);
+    EXPECT_EQ(sigismember(&signal_mask, SIGCHLD), 0);
+}
+
+TEST(WorkerPoolTest, InvalidNumThreads) {
+    ASSERT_THROW(WorkerPool(0), invalid_argument);
+}
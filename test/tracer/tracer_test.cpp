@@ -0,0 +1,82 @@
+#include "tracer/tracer.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace tracer;
+using namespace std;
+
+const string trace_file_prefix = "tracer_test";
+
+string readFile(const string &file_name) {
+    ifstream file(file_name);
+    stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+class TracerTest : public testing::Test {
+  protected:
+    void TearDown() override {
+        Tracer::disable();
+        for (auto process_name : {"main", "player_1", "player_2"}) {
+            remove(Tracer::getTraceFileName(trace_file_prefix, process_name)
+                       .c_str());
+        }
+        remove((trace_file_prefix + ".json").c_str());
+    }
+};
+
+TEST_F(TracerTest, DisabledTracerRecordsNothing) {
+    EXPECT_FALSE(Tracer::isEnabled());
+
+    { ScopedSpan span("disabled_span", "test"); }
+    Tracer::flush();
+
+    auto trace_file_name = Tracer::getTraceFileName(trace_file_prefix, "main");
+    EXPECT_FALSE(ifstream(trace_file_name).good());
+}
+
+TEST_F(TracerTest, SpansFromAllThreadsAreFlushed) {
+    Tracer::enable(trace_file_prefix, "main");
+    EXPECT_TRUE(Tracer::isEnabled());
+
+    { ScopedSpan span("main_thread_span", "test"); }
+    thread([] { ScopedSpan span("other_thread_span", "test"); }).join();
+
+    Tracer::flush();
+
+    auto trace = readFile(Tracer::getTraceFileName(trace_file_prefix, "main"));
+    EXPECT_EQ(trace.front(), '[');
+    EXPECT_NE(trace.find("\"args\":{\"name\":\"main\"}"), string::npos);
+    EXPECT_NE(trace.find("\"name\":\"main_thread_span\""), string::npos);
+    EXPECT_NE(trace.find("\"name\":\"other_thread_span\""), string::npos);
+    EXPECT_NE(trace.find("\"cat\":\"test\",\"ph\":\"X\""), string::npos);
+}
+
+TEST_F(TracerTest, ProcessTracesAreMerged) {
+    Tracer::enable(trace_file_prefix, "player_1");
+    { ScopedSpan span("player_span", "test"); }
+    Tracer::flush();
+
+    Tracer::enable(trace_file_prefix, "main");
+    { ScopedSpan span("main_span", "test"); }
+    Tracer::flush();
+
+    // player_2 has no trace file, and is skipped
+    Tracer::mergeProcessTraces({"main", "player_1", "player_2"});
+
+    auto trace = readFile(trace_file_prefix + ".json");
+    EXPECT_EQ(trace.front(), '[');
+    EXPECT_EQ(trace.substr(trace.size() - 2), "]\n");
+    EXPECT_NE(trace.find("\"args\":{\"name\":\"main\"}"), string::npos);
+    EXPECT_NE(trace.find("\"args\":{\"name\":\"player_1\"}"), string::npos);
+    EXPECT_NE(trace.find("\"name\":\"player_span\""), string::npos);
+
+    // The two arrays are joined by a single comma
+    EXPECT_EQ(trace.find("]"), trace.size() - 2);
+    EXPECT_EQ(trace.find(",,"), string::npos);
+}